@@ -0,0 +1,186 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDAndersonAcceleration.cxx - Source for Anderson Mixing of Newton Steps
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The least squares problem min |f_k - dF*gamma| over the differences
+//  of successive corrections is solved with modified Gram-Schmidt. Nearly
+//  dependent differences are dropped, the oldest first, which keeps the
+//  combination well conditioned.
+//
+
+# include <cmath>
+
+# include "cvOneDAndersonAcceleration.h"
+
+// differences reduced below this fraction by the orthogonalization are dropped
+#define ANDERSON_DROP_TOLERANCE 1.0e-10
+// corrections shrinking by less than this factor are mixed
+#ifndef ANDERSON_CONTRACTION
+#define ANDERSON_CONTRACTION 0.3
+#endif
+
+cvOneDAndersonAcceleration::cvOneDAndersonAcceleration(int historyDepth){
+  depth = historyDepth;
+  corrections.resize(depth + 1);
+  images.resize(depth + 1);
+  Q.resize(depth);
+  R.resize(depth * depth);
+  gamma.resize(depth);
+  numberOfMixedUpdates = 0;
+  Reset();
+}
+
+void cvOneDAndersonAcceleration::Reset(void){
+  head = -1;
+  count = 0;
+}
+
+long cvOneDAndersonAcceleration::Slot(long k) const{
+  long size = corrections.size();
+  return (head - k + size) % size;
+}
+
+void cvOneDAndersonAcceleration::Update(cvOneDFEAVector& solution, const cvOneDFEAVector& correction, long areaEnd){
+  long dim = solution.GetDimension();
+  long i;
+  int j, l;
+
+  head = (head + 1) % (long)corrections.size();
+  if(count < (long)corrections.size()){
+    count++;
+  }
+  vector<double>& f = corrections[head];
+  vector<double>& g = images[head];
+  f.assign(correction.GetEntries(), correction.GetEntries() + dim);
+  g.resize(dim);
+  for(i = 0; i < dim; i++){
+    g[i] = solution.Get(i) + f[i];
+  }
+
+  // Newton steps that contract fast are kept, mixing them with the
+  // older steps would only spoil the quadratic rate
+  next = g;
+  int m = 0;
+  bool slow = false;
+  if(count > 1){
+    const vector<double>& fb = corrections[Slot(1)];
+    double norm = 0.0;
+    double normb = 0.0;
+    for(i = 0; i < dim; i++){
+      norm += f[i] * f[i];
+      normb += fb[i] * fb[i];
+    }
+    slow = (norm > ANDERSON_CONTRACTION * ANDERSON_CONTRACTION * normb);
+  }
+  if(slow){
+    // differences from the newest to the oldest, orthogonalized in turn
+    vector<int> used;
+    for(int k = 0; k < count - 1; k++){
+      const vector<double>& fa = corrections[Slot(k)];
+      const vector<double>& fb = corrections[Slot(k+1)];
+      vector<double>& q = Q[m];
+      q.resize(dim);
+      double norm0 = 0.0;
+      for(i = 0; i < dim; i++){
+        q[i] = fa[i] - fb[i];
+        norm0 += q[i] * q[i];
+      }
+      norm0 = sqrt(norm0);
+      for(j = 0; j < m; j++){
+        double h = 0.0;
+        for(i = 0; i < dim; i++){
+          h += q[i] * Q[j][i];
+        }
+        R[j*depth+m] = h;
+        for(i = 0; i < dim; i++){
+          q[i] -= h * Q[j][i];
+        }
+      }
+      double norm = 0.0;
+      for(i = 0; i < dim; i++){
+        norm += q[i] * q[i];
+      }
+      norm = sqrt(norm);
+      if(norm <= ANDERSON_DROP_TOLERANCE * norm0 || norm == 0.0){
+        continue;
+      }
+      for(i = 0; i < dim; i++){
+        q[i] /= norm;
+      }
+      R[m*depth+m] = norm;
+      used.push_back(k);
+      m++;
+    }
+
+    if(m > 0){
+      // gamma = R^-1 * Q^T * f
+      for(j = 0; j < m; j++){
+        double h = 0.0;
+        for(i = 0; i < dim; i++){
+          h += Q[j][i] * f[i];
+        }
+        gamma[j] = h;
+      }
+      for(j = m - 1; j >= 0; j--){
+        for(l = j + 1; l < m; l++){
+          gamma[j] -= R[j*depth+l] * gamma[l];
+        }
+        gamma[j] /= R[j*depth+j];
+      }
+      // next = g - dG * gamma
+      for(j = 0; j < m; j++){
+        const vector<double>& ga = images[Slot(used[j])];
+        const vector<double>& gb = images[Slot(used[j]+1)];
+        for(i = 0; i < dim; i++){
+          next[i] -= gamma[j] * (ga[i] - gb[i]);
+        }
+      }
+      for(i = 0; i < areaEnd; i += 2){
+        if(!(next[i] > 0.0)){
+          next = g;
+          m = 0;
+          count = 1;
+          break;
+        }
+      }
+    }
+  }
+
+  if(m > 0){
+    numberOfMixedUpdates++;
+  }
+  for(i = 0; i < dim; i++){
+    solution.Set(i, next[i]);
+  }
+}
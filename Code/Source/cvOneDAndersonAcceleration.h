@@ -0,0 +1,89 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDANDERSONACCELERATION_H
+#define CVONEDANDERSONACCELERATION_H
+
+//
+//  cvOneDAndersonAcceleration.h - Header for Anderson Mixing of Newton Steps
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The Newton iteration of a time step is seen as the fixed point map
+//  g(x) = x + dx(x). Instead of g of the last iterate, the next iterate
+//  is the combination of the last few g whose corrections dx best cancel
+//  in the least squares sense. This recovers a superlinear rate when the
+//  corrections are only approximate, e.g. with a frozen tangent, and
+//  damps the oscillations of Newton around stenoses.
+//
+
+# include <vector>
+
+# include "cvOneDFEAVector.h"
+
+using namespace std;
+
+class cvOneDAndersonAcceleration{
+
+  public:
+
+    // depth is the number of previous corrections combined
+    cvOneDAndersonAcceleration(int depth);
+
+    // forgets the history, called at the start of every time step
+    void Reset(void);
+    // solution is the iterate the correction was computed at, it is
+    // replaced by the next iterate. Falls back to the plain update, and
+    // restarts the history, if an area of the first areaEnd entries
+    // would not be positive
+    void Update(cvOneDFEAVector& solution, const cvOneDFEAVector& correction, long areaEnd);
+
+    long GetNumberOfMixedUpdates(void) const {return numberOfMixedUpdates;}
+
+  private:
+
+    // slot of the entry k updates before the last one stored
+    long Slot(long k) const;
+
+    int depth;
+    vector<vector<double> > corrections;
+    vector<vector<double> > images;
+    long head;
+    long count;
+    long numberOfMixedUpdates;
+
+    // work arrays of the least squares problem
+    vector<vector<double> > Q;
+    vector<double> R;
+    vector<double> gamma;
+    vector<double> next;
+};
+
+#endif // CVONEDANDERSONACCELERATION_H
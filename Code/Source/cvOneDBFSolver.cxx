@@ -30,14 +30,26 @@
  */
 
 # include <time.h>
+# include <exception>
+# include <thread>
 
 # include "cvOneDGlobal.h"
 # include "cvOneDString.h"
 # include "cvOneDException.h"
+# include "cvOneDUtility.h"
 # include "cvOneDBFSolver.h"
 # include "cvOneDMaterial.h"
 # include "cvOneDMthSegmentModel.h"
 # include "cvOneDMthBranchModel.h"
+# include "cvOneDSkylineMatrix.h"
+# include "cvOneDKrylovLinearSolver.h"
+# include "cvOneDDistributedLinearSolver.h"
+# include "cvOneDPeriodicShooting.h"
+# include "cvOneDExplicitEngine.h"
+# include "cvOneDSkylineBatchSolver.h"
+# include "cvOneDResultFile.h"
+# include "cvOneDContext.h"
+# include "cvOneDWaveformRelaxation.h"
 
 #ifndef WIN32
 #define _USE_MATH_DEFINES
@@ -59,51 +71,90 @@
   # include "sparse/cvOneDSparseLinearSolver.h"
 # endif
 
+# ifdef USE_KLU
+  # include "sparse/cvOneDSparseMatrix.h"
+  # include "sparse/cvOneDSparseLinearSolver.h"
+# endif
+
 # define baryeTommHg 0.0007500615613026439
 
 //
 //  cvOneDBFSolver.cpp - Source for a One-Dimensional Network Blood Flow Solver
 //  ~~~~~~~~~~~~
-//  This is a static class which abstracts the blood flow solver.
-//  Essentially, this is a driver for 1D finite element blood flow solver
+//  This class abstracts the blood flow solver, each instance holds the
+//  state of one simulation.  Essentially, this is a driver for 1D finite element blood flow solver
 //  without any interfaces.
 //
 
-// Static Declarations...
-bool                          cvOneDBFSolver::wasSet = false;
-cvOneDModel*                  cvOneDBFSolver::model = NULL;
-cvOneDFEAVector*              cvOneDBFSolver::currentSolution = NULL;
-cvOneDFEAVector*              cvOneDBFSolver::previousSolution = NULL;
-cvOneDFEAVector*              cvOneDBFSolver::increment = NULL;
-cvOneDFEAVector*              cvOneDBFSolver::rhs = NULL;
-cvOneDMatrix<double>          cvOneDBFSolver::TotalSolution;
-cvOneDFEAMatrix*              cvOneDBFSolver::lhs = NULL;
-vector<cvOneDMthModelBase*>   cvOneDBFSolver::mathModels;
-vector<cvOneDSubdomain*>      cvOneDBFSolver::subdomainList;
-vector<cvOneDFEAJoint*>       cvOneDBFSolver::jointList;
-vector<int>                   cvOneDBFSolver::outletList;
-double                        cvOneDBFSolver::currentTime = 0;
-double                        cvOneDBFSolver::deltaTime = 0;
-double                        cvOneDBFSolver::Period = 0;
-long                          cvOneDBFSolver::stepSize = 0;
-long                          cvOneDBFSolver::maxStep = 0;
-long                          cvOneDBFSolver::quadPoints = 0;
-double*                       cvOneDBFSolver::flowRate = NULL;
-double*                       cvOneDBFSolver::flowTime = NULL;
-long                          cvOneDBFSolver::numFlowPts = 0;
-double                        cvOneDBFSolver::convCriteria = 0;
-BoundCondType                 cvOneDBFSolver::inletBCtype;
-int                           cvOneDBFSolver::ASCII = 1;
+cvOneDBFSolver::cvOneDBFSolver(cvOneDMaterialManager* materials){
+  materialManager = materials;
+}
+
+cvOneDBFSolver::~cvOneDBFSolver(){
+  for(size_t i = 0; i < subdomainList.size(); i++){
+    delete subdomainList[i];
+  }
+  for(size_t i = 0; i < jointList.size(); i++){
+    delete jointList[i];
+  }
+  FreeSystem();
+  delete predictor;
+  delete anderson;
+  delete [] flowTime;
+  delete [] flowRate;
+}
+
+void cvOneDBFSolver::FreeSystem(void){
+  for(size_t i = 0; i < mathModels.size(); i++){
+    delete mathModels[i];
+  }
+  mathModels.clear();
+  delete currentSolution;
+  delete previousSolution;
+  delete olderSolution;
+  delete increment;
+  delete rhs;
+  delete searchOrigin;
+  delete savedSolution;
+  delete lhs;
+  delete linearSolver;
+  currentSolution = previousSolution = olderSolution = NULL;
+  increment = rhs = searchOrigin = savedSolution = NULL;
+  lhs = NULL;
+  linearSolver = NULL;
+}
 
 // SET MODE PTR
 void cvOneDBFSolver::SetModelPtr(cvOneDModel *mdl){
   model = mdl;
 }
 
+namespace {
+
+// Pressure, Reynolds number and Poiseuille wall shear stress of a node at
+// z of a segment from its area and flow rate, the values of every result
+// file and of the result arrays
+void NodeResults(cvOneDMaterial* material, double z, double area, double flow,
+                 double& pressure, double& reynolds, double& wss){
+  double r = sqrt(area/M_PI);
+  pressure = material->GetPressure(area, z);
+  //usual Re=rho/mu*D*velocity=rho/mu*Q*sqrt(4/Pi/Area)
+  reynolds = material->GetDensity()/material->GetDynamicViscosity()*flow/sqrt(area)*sqrt(4.0/M_PI);
+  wss = (4.0*material->GetDynamicViscosity()*flow)/(M_PI*r*r*r);
+}
+
+} // namespace
+
 // ==================
 // WRITE TEXT RESULTS
 // ==================
 void cvOneDBFSolver::postprocess_Text(){
+  WriteTextResults([](const string& fileName){
+    return shared_ptr<ostream>(new ofstream(fileName.c_str(), ios::out));
+  });
+}
+
+void cvOneDBFSolver::WriteTextResults(const TextResultSink& openFile){
   int j;
   int fileIter;
   int elCount = 0;
@@ -151,16 +202,25 @@ void cvOneDBFSolver::postprocess_Text(){
     cout << tmp6 << endl;
 
     FILE *fp1,*fp2,*fp3,*fp5,*fp6; //for binary
-    ofstream flow,area,pressure,reynolds,wss; // for ASCII
+    shared_ptr<ostream> files[5]; // for ASCII
+    ostream noFile(NULL);
 
     if(ASCII){
 
         // Text Files
-        flow.open(tmp2, ios::out);
-        area.open(tmp3, ios::out);
-        pressure.open(tmp4, ios::out);
-        reynolds.open(tmp5, ios::out);
-        wss.open(tmp6, ios::out);
+        files[0] = openFile(tmp2);
+        files[1] = openFile(tmp3);
+        files[2] = openFile(tmp4);
+        files[3] = openFile(tmp5);
+        files[4] = openFile(tmp6);
+    }
+    ostream& flow = ASCII ? *files[0] : noFile;
+    ostream& area = ASCII ? *files[1] : noFile;
+    ostream& pressure = ASCII ? *files[2] : noFile;
+    ostream& reynolds = ASCII ? *files[3] : noFile;
+    ostream& wss = ASCII ? *files[4] : noFile;
+
+    if(ASCII){
 
         flow.precision(OUTPUT_PRECISION);
         area.precision(OUTPUT_PRECISION);
@@ -195,7 +255,7 @@ void cvOneDBFSolver::postprocess_Text(){
 
     // Output the Area/Pressure/Reynolds/WSS file
     int ii;
-    double Re, r, flo, wssVal;
+    double Re, p, flo, wssVal;
 
     for(ii=0,j=startOut;ii<numEls+1 && j<finishOut;ii++,j+=2){
       double z = (ii/double(numEls))*segLength;
@@ -207,17 +267,14 @@ void cvOneDBFSolver::postprocess_Text(){
         }else{
           fwrite(&val,sizeof(double),1,fp2);
         }
-        r = sqrt(val/M_PI);
         flo = (double)TotalSolution[i][j+1];
-        //usual Re=rho/mu*D*velocity=rho/mu*Q*sqrt(4/Pi/Area)
-        Re = curMat->GetDensity()/curMat->GetDynamicViscosity()*flo/sqrt(val)*sqrt(4.0/M_PI);
+        NodeResults(curMat, z, val, flo, p, Re, wssVal);
 
         // Write pressure - Initial (CGS) Units
-        val = (double) curMat->GetPressure(TotalSolution[i][j],z);
         if(ASCII){
-          pressure << curMat->GetPressure(TotalSolution[i][j],z) << " ";
+          pressure << p << " ";
         }else{
-          fwrite(&val, sizeof(double),1,fp3);
+          fwrite(&p, sizeof(double),1,fp3);
         }
 
         if(ASCII){
@@ -226,8 +283,7 @@ void cvOneDBFSolver::postprocess_Text(){
           fwrite(&Re,sizeof(double),1,fp5);
         }
 
-        // Compute Wall Shear Stresses for Poiseuille flow
-        wssVal = (4.0*curMat->GetDynamicViscosity()*flo)/(M_PI*r*r*r);
+        // Wall Shear Stresses for Poiseuille flow
         if(ASCII){
           wss << wssVal << " ";
         }else{
@@ -244,13 +300,8 @@ void cvOneDBFSolver::postprocess_Text(){
 
     elCount += 2*(numEls+1);
 
-    if(ASCII){
-      area.close();
-      pressure.close();
-      reynolds.close();
-      flow.close();
-      wss.close();
-    }else{
+    // the text files are closed with their streams
+    if(!ASCII){
       fclose(fp1); //flow.dat
       fclose(fp2); //area.dat
       fclose(fp3); //pressure.dat
@@ -403,11 +454,11 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
   for(int loopSegment=0;loopSegment<model->getNumberOfSegments();loopSegment++){
     if(segInlets[loopSegment] == -1){
       // CHECK INLETS
-      printf("ERROR: INLET FOR SEGMENT %d\n",loopSegment);
+      cvOneDPrintf("ERROR: INLET FOR SEGMENT %d\n",loopSegment);
     }
     if(segOutlets[loopSegment] == -1){
       // CHECK OUTLETS
-      printf("ERROR: OUTLET FOR SEGMENT %d\n",loopSegment);
+      cvOneDPrintf("ERROR: OUTLET FOR SEGMENT %d\n",loopSegment);
     }
   }
 
@@ -429,9 +480,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
   int finishOut = 0;
   double segLength = 0.0;
   double z = 0.0;
-  double flo = 0.0;
-  double area = 0.0;
-  double radius = 0.0;
+  double pressure = 0.0;
   double Re = 0.0;
   double wss = 0.0;
   double iniArea = 0.0;
@@ -535,7 +584,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
     for(int loopTime=0;loopTime<TotalSolution.Rows();loopTime++){
 
       // PRINT FLOW RATES
-      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Flowrate_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",loopTime*stepSize,loopTime*deltaTime*stepSize);
+      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Flowrate_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",(loopTime+outputOffset)*stepSize,(loopTime+outputOffset)*deltaTime*stepSize);
       for(int j=startOut+1;j<finishOut;j+=2){
         for(int k=0;k<circSubdiv;k++){
           fprintf(vtkFile,"%e ",(double)TotalSolution[loopTime][j]);
@@ -545,7 +594,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
       fprintf(vtkFile,"</DataArray>\n");
 
       // PRINT AREA
-      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Area_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",loopTime*stepSize,loopTime*deltaTime*stepSize);
+      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Area_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",(loopTime+outputOffset)*stepSize,(loopTime+outputOffset)*deltaTime*stepSize);
       for(int j=startOut;j<finishOut;j+=2){
         for(int k=0;k<circSubdiv;k++){
           fprintf(vtkFile,"%e ",(double)TotalSolution[loopTime][j]);
@@ -555,7 +604,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
       fprintf(vtkFile,"</DataArray>\n");
 
       // PRINT RADIAL DISPLACEMENTS AS VECTORS
-      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Disps_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"3\" format=\"ascii\">\n",loopTime*stepSize,loopTime*deltaTime*stepSize);
+      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Disps_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"3\" format=\"ascii\">\n",(loopTime+outputOffset)*stepSize,(loopTime+outputOffset)*deltaTime*stepSize);
       for(int j=startOut;j<finishOut;j+=2){
 
         // Evaluate Initial Area at current location
@@ -579,14 +628,15 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
       fprintf(vtkFile,"</DataArray>\n");
 
       // PRINT PRESSURE IN MMHG
-      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Pressure_mmHg_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",loopTime*stepSize,loopTime*deltaTime*stepSize);
+      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Pressure_mmHg_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",(loopTime+outputOffset)*stepSize,(loopTime+outputOffset)*deltaTime*stepSize);
       segLength = currSeg->getSegmentLength();
       curMat = subdomainList[loopSegment]->GetMaterial();
       int section = 0;
       for(int j=startOut;j<finishOut;j+=2){
         z = (section/(double)currSeg->getNumElements())*segLength;
+        NodeResults(curMat, z, TotalSolution[loopTime][j], TotalSolution[loopTime][j+1], pressure, Re, wss);
         for(int k=0;k<circSubdiv;k++){
-          fprintf(vtkFile,"%e ",curMat->GetPressure(TotalSolution[loopTime][j],z)*baryeTommHg);
+          fprintf(vtkFile,"%e ",pressure*baryeTommHg);
         }
         fprintf(vtkFile,"\n");
         section++;
@@ -594,14 +644,13 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
       fprintf(vtkFile,"</DataArray>\n");
 
       // PRINT REYNOLDS NUMBER
-      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Reynolds_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",loopTime*stepSize,loopTime*deltaTime*stepSize);
+      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Reynolds_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",(loopTime+outputOffset)*stepSize,(loopTime+outputOffset)*deltaTime*stepSize);
       curMat = subdomainList[loopSegment]->GetMaterial();
+      section = 0;
       for(int j=startOut;j<finishOut;j+=2){
-        // Get Flow
-        flo = (double)TotalSolution[loopTime][j+1];
-        area = (double)TotalSolution[loopTime][j];
-        // Get Area
-        Re = curMat->GetDensity()/curMat->GetDynamicViscosity()*flo/sqrt(area)*sqrt(4.0/M_PI);
+        z = (section/(double)currSeg->getNumElements())*segLength;
+        NodeResults(curMat, z, TotalSolution[loopTime][j], TotalSolution[loopTime][j+1], pressure, Re, wss);
+        section++;
         for(int k=0;k<circSubdiv;k++){
           fprintf(vtkFile,"%e ",Re);
         }
@@ -610,14 +659,13 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
       fprintf(vtkFile,"</DataArray>\n");
 
       // PRINT WSS
-      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"WSS_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",loopTime*stepSize,loopTime*deltaTime*stepSize);
+      fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"WSS_INCR_%05ld_TIME_%.5f\" NumberOfComponents=\"1\" format=\"ascii\">\n",(loopTime+outputOffset)*stepSize,(loopTime+outputOffset)*deltaTime*stepSize);
       curMat = subdomainList[loopSegment]->GetMaterial();
+      section = 0;
       for(int j=startOut;j<finishOut;j+=2){
-        // Get Flow
-        flo = (double)TotalSolution[loopTime][j+1];
-        radius = sqrt((double)TotalSolution[loopTime][j]/M_PI);
-        // Get Area
-        wss = 4.0*curMat->GetDynamicViscosity()*flo/(M_PI*radius*radius*radius);
+        z = (section/(double)currSeg->getNumElements())*segLength;
+        NodeResults(curMat, z, TotalSolution[loopTime][j], TotalSolution[loopTime][j+1], pressure, Re, wss);
+        section++;
         for(int k=0;k<circSubdiv;k++){
           fprintf(vtkFile,"%e ",wss);
         }
@@ -638,7 +686,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_ONEFILE(){
   // Close
   fprintf(vtkFile,"</PolyData>\n");
   fprintf(vtkFile,"</VTKFile>\n");
-  printf("Results Exported to VTK File: %s\n",fileName);
+  cvOneDPrintf("Results Exported to VTK File: %s\n",fileName);
 }
 
 // =======================================================
@@ -715,11 +763,11 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
   for(int loopSegment=0;loopSegment<model->getNumberOfSegments();loopSegment++){
     if(segInlets[loopSegment] == -1){
       // CHECK INLETS
-      printf("ERROR: INLET FOR SEGMENT %d\n",loopSegment);
+      cvOneDPrintf("ERROR: INLET FOR SEGMENT %d\n",loopSegment);
     }
     if(segOutlets[loopSegment] == -1){
       // CHECK OUTLETS
-      printf("ERROR: OUTLET FOR SEGMENT %d\n",loopSegment);
+      cvOneDPrintf("ERROR: OUTLET FOR SEGMENT %d\n",loopSegment);
     }
   }
 
@@ -743,9 +791,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
   int finishOut = 0;
   double segLength = 0.0;
   double z = 0.0;
-  double flo = 0.0;
-  double area = 0.0;
-  double radius = 0.0;
+  double pressure = 0.0;
   double Re = 0.0;
   double wss = 0.0;
   double iniArea = 0.0;
@@ -760,7 +806,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
     fileName = model->getModelName();
     char timeString[512];
     char suffix[512];
-    sprintf(timeString, "_%05d", loopTime);
+    sprintf(timeString, "_%05ld", loopTime+outputOffset);
     fileName = fileName + string(timeString) + ".vtp";
     FILE* vtkFile;
     vtkFile = fopen(fileName.c_str(),"w");
@@ -924,8 +970,9 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
       int section = 0;
       for(int j=startOut;j<finishOut;j+=2){
         z = (section/(double)currSeg->getNumElements())*segLength;
+        NodeResults(curMat, z, TotalSolution[loopTime][j], TotalSolution[loopTime][j+1], pressure, Re, wss);
         for(int k=0;k<circSubdiv;k++){
-          fprintf(vtkFile,"%e ",curMat->GetPressure(TotalSolution[loopTime][j],z)*baryeTommHg);
+          fprintf(vtkFile,"%e ",pressure*baryeTommHg);
         }
         fprintf(vtkFile,"\n");
         section++;
@@ -934,12 +981,11 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
 
       // PRINT REYNOLDS NUMBER
       fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"Reynolds\" NumberOfComponents=\"1\" format=\"ascii\">\n");
+      section = 0;
       for(int j=startOut;j<finishOut;j+=2){
-        // Get Flow
-        flo = (double)TotalSolution[loopTime][j+1];
-        area = (double)TotalSolution[loopTime][j];
-        // Get Area
-        Re = curMat->GetDensity()/curMat->GetDynamicViscosity()*flo/sqrt(area)*sqrt(4.0/M_PI);
+        z = (section/(double)currSeg->getNumElements())*segLength;
+        NodeResults(curMat, z, TotalSolution[loopTime][j], TotalSolution[loopTime][j+1], pressure, Re, wss);
+        section++;
         for(int k=0;k<circSubdiv;k++){
           fprintf(vtkFile,"%e ",Re);
         }
@@ -949,13 +995,11 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
 
       // PRINT WSS
       fprintf(vtkFile,"<DataArray type=\"Float32\" Name=\"WSS\" NumberOfComponents=\"1\" format=\"ascii\">\n");
+      section = 0;
       for(int j=startOut;j<finishOut;j+=2){
-        // Get Flow
-        flo = (double)TotalSolution[loopTime][j+1];
-        // Get Radius
-        radius = sqrt((double)TotalSolution[loopTime][j]/M_PI);
-        // Get WSS
-        wss = 4.0*curMat->GetDynamicViscosity()*flo/(M_PI*radius*radius*radius);
+        z = (section/(double)currSeg->getNumElements())*segLength;
+        NodeResults(curMat, z, TotalSolution[loopTime][j], TotalSolution[loopTime][j+1], pressure, Re, wss);
+        section++;
         for(int k=0;k<circSubdiv;k++){
           fprintf(vtkFile,"%e ",wss);
         }
@@ -986,7 +1030,7 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
   fprintf(pvdFile,"<VTKFile type=\"Collection\" version=\"0.1\" byte_order=\"LittleEndian\">");
   fprintf(pvdFile,"<Collection>");
   // Loop through the dataset
-  double currTime = 0.0;
+  double currTime = outputOffset * deltaTime * stepSize;
   for(int loopA=0;loopA<fileList.size();loopA++){
     fprintf(pvdFile,"<DataSet timestep=\"%e\" group=\"\" part=\"0\" file=\"%s\"/>",currTime,fileList[loopA].c_str());
     currTime += deltaTime * stepSize;
@@ -994,7 +1038,262 @@ void cvOneDBFSolver::postprocess_VTK_XML3D_MULTIPLEFILES(){
   fprintf(pvdFile,"</Collection>");
   fprintf(pvdFile,"</VTKFile>");
   fclose(pvdFile);
-  printf("Results Exported to VTK.\n");
+  cvOneDPrintf("Results Exported to VTK.\n");
+}
+
+// ======================
+// RESULTS AT SEGMENT ENDS
+// ======================
+void cvOneDBFSolver::GetSegmentEnds(long segment, cvDoubleVec& inletFlow, cvDoubleVec& outletFlow,
+                                    cvDoubleVec& inletPressure, cvDoubleVec& outletPressure){
+  // The columns of a segment follow those of the previous ones,
+  // area and flow rate at each node as in postprocess_Text
+  long first = 0;
+  for(long i = 0; i < segment; i++){
+    first += 2*(model->getSegment(i)->getNumElements()+1);
+  }
+  cvOneDSegment *curSeg = model->getSegment(segment);
+  cvOneDMaterial* curMat = subdomainList[segment]->GetMaterial();
+  long last = first + 2*curSeg->getNumElements();
+  double segLength = curSeg->getSegmentLength();
+
+  long rows = TotalSolution.Rows();
+  inletFlow.resize(rows);
+  outletFlow.resize(rows);
+  inletPressure.resize(rows);
+  outletPressure.resize(rows);
+  for(long i = 0; i < rows; i++){
+    inletFlow[i] = TotalSolution[i][first+1];
+    outletFlow[i] = TotalSolution[i][last+1];
+    inletPressure[i] = curMat->GetPressure(TotalSolution[i][first], 0.0);
+    outletPressure[i] = curMat->GetPressure(TotalSolution[i][last], segLength);
+  }
+}
+
+void cvOneDBFSolver::GetSegmentResults(long segment, cvDoubleVec& flow, cvDoubleVec& area, cvDoubleVec& pressure){
+  long first = 0;
+  for(long i = 0; i < segment; i++){
+    first += 2*(model->getSegment(i)->getNumElements()+1);
+  }
+  cvOneDSegment *curSeg = model->getSegment(segment);
+  cvOneDMaterial* curMat = subdomainList[segment]->GetMaterial();
+  long numEls = curSeg->getNumElements();
+  double segLength = curSeg->getSegmentLength();
+
+  long rows = TotalSolution.Rows();
+  flow.resize((numEls+1)*rows);
+  area.resize((numEls+1)*rows);
+  pressure.resize((numEls+1)*rows);
+  for(long ii = 0; ii < numEls+1; ii++){
+    double z = (ii/double(numEls))*segLength;
+    long j = first + 2*ii;
+    for(long i = 0; i < rows; i++){
+      double reynolds, wss;
+      area[ii*rows+i] = TotalSolution[i][j];
+      flow[ii*rows+i] = TotalSolution[i][j+1];
+      NodeResults(curMat, z, TotalSolution[i][j], TotalSolution[i][j+1], pressure[ii*rows+i], reynolds, wss);
+    }
+  }
+}
+
+// ====================
+// WRITE BINARY RESULTS
+// ====================
+// Each chunk of steps of a segment is assembled for all fields and written
+// at once, the values are those of the text files.
+void cvOneDBFSolver::postprocess_Binary(){
+  string fileName = string(model->getModelName()) + "results.bin";
+  long numSegs = model->getNumberOfSegments();
+  long rows = TotalSolution.Rows();
+
+  cvDoubleVec times(rows);
+  for(long i = 0; i < rows; i++){
+    times[i] = (i + outputOffset)*deltaTime*stepSize;
+  }
+  cvStringVec names(numSegs);
+  cvLongVec nodes(numSegs);
+  for(long s = 0; s < numSegs; s++){
+    names[s] = model->getSegment(s)->getSegmentName();
+    nodes[s] = model->getSegment(s)->getNumElements() + 1;
+  }
+  cvOneDResultFileWriter writer(fileName, times, names, nodes);
+
+  cvDoubleVec values;
+  long first = 0;
+  for(long s = 0; s < numSegs; s++){
+    cvOneDMaterial* curMat = subdomainList[s]->GetMaterial();
+    long numEls = nodes[s] - 1;
+    double segLength = model->getSegment(s)->getSegmentLength();
+    for(long c = 0; c < writer.GetNumberOfChunks(); c++){
+      long firstRow = c*writer.GetStepsPerChunk();
+      long steps = min(writer.GetStepsPerChunk(), rows - firstRow);
+      long fieldValues = steps*nodes[s];
+      values.resize(cvOneDResultFile::NUM_FIELDS*fieldValues);
+      double* flow = &values[cvOneDResultFile::FLOW*fieldValues];
+      double* area = &values[cvOneDResultFile::AREA*fieldValues];
+      double* pressure = &values[cvOneDResultFile::PRESSURE*fieldValues];
+      double* reynolds = &values[cvOneDResultFile::REYNOLDS*fieldValues];
+      double* wss = &values[cvOneDResultFile::WSS*fieldValues];
+      for(long i = 0; i < steps; i++){
+        for(long ii = 0; ii < nodes[s]; ii++){
+          long j = first + 2*ii;
+          long k = i*nodes[s] + ii;
+          double z = (ii/double(numEls))*segLength;
+          area[k] = TotalSolution[firstRow + i][j];
+          flow[k] = TotalSolution[firstRow + i][j+1];
+          NodeResults(curMat, z, area[k], flow[k], pressure[k], reynolds[k], wss[k]);
+        }
+      }
+      writer.WriteChunk(s, c, values.data());
+    }
+    first += 2*nodes[s];
+  }
+  writer.Close();
+  cout << "Results written to " << fileName << endl;
+}
+
+void cvOneDBFSolver::GetSegmentShearResults(long segment, cvDoubleVec& reynolds, cvDoubleVec& wss){
+  long first = 0;
+  for(long i = 0; i < segment; i++){
+    first += 2*(model->getSegment(i)->getNumElements()+1);
+  }
+  cvOneDMaterial* curMat = subdomainList[segment]->GetMaterial();
+  long numEls = model->getSegment(segment)->getNumElements();
+  double segLength = model->getSegment(segment)->getSegmentLength();
+
+  long rows = TotalSolution.Rows();
+  reynolds.resize((numEls+1)*rows);
+  wss.resize((numEls+1)*rows);
+  for(long ii = 0; ii < numEls+1; ii++){
+    double z = (ii/double(numEls))*segLength;
+    long j = first + 2*ii;
+    for(long i = 0; i < rows; i++){
+      double pressure;
+      NodeResults(curMat, z, TotalSolution[i][j], TotalSolution[i][j+1], pressure, reynolds[ii*rows+i], wss[ii*rows+i]);
+    }
+  }
+}
+
+// =============
+// CO-SIMULATION
+// =============
+// The steps of the partner are taken as those of the fixed step loop, with
+// the size of the previous step for BDF2. The boundary memory is saved
+// before each step as in the adaptive loop, so that UndoStep can restore it.
+int cvOneDBFSolver::Step(double dt){
+  if(!steppable || mathModels.empty()){
+    throw cvException("ERROR: The solver is not set up for stepping.\n");
+  }
+  if(dt <= 0.0){
+    throw cvException("ERROR: Invalid co-simulation time step.\n");
+  }
+  long dim = currentSolution->GetDimension();
+  undoSolution.assign(previousSolution->GetEntries(), previousSolution->GetEntries() + dim);
+  if(olderSolution != NULL){
+    undoOlderSolution.assign(olderSolution->GetEntries(), olderSolution->GetEntries() + dim);
+  }
+  undoTime = currentTime;
+  undoStepSize = lastStepSize;
+  for(size_t k = 0; k < subdomainList.size(); k++){
+    subdomainList[k]->SaveBoundaryMemory();
+  }
+
+  increment->Clear();
+  int numMath = mathModels.size();
+  for(int i = 0; i < numMath; i++){
+    mathModels[i]->TimeUpdate(currentTime, dt, lastStepSize);
+  }
+  currentTime += dt;
+  steppedSteps++;
+  int iter = SolveTimeStep(steppedSteps, dt, false);
+
+  // Saved as in the fixed step loop while there are rows for it
+  if(steppedSteps % stepSize == 0 && steppedSteps / stepSize < TotalSolution.Rows()){
+    double* tmp = currentSolution->GetEntries();
+    for(long j = 0; j < dim; j++){
+      TotalSolution[steppedSteps / stepSize][j] = tmp[j];
+    }
+  }
+  if(olderSolution != NULL){
+    *olderSolution = *previousSolution;
+  }
+  *previousSolution = *currentSolution;
+  lastStepSize = dt;
+  canUndo = true;
+  return iter;
+}
+
+void cvOneDBFSolver::UndoStep(void){
+  if(!canUndo){
+    throw cvException("ERROR: There is no co-simulation step to undo.\n");
+  }
+  long dim = currentSolution->GetDimension();
+  for(long j = 0; j < dim; j++){
+    previousSolution->Set(j, undoSolution[j]);
+  }
+  if(olderSolution != NULL){
+    for(long j = 0; j < dim; j++){
+      olderSolution->Set(j, undoOlderSolution[j]);
+    }
+  }
+  *currentSolution = *previousSolution;
+  for(size_t k = 0; k < subdomainList.size(); k++){
+    subdomainList[k]->RestoreBoundaryMemory();
+  }
+  currentTime = undoTime;
+  lastStepSize = undoStepSize;
+  steppedSteps--;
+  canUndo = false;
+}
+
+void cvOneDBFSolver::SetInletValue(double value){
+  for(size_t i = 0; i < mathModels.size(); i++){
+    mathModels[i]->SetCoupledInlet(value);
+  }
+}
+
+void cvOneDBFSolver::ClearInletValue(void){
+  for(size_t i = 0; i < mathModels.size(); i++){
+    mathModels[i]->ClearCoupledInlet();
+  }
+}
+
+void cvOneDBFSolver::SetOutletPressure(long segment, double pressure){
+  if(segment < 0 || segment >= (long)subdomainList.size() ||
+     subdomainList[segment]->GetBoundCondition() != BoundCondTypeScope::PRESSURE){
+    throw cvException("ERROR: The outlet pressure is only set on a PRESSURE outlet.\n");
+  }
+  subdomainList[segment]->SetBoundValue(pressure);
+}
+
+double cvOneDBFSolver::GetInletFlow(void){
+  long eqNumbers[2];
+  mathModels[0]->GetNodalEquationNumbers(0, eqNumbers, 0);
+  return currentSolution->Get(eqNumbers[1]);
+}
+
+double cvOneDBFSolver::GetInletPressure(void){
+  long eqNumbers[2];
+  mathModels[0]->GetNodalEquationNumbers(0, eqNumbers, 0);
+  return subdomainList[0]->GetMaterial()->GetPressure(currentSolution->Get(eqNumbers[0]), 0.0);
+}
+
+double cvOneDBFSolver::GetOutletFlow(long segment){
+  long eqNumbers[2];
+  cvOneDSubdomain* sub = subdomainList[segment];
+  mathModels[0]->GetNodalEquationNumbers(sub->GetNumberOfNodes() - 1, eqNumbers, segment);
+  return currentSolution->Get(eqNumbers[1]);
+}
+
+double cvOneDBFSolver::GetOutletPressure(long segment){
+  long eqNumbers[2];
+  cvOneDSubdomain* sub = subdomainList[segment];
+  mathModels[0]->GetNodalEquationNumbers(sub->GetNumberOfNodes() - 1, eqNumbers, segment);
+  return sub->GetMaterial()->GetPressure(currentSolution->Get(eqNumbers[0]), sub->GetLength());
+}
+
+void cvOneDBFSolver::GetState(cvDoubleVec& state){
+  state.assign(currentSolution->GetEntries(), currentSolution->GetEntries() + currentSolution->GetDimension());
 }
 
 // ====================
@@ -1024,33 +1323,78 @@ void cvOneDBFSolver::Solve(void){
   id = model -> getNumberOfSegments();
 
   int i;
-  for (i=0; i<id; i++){
-    CalcInitProps(i);
+  if(warmStart.empty()){
+    for (i=0; i<id; i++){
+      CalcInitProps(i);
+    }
+  }else{
+    cvOneDWarmStart results(warmStart);
+    for (i=0; i<id; i++){
+      results.Load(model->getSegment(i)->getSegmentName());
+      CalcWarmStartProps(i, results);
+    }
+    SetOutletStates();
+  }
+
+  // A steppable solver waits for the steps of its partner
+  if(steppable){
+    if(solverEngine == SolverEngineTypeScope::EXPLICIT_FV){
+      throw cvException("ERROR: A steppable solver requires the implicit engine.\n");
+    }
+    StartSolution();
+    int numMath = mathModels.size();
+    for(int i = 0; i < numMath; i++){
+      if(timeIntegrator == TimeIntegratorTypeScope::BDF2){
+        mathModels[i]->EquationInitialize(previousSolution, currentSolution, olderSolution);
+      }else{
+        mathModels[i]->EquationInitialize(previousSolution, currentSolution);
+      }
+    }
+    if(andersonDepth > 0){
+      anderson = new cvOneDAndersonAcceleration(andersonDepth);
+    }
+    lineSearchReductions = 0;
+    steppedSteps = 0;
+    lastStepSize = 0.0;
+    canUndo = false;
+    return;
   }
 
   // Start Solving the system.
   GenerateSolution();
 
+  WriteResults();
+}
+
+void cvOneDBFSolver::WriteResults(void){
+
+  // The other processes of a distributed run hold the same solution
+  if(cvOneDGlobal::rank != 0){
+    return;
+  }
+
   // Some Post Processing
-  if(cvOneDGlobal::outputType == OutputTypeScope::OUTPUT_TEXT){
+  if(outputType == OutputTypeScope::OUTPUT_TEXT){
     postprocess_Text();
-  }else if(cvOneDGlobal::outputType == OutputTypeScope::OUTPUT_VTK){
-    if(cvOneDGlobal::vtkOutputType == 0){
+  }else if(outputType == OutputTypeScope::OUTPUT_VTK){
+    if(vtkOutputType == 0){
       // Export in multifile format
       postprocess_VTK_XML3D_MULTIPLEFILES();
     }else{
       // All results in a single VTK File
       postprocess_VTK_XML3D_ONEFILE();
     }
-  }else if(cvOneDGlobal::outputType == OutputTypeScope::OUTPUT_BOTH){
+  }else if(outputType == OutputTypeScope::OUTPUT_BOTH){
     postprocess_Text();
-    if(cvOneDGlobal::vtkOutputType == 0){
+    if(vtkOutputType == 0){
       // Export in multifile format
       postprocess_VTK_XML3D_MULTIPLEFILES();
     }else{
       // All results in a single VTK File
       postprocess_VTK_XML3D_ONEFILE();
     }
+  }else if(outputType == OutputTypeScope::OUTPUT_BINARY){
+    postprocess_Binary();
   }
 }
 
@@ -1075,6 +1419,7 @@ void cvOneDBFSolver::DefineMthModels(){
 
   //specify inlet flow rate boundary condition with time
   segM->SetInflowRate(flowTime, flowRate, numFlowPts, flowTime[numFlowPts-1]);
+  segM->SetStabilization(stabilization);
   Period = flowTime[numFlowPts-1];
 
   cvOneDMthBranchModel* branchM = new cvOneDMthBranchModel(subdomainList, jointList, outletList);
@@ -1083,9 +1428,24 @@ void cvOneDBFSolver::DefineMthModels(){
 }
 
 void cvOneDBFSolver::AddOneModel(cvOneDMthModelBase* model){
+  SetupModel(model);
   mathModels.push_back(model);
 }
 
+void cvOneDBFSolver::SetupModel(cvOneDMthModelBase* model){
+  model->SetInletType(inletBCtype);
+  model->SetConservationForm(conservationForm);
+}
+
+void cvOneDBFSolver::FormShiftedResidual(const cvOneDFEAVector& shift, cvOneDFEAVector& residual){
+  *savedSolution = *currentSolution;
+  *currentSolution += shift;
+  for(int i = 0; i < mathModels.size(); i++){
+    mathModels[i]->FormResidual(&residual);
+  }
+  *currentSolution = *savedSolution;
+}
+
 void cvOneDBFSolver::QuerryModelInformation(void)
 {
     // place to create the subdomain and material.
@@ -1097,12 +1457,12 @@ void cvOneDBFSolver::QuerryModelInformation(void)
   outletList.resize(0);
   subdomainList.resize(0);
 
-    printf("\n");
-    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-    printf("Number of Joints: %ld\n",ij);
-    printf("Number of Segments: %ld\n",is);
-    printf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
-    printf("\n");
+    cvOneDPrintf("\n");
+    cvOneDPrintf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    cvOneDPrintf("Number of Joints: %ld\n",ij);
+    cvOneDPrintf("Number of Segments: %ld\n",is);
+    cvOneDPrintf("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
+    cvOneDPrintf("\n");
 
     long int i, j;
 
@@ -1163,7 +1523,7 @@ void cvOneDBFSolver::QuerryModelInformation(void)
       if(!seg->IsOutlet){
         subdomain->SetBoundCondition(BoundCondTypeScope::NOBOUND);
       }
-      subdomain->SetupMaterial(matID);
+      subdomain->SetupMaterial(matID, materialManager);
       subdomain->GetMaterial()->SetPeriod(Period);
 
       // Set up Minor Loss
@@ -1239,11 +1599,60 @@ void cvOneDBFSolver::SetInletBCType(BoundCondType bc){inletBCtype = bc;}
 void cvOneDBFSolver::SetMaxStep(long maxs){maxStep = maxs;}
 void cvOneDBFSolver::SetQuadPoints(long point){quadPoints = point;}
 void cvOneDBFSolver::SetConvergenceCriteria(double conv){convCriteria = conv;}
+void cvOneDBFSolver::SetNonlinearSolver(NonlinearSolverType type){nonlinearSolver = type;}
+void cvOneDBFSolver::SetKrylovRestart(int restart){krylovRestart = restart;}
+void cvOneDBFSolver::SetKrylovTolerance(double tolerance){krylovTolerance = tolerance;}
+void cvOneDBFSolver::SetPreconditionerRefresh(long steps){preconditionerRefresh = steps;}
+void cvOneDBFSolver::SetSolutionPredictor(PredictorType type){predictorType = type;}
+void cvOneDBFSolver::SetAndersonDepth(int depth){andersonDepth = depth;}
+void cvOneDBFSolver::SetLineSearch(int backtracks){lineSearch = backtracks;}
+void cvOneDBFSolver::SetTimeIntegrator(TimeIntegratorType type){timeIntegrator = type;}
+void cvOneDBFSolver::SetLinearSolves(int solves){linearSolves = solves;}
+void cvOneDBFSolver::SetSolverEngine(SolverEngineType engine){solverEngine = engine;}
+void cvOneDBFSolver::SetCourantNumber(double courant){courantNumber = courant;}
+void cvOneDBFSolver::SetSteadyState(SteadyStateType type){steadyState = type;}
+void cvOneDBFSolver::SetAdaptiveTimeStep(bool adaptive){adaptiveTimeStep = adaptive;}
+void cvOneDBFSolver::SetTimeStepTolerance(double tolerance){timeStepTolerance = tolerance;}
+void cvOneDBFSolver::SetMinTimeStep(double dt){minTimeStep = dt;}
+void cvOneDBFSolver::SetMaxTimeStep(double dt){maxTimeStep = dt;}
+void cvOneDBFSolver::SetPeriodicTolerance(double tolerance){periodicTolerance = tolerance;}
+void cvOneDBFSolver::SetPeriodicShooting(bool shooting){periodicShooting = shooting;}
+void cvOneDBFSolver::SetWarmStart(const string& prefix){warmStart = prefix;}
+void cvOneDBFSolver::SetParareal(int iterations){pararealIterations = iterations;}
+void cvOneDBFSolver::SetPararealCoarseFactor(int factor){pararealCoarseFactor = factor;}
+void cvOneDBFSolver::SetPararealWorkers(int workers){pararealWorkers = workers;}
+void cvOneDBFSolver::SetWorkerFactory(const WorkerFactory& factory){workerFactory = factory;}
+void cvOneDBFSolver::SetWaveformRelaxation(WaveformRelaxationType type){waveformRelaxation = type;}
+void cvOneDBFSolver::SetWaveformCuts(const cvStringVec& joints){waveformCuts = joints;}
+void cvOneDBFSolver::SetWaveformWindow(long steps){waveformWindow = steps;}
+void cvOneDBFSolver::SetSteppable(bool step){steppable = step;}
+void cvOneDBFSolver::SetLaneBatch(cvOneDSkylineBatchSolver* batch, int lane){laneBatch = batch; laneID = lane;}
+void cvOneDBFSolver::SetOutputType(int type){outputType = type;}
+void cvOneDBFSolver::SetVtkOutputType(int type){vtkOutputType = type;}
+void cvOneDBFSolver::SetConservationForm(int form){conservationForm = form;}
+void cvOneDBFSolver::SetStabilization(int stab){stabilization = stab;}
 
 void cvOneDBFSolver::CreateGlobalArrays(void){
     assert( wasSet == false);
     long neq = mathModels[0]->GetTotalNumberOfEquations();
 
+    // The explicit engine only needs the solution vectors, unless it
+    // starts from the steady state of the finite elements
+    if(solverEngine == SolverEngineTypeScope::EXPLICIT_FV && steadyState == SteadyStateTypeScope::NONE){
+      previousSolution = new cvOneDFEAVector(neq, "previousSolution");
+      previousSolution->Clear();
+      currentSolution = new cvOneDFEAVector(neq, "currentSolution");
+      currentSolution->Clear();
+      return;
+    }
+
+    CreateSystemArrays();
+}
+
+// Solution vectors, matrix and linear solver of the system formed by
+// mathModels over the current lists
+void cvOneDBFSolver::CreateSystemArrays(void){
+    long neq = mathModels[0]->GetTotalNumberOfEquations();
     long* maxa = new long[neq + 1];
     assert( maxa != 0);
     clear( neq + 1, maxa);
@@ -1255,10 +1664,34 @@ void cvOneDBFSolver::CreateGlobalArrays(void){
     long minEq, total;
     int i;
 
+    // A distributed run shares the segments among the processes,
+    // balanced by their number of elements
+    bool distributed = (cvOneDGlobal::numberOfRanks > 1);
+    vector<bool> localSubdomains(subdomainList.size(), true);
+    if(distributed){
+      cvLongVec elements;
+      for(i = 0; i < subdomainList.size(); i++){
+        elements.push_back(subdomainList[i]->GetNumberOfElements());
+      }
+      cvLongVec owner = balanced_partition(elements, cvOneDGlobal::numberOfRanks);
+      vector<long> load(cvOneDGlobal::numberOfRanks, 0);
+      for(i = 0; i < subdomainList.size(); i++){
+        localSubdomains[i] = (owner[i] == cvOneDGlobal::rank);
+        load[owner[i]] += elements[i];
+      }
+      for(int r = 0; r < cvOneDGlobal::numberOfRanks; r++){
+        cout << "Process " << std::to_string(r) << ": " << std::to_string(load[r]) << " elements" << endl;
+      }
+      mathModels[0]->SetLocalSubdomains(localSubdomains);
+    }
+
     // Element nodes
     total = 0;
     for(i = 0; i < subdomainList.size(); i++){
       total += subdomainList[i]->GetNumberOfNodes();
+      if(!localSubdomains[i]){
+        continue;
+      }
       for( long el = 0; el < subdomainList[i]->GetNumberOfElements(); el++){
         mathModels[0]->GetEquationNumbers(el, eqNumbers, i);
         minEq = min(neeq, eqNumbers);
@@ -1269,6 +1702,18 @@ void cvOneDBFSolver::CreateGlobalArrays(void){
       }
     }
 
+    // The JFNK preconditioner and the distributed solver keep the
+    // segment blocks only
+    long* blockMaxa = NULL;
+    if(nonlinearSolver != NonlinearSolverTypeScope::NEWTON || distributed){
+      blockMaxa = new long[neq + 1];
+      for( i = 0; i <= neq; i++)
+        blockMaxa[i] = maxa[i];
+      blockMaxa[neq] = sum(neq, blockMaxa);
+      for( i = neq - 1; i >= 0; i--)
+        blockMaxa[i] = blockMaxa[i+1] - blockMaxa[i];
+    }
+
     // Joints
     total *= 2;
     for(i = 0; i < jointList.size(); i++){
@@ -1286,40 +1731,105 @@ void cvOneDBFSolver::CreateGlobalArrays(void){
     for( i = neq - 1; i >= 0; i--)
         maxa[i] = maxa[i+1] - maxa[i];
 
+    previousSolution = new cvOneDFEAVector(neq, "previousSolution");
+    assert(previousSolution != 0);
+    previousSolution->Clear();
+    currentSolution = new cvOneDFEAVector(neq, "currentSolution");
+    assert(currentSolution != 0);
+    currentSolution->Clear();
+    increment = new cvOneDFEAVector(neq, "increment");
+    assert(increment != 0);
+    increment->Clear();
+    if(lineSearch > 0){
+      searchOrigin = new cvOneDFEAVector(neq, "searchOrigin");
+    }
+    if(timeIntegrator == TimeIntegratorTypeScope::BDF2 || adaptiveTimeStep){
+      olderSolution = new cvOneDFEAVector(neq, "olderSolution");
+    }
+
     // INITIALIZE MATRIX STORAGE SCHEME
     // AND ASSOCIATED SOLVER
+    if(nonlinearSolver != NonlinearSolverTypeScope::NEWTON){
+      // no global tangent: the matrix holds the segment blocks of the
+      // preconditioner and the corrections are solved matrix-free
+      lhs = new cvOneDSkylineMatrix(neq, blockMaxa, "blockMatrix");
+      // assumes that all the lagrange multipliers are at the end of the vector
+      long firstLagEq = (jointList.size() != 0) ? jointList[0]->GetGlobal1stLagNodeID() : neq;
+      cvOneDKrylovLinearSolver* krylov = new cvOneDKrylovLinearSolver(neq, firstLagEq,
+        [this](const cvOneDFEAVector& shift, cvOneDFEAVector& residual){FormShiftedResidual(shift, residual);});
+      krylov->SetRestart(krylovRestart);
+      krylov->SetTolerance(krylovTolerance);
+      krylov->SetFrozenTangent(nonlinearSolver == NonlinearSolverTypeScope::MODIFIED_NEWTON);
+      linearSolver = krylov;
+      savedSolution = new cvOneDFEAVector(neq, "savedSolution");
+      delete [] blockMaxa;
+    }else if(distributed){
+# ifdef USE_MPI
+      lhs = new cvOneDSkylineMatrix(neq, blockMaxa, "blockMatrix");
+      long firstLagEq = (jointList.size() != 0) ? jointList[0]->GetGlobal1stLagNodeID() : neq;
+      vector<bool> localEqs(neq, false);
+      long nodeEqs[2];
+      for(i = 0; i < subdomainList.size(); i++){
+        for(long node = 0; localSubdomains[i] && node < subdomainList[i]->GetNumberOfNodes(); node++){
+          mathModels[0]->GetNodalEquationNumbers(node, nodeEqs, i);
+          localEqs[nodeEqs[0]] = true;
+          localEqs[nodeEqs[1]] = true;
+        }
+      }
+      linearSolver = new cvOneDDistributedLinearSolver(neq, firstLagEq, localEqs);
+      delete [] blockMaxa;
+# endif
+    }else if(laneBatch != NULL){
+      // the members of a lock-step ensemble decompose their systems
+      // together, in the skyline format whatever the sparse solver
+      lhs = new cvOneDSkylineMatrix(neq, maxa, "globalMatrix");
+      linearSolver = new cvOneDSkylineLaneSolver(laneBatch, laneID);
+    }else{
 # ifdef USE_SKYLINE
     lhs = new cvOneDSkylineMatrix(neq, maxa, "globalMatrix");
-    cvOneDGlobal::solver = new cvOneDSkylineLinearSolver();
+    linearSolver = new cvOneDSkylineLinearSolver();
 # endif
 
 # ifdef USE_SUPERLU
     lhs = new cvOneDSparseMatrix(neq, maxa, "globalMatrix");
-    cvOneDGlobal::solver = new cvOneDSparseLinearSolver();
+    linearSolver = new cvOneDSparseLinearSolver();
 # endif
 
 # ifdef USE_CSPARSE
     lhs = new cvOneDSparseMatrix(neq, maxa, "globalMatrix");
-    cvOneDGlobal::solver = new cvOneDSparseLinearSolver();
+    linearSolver = new cvOneDSparseLinearSolver();
 # endif
 
+# ifdef USE_KLU
+    lhs = new cvOneDSparseMatrix(neq, maxa, "globalMatrix");
+    linearSolver = new cvOneDSparseLinearSolver();
+# endif
+    }
+
     assert(lhs != 0);
 
+    // Equations modified by ApplyBoundaryConditions: both degrees of
+    // freedom of the inlet node and of the last node of every outlet
+    cvLongVec bcEquations;
+    long nodeEqs[2];
+    mathModels[0]->GetNodalEquationNumbers(0, nodeEqs, 0);
+    bcEquations.push_back(nodeEqs[0]);
+    bcEquations.push_back(nodeEqs[1]);
+    for(i = 0; i < outletList.size(); i++){
+      mathModels[0]->GetNodalEquationNumbers(subdomainList[outletList[i]]->GetNumberOfNodes() - 1, nodeEqs, outletList[i]);
+      bcEquations.push_back(nodeEqs[0]);
+      bcEquations.push_back(nodeEqs[1]);
+    }
+    lhs->SetBoundaryEquations(bcEquations.size(), &bcEquations[0]);
+
     rhs = new cvOneDFEAVector( neq);
     assert(rhs != 0);
 
-    cvOneDGlobal::solver->SetLHS(lhs);
-    cvOneDGlobal::solver->SetRHS(rhs);
+    linearSolver->SetLHS(lhs);
+    linearSolver->SetRHS(rhs);
 
-    previousSolution = new cvOneDFEAVector(neq, "previousSolution");
-    assert(previousSolution != 0);
-    previousSolution->Clear();
-    currentSolution = new cvOneDFEAVector(neq, "currentSolution");
-    assert(currentSolution != 0);
-    currentSolution->Clear();
-    increment = new cvOneDFEAVector(neq, "increment");
-    assert(increment != 0);
-    increment->Clear();
+    delete [] maxa;
+    delete [] eqNumbers;
 }
 
 // Initialize the solution, that is, area as area input and flow rate as 0 except the inlet
@@ -1349,21 +1859,28 @@ void cvOneDBFSolver::CalcInitProps(long ID){
   }
 }
 
+// Initialize the solution with the final state of a previous run, mapped
+// on the nodes by their relative position along the segment
+void cvOneDBFSolver::CalcWarmStartProps(long ID, const cvOneDWarmStart& results){
+  double segLen = subdomainList[ID] -> GetLength();
+  for( long node = 0; node < subdomainList[ID]->GetNumberOfNodes(); node++){
+    double s = subdomainList[ID]->GetNodalCoordinate( node) / segLen;
+    long eqNumbers[2];
+    mathModels[0]->GetNodalEquationNumbers(node, eqNumbers, ID);
+    (*previousSolution)[eqNumbers[0]] = results.GetArea(s);
+    (*previousSolution)[eqNumbers[1]] = results.GetFlow(s);
+  }
+}
+
 // =================
 // GENERATE SOLUTION
 // =================
-void cvOneDBFSolver::GenerateSolution(void){
+void cvOneDBFSolver::StartSolution(void){
   currentTime = 0.0;
-  long i = 0;
-  clock_t tstart_iter;
-  clock_t tstart_solve;
-  clock_t tend_iter;
-  clock_t tend_solve;
-
 
   // Print the formulation used
 
-  if(cvOneDGlobal::CONSERVATION_FORM){
+  if(conservationForm){
     cout << "Using Conservative Form ..." << endl;
   }else{
     cout << "Using Advective Form ..." << endl;
@@ -1372,13 +1889,16 @@ void cvOneDBFSolver::GenerateSolution(void){
   // Allocate the TotalSolution Array.
   cout << "maxStep/stepSize: " << maxStep/stepSize << endl;
   long numSteps = maxStep/stepSize;
+  if(steadyState == SteadyStateTypeScope::ONLY){
+    numSteps = 0;
+  }
   TotalSolution.SetSize(numSteps+1, currentSolution -> GetDimension());
   cout << "Total Solution is: " << numSteps << " x ";
   cout << currentSolution -> GetDimension() << endl;
 
-  cvOneDString String1( "step_");
-  char String2[] = "99999";
-  cvOneDString title;
+  if(steadyState != SteadyStateTypeScope::NONE){
+    SolveSteadyState();
+  }
 
   previousSolution->Rename( "step_0");
   *currentSolution = *previousSolution;
@@ -1388,197 +1908,1313 @@ void cvOneDBFSolver::GenerateSolution(void){
   for (j=0;j<previousSolution -> GetDimension(); j++){
     TotalSolution[0][j] = tmp[j];
   }
+}
+
+void cvOneDBFSolver::GenerateSolution(void){
+  long i = 0;
+
+  StartSolution();
+
+  cvOneDString String1( "step_");
+  char String2[] = "99999";
+  cvOneDString title;
+
+  if(steadyState == SteadyStateTypeScope::ONLY){
+    return;
+  }
+
+  if(solverEngine == SolverEngineTypeScope::EXPLICIT_FV){
+    GenerateExplicitSolution();
+    return;
+  }
 
   // Initialize the Equations...
   int numMath = mathModels.size();
   for(i = 0; i < numMath; i++){
-    mathModels[i]->EquationInitialize(previousSolution, currentSolution);
+    if(timeIntegrator == TimeIntegratorTypeScope::BDF2){
+      mathModels[i]->EquationInitialize(previousSolution, currentSolution, olderSolution);
+    }else{
+      mathModels[i]->EquationInitialize(previousSolution, currentSolution);
+    }
   }
 
   double cycleTime = mathModels[0]->GetCycleTime();
 
+  if(predictorType != PredictorTypeScope::NONE){
+    long cycleSteps = (long)floor(cycleTime / deltaTime + 0.5);
+    if(adaptiveTimeStep || fabs(cycleSteps * deltaTime - cycleTime) > 1.0e-6 * cycleTime){
+      cycleSteps = 0;
+    }
+    predictor = new cvOneDSolutionPredictor(predictorType, cycleSteps);
+    predictor->Push(*previousSolution, currentTime);
+    predictedIterations = 0;
+  }
+  if(andersonDepth > 0){
+    anderson = new cvOneDAndersonAcceleration(andersonDepth);
+  }
+  lineSearchReductions = 0;
+
   // Global Solution Loop
   long q=1;
   double checkMass = 0;
   int numberOfCycle = 1;
   long iter_total = 0;
 
+  if(periodicTolerance > 0.0){
+    InitCycleMonitor();
+  }
+
   // Time stepping
+  if(adaptiveTimeStep){
+    GenerateAdaptiveSolution(cycleTime);
+    return;
+  }
+  if(pararealIterations > 0){
+    GeneratePararealSolution(cycleTime);
+    return;
+  }
+  if(waveformRelaxation != WaveformRelaxationTypeScope::NONE){
+    cvOneDWaveformRelaxation relaxation(this, waveformRelaxation, waveformCuts, waveformWindow);
+    relaxation.Solve();
+    return;
+  }
+  long lastStep = maxStep;
   for(long step = 1; step <= maxStep; step++){
     increment->Clear();
     for(i = 0; i < numMath; i++){
-      mathModels[i]->TimeUpdate(currentTime, deltaTime);
+      // the first step has no older solution and is backward Euler
+      mathModels[i]->TimeUpdate(currentTime, deltaTime, (step > 1) ? deltaTime : 0.0);
     }
 
-    // Newton-Raphson Iterations...
-    int iter = 0;
-    double normf = 1.0;
-    double norms = 1.0;
-
     if(fmod(currentTime, cycleTime) <5.0E-6 || -(fmod(currentTime,cycleTime)-cycleTime)<5.0E-6) {
+      // Solve for the periodic state once the first cycle is complete
+      if(periodicShooting && step > 1){
+        lastStep = step - 1 + ShootPeriodicState(step - 1, cycleTime, iter_total);
+        break;
+      }
+      // Stop once the last cycle repeats the one before
+      if(periodicTolerance > 0.0 && CycleConverged(checkMass)){
+        cout << "Periodic state reached at time " << currentTime << endl;
+        KeepLastCycle(q, cycleTime);
+        lastStep = step - 1;
+        break;
+      }
       checkMass = 0;
       cout << "**** Time cycle " << numberOfCycle++ << endl;
     }
     currentTime += deltaTime;
 
-    while(true){
-      tstart_iter=clock();
-
-      for(i = 0; i < numMath; i++){
-        mathModels[i]->FormNewton(lhs, rhs);
-      }
-
-      // PRINT RHS BEFORE BC APP
-      if(cvOneDGlobal::debugMode){
-        printf("(Debug) Printing LHS and RHS...\n");
-        ofstream ofsRHS;
-        ofstream ofsLHS;
-        ofsRHS.open("rhs_1.txt");
-        ofsLHS.open("lhs_1.txt");
-        ofsRHS<<" --- RHS: Before ApplyBoundaryConditions" << endl;
-        rhs->print(ofsRHS);
-        ofsLHS<<" --- LHS: Before ApplyBoundaryConditions" << endl;
-        lhs->print(ofsLHS);
-        ofsRHS.close();
-        ofsLHS.close();
-        printf("ECCOLO\n");
-        getchar();
-      }
-
-      mathModels[0]->ApplyBoundaryConditions();
+    // Newton-Raphson Iterations...
+    bool predicted = PredictSolution();
+    int iter = SolveTimeStep(step, deltaTime, false);
+    if(predicted){
+      predictedIterations += iter;
+    }
+    if(predictor != NULL){
+      predictor->Push(*currentSolution, currentTime);
+    }
 
-      // PRINT RHS AFTER BC APP
-      if(cvOneDGlobal::debugMode){
-        cout<<" --- RHS: After Application of BC " << endl;
-        rhs->print(cout);
-      }
+  checkMass += mathModels[0]->CheckMassBalance() * deltaTime;
+  if(periodicTolerance > 0.0){
+    AccumulateCycleNorms(deltaTime);
+  }
+  cout << "  Time = " << currentTime << ", ";
+  cout << "Mass = " << checkMass << ", ";
+  cout << "Tot iters = " << std::to_string(iter) << endl;
 
-      // Do not evaluate residuals of lagrange eqns
-      if(jointList.size() != 0){
-        normf = rhs->Norm(L2_norm,1,2, jointList[0]->GetGlobal1stLagNodeID());
-        norms = rhs->Norm(L2_norm,0,2, jointList[0]->GetGlobal1stLagNodeID());
-      }else{
-        normf = rhs->Norm(L2_norm,1,2);
-        norms = rhs->Norm(L2_norm,0,2);
-      }
+  // Save solution if needed
+  if(step % stepSize == 0){
+    sprintf( String2, "%ld", (unsigned long)step);
+    title = String1 + String2;
+    currentSolution->Rename(title.data());
 
-      if (std::isnan(norms) || std::isnan(normf)) {
-          throw cvException("Calculated a NaN for the residual.");
-      }
+    double * tmp = currentSolution -> GetEntries();
+    int j;
 
-      // Check Newton-Raphson Convergence
-      if((currentTime != deltaTime || (currentTime == deltaTime && iter != 0)) && normf < convCriteria && norms < convCriteria){
-        cout << "    iter: " << std::to_string(iter) << " ";
-        cout << "normf: " << normf << " ";
-        cout << "norms: " << norms << " ";
-        cout << "time: " << ((float)(tend_iter-tstart_iter))/CLOCKS_PER_SEC << endl;
-        break;
-      }
+    for(j=0;j<currentSolution -> GetDimension(); j++){
+      TotalSolution[q][j] = tmp[j];
+    }
+    q++;
+  }
+  if(olderSolution != NULL){
+    *olderSolution = *previousSolution;
+  }
+  *previousSolution = *currentSolution;
+  iter_total += iter;
+  } // End global loop
 
-      // Add increment
-      increment->Clear();
+  cout << "\nAvgerage number of Newton-Raphson iterations per time step = "<<(double)iter_total / (double)lastStep<<"\n"<< endl;
+  PrintIterationSummary();
+}
 
-      cvOneDGlobal::solver->Solve(*increment);
+// ============
+// STEADY STATE
+// ============
+// The network with the mean inflow and the outlet models lumped into their
+// total resistance. The steady Newton iterations, without time derivative,
+// start from previousSolution; if they fail, a pseudo time step is taken
+// and they are tried again. The pseudo steps grow by STEADY_STEP_GROWTH and
+// are halved when they fail themselves. A pseudo step that changes the
+// solution by less than STEADY_TOLERANCE has reached the steady state too,
+// which is how the minor losses, whose tangent misses the coupling to the
+// neighbouring segments, usually end.
+void cvOneDBFSolver::SolveSteadyState(void){
+  int numMath = mathModels.size();
+  for(int i = 0; i < numMath; i++){
+    mathModels[i]->EquationInitialize(previousSolution, currentSolution);
+  }
+  // the steady iterations always run to convergence
+  int solves = linearSolves;
+  linearSolves = 0;
+  for(int i = 0; i < numMath; i++){
+    mathModels[i]->SetSteadyState(true);
+  }
+  currentTime = 0.0;
 
-      currentSolution->Add(*increment);
+  cout << "Solving for the steady state ..." << endl;
+  double dt = deltaTime;
+  long pseudoSteps = 0;
+  while(true){
+    for(int i = 0; i < numMath; i++){
+      mathModels[i]->SteadyUpdate(deltaTime);
+    }
+    *currentSolution = *previousSolution;
+    mathModels[0]->SetBoundaryConditions();
+    if(SolveTimeStep(1, deltaTime, true) >= 0){
+      break;
+    }
+    if(pseudoSteps == STEADY_MAX_PSEUDO_STEPS){
+      throw cvException("ERROR: The steady state did not converge.\n");
+    }
 
-      // If the area goes less than zero, it tells in which segment the error occurs.
-      // Assumes that all the lagrange multipliers are at the end of the vector.
-      int negArea=0;
-      if(jointList.size() != 0){
-        for (long i= 0; i< jointList[0]->GetGlobal1stLagNodeID();i+=2){
-          long elCount = 0;
-          int fileIter = 0;
-          //check if area <0 or =nan
-          if (currentSolution->Get(i) < 0.0 || (currentSolution->Get(i) != currentSolution->Get(i))){
-           negArea=1;
-            while (fileIter < model -> getNumberOfSegments()){
-              cvOneDSegment *curSeg = model -> getSegment(fileIter);
-              long numEls = curSeg -> getNumElements();
-              long startOut = elCount;
-              long finishOut = elCount + ((numEls+1)*2);
-              char *modelname;
-              char *segname;
-              if (startOut <= i && i <= finishOut) {
-                 modelname = model-> getModelName();
-                 segname = curSeg -> getSegmentName();
-                 std::string msg = "ERROR: The area of segment '" + std::string(segname) + "' is negative.";
-                 throw cvException(msg.c_str());
-              }
-              elCount += 2*(numEls+1);
-              fileIter++;
-             }
-           }
-         }
-        }
+    for(int i = 0; i < numMath; i++){
+      mathModels[i]->TimeUpdate(0.0, dt);
+    }
+    *currentSolution = *previousSolution;
+    mathModels[0]->SetBoundaryConditions();
+    pseudoSteps++;
+    if(SolveTimeStep(1, dt, true) < 0){
+      dt *= 0.5;
+      continue;
+    }
+    double change = 0.0;
+    double size = 0.0;
+    for(long k = 0; k < currentSolution->GetDimension(); k++){
+      change += pow(currentSolution->Get(k) - previousSolution->Get(k), 2);
+      size += pow(currentSolution->Get(k), 2);
+    }
+    *previousSolution = *currentSolution;
+    if(change <= STEADY_TOLERANCE * STEADY_TOLERANCE * size){
+      break;
+    }
+    dt *= STEADY_STEP_GROWTH;
+  }
+  *previousSolution = *currentSolution;
 
-        if(negArea==1) {
-        postprocess_Text();
-        assert(0);
-        }
+  cout << "Steady state reached after " << pseudoSteps << " pseudo time steps, ";
+  cout << "Mass = " << mathModels[0]->CheckMassBalance() << endl;
+  for(int i = 0; i < numMath; i++){
+    mathModels[i]->SetSteadyState(false);
+  }
+  linearSolves = solves;
+  SetOutletStates();
+}
 
-      if(cvOneDGlobal::debugMode){
-        printf("(Debug) Printing Solution...\n");
-        ofstream ofs("solution.txt");
-        for(int loopA=0;loopA<currentSolution->GetDimension();loopA++){
-          ofs << to_string(loopA) << " " << currentSolution->Get(i) << endl;
+// The RCR memory assumes the reference pressure at t=0 and its initial flow
+// carries the capacitor pressure instead: the flow that keeps the outlet
+// pressure p steady. The backward Euler convolution of the pressure starts
+// one step late, which the factor lag makes up for. The coronary model
+// starts from the outlet flow and pressure.
+void cvOneDBFSolver::SetOutletStates(void){
+  long eqNumbers[2];
+  for(int k = 0; k < outletList.size(); k++){
+    cvOneDSubdomain* sub = subdomainList[outletList[k]];
+    mathModels[0]->GetNodalEquationNumbers(sub->GetNumberOfNodes() - 1, eqNumbers, outletList[k]);
+    cvOneDMaterial* material = sub->GetMaterial();
+    double Q = previousSolution->Get(eqNumbers[1]);
+    double p = material->GetPressure(previousSolution->Get(eqNumbers[0]), sub->GetOutletZ());
+    double Rp, Pc, alpha, lag;
+    switch(sub->GetBoundCondition()){
+      case BoundCondTypeScope::RCR:
+        // Capacitor pressure behind the proximal resistance, the backward
+        // Euler convolution of the pressure starts one step late
+        Rp = sub->GetRp();
+        Pc = p - Rp * Q;
+        alpha = sub->GetAlphaRCR();
+        lag = 1.0;
+        if(solverEngine == SolverEngineTypeScope::IMPLICIT_FEM && timeIntegrator != TimeIntegratorTypeScope::BDF2){
+          lag = exp(alpha * deltaTime);
         }
-        ofs.close();
-        getchar();
+        sub->SetInitialFlow((material->GetReferencePressure() - Pc) / Rp
+                            - (lag - 1.0) * p / (alpha * Rp * Rp * sub->GetCap()));
+        break;
+      case BoundCondTypeScope::CORONARY:
+        sub->SetInitialFlow(Q);
+        sub->SetInitialPressure(p + sub->GetP_v());
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+// ==========================
+// GENERATE EXPLICIT SOLUTION
+// ==========================
+// The explicit engine takes as many steps as the Courant number allows
+// between the output times of the implicit loop, the saved rows have the
+// same layout and go through the same postprocessing
+void cvOneDBFSolver::GenerateExplicitSolution(void){
+  cvOneDExplicitEngine engine(subdomainList, jointList, outletList, inletBCtype, flowTime, flowRate, numFlowPts);
+  engine.SetCourantNumber(courantNumber);
+  vector<string> names;
+  for(int i = 0; i < model->getNumberOfSegments(); i++){
+    names.push_back(model->getSegment(i)->getSegmentName());
+  }
+  engine.SetSegmentNames(names);
+  engine.SetState(*previousSolution, currentTime);
+
+  cout << "Using the explicit finite volume engine ..." << endl;
+
+  long q = 1;
+  double checkMass = 0.0;
+  for(long step = 1; step <= maxStep; step++){
+    engine.Advance(step * deltaTime);
+    currentTime = engine.GetTime();
+    checkMass += engine.GetMassImbalance() * deltaTime;
+
+    // Save solution if needed
+    if(step % stepSize == 0){
+      engine.GetState(*currentSolution);
+      double* tmp = currentSolution->GetEntries();
+      for(long j = 0; j < currentSolution->GetDimension(); j++){
+        TotalSolution[q][j] = tmp[j];
       }
+      q++;
+      cout << "  Time = " << currentTime << ", ";
+      cout << "Mass = " << checkMass << ", ";
+      cout << "Steps = " << engine.GetNumberOfSteps() << endl;
+    }
+  }
 
+  cout << "\nAverage number of explicit steps per time step = " << (double)engine.GetNumberOfSteps() / (double)maxStep << "\n" << endl;
+}
 
-      // A flag in case the cross sectional area is negative, but don't want to include the lagrange multipliers
-      // Assumes that all the lagrange multipliers are at the end of the vector
-      if(jointList.size() != 0){
-        currentSolution->CheckPositive(0,2,jointList[0]->GetGlobal1stLagNodeID());
+// ===============
+// SOLVE TIME STEP
+// ===============
+int cvOneDBFSolver::SolveTimeStep(long step, double dt, bool allowFailure){
+  long i = 0;
+  int numMath = mathModels.size();
+  clock_t tstart_iter = clock();
+  clock_t tend_iter = tstart_iter;
+
+  int iter = 0;
+  double normf = 1.0;
+  double norms = 1.0;
+  double lastNorm = 0.0;
+
+  while(true){
+    tstart_iter=clock();
+
+    if(nonlinearSolver != NonlinearSolverTypeScope::NEWTON){
+      // the tangent is only formed when the preconditioner is refreshed
+      cvOneDKrylovLinearSolver* krylov = (cvOneDKrylovLinearSolver*)linearSolver;
+      bool refresh = krylov->NeedsRefresh() || (iter == 0 && (step - 1) % preconditionerRefresh == 0);
+      krylov->BeginAssembly(refresh);
+      if(refresh){
+        mathModels[0]->FormNewton(lhs, rhs);
+        for(i = 1; i < numMath; i++){
+          mathModels[i]->FormNewton(krylov->GetCouplingMatrix(), rhs);
+        }
       }else{
-        currentSolution->CheckPositive(0,2,currentSolution->GetDimension());
+        for(i = 0; i < numMath; i++){
+          mathModels[i]->FormResidual(rhs);
+        }
+      }
+    }else{
+      cvOneDFEAMatrix* jointMatrix = lhs;
+# ifdef USE_MPI
+      // the joints are kept apart from the blocks of the local segments
+      if(cvOneDGlobal::numberOfRanks > 1){
+        jointMatrix = ((cvOneDDistributedLinearSolver*)linearSolver)->GetCouplingMatrix();
+        jointMatrix->Clear();
       }
+# endif
+      mathModels[0]->FormNewton(lhs, rhs);
+      for(i = 1; i < numMath; i++){
+        mathModels[i]->FormNewton(jointMatrix, rhs);
+      }
+    }
+
+    // PRINT RHS BEFORE BC APP
+    if(cvOneDGlobal::debugMode){
+      cvOneDPrintf("(Debug) Printing LHS and RHS...\n");
+      ofstream ofsRHS;
+      ofstream ofsLHS;
+      ofsRHS.open("rhs_1.txt");
+      ofsLHS.open("lhs_1.txt");
+      ofsRHS<<" --- RHS: Before ApplyBoundaryConditions" << endl;
+      rhs->print(ofsRHS);
+      ofsLHS<<" --- LHS: Before ApplyBoundaryConditions" << endl;
+      lhs->print(ofsLHS);
+      ofsRHS.close();
+      ofsLHS.close();
+      cvOneDPrintf("ECCOLO\n");
+      getchar();
+    }
+
+    mathModels[0]->ApplyBoundaryConditions(linearSolver);
+
+    // PRINT RHS AFTER BC APP
+    if(cvOneDGlobal::debugMode){
+      cout<<" --- RHS: After Application of BC " << endl;
+      rhs->print(cout);
+    }
+
+    ComputeResidualNorms(normf, norms);
 
-      // Set Boundary Conditions
-      mathModels[0]->SetBoundaryConditions();
-      tend_iter=clock();
+    if (std::isnan(norms) || std::isnan(normf)) {
+        if(allowFailure){
+          return -1;
+        }
+        throw cvException("Calculated a NaN for the residual.");
+    }
+
+    // The frozen tangent is formed again once it stops contracting
+    if(nonlinearSolver == NonlinearSolverTypeScope::MODIFIED_NEWTON){
+      if(iter > 0 && normf + norms > FROZEN_TANGENT_RATIO * lastNorm){
+        ((cvOneDKrylovLinearSolver*)linearSolver)->RequestRefresh();
+      }
+      lastNorm = normf + norms;
+    }
 
+    // Check Newton-Raphson Convergence
+    if((currentTime != dt || (currentTime == dt && iter != 0)) && normf < convCriteria && norms < convCriteria){
       cout << "    iter: " << std::to_string(iter) << " ";
       cout << "normf: " << normf << " ";
       cout << "norms: " << norms << " ";
       cout << "time: " << ((float)(tend_iter-tstart_iter))/CLOCKS_PER_SEC << endl;
+      break;
+    }
 
+    // Add increment
+    increment->Clear();
 
-      if(iter > MAX_NONLINEAR_ITERATIONS){
-        cout << "Error: Newton not converged, exceed max iterations" << endl;
-        cout << "norm of Flow rate:" << normf << ", norm of Area:" << norms << endl;
-        break;
+    linearSolver->Solve(*increment);
+
+    if(searchOrigin != NULL){
+      *searchOrigin = *currentSolution;
+    }
+
+    // The first iterate still holds the Dirichlet values of the previous
+    // step, its correction does not belong to the same fixed point map
+    if(anderson != NULL && iter == 0){
+      anderson->Reset();
+    }
+    if(anderson != NULL && iter > 0){
+      long areaEnd = currentSolution->GetDimension();
+      if(jointList.size() != 0){
+        areaEnd = jointList[0]->GetGlobal1stLagNodeID();
+      }
+      anderson->Update(*currentSolution, *increment, areaEnd);
+    }else{
+      currentSolution->Add(*increment);
+    }
+
+    if(searchOrigin != NULL){
+      lineSearchReductions += SearchLine(iter, normf + norms);
+    }
+
+    // A rejected step is retried with a smaller time step instead
+    if(allowFailure){
+      long stop = currentSolution->GetDimension();
+      if(jointList.size() != 0){
+        stop = jointList[0]->GetGlobal1stLagNodeID();
+      }
+      for(long k = 0; k < stop; k += 2){
+        if(!(currentSolution->Get(k) > 0.0)){
+          return -1;
+        }
+      }
+    }
+
+    // If the area goes less than zero, it tells in which segment the error occurs.
+    // Assumes that all the lagrange multipliers are at the end of the vector.
+    int negArea=0;
+    if(jointList.size() != 0){
+      for (long i= 0; i< jointList[0]->GetGlobal1stLagNodeID();i+=2){
+        long elCount = 0;
+        int fileIter = 0;
+        //check if area <0 or =nan
+        if (currentSolution->Get(i) < 0.0 || (currentSolution->Get(i) != currentSolution->Get(i))){
+         negArea=1;
+          while (fileIter < model -> getNumberOfSegments()){
+            cvOneDSegment *curSeg = model -> getSegment(fileIter);
+            long numEls = curSeg -> getNumElements();
+            long startOut = elCount;
+            long finishOut = elCount + ((numEls+1)*2);
+            char *modelname;
+            char *segname;
+            if (startOut <= i && i <= finishOut) {
+               modelname = model-> getModelName();
+               segname = curSeg -> getSegmentName();
+               std::string msg = "ERROR: The area of segment '" + std::string(segname) + "' is negative.";
+               throw cvException(msg.c_str());
+            }
+            elCount += 2*(numEls+1);
+            fileIter++;
+           }
+         }
+       }
+      }
+
+      if(negArea==1) {
+      postprocess_Text();
+      assert(0);
+      }
+
+    if(cvOneDGlobal::debugMode){
+      cvOneDPrintf("(Debug) Printing Solution...\n");
+      ofstream ofs("solution.txt");
+      for(int loopA=0;loopA<currentSolution->GetDimension();loopA++){
+        ofs << to_string(loopA) << " " << currentSolution->Get(i) << endl;
+      }
+      ofs.close();
+      getchar();
+    }
+
+
+    // A flag in case the cross sectional area is negative, but don't want to include the lagrange multipliers
+    // Assumes that all the lagrange multipliers are at the end of the vector
+    if(jointList.size() != 0){
+      currentSolution->CheckPositive(0,2,jointList[0]->GetGlobal1stLagNodeID());
+    }else{
+      currentSolution->CheckPositive(0,2,currentSolution->GetDimension());
+    }
+
+    // Set Boundary Conditions
+    mathModels[0]->SetBoundaryConditions();
+    tend_iter=clock();
+
+    cout << "    iter: " << std::to_string(iter) << " ";
+    cout << "normf: " << normf << " ";
+    cout << "norms: " << norms << " ";
+    cout << "time: " << ((float)(tend_iter-tstart_iter))/CLOCKS_PER_SEC;
+    if(nonlinearSolver == NonlinearSolverTypeScope::JFNK){
+      cout << " krylov: " << ((cvOneDKrylovLinearSolver*)linearSolver)->GetNumberOfIterations();
+    }
+    cout << endl;
+
+    // Linearly implicit stepping: the step ends after a fixed number of
+    // linear solves, the last residual is not formed
+    if(linearSolves > 0 && iter + 1 >= linearSolves){
+      iter++;
+      break;
+    }
+
+    if(iter > MAX_NONLINEAR_ITERATIONS){
+      cout << "Error: Newton not converged, exceed max iterations" << endl;
+      cout << "norm of Flow rate:" << normf << ", norm of Area:" << norms << endl;
+      // a stall close to the tolerance is accepted as in the fixed step loop
+      if(allowFailure && (normf > NONLINEAR_FAILURE_RATIO * convCriteria || norms > NONLINEAR_FAILURE_RATIO * convCriteria)){
+        return -1;
       }
+      break;
+    }
 
     // Increment Iteration Number
     iter++;
 
   }// End while
 
-  checkMass += mathModels[0]->CheckMassBalance() * deltaTime;
-  cout << "  Time = " << currentTime << ", ";
-  cout << "Mass = " << checkMass << ", ";
-  cout << "Tot iters = " << std::to_string(iter) << endl;
+  return iter;
+}
 
-  // Save solution if needed
-  if(step % stepSize == 0){
-    sprintf( String2, "%ld", (unsigned long)step);
-    title = String1 + String2;
-    currentSolution->Rename(title.data());
+// ========================
+// ESTIMATE TIME STEP ERROR
+// ========================
+// The backward Euler step is compared with a linear extrapolation of the
+// two previous steps. Their difference is dt*(dt+prevDt)/2*u'' while the
+// local error of the step is dt^2/2*u'', so the difference scaled by
+// dt/(dt+prevDt) estimates it.
+// Areas and flow rates are measured separately relative to their largest
+// magnitude, the joint multipliers are not checked.
+double cvOneDBFSolver::EstimateTimeStepError(double dt, double prevDt, const cvOneDFEAVector& olderSolution){
+  long stop = currentSolution->GetDimension();
+  if(jointList.size() != 0){
+    stop = jointList[0]->GetGlobal1stLagNodeID();
+  }
+  double ratio = dt / prevDt;
+  double scale = dt / (dt + prevDt);
+  double sumErr[2] = {0.0, 0.0};
+  double maxVal[2] = {0.0, 0.0};
+  for(long k = 0; k < stop; k++){
+    double un = previousSolution->Get(k);
+    double predicted = un + ratio * (un - olderSolution.Get(k));
+    double err = scale * (currentSolution->Get(k) - predicted);
+    sumErr[k % 2] += err * err;
+    maxVal[k % 2] = max(maxVal[k % 2], max(fabs(currentSolution->Get(k)), fabs(un)));
+  }
+  double error = 0.0;
+  for(int field = 0; field < 2; field++){
+    if(maxVal[field] > 0.0){
+      error = max(error, sqrt(2.0 * sumErr[field] / stop) / maxVal[field]);
+    }
+  }
+  return error / timeStepTolerance;
+}
 
-    double * tmp = currentSolution -> GetEntries();
-    int j;
+// ==========================
+// GENERATE ADAPTIVE SOLUTION
+// ==========================
+// Time loop with the step size chosen from the local error estimate. A step
+// is rejected if Newton fails, an area turns negative or the error is above
+// the tolerance; the solution and the outlet memory are then restored and
+// the step is retried with a smaller size. Output is still written every
+// stepSize*deltaTime, interpolated between the accepted steps around it.
+void cvOneDBFSolver::GenerateAdaptiveSolution(double cycleTime){
+  long i = 0;
+  int numMath = mathModels.size();
+  long numSteps = maxStep/stepSize;
+  double outputInterval = deltaTime * stepSize;
+  double finalTime = deltaTime * maxStep;
+  double dtMin = (minTimeStep > 0.0) ? minTimeStep : deltaTime;
+  double dtMax = (maxTimeStep > 0.0) ? maxTimeStep : outputInterval;
 
-    for(j=0;j<currentSolution -> GetDimension(); j++){
-      TotalSolution[q][j] = tmp[j];
+  double dt = min(deltaTime, dtMax);
+  double prevDt = 0.0;
+  double checkMass = 0;
+  long cycle = -1;
+  long q = 1;
+  long attempts = 0;
+  long accepted = 0;
+  long rejected = 0;
+  long iter_total = 0;
+  // size of the last rejected step and the accepted steps left before
+  // the step may grow back to it
+  double rejectedDt = 0.0;
+  long holdSteps = 0;
+
+  while(q <= numSteps){
+    long thisCycle = (cycleTime > 0.0) ? (long)floor(currentTime / cycleTime + 1.0e-9) : 0;
+
+    // Steps end on the cycle boundaries and the final time, without
+    // leaving a sliver of a step before them
+    double remaining = finalTime - currentTime;
+    if(cycleTime > 0.0){
+      remaining = min(remaining, (thisCycle + 1) * cycleTime - currentTime);
     }
-    q++;
+    if(1.1 * dt > remaining){
+      dt = remaining;
+    }
+
+    if(thisCycle != cycle){
+      if(periodicTolerance > 0.0 && CycleConverged(checkMass)){
+        cout << "Periodic state reached at time " << currentTime << endl;
+        KeepLastCycle(q, cycleTime);
+        break;
+      }
+      cycle = thisCycle;
+      checkMass = 0;
+      cout << "**** Time cycle " << cycle + 1 << endl;
+    }
+
+    for(size_t k = 0; k < subdomainList.size(); k++){
+      subdomainList[k]->SaveBoundaryMemory();
+    }
+    double startTime = currentTime;
+    increment->Clear();
+    for(i = 0; i < numMath; i++){
+      mathModels[i]->TimeUpdate(startTime, dt, prevDt);
+    }
+    currentTime = startTime + dt;
+
+    // At the minimum size the step is taken as in the fixed step loop
+    attempts++;
+    bool predicted = PredictSolution();
+    int iter = SolveTimeStep(attempts, dt, dt > dtMin);
+
+    // the first step leaves the initial condition, which is not a solution
+    // of the discrete equations, so the estimate needs two solved steps
+    double error = 0.0;
+    if(iter >= 0 && accepted > 1){
+      error = EstimateTimeStepError(dt, prevDt, *olderSolution);
+    }
+
+    if(iter < 0 || (error > 1.0 && dt > dtMin)){
+      rejected++;
+      *currentSolution = *previousSolution;
+      for(size_t k = 0; k < subdomainList.size(); k++){
+        subdomainList[k]->RestoreBoundaryMemory();
+      }
+      currentTime = startTime;
+      rejectedDt = dt;
+      holdSteps = STEP_GROWTH_HOLD;
+      if(iter < 0){
+        dt = max(0.25 * dt, dtMin);
+      }else{
+        dt = max(dt * max(0.2, 0.9 / sqrt(error)), dtMin);
+      }
+      cout << "  Step rejected, retrying with dt = " << dt << endl;
+      continue;
+    }
+
+    accepted++;
+    if(predicted){
+      predictedIterations += iter;
+    }
+    if(predictor != NULL){
+      predictor->Push(*currentSolution, currentTime);
+    }
+    checkMass += mathModels[0]->CheckMassBalance() * dt;
+    if(periodicTolerance > 0.0){
+      AccumulateCycleNorms(dt);
+    }
+    cout << "  Time = " << currentTime << ", ";
+    cout << "dt = " << dt << ", ";
+    cout << "Mass = " << checkMass << ", ";
+    cout << "Tot iters = " << std::to_string(iter) << endl;
+
+    // Save the output times covered by this step
+    while(q <= numSteps && q * outputInterval <= currentTime + 1.0e-9 * outputInterval){
+      double w = (q * outputInterval - startTime) / dt;
+      w = min(1.0, max(0.0, w));
+      for(long j = 0; j < currentSolution->GetDimension(); j++){
+        TotalSolution[q][j] = (1.0 - w) * previousSolution->Get(j) + w * currentSolution->Get(j);
+      }
+      q++;
+    }
+
+    *olderSolution = *previousSolution;
+    *previousSolution = *currentSolution;
+    iter_total += iter;
+
+    // Grow or shrink the next step, the first two have no estimate. For
+    // some steps after a rejection the step stays below the rejected size
+    // instead of growing straight back to it.
+    double nextDt = dt;
+    if(accepted > 2){
+      double factor = (error > 0.0) ? min(1.5, 0.8 / sqrt(error)) : 1.5;
+      nextDt = dt * factor;
+      if(holdSteps > 0){
+        nextDt = min(nextDt, max(min(dt, nextDt), 0.9 * rejectedDt));
+        holdSteps--;
+      }
+    }
+    prevDt = dt;
+    dt = min(max(nextDt, dtMin), dtMax);
   }
-  *previousSolution = *currentSolution;
-  iter_total += iter;
-  } // End global loop
 
-  cout << "\nAvgerage number of Newton-Raphson iterations per time step = "<<(double)iter_total / (double)maxStep<<"\n"<< endl;
+  cout << "\nAccepted time steps = " << accepted << ", rejected time steps = " << rejected << endl;
+  cout << "Avgerage number of Newton-Raphson iterations per time step = "<<(double)iter_total / (double)accepted<<"\n"<< endl;
+  PrintIterationSummary();
+}
+
+// =============
+// CYCLE MONITOR
+// =============
+// The outlet node of every segment is monitored, which covers the model
+// outlets and the inlet side of every joint.
+void cvOneDBFSolver::InitCycleMonitor(void){
+  cycleMonitorSubdomains.clear();
+  cycleMonitorEqs.clear();
+  cycleMonitorZ.clear();
+  for(long ID = 0; ID < (long)subdomainList.size(); ID++){
+    long node = subdomainList[ID]->GetNumberOfNodes() - 1;
+    long eqNumbers[2];
+    mathModels[0]->GetNodalEquationNumbers(node, eqNumbers, ID);
+    cycleMonitorSubdomains.push_back(ID);
+    cycleMonitorEqs.push_back(eqNumbers[0]);
+    cycleMonitorZ.push_back(subdomainList[ID]->GetNodalCoordinate(node));
+  }
+  // Pressure and flow norms and the volume through each node
+  cycleNorms.assign(3 * cycleMonitorEqs.size(), 0.0);
+  lastCycleNorms.clear();
+  lastCycleMass = 0.0;
+}
+
+void cvOneDBFSolver::AccumulateCycleNorms(double dt){
+  for(size_t k = 0; k < cycleMonitorEqs.size(); k++){
+    double S = currentSolution->Get(cycleMonitorEqs[k]);
+    double Q = currentSolution->Get(cycleMonitorEqs[k] + 1);
+    double P = subdomainList[cycleMonitorSubdomains[k]]->GetMaterial()->GetPressure(S, cycleMonitorZ[k]);
+    cycleNorms[3*k] += P * P * dt;
+    cycleNorms[3*k+1] += Q * Q * dt;
+    cycleNorms[3*k+2] += fabs(Q) * dt;
+  }
+}
+
+// Called at every cycle boundary: the pressure and flow norms of the cycle
+// just finished are compared with the previous cycle relative to their
+// size, the mass balance relative to the largest volume through a node.
+bool cvOneDBFSolver::CycleConverged(double cycleMass){
+  bool complete = false;
+  for(size_t k = 0; k < cycleNorms.size(); k++){
+    if(cycleNorms[k] > 0.0){
+      complete = true;
+    }
+  }
+  if(!complete){
+    return false;
+  }
+
+  bool converged = false;
+  if(lastCycleNorms.size() == cycleNorms.size()){
+    double difference = 0.0;
+    double volume = 0.0;
+    for(size_t k = 0; k < cycleMonitorEqs.size(); k++){
+      for(int field = 0; field < 2; field++){
+        double curr = sqrt(cycleNorms[3*k+field]);
+        double prev = sqrt(lastCycleNorms[3*k+field]);
+        if(curr > 0.0){
+          difference = max(difference, fabs(curr - prev) / curr);
+        }
+      }
+      volume = max(volume, cycleNorms[3*k+2]);
+    }
+    if(volume > 0.0){
+      difference = max(difference, fabs(cycleMass - lastCycleMass) / volume);
+    }
+    cout << "  Cycle to cycle difference = " << difference << endl;
+    converged = (difference < periodicTolerance);
+  }
+
+  lastCycleNorms = cycleNorms;
+  lastCycleMass = cycleMass;
+  cycleNorms.assign(cycleNorms.size(), 0.0);
+  return converged;
+}
+
+// ===============
+// KEEP LAST CYCLE
+// ===============
+void cvOneDBFSolver::KeepLastCycle(long savedRows, double cycleTime){
+  long cycleRows = (long)floor(cycleTime / (deltaTime * stepSize) + 1.0e-6);
+  long first = max(0L, savedRows - 1 - cycleRows);
+  cvOneDMatrix<double> lastCycle(savedRows - first, TotalSolution.Cols());
+  for(long i = first; i < savedRows; i++){
+    for(long j = 0; j < TotalSolution.Cols(); j++){
+      lastCycle[i-first][j] = TotalSolution[i][j];
+    }
+  }
+  TotalSolution = lastCycle;
+  outputOffset = first;
+}
+
+// ====================
+// SHOOT PERIODIC STATE
+// ====================
+// The state at the start of a cycle is the solution with the RCR and
+// coronary convolution integrals. Each evaluation of the cycle map
+// restores the outlet memory saved here, then overwrites its integrals,
+// so the map always integrates the same interval. The rows of the last
+// cycle integrated replace TotalSolution. Returns the number of steps.
+long cvOneDBFSolver::ShootPeriodicState(long step, double cycleTime, long& iterTotal){
+  shootingSteps = (long)floor(cycleTime / deltaTime + 0.5);
+  if(fabs(shootingSteps * deltaTime - cycleTime) > 1.0e-6 * cycleTime){
+    throw cvException("ERROR: Periodic Shooting requires a cycle time that is a multiple of the time step.\n");
+  }
+  shootingStartTime = currentTime;
+  shootingFirstStep = step;
+  shootingIterations = 0;
+  for(size_t k = 0; k < subdomainList.size(); k++){
+    subdomainList[k]->SaveBoundaryMemory();
+  }
+
+  long firstRow = (step + stepSize - 1) / stepSize;
+  long lastRow = (step + shootingSteps) / stepSize;
+  TotalSolution.SetSize(lastRow - firstRow + 1, currentSolution->GetDimension());
+  outputOffset = firstRow;
+
+  vector<double> state;
+  PackPeriodicState(state);
+
+  // areas, flow rates, multipliers and each kind of memory are scaled
+  // by their largest magnitude
+  long dim = previousSolution->GetDimension();
+  long stop = dim;
+  if(jointList.size() != 0){
+    stop = jointList[0]->GetGlobal1stLagNodeID();
+  }
+  int numClasses = 3 + cvOneDSubdomain::BOUNDARY_MEMORY_SIZE;
+  vector<int> classes(state.size());
+  for(long k = 0; k < (long)state.size(); k++){
+    if(k < stop){
+      classes[k] = k % 2;
+    }else if(k < dim){
+      classes[k] = 2;
+    }else{
+      classes[k] = 3 + (k - dim) % cvOneDSubdomain::BOUNDARY_MEMORY_SIZE;
+    }
+  }
+  vector<double> classScale(numClasses, 0.0);
+  for(size_t k = 0; k < state.size(); k++){
+    classScale[classes[k]] = max(classScale[classes[k]], fabs(state[k]));
+  }
+  vector<double> scale(state.size());
+  for(size_t k = 0; k < state.size(); k++){
+    scale[k] = (classScale[classes[k]] > 0.0) ? classScale[classes[k]] : 1.0;
+  }
+
+  cout << "**** Periodic shooting from time " << currentTime << endl;
+  cvOneDPeriodicShooting shooting([this](const vector<double>& start, vector<double>& end){CycleMap(start, end);});
+  shooting.SetTolerance((periodicTolerance > 0.0) ? periodicTolerance : 1.0e-4);
+  shooting.SetScale(scale);
+  if(shooting.Solve(state)){
+    cout << "Periodic state reached after " << shooting.GetNumberOfCycles() << " shooting cycles" << endl;
+  }else{
+    cout << "WARNING: Periodic shooting not converged, residual = " << shooting.GetResidual() << endl;
+  }
+
+  iterTotal += shootingIterations;
+  return shooting.GetNumberOfCycles() * shootingSteps;
+}
+
+void cvOneDBFSolver::CycleMap(const vector<double>& start, vector<double>& end){
+  UnpackPeriodicState(start);
+  currentTime = shootingStartTime;
+  // the guesses only depend on the steps of this cycle
+  if(predictor != NULL){
+    predictor->Reset();
+    predictor->Push(*currentSolution, currentTime);
+  }
+
+  long i = 0;
+  int numMath = mathModels.size();
+  long dim = currentSolution->GetDimension();
+  for(long step = shootingFirstStep; step <= shootingFirstStep + shootingSteps; step++){
+    if(step > shootingFirstStep){
+      increment->Clear();
+      // the map starts from a single state, its first step is backward Euler
+      for(i = 0; i < numMath; i++){
+        mathModels[i]->TimeUpdate(currentTime, deltaTime, (step > shootingFirstStep + 1) ? deltaTime : 0.0);
+      }
+      currentTime += deltaTime;
+      bool predicted = PredictSolution();
+      int iter = SolveTimeStep(step, deltaTime, false);
+      shootingIterations += iter;
+      if(predicted){
+        predictedIterations += iter;
+      }
+      if(predictor != NULL){
+        predictor->Push(*currentSolution, currentTime);
+      }
+      cout << "  Time = " << currentTime << ", ";
+      cout << "Tot iters = " << std::to_string(iter) << endl;
+      if(olderSolution != NULL){
+        *olderSolution = *previousSolution;
+      }
+      *previousSolution = *currentSolution;
+    }
+    if(step % stepSize == 0){
+      double* tmp = currentSolution->GetEntries();
+      for(long j = 0; j < dim; j++){
+        TotalSolution[step / stepSize - outputOffset][j] = tmp[j];
+      }
+    }
+  }
+  PackPeriodicState(end);
+}
+
+void cvOneDBFSolver::PackPeriodicState(vector<double>& state){
+  long dim = previousSolution->GetDimension();
+  state.resize(dim + cvOneDSubdomain::BOUNDARY_MEMORY_SIZE * subdomainList.size());
+  for(long j = 0; j < dim; j++){
+    state[j] = previousSolution->Get(j);
+  }
+  for(size_t k = 0; k < subdomainList.size(); k++){
+    subdomainList[k]->GetBoundaryMemory(&state[dim + cvOneDSubdomain::BOUNDARY_MEMORY_SIZE * k]);
+  }
+}
+
+void cvOneDBFSolver::UnpackPeriodicState(const vector<double>& state){
+  long dim = previousSolution->GetDimension();
+  for(long j = 0; j < dim; j++){
+    previousSolution->Set(j, state[j]);
+  }
+  *currentSolution = *previousSolution;
+  for(size_t k = 0; k < subdomainList.size(); k++){
+    subdomainList[k]->RestoreBoundaryMemory();
+    subdomainList[k]->SetBoundaryMemory(&state[dim + cvOneDSubdomain::BOUNDARY_MEMORY_SIZE * k]);
+  }
+}
+
+// ========
+// PARAREAL
+// ========
+// Each cycle is a time slice. The coarse propagator marches the slice
+// boundary states serially with pararealCoarseFactor times larger steps,
+// the fine propagator runs all slices that are not exact yet at once, and
+// the boundary states are corrected with the difference between the two
+// until they stop changing. The fine propagators run on worker threads,
+// each on a copy of the model in its own context, which saves its rows
+// of the results and hands them back with the final state.
+
+void cvOneDBFSolver::GeneratePararealSolution(double cycleTime){
+  long cycleSteps = (long)floor(cycleTime / deltaTime + 0.5);
+  if(fabs(cycleSteps * deltaTime - cycleTime) > 1.0e-6 * cycleTime || maxStep % cycleSteps != 0){
+    throw cvException("ERROR: Parareal requires a whole number of cycles, each a multiple of the time step.\n");
+  }
+  if(cycleSteps % pararealCoarseFactor != 0){
+    throw cvException("ERROR: The Parareal coarse factor must divide the number of steps per cycle.\n");
+  }
+  long numSlices = maxStep / cycleSteps;
+  long coarseSteps = cycleSteps / pararealCoarseFactor;
+  double coarseDt = deltaTime * pararealCoarseFactor;
+  int workers = pararealWorkers;
+  if(workers == 0){
+    workers = (int)thread::hardware_concurrency();
+  }
+  if(workers < 1){
+    workers = 1;
+  }
+  pararealWorkers = workers;
+
+  cout << "Using Parareal over " << std::to_string(numSlices) << " cycles with ";
+  cout << std::to_string(workers) << " workers ..." << endl;
+
+  // Initial coarse sweep
+  vector<vector<double> > slice(numSlices + 1);
+  vector<vector<double> > coarse(numSlices);
+  PackSliceState(slice[0], 0.0);
+  long coarseIters = 0;
+  for(long k = 0; k < numSlices; k++){
+    coarse[k] = slice[k];
+    coarseIters += PropagateSlice(coarse[k], k * cycleTime, k * cycleSteps, coarseSteps, coarseDt, false);
+    slice[k + 1] = coarse[k];
+  }
+
+  long fineIters = 0;
+  long iterations = 0;
+  double change = 0.0;
+  vector<double> next;
+  vector<unique_ptr<cvOneDContext> > workerContexts;
+  for(long j = 1; j <= pararealIterations && j <= numSlices; j++){
+    // the slices before j-1 start from their exact state, and so are done
+    vector<vector<double> > fine(slice.begin() + (j - 1), slice.begin() + numSlices);
+    fineIters += RunFineSlices(fine, j - 1, cycleSteps, cycleTime, workerContexts);
+
+    change = SliceChange(slice[j], fine[0]);
+    slice[j] = fine[0];
+    for(long k = j; k < numSlices; k++){
+      next = slice[k];
+      coarseIters += PropagateSlice(next, k * cycleTime, k * cycleSteps, coarseSteps, coarseDt, false);
+      vector<double>& corrected = fine[k - j + 1];
+      for(size_t m = 0; m < corrected.size(); m++){
+        corrected[m] += next[m] - coarse[k][m];
+      }
+      coarse[k] = next;
+      change = max(change, SliceChange(slice[k + 1], corrected));
+      slice[k + 1] = corrected;
+    }
+    iterations = j;
+    cout << "**** Parareal iteration " << std::to_string(j) << ", change of the cycle states = " << change << endl;
+    if(change < PARAREAL_TOLERANCE){
+      break;
+    }
+  }
+  if(change >= PARAREAL_TOLERANCE && iterations < numSlices){
+    cout << "WARNING: Parareal not converged, change = " << change << endl;
+  }
+
+  UnpackSliceState(slice[numSlices], numSlices * cycleTime, deltaTime);
+  currentTime = numSlices * cycleTime;
+
+  cout << "\nParareal iterations = " << std::to_string(iterations) << ", ";
+  cout << "Newton iterations of the fine propagators = " << std::to_string(fineIters) << ", ";
+  cout << "of the coarse propagator = " << std::to_string(coarseIters) << "\n" << endl;
+}
+
+long cvOneDBFSolver::PropagateSlice(vector<double>& state, double startTime, long firstStep, long steps, double dt, bool save){
+  UnpackSliceState(state, startTime, dt);
+  currentTime = startTime;
+  if(predictor != NULL){
+    predictor->Reset();
+    predictor->Push(*currentSolution, currentTime);
+  }
+
+  long iterTotal = 0;
+  int numMath = mathModels.size();
+  long dim = currentSolution->GetDimension();
+  for(long s = 1; s <= steps; s++){
+    increment->Clear();
+    // a slice starts from a single state, its first step is backward Euler
+    for(int i = 0; i < numMath; i++){
+      mathModels[i]->TimeUpdate(currentTime, dt, (s > 1) ? dt : 0.0);
+    }
+    currentTime += dt;
+    bool predicted = PredictSolution();
+    int iter = SolveTimeStep(firstStep + s, dt, false);
+    iterTotal += iter;
+    if(predicted){
+      predictedIterations += iter;
+    }
+    if(predictor != NULL){
+      predictor->Push(*currentSolution, currentTime);
+    }
+    long step = firstStep + s;
+    if(save && step % stepSize == 0){
+      double* tmp = currentSolution->GetEntries();
+      for(long j = 0; j < dim; j++){
+        TotalSolution[step / stepSize][j] = tmp[j];
+      }
+    }
+    if(olderSolution != NULL){
+      *olderSolution = *previousSolution;
+    }
+    *previousSolution = *currentSolution;
+  }
+  PackSliceState(state, currentTime);
+  return iterTotal;
+}
+
+long cvOneDBFSolver::RunFineSlices(vector<vector<double> >& states, long firstSlice, long cycleSteps, double cycleTime, vector<unique_ptr<cvOneDContext> >& workers){
+  long numStates = states.size();
+  long iterTotal = 0;
+  if(pararealWorkers > 1 && workerFactory){
+    // worker w propagates the slices w, w + count, ... and copies their
+    // rows to the results, which no other slice saves
+    size_t count = min((size_t)pararealWorkers, (size_t)numStates);
+    long dim = currentSolution->GetDimension();
+    vector<long> iters(count, 0);
+    RunWorkers(workers, count, [&](cvOneDBFSolver* worker, size_t w){
+      if(predictor != NULL && worker->predictor == NULL){
+        worker->predictor = new cvOneDSolutionPredictor(*predictor);
+      }
+      for(long s = w; s < numStates; s += count){
+        long k = firstSlice + s;
+        iters[w] += worker->PropagateSlice(states[s], k * cycleTime, k * cycleSteps, cycleSteps, deltaTime, true);
+        for(long row = k * cycleSteps / stepSize + 1; row <= (k + 1) * cycleSteps / stepSize; row++){
+          for(long j = 0; j < dim; j++){
+            TotalSolution[row][j] = worker->TotalSolution[row][j];
+          }
+        }
+      }
+    });
+    for(size_t w = 0; w < count; w++){
+      iterTotal += iters[w];
+    }
+    return iterTotal;
+  }
+  for(long s = 0; s < numStates; s++){
+    long k = firstSlice + s;
+    iterTotal += PropagateSlice(states[s], k * cycleTime, k * cycleSteps, cycleSteps, deltaTime, true);
+  }
+  return iterTotal;
+}
+
+// The worker contexts are created on the first run and set up with the
+// model of the factory on their thread, later runs reuse them. The first
+// error of a worker is thrown once all threads are done.
+void cvOneDBFSolver::RunWorkers(vector<unique_ptr<cvOneDContext> >& workers, size_t count, const std::function<void(cvOneDBFSolver*, size_t)>& task){
+  while(workers.size() < count){
+    workers.push_back(unique_ptr<cvOneDContext>(new cvOneDContext()));
+    workers.back()->quiet = !cvOneDGlobal::debugMode;
+    workers.back()->solver->SetSteppable(true);
+  }
+  vector<exception_ptr> errors(count);
+  vector<thread> threads;
+  for(size_t w = 0; w < count; w++){
+    threads.push_back(thread([&, w](){
+      try{
+        cvOneDContext::Scope scope(workers[w].get());
+        cvOneDBFSolver* worker = workers[w]->solver;
+        if(worker->mathModels.empty()){
+          workerFactory();
+        }
+        task(worker, w);
+      }catch(...){
+        errors[w] = current_exception();
+      }
+    }));
+  }
+  for(size_t w = 0; w < count; w++){
+    threads[w].join();
+  }
+  for(size_t w = 0; w < count; w++){
+    if(errors[w]){
+      rethrow_exception(errors[w]);
+    }
+  }
+}
+
+// The solution and the boundary memory completed up to time, so that the
+// states of the coarse and the fine propagators can be combined
+void cvOneDBFSolver::PackSliceState(vector<double>& state, double time){
+  bool linear = (timeIntegrator == TimeIntegratorTypeScope::BDF2);
+  long eqNumbers[2];
+  for(size_t k = 0; k < outletList.size(); k++){
+    cvOneDSubdomain* sub = subdomainList[outletList[k]];
+    mathModels[0]->GetNodalEquationNumbers(sub->GetNumberOfNodes() - 1, eqNumbers, outletList[k]);
+    double p = sub->GetMaterial()->GetPressure(previousSolution->Get(eqNumbers[0]), sub->GetOutletZ());
+    if(sub->GetBoundCondition() == BoundCondTypeScope::CORONARY){
+      p += sub->GetP_v();
+    }
+    sub->CompleteBoundaryMemory(p, time, linear);
+  }
+  PackPeriodicState(state);
+}
+
+void cvOneDBFSolver::UnpackSliceState(const vector<double>& state, double time, double dt){
+  long dim = previousSolution->GetDimension();
+  for(long j = 0; j < dim; j++){
+    previousSolution->Set(j, state[j]);
+  }
+  *currentSolution = *previousSolution;
+  if(olderSolution != NULL){
+    *olderSolution = *previousSolution;
+  }
+  for(size_t k = 0; k < subdomainList.size(); k++){
+    subdomainList[k]->SetBoundaryMemory(&state[dim + cvOneDSubdomain::BOUNDARY_MEMORY_SIZE * k]);
+    subdomainList[k]->ResumeBoundaryMemory(time, dt);
+  }
+}
+
+// Largest relative change of the areas and of the flow rates
+double cvOneDBFSolver::SliceChange(const vector<double>& oldState, const vector<double>& newState){
+  long stop = currentSolution->GetDimension();
+  if(jointList.size() != 0){
+    stop = jointList[0]->GetGlobal1stLagNodeID();
+  }
+  double diff[2] = {0.0, 0.0};
+  double size[2] = {0.0, 0.0};
+  for(long j = 0; j < stop; j++){
+    double d = newState[j] - oldState[j];
+    diff[j % 2] += d * d;
+    size[j % 2] += newState[j] * newState[j];
+  }
+  double change = 0.0;
+  for(int c = 0; c < 2; c++){
+    if(size[c] > 0.0){
+      change = max(change, sqrt(diff[c] / size[c]));
+    }
+  }
+  return change;
+}
+
+// ================
+// PREDICT SOLUTION
+// ================
+// Called once the models are at the new time level, the Dirichlet values
+// are imposed on the guess since the boundary rows only carry increments.
+bool cvOneDBFSolver::PredictSolution(void){
+  if(predictor == NULL){
+    return false;
+  }
+  long areaEnd = currentSolution->GetDimension();
+  if(jointList.size() != 0){
+    areaEnd = jointList[0]->GetGlobal1stLagNodeID();
+  }
+  if(!predictor->Predict(*currentSolution, currentTime, areaEnd)){
+    return false;
+  }
+  mathModels[0]->SetBoundaryConditions();
+  return true;
+}
+
+// ===========
+// LINE SEARCH
+// ===========
+void cvOneDBFSolver::ComputeResidualNorms(double& normf, double& norms){
+# ifdef USE_MPI
+  // every process holds the residual of its own segments
+  if(cvOneDGlobal::numberOfRanks > 1){
+    cvOneDDistributedLinearSolver* distributed = (cvOneDDistributedLinearSolver*)linearSolver;
+    normf = distributed->Norm(*rhs, 1);
+    norms = distributed->Norm(*rhs, 0);
+    return;
+  }
+# endif
+  // Do not evaluate residuals of lagrange eqns
+  if(jointList.size() != 0){
+    normf = rhs->Norm(L2_norm,1,2, jointList[0]->GetGlobal1stLagNodeID());
+    norms = rhs->Norm(L2_norm,0,2, jointList[0]->GetGlobal1stLagNodeID());
+  }else{
+    normf = rhs->Norm(L2_norm,1,2);
+    norms = rhs->Norm(L2_norm,0,2);
+  }
+}
+
+// Residual of the current solution with the Dirichlet values imposed,
+// assembled without the tangent. The tangent is formed again at the
+// start of the next iteration, so the boundary operations on it are lost.
+double cvOneDBFSolver::TrialResidualNorm(void){
+  mathModels[0]->SetBoundaryConditions();
+  if(nonlinearSolver != NonlinearSolverTypeScope::NEWTON){
+    ((cvOneDKrylovLinearSolver*)linearSolver)->BeginAssembly(false);
+  }
+  for(int i = 0; i < mathModels.size(); i++){
+    mathModels[i]->FormResidual(rhs);
+  }
+  mathModels[0]->ApplyBoundaryConditions(linearSolver);
+  double normf = 0.0;
+  double norms = 0.0;
+  ComputeResidualNorms(normf, norms);
+  return normf + norms;
+}
+
+// The update from searchOrigin to the current solution is first shortened
+// so that no area loses more than LINE_SEARCH_BOUNDARY of its value, then
+// halved until the residual decreases, at most lineSearch times. The first
+// update of a step also moves the Dirichlet values to the new time and its
+// residual is not comparable, so it is only kept positive. Returns 1 when
+// the update was shortened.
+int cvOneDBFSolver::SearchLine(long iter, double norm){
+  long areaEnd = currentSolution->GetDimension();
+  if(jointList.size() != 0){
+    areaEnd = jointList[0]->GetGlobal1stLagNodeID();
+  }
+  double* x = currentSolution->GetEntries();
+  const double* x0 = searchOrigin->GetEntries();
+  double alpha = 1.0;
+  for(long k = 0; k < areaEnd; k += 2){
+    double ds = x[k] - x0[k];
+    if(x0[k] > 0.0 && ds < -LINE_SEARCH_BOUNDARY * x0[k]){
+      alpha = min(alpha, -LINE_SEARCH_BOUNDARY * x0[k] / ds);
+    }
+  }
+  if(alpha == 1.0 && iter == 0){
+    return 0;
+  }
+
+  // direction of the update
+  *increment = *currentSolution;
+  double* dx = increment->GetEntries();
+  long dim = currentSolution->GetDimension();
+  for(long k = 0; k < dim; k++){
+    dx[k] -= x0[k];
+  }
+
+  int halvings = 0;
+  while(true){
+    if(alpha < 1.0){
+      for(long j = 0; j < dim; j++){
+        x[j] = x0[j] + alpha * dx[j];
+      }
+    }
+    if(iter == 0 || halvings == lineSearch){
+      break;
+    }
+    if(TrialResidualNorm() <= (1.0 - LINE_SEARCH_DECREASE * alpha) * norm){
+      break;
+    }
+    alpha *= 0.5;
+    halvings++;
+  }
+  return (alpha < 1.0) ? 1 : 0;
+}
+
+void cvOneDBFSolver::PrintIterationSummary(void){
+  if(predictor != NULL && predictor->GetNumberOfPredictions() > 0){
+    cout << "Predicted time steps = " << predictor->GetNumberOfPredictions() << ", ";
+    cout << "average number of Newton-Raphson iterations per predicted step = ";
+    cout << (double)predictedIterations / (double)predictor->GetNumberOfPredictions() << "\n" << endl;
+  }
+  if(anderson != NULL){
+    cout << "Anderson mixed updates = " << anderson->GetNumberOfMixedUpdates() << "\n" << endl;
+  }
+  if(searchOrigin != NULL){
+    cout << "Shortened Newton updates = " << lineSearchReductions << "\n" << endl;
+  }
 }
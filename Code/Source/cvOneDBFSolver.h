@@ -35,14 +35,16 @@
 //
 //  cvOneDBFSolver.h - Header for a One-Dimensional Network Blood Flow Solver
 //  ~~~~~~~~~~~~
-//  This is a static class which abstracts the blood flow solver.
-//  Essentially, this is a driver for 1D finite element blood flow solver
+//  This class abstracts the blood flow solver, each instance holds the
+//  state of one simulation.  Essentially, this is a driver for 1D finite element blood flow solver
 //  without any interfaces.
 //
 
 # include <vector>
 # include <iostream>
 # include <ostream>
+# include <memory>
+# include <functional>
 # include <cstdlib>
 # include <cstdio>
 # include <math.h>
@@ -52,92 +54,362 @@
 # include "cvOneDSubdomain.h"
 # include "cvOneDMthModelBase.h"
 # include "cvOneDFEAJoint.h"
+# include "cvOneDSolutionPredictor.h"
+# include "cvOneDAndersonAcceleration.h"
+# include "cvOneDWarmStart.h"
 
 using namespace std;
 
+class cvOneDLinearSolver;
+class cvOneDMaterialManager;
+class cvOneDSkylineBatchSolver;
+class cvOneDContext;
+class cvOneDWaveformRelaxation;
+
 class cvOneDBFSolver{
 
+    // the subtrees of a waveform relaxation take turns on the arrays
+    friend class cvOneDWaveformRelaxation;
+
  public:
 
+    // The materials of the segments are taken from the manager
+    cvOneDBFSolver(cvOneDMaterialManager* materials);
+    ~cvOneDBFSolver();
+
     // Solver Initialization
-    static void SetDeltaTime(double dt);
-    static void SetStepSize(long size);
-    static void SetInletBCType(BoundCondType bc);
-    static void SetMaxStep(long maxs);
-    static void SetQuadPoints(long quadPoints_);
-	static void SetConvergenceCriteria(double convCriteria);
+    void SetDeltaTime(double dt);
+    void SetStepSize(long size);
+    void SetInletBCType(BoundCondType bc);
+    void SetMaxStep(long maxs);
+    void SetQuadPoints(long quadPoints_);
+	void SetConvergenceCriteria(double convCriteria);
+    // Matrix-free Newton-Krylov (JFNK) settings
+    void SetNonlinearSolver(NonlinearSolverType type);
+    void SetKrylovRestart(int restart);
+    void SetKrylovTolerance(double tolerance);
+    void SetPreconditionerRefresh(long steps);
+    void SetSolutionPredictor(PredictorType type);
+    void SetAndersonDepth(int depth);
+    void SetLineSearch(int backtracks);
+    void SetTimeIntegrator(TimeIntegratorType type);
+    void SetLinearSolves(int solves);
+    // Explicit finite volume engine instead of the finite elements
+    void SetSolverEngine(SolverEngineType engine);
+    void SetCourantNumber(double courant);
+    // Steady state with the mean inflow as initial condition or result
+    void SetSteadyState(SteadyStateType type);
+    // Start from the final state of the text results with this prefix
+    void SetWarmStart(const string& prefix);
+    // Adaptive time stepping settings
+    void SetAdaptiveTimeStep(bool adaptive);
+    void SetTimeStepTolerance(double tolerance);
+    void SetMinTimeStep(double dt);
+    void SetMaxTimeStep(double dt);
+    // Stop once successive cardiac cycles differ by less than tolerance
+    void SetPeriodicTolerance(double tolerance);
+    void SetPeriodicShooting(bool shooting);
+    // Parareal iterations over the cycles
+    void SetParareal(int iterations);
+    void SetPararealCoarseFactor(int factor);
+    void SetPararealWorkers(int workers);
+    // Parareal and Jacobi waveform relaxation run the fine propagators and
+    // the subtrees on threads, each on a copy of the model that the
+    // factory creates in the context bound to the thread; without it they
+    // run one after the other on this solver
+    typedef std::function<void()> WorkerFactory;
+    void SetWorkerFactory(const WorkerFactory& factory);
+    // Waveform relaxation over the subtrees cut at the named joints
+    void SetWaveformRelaxation(WaveformRelaxationType type);
+    void SetWaveformCuts(const cvStringVec& joints);
+    void SetWaveformWindow(long steps);
+    // Result output: text, VTK or both, VTK in one or multiple files
+    void SetOutputType(int type);
+    void SetVtkOutputType(int type);
+    // Conservative form of the equations and stabilization of the elements
+    void SetConservationForm(int form);
+    void SetStabilization(int stab);
+    // Newton systems solved in a lane of a lock-step ensemble
+    void SetLaneBatch(cvOneDSkylineBatchSolver* batch, int lane);
 
     // Set the Model Pointer
-    static void SetModelPtr(cvOneDModel *mdl);
-    static cvOneDModel* GetModelPtr(){return model;}
+    void SetModelPtr(cvOneDModel *mdl);
+    cvOneDModel* GetModelPtr(){return model;}
 
     // Solve the blood flow problem
-    static void Solve(void);
+    void Solve(void);
 
     // Get the solution;
-    static double GetSolution(int i, int j){return TotalSolution[i][j];}//IV 082103
+    double GetSolution(int i, int j){return TotalSolution[i][j];}//IV 082103
+    // Flow rates and pressures at the inlet and outlet of a segment, one
+    // value per saved step
+    void GetSegmentEnds(long segment, cvDoubleVec& inletFlow, cvDoubleVec& outletFlow,
+                        cvDoubleVec& inletPressure, cvDoubleVec& outletPressure);
+    // Flow rates, areas and pressures of a segment as in its text result
+    // files, the saved steps of each node in turn
+    void GetSegmentResults(long segment, cvDoubleVec& flow, cvDoubleVec& area, cvDoubleVec& pressure);
+    // Reynolds numbers and Poiseuille wall shear stresses of a segment, laid
+    // out as GetSegmentResults
+    void GetSegmentShearResults(long segment, cvDoubleVec& reynolds, cvDoubleVec& wss);
+    long GetNumberOfSavedSteps(){return TotalSolution.Rows();}
+
+    // Co-simulation: a steppable solver only sets up the model and its
+    // initial solution in Solve, the coupled partner then advances it one
+    // implicit step of its choice at a time. UndoStep returns to the
+    // solution before the last step, so that the step can be taken again
+    // with new interface values.
+    void SetSteppable(bool steppable);
+    int Step(double dt);
+    void UndoStep(void);
+    double GetCurrentTime(){return currentTime;}
+    // Interface values: the inlet value, a flow rate or a pressure as the
+    // inlet type, replaces the inlet table until cleared; the outlet
+    // pressure is that of an outlet with a PRESSURE condition
+    void SetInletValue(double value);
+    void ClearInletValue(void);
+    void SetOutletPressure(long segment, double pressure);
+    double GetInletFlow(void);
+    double GetInletPressure(void);
+    double GetOutletFlow(long segment);
+    double GetOutletPressure(long segment);
+    // segments at the outlets of the network
+    long GetNumberOfOutlets(){return outletList.size();}
+    long GetOutletSegment(long outlet){return outletList[outlet];}
+    // current solution, area and flow rate of each node in turn, then
+    // the joint unknowns, as one row of the saved solution
+    void GetState(cvDoubleVec& state);
+    // result files of the saved steps, as the output type of the solver
+    void WriteResults(void);
 
     // Cleanup
-    static void Cleanup(void);
+    void Cleanup(void);
 
-    static void DefineInletFlow(double* time, double* flrt, int num);
+    void DefineInletFlow(double* time, double* flrt, int num);
 
-	static void QuerryModelInformation(void);
-    static double currentTime;
-    static double deltaTime;
-	static BoundCondType inletBCtype;
-	static int ASCII;
+	void QuerryModelInformation(void);
+    double currentTime = 0;
+    double deltaTime = 0;
+	BoundCondType inletBCtype = BoundCondTypeScope::FLOW;
+	int ASCII = 1;
 
     // Result Output
-    static void postprocess_Text();
-    static void postprocess_VTK();
-    static void postprocess_VTK_XML3D_ONEFILE();
-    static void postprocess_VTK_XML3D_MULTIPLEFILES();
+    void postprocess_Text();
+    // Text results written to the streams the sink opens for the file
+    // names, postprocess_Text opens the files themselves
+    typedef std::function<shared_ptr<ostream>(const string&)> TextResultSink;
+    void WriteTextResults(const TextResultSink& openFile);
+    // All fields of all segments in <modelName>results.bin
+    void postprocess_Binary();
+    void postprocess_VTK();
+    void postprocess_VTK_XML3D_ONEFILE();
+    void postprocess_VTK_XML3D_MULTIPLEFILES();
 
     // Find Segment index given the ID
-    static int getSegmentIndex(int segID);
+    int getSegmentIndex(int segID);
 
  private:
 
     // Query Model, Allocate Memory, Set Initial Conditions
-    static void CreateGlobalArrays(void);
+    void CreateGlobalArrays(void);
 
     //initialize the solution, flow rate and area
-    static void CalcInitProps(long subdomainID);
+    void CalcInitProps(long subdomainID);
+    //initialize the solution from the results of a previous run
+    void CalcWarmStartProps(long subdomainID, const cvOneDWarmStart& results);
+    //initial solution, steady if requested, as the first saved step
+    void StartSolution(void);
     //the main solve part
-    static void GenerateSolution(void);
+    void GenerateSolution(void);
+    //time loop with error controlled step size, called from GenerateSolution
+    void GenerateAdaptiveSolution(double cycleTime);
+    //steady state in previousSolution, pseudo time steps until the steady Newton converges
+    void SolveSteadyState(void);
+    //initial states of the RCR and coronary outlets consistent with the outlet flow and pressure
+    void SetOutletStates(void);
+    //time loop of the explicit finite volume engine, called from GenerateSolution
+    void GenerateExplicitSolution(void);
+    //Newton iterations, or linearSolves linear solves, of one time step, returns -1 if the step failed and allowFailure is set
+    int SolveTimeStep(long step, double dt, bool allowFailure);
+    //estimate of the local error of the last step relative to the tolerance
+    double EstimateTimeStepError(double dt, double prevDt, const cvOneDFEAVector& olderSolution);
+    //periodic state detection: cycle norms at the segment outlets
+    void InitCycleMonitor(void);
+    void AccumulateCycleNorms(double dt);
+    bool CycleConverged(double cycleMass);
+    //drop all saved rows but the last cycle
+    void KeepLastCycle(long savedRows, double cycleTime);
+    //initial guess of the Newton iterations at the new time level
+    bool PredictSolution(void);
+    //L2 norms of the flow and area residuals, without the lagrange equations
+    void ComputeResidualNorms(double& normf, double& norms);
+    //backtracking on the update of the current solution from searchOrigin
+    int SearchLine(long iter, double norm);
+    double TrialResidualNorm(void);
+    //predictor, Anderson and line search statistics at the end of the run
+    void PrintIterationSummary(void);
+    //Newton-Krylov shooting for the periodic state from the end of the first cycle
+    long ShootPeriodicState(long step, double cycleTime, long& iterTotal);
+    void CycleMap(const vector<double>& start, vector<double>& end);
+    void PackPeriodicState(vector<double>& state);
+    void UnpackPeriodicState(const vector<double>& state);
+    //Parareal: coarse and fine propagators over the cycles, the fine ones on worker threads
+    void GeneratePararealSolution(double cycleTime);
+    long PropagateSlice(vector<double>& state, double startTime, long firstStep, long steps, double dt, bool save);
+    long RunFineSlices(vector<vector<double> >& states, long firstSlice, long cycleSteps, double cycleTime, vector<unique_ptr<cvOneDContext> >& workers);
+    //runs task on count threads, each with the solver of its own worker context
+    void RunWorkers(vector<unique_ptr<cvOneDContext> >& workers, size_t count, const std::function<void(cvOneDBFSolver*, size_t)>& task);
+    void PackSliceState(vector<double>& state, double time);
+    void UnpackSliceState(const vector<double>& state, double time, double dt);
+    double SliceChange(const vector<double>& oldState, const vector<double>& newState);
+    //system arrays of the current lists and models, called from CreateGlobalArrays
+    void CreateSystemArrays(void);
     //create MthSegmentModel and MthBranchModel if exists. Also specify inflow profile
-    static void DefineMthModels(void);
-    static void AddOneModel(cvOneDMthModelBase* model);
+    void DefineMthModels(void);
+    void AddOneModel(cvOneDMthModelBase* model);
+    //formulation settings of a new model
+    void SetupModel(cvOneDMthModelBase* model);
+    //frees the models and system arrays currently loaded
+    void FreeSystem(void);
+    //minus the residual at the current solution plus shift, for JFNK
+    void FormShiftedResidual(const cvOneDFEAVector& shift, cvOneDFEAVector& residual);
 
-    static bool wasSet;
+    bool wasSet = false;
 
     // Pointer to the Model
-    static cvOneDModel *model;
-
-    static vector<cvOneDSubdomain*> subdomainList;
-    static vector<cvOneDFEAJoint*> jointList;
-    static vector<int> outletList;
-    static cvOneDFEAVector *currentSolution;
-    static cvOneDFEAVector *previousSolution;
-    static cvOneDFEAVector *increment;
-    static cvOneDFEAVector *rhs;
-    static cvOneDFEAVector *relLength; //for pressure calculation
-    static cvOneDMatrix<double> TotalSolution;
-
-    // Generic matrix, can be skyline or sparse
-    static cvOneDFEAMatrix *lhs;
-
-    static long stepSize;
-    static long maxStep;
-    static long quadPoints;
-    static vector<cvOneDMthModelBase*> mathModels;
-
-    static long numFlowPts;
-    static double *flowRate;
-    static double *flowTime;
-	static double Period;
-	static double convCriteria;
+    cvOneDModel *model = NULL;
+    cvOneDMaterialManager *materialManager = NULL;
+
+    // Output and formulation settings
+    int outputType = 0;
+    int vtkOutputType = 0;
+    int conservationForm = 0;
+    int stabilization = 0;
+
+    vector<cvOneDSubdomain*> subdomainList;
+    vector<cvOneDFEAJoint*> jointList;
+    vector<int> outletList;
+    cvOneDFEAVector *currentSolution = NULL;
+    cvOneDFEAVector *previousSolution = NULL;
+    cvOneDFEAVector *increment = NULL;
+    cvOneDFEAVector *rhs = NULL;
+    cvOneDFEAVector *relLength = NULL; //for pressure calculation
+    cvOneDMatrix<double> TotalSolution;
+
+    // Generic matrix, can be skyline or sparse, and the solver acting on it
+    cvOneDFEAMatrix *lhs = NULL;
+    cvOneDLinearSolver *linearSolver = NULL;
+
+    long stepSize = 0;
+    long maxStep = 0;
+    long quadPoints = 0;
+    vector<cvOneDMthModelBase*> mathModels;
+
+    long numFlowPts = 0;
+    double *flowRate = NULL;
+    double *flowTime = NULL;
+	double Period = 0;
+	double convCriteria = 0;
+
+    // JFNK: Krylov restart length, relative tolerance and number of
+    // time steps between refreshes of the segment block preconditioner
+    NonlinearSolverType nonlinearSolver = NonlinearSolverTypeScope::NEWTON;
+    int krylovRestart = 30;
+    double krylovTolerance = 1.0e-6;
+    long preconditionerRefresh = 10;
+    cvOneDFEAVector *savedSolution = NULL;
+
+    // Adaptive time stepping: relative tolerance on the local error
+    // estimate and bounds on the step, zero bounds are derived from
+    // deltaTime when the loop starts
+    bool adaptiveTimeStep = false;
+    double timeStepTolerance = 1.0e-3;
+    double minTimeStep = 0.0;
+    double maxTimeStep = 0.0;
+
+    // Periodic state detection: the equations and positions of the
+    // monitored nodes, the running pressure and flow norms of the current
+    // cycle and the norms and mass balance of the previous one. Rows
+    // dropped from the start of TotalSolution are counted in outputOffset.
+    double periodicTolerance = 0.0;
+    vector<long> cycleMonitorSubdomains;
+    vector<long> cycleMonitorEqs;
+    vector<double> cycleMonitorZ;
+    vector<double> cycleNorms;
+    vector<double> lastCycleNorms;
+    double lastCycleMass = 0.0;
+    long outputOffset = 0;
+
+    // Periodic shooting: the time and step the cycle map starts from, its
+    // number of steps and the Newton iterations spent in it
+    bool periodicShooting = false;
+    double shootingStartTime = 0.0;
+    long shootingFirstStep = 0;
+    long shootingSteps = 0;
+    long shootingIterations = 0;
+
+    // Newton initial guess: the extrapolation used, its history of
+    // accepted steps and the iterations spent on predicted steps
+    PredictorType predictorType = PredictorTypeScope::NONE;
+    cvOneDSolutionPredictor* predictor = NULL;
+    long predictedIterations = 0;
+
+    // Anderson mixing of the Newton corrections, off with a zero depth
+    int andersonDepth = 0;
+    cvOneDAndersonAcceleration* anderson = NULL;
+
+    // Line search on the Newton updates: maximum number of step halvings,
+    // off with zero, the iterate the update starts from and the number
+    // of shortened updates
+    int lineSearch = 0;
+    cvOneDFEAVector* searchOrigin = NULL;
+    long lineSearchReductions = 0;
+
+    // Time discretization, BDF2 also keeps the solution one step before
+    // previousSolution, which the adaptive loop uses for its error estimate
+    TimeIntegratorType timeIntegrator = TimeIntegratorTypeScope::BACKWARD_EULER;
+    cvOneDFEAVector* olderSolution = NULL;
+
+    // Linearly implicit stepping: number of linear solves per time step,
+    // zero iterates Newton to convergence
+    int linearSolves = 0;
+
+    // Solver engine and the Courant number of the explicit steps
+    SolverEngineType solverEngine = SolverEngineTypeScope::IMPLICIT_FEM;
+    double courantNumber = 0.8;
+
+    // Steady state used as initial condition or as the only result
+    SteadyStateType steadyState = SteadyStateTypeScope::NONE;
+
+    // Result file prefix of the previous run to start from, empty for none
+    string warmStart;
+
+    // Parareal: maximum number of iterations (zero for none), ratio of the
+    // coarse to the fine time step and number of worker threads
+    int pararealIterations = 0;
+    int pararealCoarseFactor = 10;
+    int pararealWorkers = 0;
+    WorkerFactory workerFactory;
+
+    // Waveform relaxation: iteration type, names of the cut joints and
+    // window length in steps
+    WaveformRelaxationType waveformRelaxation = WaveformRelaxationTypeScope::NONE;
+    cvStringVec waveformCuts;
+    long waveformWindow = 0;
+
+    // Lock-step ensemble the Newton systems are solved with, not owned
+    cvOneDSkylineBatchSolver* laneBatch = NULL;
+    int laneID = 0;
+
+    // Co-simulation: number of steps taken and size of the last one, and
+    // the solutions, time and saved rows before it for UndoStep
+    bool steppable = false;
+    long steppedSteps = 0;
+    double lastStepSize = 0.0;
+    bool canUndo = false;
+    vector<double> undoSolution;
+    vector<double> undoOlderSolution;
+    double undoTime = 0.0;
+    double undoStepSize = 0.0;
 
 };
 
@@ -0,0 +1,123 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+# include <mutex>
+# include <streambuf>
+
+# include "cvOneDContext.h"
+# include "cvOneDBFSolver.h"
+
+// Context bound to this thread, NULL for the process default
+static thread_local cvOneDContext* boundContext = NULL;
+
+namespace {
+
+// Put in front of the buffer of std::cout once a quiet context is bound,
+// it drops the characters of the threads bound to a quiet context and
+// passes those of the others on unchanged
+class cvOneDQuietBuffer: public streambuf{
+  public:
+    cvOneDQuietBuffer(streambuf* target): target(target){}
+  protected:
+    int overflow(int c){
+      if(cvOneDContext::IsQuiet() || traits_type::eq_int_type(c, traits_type::eof())){
+        return traits_type::not_eof(c);
+      }
+      return target->sputc(traits_type::to_char_type(c));
+    }
+    streamsize xsputn(const char* s, streamsize n){
+      if(cvOneDContext::IsQuiet()){
+        return n;
+      }
+      return target->sputn(s, n);
+    }
+    int sync(){
+      return target->pubsync();
+    }
+  private:
+    streambuf* target;
+};
+
+void InstallQuietBuffer(){
+  static once_flag installed;
+  call_once(installed, [](){
+    // kept until the process ends, as std::cout
+    static cvOneDQuietBuffer* buffer = new cvOneDQuietBuffer(cout.rdbuf());
+    cout.rdbuf(buffer);
+  });
+}
+
+} // namespace
+
+cvOneDContext::cvOneDContext(){
+  isCreating = false;
+  isSolving = false;
+  quiet = false;
+  currentModel = -1;
+  materialManager = new cvOneDMaterialManager();
+  solver = new cvOneDBFSolver(materialManager);
+}
+
+cvOneDContext::~cvOneDContext(){
+  delete solver;
+  for(size_t i = 0; i < modelList.size(); i++){
+    delete modelList[i];
+  }
+  for(size_t i = 0; i < dataTables.size(); i++){
+    delete dataTables[i];
+  }
+  delete materialManager;
+}
+
+cvOneDContext* cvOneDContext::Current(){
+  if(boundContext != NULL){
+    return boundContext;
+  }
+  // the default context lives as long as the process
+  static cvOneDContext* processContext = new cvOneDContext();
+  return processContext;
+}
+
+bool cvOneDContext::IsQuiet(){
+  return boundContext != NULL && boundContext->quiet;
+}
+
+cvOneDContext::Scope::Scope(cvOneDContext* context){
+  if(context != NULL && context->quiet){
+    InstallQuietBuffer();
+  }
+  previous = boundContext;
+  boundContext = context;
+}
+
+cvOneDContext::Scope::~Scope(){
+  boundContext = previous;
+}
@@ -0,0 +1,106 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDCONTEXT_H
+#define CVONEDCONTEXT_H
+
+//
+//  cvOneDContext.h - Header for the state of one simulation
+//  ~~~~~~~~~~~~
+//  The models, materials, data tables and solver of a simulation live in
+//  a context, so that independent simulations can run in one process on
+//  different threads. Each thread works on the context bound to it with
+//  a Scope, or on the process default one. The output of a quiet context
+//  is discarded on the threads bound to it, the other threads of the
+//  process, e.g. of a host application, still write theirs.
+//
+
+# include <vector>
+
+# include "cvOneDModel.h"
+# include "cvOneDMaterialManager.h"
+# include "cvOneDDataTable.h"
+
+using namespace std;
+
+class cvOneDBFSolver;
+
+class cvOneDContext{
+
+  public:
+
+    cvOneDContext();
+    ~cvOneDContext();
+
+    // Context of the calling thread
+    static cvOneDContext* Current();
+
+    // Binds a context to the calling thread for the lifetime of the scope
+    class Scope{
+      public:
+        Scope(cvOneDContext* context);
+        ~Scope();
+      private:
+        cvOneDContext* previous;
+    };
+
+    // FLAGS
+    bool isCreating;
+    bool isSolving;
+    // std::cout and cvOneDPrintf write nothing for a quiet context
+    bool quiet;
+
+    // Whether the context bound to the calling thread is quiet
+    static bool IsQuiet();
+
+    // CURRENT MODEL INDEX
+    long currentModel;
+
+    // VECTOR OF CREATED MODELS
+    vector<cvOneDModel*> modelList;
+
+    // MATERIAL MANAGER
+    cvOneDMaterialManager* materialManager;
+
+    // VECTOR OF DATATABLES
+    vector<cvOneDDataTable*> dataTables;
+
+    // SOLVER
+    cvOneDBFSolver* solver;
+
+  private:
+
+    cvOneDContext(const cvOneDContext&);
+    cvOneDContext& operator=(const cvOneDContext&);
+
+};
+
+#endif // CVONEDCONTEXT_H
@@ -0,0 +1,315 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDCouplingChannel.cxx - Source for the Co-Simulation Shared Memory
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+
+# include <errno.h>
+# include <fcntl.h>
+# include <pthread.h>
+# include <signal.h>
+# include <string.h>
+# include <time.h>
+# include <unistd.h>
+# include <sys/mman.h>
+# include <sys/stat.h>
+# include <atomic>
+# include <chrono>
+# include <thread>
+
+# include "cvOneDCouplingChannel.h"
+# include "cvOneDException.h"
+
+// Written as the last step of the creation, the partner waits for it
+static const int COUPLING_READY = 0x31444344;
+// Default longest wait, and interval of the checks of the other process
+static const double COUPLING_TIMEOUT = 3600.0;
+static const long COUPLING_CHECK_NSEC = 100000000;
+
+struct cvOneDCouplingBlock{
+  std::atomic<int> ready;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  // processes of the solver and of the partner, zero before it opens
+  pid_t solverPid;
+  pid_t partnerPid;
+  // requests sent by the partner and answered by the solver
+  long requests;
+  long replies;
+  int command;
+  int failed;
+  double dt;
+  int numInputs;
+  int numOutputs;
+  double inputs[cvOneDCouplingChannel::MAX_VALUES];
+  double outputs[cvOneDCouplingChannel::MAX_VALUES];
+  char message[512];
+};
+
+namespace{
+
+// Shared memory names start with a slash
+string BlockName(const string& name){
+  return (!name.empty() && name[0] == '/') ? name : "/" + name;
+}
+
+cvOneDCouplingBlock* MapBlock(int fd){
+  void* memory = mmap(NULL, sizeof(cvOneDCouplingBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if(memory == MAP_FAILED){
+    throw cvException("ERROR: Cannot map the co-simulation shared memory.\n");
+  }
+  return (cvOneDCouplingBlock*)memory;
+}
+
+// A process that cannot be signalled for lack of permission still exists
+bool ProcessAlive(pid_t pid){
+  return pid == 0 || kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+} // namespace
+
+cvOneDCouplingChannel::cvOneDCouplingChannel(const string& blockName, cvOneDCouplingBlock* memory, bool creator){
+  name = blockName;
+  block = memory;
+  owner = creator;
+  timeout = COUPLING_TIMEOUT;
+}
+
+cvOneDCouplingChannel::~cvOneDCouplingChannel(){
+  if(!owner){
+    // the solver no longer checks on this partner
+    try{
+      Lock();
+      block->partnerPid = 0;
+      pthread_mutex_unlock(&block->lock);
+    }catch(cvException&){
+    }
+  }
+  munmap(block, sizeof(cvOneDCouplingBlock));
+  if(owner){
+    shm_unlink(name.c_str());
+  }
+}
+
+cvOneDCouplingChannel* cvOneDCouplingChannel::Create(const string& channelName){
+  string blockName = BlockName(channelName);
+  // the block of another solver, or one left by a solver that did not
+  // stop, is not taken over
+  int fd = shm_open(blockName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if(fd < 0 && errno == EEXIST){
+    throw cvException(("ERROR: The co-simulation shared memory " + blockName + " already exists.\n").c_str());
+  }
+  if(fd < 0 || ftruncate(fd, sizeof(cvOneDCouplingBlock)) != 0){
+    if(fd >= 0){
+      close(fd);
+      shm_unlink(blockName.c_str());
+    }
+    throw cvException(("ERROR: Cannot create the co-simulation shared memory " + blockName + ".\n").c_str());
+  }
+  cvOneDCouplingBlock* block = MapBlock(fd);
+
+  pthread_mutexattr_t mutexAttributes;
+  pthread_mutexattr_init(&mutexAttributes);
+  pthread_mutexattr_setpshared(&mutexAttributes, PTHREAD_PROCESS_SHARED);
+  pthread_mutexattr_setrobust(&mutexAttributes, PTHREAD_MUTEX_ROBUST);
+  pthread_mutex_init(&block->lock, &mutexAttributes);
+  pthread_mutexattr_destroy(&mutexAttributes);
+  pthread_condattr_t condAttributes;
+  pthread_condattr_init(&condAttributes);
+  pthread_condattr_setpshared(&condAttributes, PTHREAD_PROCESS_SHARED);
+  pthread_condattr_setclock(&condAttributes, CLOCK_MONOTONIC);
+  pthread_cond_init(&block->changed, &condAttributes);
+  pthread_condattr_destroy(&condAttributes);
+  block->solverPid = getpid();
+  block->partnerPid = 0;
+  block->requests = 0;
+  block->replies = 0;
+  block->ready.store(COUPLING_READY);
+
+  return new cvOneDCouplingChannel(blockName, block, true);
+}
+
+cvOneDCouplingChannel* cvOneDCouplingChannel::Open(const string& channelName, double waitSeconds){
+  string blockName = BlockName(channelName);
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::duration<double>(waitSeconds);
+  while(true){
+    int fd = shm_open(blockName.c_str(), O_RDWR, 0600);
+    struct stat status;
+    if(fd >= 0 && fstat(fd, &status) == 0 && status.st_size >= (off_t)sizeof(cvOneDCouplingBlock)){
+      cvOneDCouplingBlock* block = MapBlock(fd);
+      while(block->ready.load() != COUPLING_READY && std::chrono::steady_clock::now() < deadline){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+      if(block->ready.load() == COUPLING_READY){
+        cvOneDCouplingChannel* channel = new cvOneDCouplingChannel(blockName, block, false);
+        try{
+          channel->Lock();
+        }catch(cvException&){
+          delete channel;
+          throw;
+        }
+        block->partnerPid = getpid();
+        pthread_mutex_unlock(&block->lock);
+        return channel;
+      }
+      munmap(block, sizeof(cvOneDCouplingBlock));
+    }else if(fd >= 0){
+      close(fd);
+    }
+    if(std::chrono::steady_clock::now() >= deadline){
+      throw cvException(("ERROR: Cannot open the co-simulation shared memory " + blockName + ".\n").c_str());
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+}
+
+void cvOneDCouplingChannel::SetTimeout(double seconds){
+  if(seconds < 0.0){
+    throw cvException("ERROR: Invalid co-simulation timeout.\n");
+  }
+  timeout = seconds;
+}
+
+string cvOneDCouplingChannel::PeerName() const{
+  return owner ? "partner" : "solver";
+}
+
+void cvOneDCouplingChannel::Lock(){
+  int result = pthread_mutex_lock(&block->lock);
+  if(result == EOWNERDEAD){
+    // the exchange the other process was in the middle of is lost
+    pthread_mutex_consistent(&block->lock);
+    pthread_mutex_unlock(&block->lock);
+    throw cvException(("ERROR: The co-simulation " + PeerName() + " died during an exchange.\n").c_str());
+  }
+  if(result != 0){
+    throw cvException("ERROR: Cannot lock the co-simulation shared memory.\n");
+  }
+}
+
+void cvOneDCouplingChannel::WaitFor(const long& counter, long count){
+  const pid_t& peer = owner ? block->partnerPid : block->solverPid;
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  while(counter < count){
+    struct timespec until;
+    clock_gettime(CLOCK_MONOTONIC, &until);
+    until.tv_nsec += COUPLING_CHECK_NSEC;
+    if(until.tv_nsec >= 1000000000){
+      until.tv_sec++;
+      until.tv_nsec -= 1000000000;
+    }
+    int result = pthread_cond_timedwait(&block->changed, &block->lock, &until);
+    if(result == EOWNERDEAD){
+      pthread_mutex_consistent(&block->lock);
+      pthread_mutex_unlock(&block->lock);
+      throw cvException(("ERROR: The co-simulation " + PeerName() + " died during an exchange.\n").c_str());
+    }
+    if(counter >= count){
+      break;
+    }
+    if(!ProcessAlive(peer)){
+      pthread_mutex_unlock(&block->lock);
+      throw cvException(("ERROR: The co-simulation " + PeerName() + " is gone.\n").c_str());
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    double waited = (now.tv_sec - start.tv_sec) + 1.0e-9 * (now.tv_nsec - start.tv_nsec);
+    if(timeout > 0.0 && waited >= timeout){
+      pthread_mutex_unlock(&block->lock);
+      throw cvException(("ERROR: Timeout waiting for the co-simulation " + PeerName() + ".\n").c_str());
+    }
+  }
+}
+
+void cvOneDCouplingChannel::Request(int command, double dt, const cvDoubleVec& inputs, cvDoubleVec& outputs){
+  if(inputs.size() > MAX_VALUES){
+    throw cvException("ERROR: Too many co-simulation values.\n");
+  }
+  Lock();
+  block->command = command;
+  block->dt = dt;
+  block->numInputs = inputs.size();
+  for(size_t i = 0; i < inputs.size(); i++){
+    block->inputs[i] = inputs[i];
+  }
+  long request = ++block->requests;
+  pthread_cond_broadcast(&block->changed);
+  WaitFor(block->replies, request);
+  bool failed = block->failed;
+  string message = block->message;
+  outputs.assign(block->outputs, block->outputs + block->numOutputs);
+  pthread_mutex_unlock(&block->lock);
+  if(failed){
+    throw cvException((message + "\n").c_str());
+  }
+}
+
+int cvOneDCouplingChannel::WaitRequest(double& dt, cvDoubleVec& inputs){
+  Lock();
+  WaitFor(block->requests, block->replies + 1);
+  int command = block->command;
+  dt = block->dt;
+  inputs.assign(block->inputs, block->inputs + block->numInputs);
+  pthread_mutex_unlock(&block->lock);
+  return command;
+}
+
+void cvOneDCouplingChannel::Reply(const cvDoubleVec& outputs){
+  if(outputs.size() > MAX_VALUES){
+    ReplyError("ERROR: Too many co-simulation values.");
+    return;
+  }
+  Lock();
+  block->failed = 0;
+  block->message[0] = '\0';
+  block->numOutputs = outputs.size();
+  for(size_t i = 0; i < outputs.size(); i++){
+    block->outputs[i] = outputs[i];
+  }
+  block->replies = block->requests;
+  pthread_cond_broadcast(&block->changed);
+  pthread_mutex_unlock(&block->lock);
+}
+
+void cvOneDCouplingChannel::ReplyError(const string& message){
+  Lock();
+  block->failed = 1;
+  strncpy(block->message, message.c_str(), sizeof(block->message) - 1);
+  block->message[sizeof(block->message) - 1] = '\0';
+  block->numOutputs = 0;
+  block->replies = block->requests;
+  pthread_cond_broadcast(&block->changed);
+  pthread_mutex_unlock(&block->lock);
+}
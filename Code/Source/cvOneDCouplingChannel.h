@@ -0,0 +1,109 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDCOUPLINGCHANNEL_H
+#define CVONEDCOUPLINGCHANNEL_H
+
+//
+//  cvOneDCouplingChannel.h - Header for the Co-Simulation Shared Memory
+//  ~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  A block of POSIX shared memory through which a partner process on the
+//  same host drives a steppable solver. The partner sends one request at
+//  a time, a command with the time step and its interface values, and
+//  waits for the values of the solver in reply; both sides wait on a
+//  process-shared condition variable, so an exchange costs no copy
+//  beyond the values themselves and no system call but the wake-ups.
+//
+//  The solver creates the block and removes it when it is destroyed, the
+//  partner opens it by name. A wait gives up once the other process is
+//  gone, or holds the lock as it died, and after the timeout.
+//
+
+# include <string>
+
+# include "cvOneDTypes.h"
+
+using namespace std;
+
+struct cvOneDCouplingBlock;
+
+class cvOneDCouplingChannel{
+
+  public:
+
+    static const int MAX_VALUES = 1024;
+
+    // STATE only replies the current values
+    enum Command{STATE = 0, STEP = 1, UNDO = 2, STOP = 3};
+
+    // solver side: creates the block with this name, throws if a block
+    // of that name exists
+    static cvOneDCouplingChannel* Create(const string& name);
+    // partner side: opens the block of a solver, waiting up to
+    // waitSeconds for the solver to create it
+    static cvOneDCouplingChannel* Open(const string& name, double waitSeconds = 0.0);
+    ~cvOneDCouplingChannel();
+
+    // longest wait for the other side in seconds, one hour by default,
+    // zero waits as long as the other process is alive
+    void SetTimeout(double seconds);
+
+    // partner side: sends a request and returns the values of the reply,
+    // throws the message of the solver if the request failed
+    void Request(int command, double dt, const cvDoubleVec& inputs, cvDoubleVec& outputs);
+
+    // solver side: waits for the next request, returns its command
+    int WaitRequest(double& dt, cvDoubleVec& inputs);
+    void Reply(const cvDoubleVec& outputs);
+    void ReplyError(const string& message);
+
+  private:
+
+    cvOneDCouplingChannel(const string& name, cvOneDCouplingBlock* block, bool owner);
+    cvOneDCouplingChannel(const cvOneDCouplingChannel&);
+    cvOneDCouplingChannel& operator=(const cvOneDCouplingChannel&);
+
+    // the other side, for the messages
+    string PeerName() const;
+    // locks the block, throws if the other process died holding it
+    void Lock();
+    // waits with the lock held until counter reaches count, throws with
+    // the lock released if the other process is gone or on timeout
+    void WaitFor(const long& counter, long count);
+
+    string name;
+    cvOneDCouplingBlock* block;
+    bool owner;
+    double timeout;
+};
+
+#endif // CVONEDCOUPLINGCHANNEL_H
@@ -0,0 +1,126 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDCouplingMatrix.cxx - Source for a List of Matrix Entries
+//  ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+
+# include <cassert>
+
+# include "cvOneDCouplingMatrix.h"
+
+cvOneDCouplingMatrix::cvOneDCouplingMatrix(long dim, const char* tit): cvOneDFEAMatrix(tit){
+  dimension = dim;
+}
+
+cvOneDCouplingMatrix::~cvOneDCouplingMatrix(){
+}
+
+void cvOneDCouplingMatrix::Add(cvOneDDenseMatrix& matrix){
+  long eDimension = matrix.GetDimension();
+  long* eqNumbers = matrix.GetEquationNumbers();
+  double* eEntries = matrix.GetPointerToEntries();
+  for(long i = 0; i < eDimension; i++){
+    for(long j = 0; j < eDimension; j++){
+      AddValue(eqNumbers[i], eqNumbers[j], eEntries[i * eDimension + j]);
+    }
+  }
+}
+
+void cvOneDCouplingMatrix::AddValue(long row, long column, double value){
+  assert(row >= 0 && row < dimension && column >= 0 && column < dimension);
+  rows.push_back(row);
+  columns.push_back(column);
+  values.push_back(value);
+}
+
+void cvOneDCouplingMatrix::Clear(){
+  rows.clear();
+  columns.clear();
+  values.clear();
+}
+
+void cvOneDCouplingMatrix::SetValue(long row, long column, double value){
+  for(long i = 0; i < values.size(); i++){
+    if(rows[i] == row && columns[i] == column){
+      values[i] = 0.0;
+    }
+  }
+  AddValue(row, column, value);
+}
+
+void cvOneDCouplingMatrix::Remove(bool byRow, long index){
+  long k = 0;
+  for(long i = 0; i < values.size(); i++){
+    if((byRow ? rows[i] : columns[i]) != index){
+      rows[k] = rows[i];
+      columns[k] = columns[i];
+      values[k] = values[i];
+      k++;
+    }
+  }
+  rows.resize(k);
+  columns.resize(k);
+  values.resize(k);
+}
+
+void cvOneDCouplingMatrix::ClearRow(long row){
+  Remove(true, row);
+}
+
+void cvOneDCouplingMatrix::ClearColumn(long column){
+  Remove(false, column);
+}
+
+void cvOneDCouplingMatrix::SetBoundaryEquations(long numEqs, const long* eqs){
+}
+
+double cvOneDCouplingMatrix::GetValue(long row, long column){
+  double res = 0.0;
+  for(long i = 0; i < values.size(); i++){
+    if(rows[i] == row && columns[i] == column){
+      res += values[i];
+    }
+  }
+  return res;
+}
+
+long cvOneDCouplingMatrix::GetDimension() const{
+  return dimension;
+}
+
+void cvOneDCouplingMatrix::print(std::ostream &os){
+  os << title << " entries: " << values.size() << endl;
+  for(long i = 0; i < values.size(); i++){
+    os << rows[i] << " " << columns[i] << " " << values[i] << endl;
+  }
+}
@@ -0,0 +1,88 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDCOUPLINGMATRIX_H
+#define CVONEDCOUPLINGMATRIX_H
+
+//
+//  cvOneDCouplingMatrix.h - Header for a List of Matrix Entries
+//  ~~~~~~~~~~~~~~~~~~~~~~
+//
+//  Collects the few entries the joints add to the tangent, in the order
+//  they were assembled and with repeated positions kept, so that they can
+//  be handled outside of a matrix with a fixed profile.
+//
+
+# include <iostream>
+# include <vector>
+
+# include "cvOneDDenseMatrix.h"
+# include "cvOneDFEAMatrix.h"
+
+using namespace std;
+
+class cvOneDCouplingMatrix: public cvOneDFEAMatrix{
+
+  public:
+
+    cvOneDCouplingMatrix( long dim, const char* tit = "matrix");
+    virtual ~cvOneDCouplingMatrix();
+
+    long GetNumberOfEntries() const {return (long)values.size();}
+    long GetRow( long entry) const {return rows[entry];}
+    long GetColumn( long entry) const {return columns[entry];}
+    double GetEntry( long entry) const {return values[entry];}
+
+    // VIRTUAL FUNCTIONS
+    virtual void Add(cvOneDDenseMatrix& matrix);
+    virtual void AddValue( long row, long column, double value);
+    virtual void Clear();
+    virtual void SetValue(long row, long column, double value);
+    virtual void ClearRow(long row);
+    virtual void ClearColumn(long column);
+    // nothing to precompute for a list of entries
+    virtual void SetBoundaryEquations(long numEqs, const long* eqs);
+    virtual double GetValue(long row, long column);
+    virtual long GetDimension() const;
+    // print matrix
+    virtual void print(std::ostream &os);
+
+  private:
+
+    void Remove( bool byRow, long index);
+
+    long dimension;
+    vector<long> rows;
+    vector<long> columns;
+    vector<double> values;
+};
+
+#endif // CVONEDCOUPLINGMATRIX_H
@@ -0,0 +1,335 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDDistributedLinearSolver.cxx - Source for a Distributed Schur Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  With K the local blocks, J12 and J21 the joint entries in the
+//  multiplier columns and rows and J22 the remainder, the multipliers
+//  solve S*y2 = x2 - sum(J21*K^-1*x1) and the segments K*y1 = x1 - J12*y2,
+//  S = J22 - sum(J21*K^-1*J12) being summed over the processes.
+//
+
+# ifdef USE_MPI
+
+# include <mpi.h>
+# include <cmath>
+# include <cstring>
+
+# include "cvOneDDistributedLinearSolver.h"
+# include "cvOneDException.h"
+
+cvOneDDistributedLinearSolver::cvOneDDistributedLinearSolver(long dim, long firstLagEq,
+                                                             const vector<bool>& localEqs){
+  dimension = dim;
+  firstLagrangeEquation = firstLagEq;
+  numberOfMultipliers = dimension - firstLagrangeEquation;
+  localEquations = localEqs;
+  coupling = new cvOneDCouplingMatrix(dimension, "couplingMatrix");
+  schur = NULL;
+  work = new double[dimension];
+  blockSolution = new double[dimension];
+}
+
+cvOneDDistributedLinearSolver::~cvOneDDistributedLinearSolver(){
+  delete coupling;
+  delete schur;
+  delete [] work;
+  delete [] blockSolution;
+}
+
+void cvOneDDistributedLinearSolver::SetLHS(cvOneDFEAMatrix* matrix){
+  lhsMatrix = matrix;
+  blockSolver.SetLHS(matrix);
+}
+
+void cvOneDDistributedLinearSolver::SetRHS(cvOneDFEAVector *vector){
+  rhsVector = vector;
+  blockSolver.SetRHS(vector);
+}
+
+cvOneDFEAMatrix* cvOneDDistributedLinearSolver::GetLHS(){
+  return lhsMatrix;
+}
+
+cvOneDFEAVector* cvOneDDistributedLinearSolver::GetRHS(){
+  return rhsVector;
+}
+
+cvOneDFEAMatrix* cvOneDDistributedLinearSolver::GetCouplingMatrix(){
+  return coupling;
+}
+
+void cvOneDDistributedLinearSolver::SetSolution(long equation, double value){
+  if(localEquations[equation]){
+    blockSolver.SetSolution(equation, value);
+  }
+}
+
+void cvOneDDistributedLinearSolver::Minus1dof(long rbEqnNo, double k_m){
+  if(localEquations[rbEqnNo]){
+    blockSolver.Minus1dof(rbEqnNo, k_m);
+  }
+}
+
+void cvOneDDistributedLinearSolver::DirectAppResistanceBC(long rbEqnNo, double resistance, double dpds, double rhs){
+  if(localEquations[rbEqnNo]){
+    blockSolver.DirectAppResistanceBC(rbEqnNo, resistance, dpds, rhs);
+  }
+}
+
+void cvOneDDistributedLinearSolver::AddFlux(long rbEqnNo, double* OutletLHS11, double* OutletRHS1){
+  if(localEquations[rbEqnNo]){
+    blockSolver.AddFlux(rbEqnNo, OutletLHS11, OutletRHS1);
+  }
+}
+
+void cvOneDDistributedLinearSolver::SumOverRanks(const double* local, double* total, int count){
+  int ranks;
+  MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+  vector<double> all((long)ranks*count);
+  MPI_Allgather(local, count, MPI_DOUBLE, &all[0], count, MPI_DOUBLE, MPI_COMM_WORLD);
+  for(int k = 0; k < count; k++){
+    total[k] = 0.0;
+    for(int r = 0; r < ranks; r++){
+      total[k] += all[(long)r*count + k];
+    }
+  }
+}
+
+double cvOneDDistributedLinearSolver::Norm(const cvOneDFEAVector& vector, int start){
+  double local = 0.0;
+  for(long i = start; i < firstLagrangeEquation; i += 2){
+    if(localEquations[i]){
+      local += vector.Get(i)*vector.Get(i);
+    }
+  }
+  double total;
+  SumOverRanks(&local, &total, 1);
+  return sqrt(total);
+}
+
+void cvOneDDistributedLinearSolver::Factor(){
+  long i, j, k, p;
+  long L = firstLagrangeEquation;
+  long m = numberOfMultipliers;
+  cvOneDSkylineMatrix* blocks = (cvOneDSkylineMatrix*)lhsMatrix;
+  double* KD = blocks->GetDiagonalEntries();
+
+  // the segments of the other processes and the multipliers are
+  // left out of the local blocks
+  for(i = 0; i < dimension; i++){
+    if(i >= L || !localEquations[i]){
+      KD[i] = 1.0;
+    }
+  }
+
+  // sort the joint entries, the ones on segment unknowns only act on
+  // the diagonal of the blocks
+  multiplierColumnStart.assign(m + 1, 0);
+  multiplierRowStart.assign(m + 1, 0);
+  vector<long> schurRow, schurColumn;
+  vector<double> schurValue;
+  long nent = coupling->GetNumberOfEntries();
+  for(p = 0; p < nent; p++){
+    i = coupling->GetRow(p);
+    j = coupling->GetColumn(p);
+    if(i < L && j < L){
+      if(i == j && localEquations[i]){
+        KD[i] += coupling->GetEntry(p);
+      }
+    }else if(i < L){
+      if(localEquations[i]){
+        multiplierColumnStart[j - L + 1]++;
+      }
+    }else if(j < L){
+      if(localEquations[j]){
+        multiplierRowStart[i - L + 1]++;
+      }
+    }else{
+      schurRow.push_back(i - L);
+      schurColumn.push_back(j - L);
+      schurValue.push_back(coupling->GetEntry(p));
+    }
+  }
+  for(k = 0; k < m; k++){
+    multiplierColumnStart[k+1] += multiplierColumnStart[k];
+    multiplierRowStart[k+1] += multiplierRowStart[k];
+  }
+  multiplierColumnRow.resize(multiplierColumnStart[m]);
+  multiplierColumnValue.resize(multiplierColumnStart[m]);
+  multiplierRowColumn.resize(multiplierRowStart[m]);
+  multiplierRowValue.resize(multiplierRowStart[m]);
+  vector<long> columnFill(multiplierColumnStart.begin(), multiplierColumnStart.end() - 1);
+  vector<long> rowFill(multiplierRowStart.begin(), multiplierRowStart.end() - 1);
+  for(p = 0; p < nent; p++){
+    i = coupling->GetRow(p);
+    j = coupling->GetColumn(p);
+    if(i < L && j >= L && localEquations[i]){
+      multiplierColumnRow[columnFill[j - L]] = i;
+      multiplierColumnValue[columnFill[j - L]++] = coupling->GetEntry(p);
+    }else if(i >= L && j < L && localEquations[j]){
+      multiplierRowColumn[rowFill[i - L]] = j;
+      multiplierRowValue[rowFill[i - L]++] = coupling->GetEntry(p);
+    }
+  }
+
+  if(cvOneDSkylineLinearSolver::Factor(blocks) == 0){
+    throw cvException("ERROR: Singular segment block in the distributed solver.\n");
+  }
+
+  delete schur;
+  schur = NULL;
+  if(m == 0){
+    return;
+  }
+
+  // local columns of sum(J21*K^-1*J12), only the multipliers of the
+  // joints touching a local segment give entries
+  vector<long> localRow, localColumn;
+  vector<double> localValue;
+  for(j = 0; j < m; j++){
+    if(multiplierColumnStart[j+1] == multiplierColumnStart[j]){
+      continue;
+    }
+    memset(work, 0, dimension*sizeof(double));
+    for(p = multiplierColumnStart[j]; p < multiplierColumnStart[j+1]; p++){
+      work[multiplierColumnRow[p]] += multiplierColumnValue[p];
+    }
+    cvOneDSkylineLinearSolver::SolveFactored(blocks, work, blockSolution);
+    for(k = 0; k < m; k++){
+      double sum = 0.0;
+      for(p = multiplierRowStart[k]; p < multiplierRowStart[k+1]; p++){
+        sum += multiplierRowValue[p]*blockSolution[multiplierRowColumn[p]];
+      }
+      if(sum != 0.0){
+        localRow.push_back(k);
+        localColumn.push_back(j);
+        localValue.push_back(-sum);
+      }
+    }
+  }
+
+  // every process gets the entries of all of them, in the order of
+  // their ranks
+  int ranks;
+  MPI_Comm_size(MPI_COMM_WORLD, &ranks);
+  int count = (int)localValue.size();
+  vector<int> counts(ranks), offsets(ranks, 0);
+  MPI_Allgather(&count, 1, MPI_INT, &counts[0], 1, MPI_INT, MPI_COMM_WORLD);
+  for(int r = 1; r < ranks; r++){
+    offsets[r] = offsets[r-1] + counts[r-1];
+  }
+  long total = offsets[ranks-1] + counts[ranks-1];
+  long first = schurValue.size();
+  schurRow.resize(first + total);
+  schurColumn.resize(first + total);
+  schurValue.resize(first + total);
+  MPI_Allgatherv(localRow.data(), count, MPI_LONG, &schurRow[first], &counts[0], &offsets[0], MPI_LONG, MPI_COMM_WORLD);
+  MPI_Allgatherv(localColumn.data(), count, MPI_LONG, &schurColumn[first], &counts[0], &offsets[0], MPI_LONG, MPI_COMM_WORLD);
+  MPI_Allgatherv(localValue.data(), count, MPI_DOUBLE, &schurValue[first], &counts[0], &offsets[0], MPI_DOUBLE, MPI_COMM_WORLD);
+
+  // skyline profile of S
+  vector<long> pos(m + 1, 0);
+  for(p = 0; p < schurValue.size(); p++){
+    i = schurRow[p];
+    j = schurColumn[p];
+    k = (i > j) ? i : j;
+    pos[k + 1] = max(pos[k + 1], labs(i - j));
+  }
+  for(k = 0; k < m; k++){
+    pos[k+1] += pos[k];
+  }
+  schur = new cvOneDSkylineMatrix(m, &pos[0], "schurMatrix");
+  schur->Clear();
+  for(p = 0; p < schurValue.size(); p++){
+    schur->AddValue(schurRow[p], schurColumn[p], schurValue[p]);
+  }
+  if(cvOneDSkylineLinearSolver::Factor(schur) == 0){
+    throw cvException("ERROR: Singular joint coupling in the distributed solver.\n");
+  }
+}
+
+void cvOneDDistributedLinearSolver::Solve(cvOneDFEAVector& sol){
+  long i, k, p;
+  long L = firstLagrangeEquation;
+  long m = numberOfMultipliers;
+  cvOneDSkylineMatrix* blocks = (cvOneDSkylineMatrix*)lhsMatrix;
+  const double* x = rhsVector->GetEntries();
+  double* y = sol.GetEntries();
+
+  Factor();
+
+  vector<double> schurSolution(m, 0.0);
+  if(schur != NULL){
+    // S*y2 = x2 - sum(J21*K^-1*x1)
+    for(i = 0; i < dimension; i++){
+      work[i] = (i < L && localEquations[i]) ? x[i] : 0.0;
+    }
+    cvOneDSkylineLinearSolver::SolveFactored(blocks, work, blockSolution);
+    vector<double> localRhs(m), schurRhs(m);
+    for(k = 0; k < m; k++){
+      double sum = 0.0;
+      for(p = multiplierRowStart[k]; p < multiplierRowStart[k+1]; p++){
+        sum -= multiplierRowValue[p]*blockSolution[multiplierRowColumn[p]];
+      }
+      localRhs[k] = sum;
+    }
+    SumOverRanks(&localRhs[0], &schurRhs[0], (int)m);
+    for(k = 0; k < m; k++){
+      schurRhs[k] += x[L + k];
+    }
+    cvOneDSkylineLinearSolver::SolveFactored(schur, &schurRhs[0], &schurSolution[0]);
+  }
+
+  // K*y1 = x1 - J12*y2 on the local segments
+  for(i = 0; i < dimension; i++){
+    work[i] = (i < L && localEquations[i]) ? x[i] : 0.0;
+  }
+  for(k = 0; k < m; k++){
+    for(p = multiplierColumnStart[k]; p < multiplierColumnStart[k+1]; p++){
+      work[multiplierColumnRow[p]] -= multiplierColumnValue[p]*schurSolution[k];
+    }
+  }
+  cvOneDSkylineLinearSolver::SolveFactored(blocks, work, blockSolution);
+
+  // each segment equation comes from a single process
+  for(i = 0; i < L; i++){
+    y[i] = localEquations[i] ? blockSolution[i] : 0.0;
+  }
+  MPI_Allreduce(MPI_IN_PLACE, y, (int)L, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+  for(k = 0; k < m; k++){
+    y[L + k] = schurSolution[k];
+  }
+}
+
+# endif // USE_MPI
@@ -0,0 +1,124 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDDISTRIBUTEDLINEARSOLVER_H
+#define CVONEDDISTRIBUTEDLINEARSOLVER_H
+
+//
+//  cvOneDDistributedLinearSolver.h - Header for a Distributed Schur Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The segments of the network are shared among the MPI processes. Every
+//  process assembles and factors the blocks of its own segments in a
+//  skyline matrix, without the joint coupling. The joint multipliers are
+//  the interface unknowns: their Schur complement is summed from the
+//  contributions of all the processes and solved by each of them, then
+//  the segments are solved locally and the corrections are exchanged, so
+//  that every process keeps the whole solution vector.
+//
+
+# ifdef USE_MPI
+
+# include <vector>
+
+# include "cvOneDLinearSolver.h"
+# include "cvOneDSkylineLinearSolver.h"
+# include "cvOneDSkylineMatrix.h"
+# include "cvOneDCouplingMatrix.h"
+# include "cvOneDFEAVector.h"
+
+using namespace std;
+
+class cvOneDDistributedLinearSolver: public cvOneDLinearSolver{
+
+  public:
+
+    // the LHS set on this solver holds the blocks of the local segments,
+    // equations from firstLagrangeEquation on are the joint multipliers
+    // and localEquations flags the segment equations of this process
+    cvOneDDistributedLinearSolver(long dim, long firstLagrangeEquation,
+                                  const vector<bool>& localEquations);
+    virtual ~cvOneDDistributedLinearSolver();
+
+    // the joints assemble their entries here, cleared at every assembly
+    cvOneDFEAMatrix* GetCouplingMatrix();
+    // L2 norm of every second entry of the local segment equations from
+    // start, over all the processes
+    double Norm( const cvOneDFEAVector& vector, int start);
+
+    virtual void SetLHS( cvOneDFEAMatrix* matrix);
+    virtual void SetRHS( cvOneDFEAVector* vector);
+
+    // the blocks are overwritten with their LU decomposition, solution
+    // gets the whole correction on every process
+    virtual void Solve( cvOneDFEAVector& solution);
+
+    virtual cvOneDFEAMatrix* GetLHS();
+    virtual cvOneDFEAVector* GetRHS();
+    // the boundary conditions act on the equations of this process only
+    virtual void SetSolution( long equation, double value);
+    virtual void Minus1dof( long rightBottomEquationNumber, double k_m);
+    virtual void DirectAppResistanceBC( long rbEqnNo, double resistance, double dpds, double rhs);
+    virtual void AddFlux( long rbEqnNo, double* OutletLHS11, double* OutletRHS1);
+
+  private:
+
+    // sums count values over the processes in the order of their ranks,
+    // so that every process gets the same bits
+    void SumOverRanks( const double* local, double* total, int count);
+    // factors the local blocks and the Schur complement of the joints
+    void Factor();
+
+    long dimension;
+    long firstLagrangeEquation;
+    long numberOfMultipliers;
+    vector<bool> localEquations;
+    cvOneDSkylineLinearSolver blockSolver;
+    cvOneDCouplingMatrix* coupling;
+
+    // joint entries in the multiplier columns (J12, by column) and rows
+    // (J21, by row) on local segment equations, and the factored
+    // J22 - sum over the processes of J21*blocks^-1*J12
+    vector<long> multiplierColumnStart;
+    vector<long> multiplierColumnRow;
+    vector<double> multiplierColumnValue;
+    vector<long> multiplierRowStart;
+    vector<long> multiplierRowColumn;
+    vector<double> multiplierRowValue;
+    cvOneDSkylineMatrix* schur;
+
+    double* work;
+    double* blockSolution;
+};
+
+# endif // USE_MPI
+
+#endif // CVONEDDISTRIBUTEDLINEARSOLVER_H
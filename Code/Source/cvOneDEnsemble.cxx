@@ -0,0 +1,423 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDEnsemble.cxx - Source for Parameter Sweeps in one Process
+//  ~~~~~~~~~~~~~~~~~~
+//
+//  Each thread starts with a contiguous block of batches and, once it is
+//  done, takes the last batches of the other blocks, so that members
+//  with slow solves do not leave threads idle. Without lanes a batch is
+//  a single member.
+//
+
+# include <stdio.h>
+# include <deque>
+# include <fstream>
+# include <mutex>
+# include <thread>
+# include <nlohmann/json.hpp>
+
+# include "cvOneDEnsemble.h"
+# include "cvOneDContext.h"
+# include "cvOneDBFSolver.h"
+# include "cvOneDSkylineBatchSolver.h"
+# include "cvOneDGlobal.h"
+# include "cvOneDUtility.h"
+# include "cvOneDSolverDefinitions.h"
+# include "cvOneDException.h"
+
+namespace{
+
+// Batches waiting on one thread, its owner takes them from the front
+// and the other threads from the back
+struct cvOneDWorkQueue{
+  mutex lock;
+  deque<long> batches;
+};
+
+bool TakeBatch(vector<cvOneDWorkQueue>& queues, size_t worker, long& batch){
+  {
+    lock_guard<mutex> guard(queues[worker].lock);
+    if(!queues[worker].batches.empty()){
+      batch = queues[worker].batches.front();
+      queues[worker].batches.pop_front();
+      return true;
+    }
+  }
+  for(size_t i = 1; i < queues.size(); i++){
+    cvOneDWorkQueue& other = queues[(worker + i) % queues.size()];
+    lock_guard<mutex> guard(other.lock);
+    if(!other.batches.empty()){
+      batch = other.batches.back();
+      other.batches.pop_back();
+      return true;
+    }
+  }
+  return false;
+}
+
+} // namespace
+
+cvOneDEnsemble::cvOneDEnsemble(const cvOneD::options& opts){
+  base = opts;
+}
+
+void cvOneDEnsemble::ReadSweep(const string& fileName){
+  ifstream file(fileName.c_str());
+  if(!file){
+    throw cvException(("ERROR: Cannot open ensemble file " + fileName + ".\n").c_str());
+  }
+  try{
+    nlohmann::json sweep = nlohmann::json::parse(file);
+    if(sweep.contains("threads")){
+      SetThreads(sweep.at("threads").get<int>());
+    }
+    if(sweep.contains("lanes")){
+      SetLanes(sweep.at("lanes").get<int>());
+    }
+    for(const auto& entry : sweep.at("parameters")){
+      cvOneDEnsembleParameter param;
+      param.type = entry.at("type").get<string>();
+      param.name = entry.at("name").get<string>();
+      if(entry.contains("property")){
+        param.property = entry.at("property").get<string>();
+      }
+      if(entry.contains("index")){
+        param.index = entry.at("index").get<long>();
+      }
+      if(entry.contains("values")){
+        param.values = entry.at("values").get<cvDoubleVec>();
+      }else if(entry.contains("min")){
+        // evenly spaced values including both ends
+        double minValue = entry.at("min").get<double>();
+        double maxValue = entry.at("max").get<double>();
+        long count = entry.at("count").get<long>();
+        for(long i = 0; i < count; i++){
+          param.values.push_back(count > 1 ? minValue + (maxValue - minValue)*i/(count - 1) : minValue);
+        }
+      }
+      AddParameter(param);
+    }
+    if(sweep.contains("samples")){
+      for(const auto& sample : sweep.at("samples")){
+        AddSample(sample.get<cvDoubleVec>());
+      }
+    }
+  }catch(const nlohmann::json::exception& e){
+    throw cvException(("ERROR: Invalid ensemble file " + fileName + ": " + e.what() + "\n").c_str());
+  }
+}
+
+void cvOneDEnsemble::AddParameter(const cvOneDEnsembleParameter& param){
+  cvOneD::options check = base;
+  ApplyParameter(check, param, 0.0);
+  parameters.push_back(param);
+}
+
+void cvOneDEnsemble::AddSample(const cvDoubleVec& values){
+  samples.push_back(values);
+}
+
+void cvOneDEnsemble::SetThreads(int count){
+  if(count < 0){
+    throw cvException("ERROR: Invalid number of ensemble threads.\n");
+  }
+  threads = count;
+}
+
+void cvOneDEnsemble::SetLanes(int count){
+  if(count < 1){
+    throw cvException("ERROR: Invalid number of ensemble lanes.\n");
+  }
+  lanes = count;
+}
+
+long cvOneDEnsemble::GetNumberOfMembers() const{
+  if(!samples.empty()){
+    return samples.size();
+  }
+  if(parameters.empty()){
+    return 0;
+  }
+  long members = 1;
+  for(size_t i = 0; i < parameters.size(); i++){
+    members *= parameters[i].values.size();
+  }
+  return members;
+}
+
+// The last parameter varies fastest on the grid
+void cvOneDEnsemble::MemberValues(long member, cvDoubleVec& values) const{
+  if(!samples.empty()){
+    values = samples[member];
+    return;
+  }
+  values.resize(parameters.size());
+  for(long i = parameters.size() - 1; i >= 0; i--){
+    long count = parameters[i].values.size();
+    values[i] = parameters[i].values[member % count];
+    member /= count;
+  }
+}
+
+cvOneD::options cvOneDEnsemble::GetMemberOptions(long member) const{
+  cvDoubleVec values;
+  MemberValues(member, values);
+  cvOneD::options opts = base;
+  // the results are read from the solver, not from files
+  opts.outputType = "NONE";
+  for(size_t i = 0; i < parameters.size(); i++){
+    ApplyParameter(opts, parameters[i], values[i]);
+  }
+  return opts;
+}
+
+void cvOneDEnsemble::ApplyParameter(cvOneD::options& opts, const cvOneDEnsembleParameter& param, double value){
+  string type = upper_string(param.type);
+  string property = upper_string(param.property);
+  if(type == "SEGMENT"){
+    int id = getListIDWithStringKey(upper_string(param.name), opts.segmentName);
+    if(id < 0){
+      throw cvException(("ERROR: Cannot find ensemble segment " + param.name + ".\n").c_str());
+    }
+    if(property == "LENGTH"){
+      opts.segmentLength[id] = value;
+    }else if(property == "INLETAREA"){
+      opts.segmentInInletArea[id] = value;
+    }else if(property == "OUTLETAREA"){
+      opts.segmentInOutletArea[id] = value;
+    }else if(property == "FLOW"){
+      opts.segmentInFlow[id] = value;
+    }else if(property == "BRANCHANGLE"){
+      opts.segmentBranchAngle[id] = value;
+    }else{
+      throw cvException(("ERROR: Invalid ensemble segment property " + param.property + ".\n").c_str());
+    }
+  }else if(type == "MATERIAL"){
+    int id = getListIDWithStringKey(upper_string(param.name), opts.materialName);
+    if(id < 0){
+      throw cvException(("ERROR: Cannot find ensemble material " + param.name + ".\n").c_str());
+    }
+    if(property == "DENSITY"){
+      opts.materialDensity[id] = value;
+    }else if(property == "VISCOSITY"){
+      opts.materialViscosity[id] = value;
+    }else if(property == "PREF"){
+      opts.materialPRef[id] = value;
+    }else if(property == "EXPONENT"){
+      opts.materialExponent[id] = value;
+    }else if(property == "PARAM1"){
+      opts.materialParam1[id] = value;
+    }else if(property == "PARAM2"){
+      opts.materialParam2[id] = value;
+    }else if(property == "PARAM3"){
+      opts.materialParam3[id] = value;
+    }else{
+      throw cvException(("ERROR: Invalid ensemble material property " + param.property + ".\n").c_str());
+    }
+  }else if(type == "DATATABLE"){
+    int id = getListIDWithStringKey(upper_string(param.name), opts.dataTableName);
+    if(id < 0){
+      throw cvException(("ERROR: Cannot find ensemble data table " + param.name + ".\n").c_str());
+    }
+    if(param.index < 0 || param.index >= (long)opts.dataTableVals[id].size()){
+      throw cvException(("ERROR: Invalid ensemble index of data table " + param.name + ".\n").c_str());
+    }
+    opts.dataTableVals[id][param.index] = value;
+  }else{
+    throw cvException(("ERROR: Invalid ensemble parameter type " + param.type + ".\n").c_str());
+  }
+}
+
+void cvOneDEnsemble::Run(const MemberSolver& solveMember, const string& fileName){
+  long members = GetNumberOfMembers();
+  if(members == 0){
+    throw cvException("ERROR: The ensemble has no members.\n");
+  }
+  for(size_t i = 0; i < samples.size(); i++){
+    if(samples[i].size() != parameters.size()){
+      throw cvException(("ERROR: Ensemble sample " + to_string(i) + " needs one value per parameter.\n").c_str());
+    }
+  }
+  if(cvOneDGlobal::numberOfRanks > 1){
+    throw cvException("ERROR: An ensemble runs in a single process.\n");
+  }
+
+  // every batch runs one thread per lane, so the pool has one worker per
+  // lanes threads
+  long batches = (members + lanes - 1) / lanes;
+  size_t count = threads > 0 ? threads : thread::hardware_concurrency();
+  count = max((size_t)1, min(count / lanes, (size_t)batches));
+  results.assign(members, cvOneDEnsembleResult());
+
+  vector<cvOneDWorkQueue> queues(count);
+  for(long b = 0; b < batches; b++){
+    queues[b*count/batches].batches.push_back(b);
+  }
+
+  printf("Solving %ld Ensemble Members in %ld Batches of %d Lanes on %zu Workers ...\n", members, batches, lanes, count);
+  {
+    vector<thread> workers;
+    for(size_t w = 0; w < count; w++){
+      workers.push_back(thread([&, w](){
+        long batch;
+        while(TakeBatch(queues, w, batch)){
+          RunBatch(solveMember, batch);
+        }
+      }));
+    }
+    for(size_t w = 0; w < count; w++){
+      workers[w].join();
+    }
+  }
+
+  long failed = 0;
+  for(long m = 0; m < members; m++){
+    if(!results[m].solved){
+      printf("Ensemble Member %ld Failed: %s\n", m, results[m].message.c_str());
+      failed++;
+    }
+  }
+  printf("Ensemble Members Solved: %ld of %ld\n", members - failed, members);
+
+  WriteResults(fileName);
+  printf("Ensemble Results Written to %s\n", fileName.c_str());
+}
+
+// The members of a batch run in lock-step, one thread per lane
+void cvOneDEnsemble::RunBatch(const MemberSolver& solveMember, long batch){
+  long first = batch * lanes;
+  int width = min((long)lanes, (long)results.size() - first);
+  if(width == 1){
+    RunMember(solveMember, first, NULL, 0);
+    return;
+  }
+  cvOneDSkylineBatchSolver laneBatch(width);
+  vector<thread> laneThreads;
+  for(int l = 0; l < width; l++){
+    laneThreads.push_back(thread([&, l](){
+      RunMember(solveMember, first + l, &laneBatch, l);
+    }));
+  }
+  for(int l = 0; l < width; l++){
+    laneThreads[l].join();
+  }
+}
+
+void cvOneDEnsemble::RunMember(const MemberSolver& solveMember, long member,
+                               cvOneDSkylineBatchSolver* laneBatch, int lane){
+  cvOneDEnsembleResult& result = results[member];
+  try{
+    cvOneD::options opts = GetMemberOptions(member);
+    // the members report their iterations as a single run does, which
+    // the threads would interleave
+    cvOneDContext context;
+    context.quiet = !cvOneDGlobal::debugMode;
+    cvOneDContext::Scope scope(&context);
+    if(laneBatch != NULL){
+      context.solver->SetLaneBatch(laneBatch, lane);
+    }
+    solveMember(opts);
+
+    cvOneDBFSolver* solver = context.solver;
+    cvOneDModel* model = solver->GetModelPtr();
+    if(model == NULL){
+      throw cvException("ERROR: The ensemble member did not solve a model.\n");
+    }
+    long segments = model->getNumberOfSegments();
+    result.segmentName.resize(segments);
+    result.inletFlow.resize(segments);
+    result.outletFlow.resize(segments);
+    result.inletPressure.resize(segments);
+    result.outletPressure.resize(segments);
+    for(long s = 0; s < segments; s++){
+      result.segmentName[s] = model->getSegment(s)->getSegmentName();
+      solver->GetSegmentEnds(s, result.inletFlow[s], result.outletFlow[s],
+                             result.inletPressure[s], result.outletPressure[s]);
+    }
+    result.solved = true;
+  }catch(exception& e){
+    result.message = e.what();
+    // the messages of the solver end with a new line
+    while(!result.message.empty() && result.message.back() == '\n'){
+      result.message.pop_back();
+    }
+  }
+  // the other lanes no longer wait for this member
+  if(laneBatch != NULL){
+    laneBatch->Leave(lane);
+  }
+}
+
+// One header line per member with its parameter values, followed by
+// one row per segment end and quantity with a value per saved step
+void cvOneDEnsemble::WriteResults(const string& fileName) const{
+  ofstream file(fileName.c_str());
+  if(!file){
+    throw cvException(("ERROR: Cannot write ensemble file " + fileName + ".\n").c_str());
+  }
+  file.precision(OUTPUT_PRECISION);
+  file << "# ENSEMBLE MEMBERS " << results.size() << " PARAMETERS " << parameters.size() << endl;
+  for(size_t i = 0; i < parameters.size(); i++){
+    file << "# PARAMETER " << i << " " << upper_string(parameters[i].type) << " " << parameters[i].name;
+    if(upper_string(parameters[i].type) == "DATATABLE"){
+      file << " " << parameters[i].index << endl;
+    }else{
+      file << " " << parameters[i].property << endl;
+    }
+  }
+  const char* quantities[4] = {"INLET_FLOW", "OUTLET_FLOW", "INLET_PRESSURE", "OUTLET_PRESSURE"};
+  cvDoubleVec values;
+  for(size_t m = 0; m < results.size(); m++){
+    const cvOneDEnsembleResult& result = results[m];
+    MemberValues(m, values);
+    file << "# MEMBER " << m << (result.solved ? " SOLVED" : " FAILED");
+    for(size_t i = 0; i < values.size(); i++){
+      file << " " << values[i];
+    }
+    file << endl;
+    if(!result.solved){
+      continue;
+    }
+    for(size_t s = 0; s < result.segmentName.size(); s++){
+      const cvDoubleVec* rows[4] = {&result.inletFlow[s], &result.outletFlow[s],
+                                    &result.inletPressure[s], &result.outletPressure[s]};
+      for(int q = 0; q < 4; q++){
+        file << result.segmentName[s] << " " << quantities[q];
+        for(size_t i = 0; i < rows[q]->size(); i++){
+          file << " " << (*rows[q])[i];
+        }
+        file << endl;
+      }
+    }
+  }
+}
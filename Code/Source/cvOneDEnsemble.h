@@ -0,0 +1,129 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDENSEMBLE_H
+#define CVONEDENSEMBLE_H
+
+//
+//  cvOneDEnsemble.h - Header for Parameter Sweeps in one Process
+//  ~~~~~~~~~~~~~~~~
+//
+//  The members of an ensemble are the base options with some segment,
+//  material or data table values replaced, either on the grid of the
+//  values given for each parameter or from a list of samples. They are
+//  solved on a pool of threads, each in its own context, and the flow
+//  rates and pressures at the ends of the segments of all members are
+//  written to a single file. With lanes, consecutive members are solved
+//  in lock-step and their Newton systems decomposed together.
+//
+
+# include <functional>
+# include <string>
+# include <vector>
+
+# include "cvOneDOptions.h"
+
+using namespace std;
+
+class cvOneDSkylineBatchSolver;
+
+struct cvOneDEnsembleParameter{
+  // SEGMENT, MATERIAL or DATATABLE
+  string type;
+  // segment, material or data table name
+  string name;
+  // key of the segment or material in the JSON input, e.g. inletArea
+  // or param1, unused for data tables
+  string property;
+  // entry of the data table values
+  long index = 0;
+  // values of the grid, unused with samples
+  cvDoubleVec values;
+};
+
+struct cvOneDEnsembleResult{
+  bool solved = false;
+  string message;
+  // one entry per segment, one value per saved step
+  cvStringVec segmentName;
+  cvDoubleMat inletFlow;
+  cvDoubleMat outletFlow;
+  cvDoubleMat inletPressure;
+  cvDoubleMat outletPressure;
+};
+
+class cvOneDEnsemble{
+
+  public:
+
+    // creates and solves the model of a member in the context bound to
+    // the calling thread
+    typedef std::function<void(const cvOneD::options&)> MemberSolver;
+
+    cvOneDEnsemble(const cvOneD::options& base);
+
+    // reads the parameters, samples and threads from a JSON file
+    void ReadSweep(const string& fileName);
+
+    // throws if the base options have no such entry
+    void AddParameter(const cvOneDEnsembleParameter& param);
+    // one value per parameter, replaces the grid
+    void AddSample(const cvDoubleVec& values);
+    // threads in all, zero for one per core, a batch takes one per lane
+    void SetThreads(int count);
+    // members solved in lock-step in a batch, one for independent members
+    void SetLanes(int count);
+
+    long GetNumberOfMembers() const;
+    cvOneD::options GetMemberOptions(long member) const;
+    const cvOneDEnsembleResult& GetResult(long member) const {return results[member];}
+
+    // solves all members, then writes the results to fileName
+    void Run(const MemberSolver& solveMember, const string& fileName);
+
+  private:
+
+    void MemberValues(long member, cvDoubleVec& values) const;
+    static void ApplyParameter(cvOneD::options& opts, const cvOneDEnsembleParameter& param, double value);
+    void RunBatch(const MemberSolver& solveMember, long batch);
+    void RunMember(const MemberSolver& solveMember, long member,
+                   cvOneDSkylineBatchSolver* laneBatch, int lane);
+    void WriteResults(const string& fileName) const;
+
+    cvOneD::options base;
+    vector<cvOneDEnsembleParameter> parameters;
+    cvDoubleMat samples;
+    int threads = 0;
+    int lanes = 1;
+    vector<cvOneDEnsembleResult> results;
+};
+
+#endif // CVONEDENSEMBLE_H
@@ -198,9 +198,70 @@ struct OutputTypeScope {
   enum OutputType {
     OUTPUT_TEXT = 0,
     OUTPUT_VTK  = 1,
-    OUTPUT_BOTH = 2
+    OUTPUT_BOTH = 2,
+    OUTPUT_NONE = 3, // results kept in memory, read by the ensemble runner
+    OUTPUT_BINARY = 4 // one indexed file, see cvOneDResultFile.h
   };
 };
 
+// Nonlinear Solver Type
+struct NonlinearSolverTypeScope {
+  enum NonlinearSolverType {
+    NEWTON          = 0, // assembled tangent, direct solve
+    JFNK            = 1, // matrix-free Newton-Krylov
+    MODIFIED_NEWTON = 2  // tangent frozen between refreshes, no Krylov iterations
+  };
+};
+typedef NonlinearSolverTypeScope::NonlinearSolverType NonlinearSolverType;
+
+// Initial Guess of the Newton Iterations
+struct PredictorTypeScope {
+  enum PredictorType {
+    NONE      = 0, // previous solution
+    LINEAR    = 1, // extrapolated from the last two steps
+    QUADRATIC = 2, // extrapolated from the last three steps
+    CYCLE     = 3  // previous solution plus its change one cycle earlier
+  };
+};
+typedef PredictorTypeScope::PredictorType PredictorType;
+
+// Time Discretization of the Segment Equations
+struct TimeIntegratorTypeScope {
+  enum TimeIntegratorType {
+    BACKWARD_EULER = 0, // first order
+    BDF2           = 1  // second order backward differences, variable step
+  };
+};
+typedef TimeIntegratorTypeScope::TimeIntegratorType TimeIntegratorType;
+
+// Solver Engine
+struct SolverEngineTypeScope {
+  enum SolverEngineType {
+    IMPLICIT_FEM = 0, // finite elements, Newton on every time step
+    EXPLICIT_FV  = 1  // finite volumes, Courant limited steps, no global system
+  };
+};
+typedef SolverEngineTypeScope::SolverEngineType SolverEngineType;
+
+// Steady State
+struct SteadyStateTypeScope {
+  enum SteadyStateType {
+    NONE              = 0, // start from the interpolated areas
+    INITIAL_CONDITION = 1, // start the time loop from the steady state
+    ONLY              = 2  // the steady state is the only result
+  };
+};
+typedef SteadyStateTypeScope::SteadyStateType SteadyStateType;
+
+// Waveform Relaxation
+struct WaveformRelaxationTypeScope {
+  enum WaveformRelaxationType {
+    NONE         = 0, // the whole network in a single system
+    JACOBI       = 1, // all subtrees from the last iterates at the cuts
+    GAUSS_SEIDEL = 2  // downstream subtrees from the new upstream pressures
+  };
+};
+typedef WaveformRelaxationTypeScope::WaveformRelaxationType WaveformRelaxationType;
+
 
 #endif // CVONEDENUMS_H
@@ -0,0 +1,539 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDExplicitEngine.cxx - Source for an Explicit Finite Volume Network Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The conservation form dU/dt + dF/dz = G with U = (S, Q),
+//  F = (Q, (1+delta)Q^2/S + IntegralpS/rho) and
+//  G = (-Outflow, N Q/S + IntegralpD2S/rho), as in the finite elements
+//  without the viscous flux. The boundary states are first order, the
+//  linearized characteristic relation at a segment end is
+//  Q_b - Q_c = lambda_in (S_b - S_c), with lambda_in the eigenvalue that
+//  enters the segment there.
+//
+
+# include <cmath>
+# include <cstring>
+# include <string>
+# include <algorithm>
+
+# include "cvOneDExplicitEngine.h"
+# include "cvOneDException.h"
+
+// Newton iterations for the joint and outlet pressures
+#define EXPLICIT_MAX_BOUNDARY_ITERATIONS 30
+#define EXPLICIT_BOUNDARY_TOLERANCE 1.0e-12
+
+namespace{
+
+double minmod(double a, double b){
+  if(a*b <= 0.0){
+    return 0.0;
+  }
+  return (fabs(a) < fabs(b)) ? a : b;
+}
+
+double materialProperty(cvOneDMaterial* material, const char* name){
+  char propName[256];
+  strcpy(propName, name);
+  return material->GetProperty(propName);
+}
+
+}
+
+cvOneDExplicitEngine::cvOneDExplicitEngine(const vector<cvOneDSubdomain*>& subdomains,
+                                           const vector<cvOneDFEAJoint*>& joints,
+                                           const vector<int>& outlets,
+                                           BoundCondType inlet,
+                                           const double* tableTime, const double* tableValue, long tablePoints){
+  if(inlet != BoundCondTypeScope::FLOW && inlet != BoundCondTypeScope::PRESSURE_WAVE){
+    throw cvException("ERROR: The explicit engine supports flow and pressure wave inlets only.\n");
+  }
+  inletType = inlet;
+  inletTime.assign(tableTime, tableTime + tablePoints);
+  inletValue.assign(tableValue, tableValue + tablePoints);
+
+  long total = 0;
+  for(size_t k = 0; k < subdomains.size(); k++){
+    cvOneDSubdomain* sub = subdomains[k];
+    if(sub->GetMinorLossType() != MinorLossScope::NONE){
+      throw cvException("ERROR: The explicit engine does not support minor losses.\n");
+    }
+    Segment seg;
+    seg.sub = sub;
+    seg.material = sub->GetMaterial();
+    seg.first = total;
+    seg.nodes = sub->GetNumberOfNodes();
+    seg.eqOffset = 2 * sub->GetGlobal1stNodeID();
+    seg.length = sub->GetLength();
+    seg.h = seg.length / (seg.nodes - 1);
+    seg.density = materialProperty(seg.material, "density");
+    seg.delta = materialProperty(seg.material, "delta");
+    seg.N = materialProperty(seg.material, "N");
+    seg.inS = seg.inQ = seg.outS = seg.outQ = 0.0;
+    segments.push_back(seg);
+    total += seg.nodes;
+  }
+
+  jointList = joints;
+  jointPressure.assign(joints.size(), 0.0);
+
+  for(size_t i = 0; i < outlets.size(); i++){
+    Outlet outlet;
+    outlet.segment = outlets[i];
+    outlet.type = subdomains[outlets[i]]->GetBoundCondition();
+    switch(outlet.type){
+      case BoundCondTypeScope::PRESSURE:
+      case BoundCondTypeScope::PRESSURE_WAVE:
+      case BoundCondTypeScope::FLOW:
+      case BoundCondTypeScope::RESISTANCE:
+      case BoundCondTypeScope::RESISTANCE_TIME:
+      case BoundCondTypeScope::RCR:
+      case BoundCondTypeScope::CORONARY:
+        break;
+      default:
+        throw cvException("ERROR: Outlet boundary condition not supported by the explicit engine.\n");
+    }
+    for(int j = 0; j < 2; j++){
+      outlet.y[j] = outlet.y0[j] = outlet.rate[j] = 0.0;
+    }
+    outletList.push_back(outlet);
+  }
+
+  S.assign(total, 0.0);
+  Q.assign(total, 0.0);
+  S0.assign(total, 0.0);
+  Q0.assign(total, 0.0);
+  dS.assign(total, 0.0);
+  dQ.assign(total, 0.0);
+
+  courantNumber = 0.8;
+  time = 0.0;
+  numberOfSteps = 0;
+}
+
+cvOneDExplicitEngine::~cvOneDExplicitEngine(){
+}
+
+void cvOneDExplicitEngine::SetCourantNumber(double courant){
+  courantNumber = courant;
+}
+
+void cvOneDExplicitEngine::SetSegmentNames(const vector<string>& names){
+  segmentNames = names;
+}
+
+// ===========
+// STATE
+// ===========
+
+void cvOneDExplicitEngine::SetState(const cvOneDFEAVector& solution, double startTime){
+  time = startTime;
+  for(size_t k = 0; k < segments.size(); k++){
+    const Segment& seg = segments[k];
+    for(long i = 0; i < seg.nodes; i++){
+      S[seg.first + i] = solution.Get(seg.eqOffset + 2*i);
+      Q[seg.first + i] = solution.Get(seg.eqOffset + 2*i + 1);
+    }
+  }
+
+  // Outlet models start from the state the implicit outlets assume at
+  // the reference pressure and the initial flow of the segment
+  for(size_t i = 0; i < outletList.size(); i++){
+    Outlet& outlet = outletList[i];
+    cvOneDSubdomain* sub = segments[outlet.segment].sub;
+    double p0 = segments[outlet.segment].material->GetReferencePressure();
+    double q0 = sub->GetInitialFlow();
+    if(outlet.type == BoundCondTypeScope::RCR){
+      outlet.y[0] = p0 - sub->GetRp() * q0;
+    }else if(outlet.type == BoundCondTypeScope::CORONARY){
+      outlet.y[0] = p0 - sub->GetRa1() * q0;
+      outlet.y[1] = outlet.y[0] - sub->GetRa2() * q0 - sub->getBoundCoronaryValues(startTime);
+    }
+  }
+
+  // Joints start from the pressure of their first inlet segment
+  for(size_t j = 0; j < jointList.size(); j++){
+    jointPressure[j] = EndPressure(segments[jointList[j]->GetInletID(0)], false);
+  }
+
+  EvaluateBoundaries(time);
+}
+
+void cvOneDExplicitEngine::GetState(cvOneDFEAVector& solution) const{
+  for(size_t k = 0; k < segments.size(); k++){
+    const Segment& seg = segments[k];
+    for(long i = 0; i < seg.nodes; i++){
+      solution[seg.eqOffset + 2*i] = S[seg.first + i];
+      solution[seg.eqOffset + 2*i + 1] = Q[seg.first + i];
+    }
+    long last = seg.eqOffset + 2*(seg.nodes - 1);
+    solution[seg.eqOffset] = seg.inS;
+    solution[seg.eqOffset + 1] = seg.inQ;
+    solution[last] = seg.outS;
+    solution[last + 1] = seg.outQ;
+  }
+}
+
+double cvOneDExplicitEngine::GetMassImbalance() const{
+  double imbalance = segments[0].inQ;
+  for(size_t i = 0; i < outletList.size(); i++){
+    imbalance -= segments[outletList[i].segment].outQ;
+  }
+  return imbalance;
+}
+
+// ===========
+// TIME STEPS
+// ===========
+
+long cvOneDExplicitEngine::Advance(double endTime){
+  long steps = 0;
+  while(time < endTime - 1.0e-12 * endTime){
+    double dt = min(StableTimeStep(), endTime - time);
+
+    S0 = S;
+    Q0 = Q;
+    for(size_t i = 0; i < outletList.size(); i++){
+      outletList[i].y0[0] = outletList[i].y[0];
+      outletList[i].y0[1] = outletList[i].y[1];
+    }
+
+    // First stage: forward Euler
+    EvaluateRates(time);
+    for(size_t n = 0; n < S.size(); n++){
+      S[n] = S0[n] + dt * dS[n];
+      Q[n] = Q0[n] + dt * dQ[n];
+    }
+    for(size_t i = 0; i < outletList.size(); i++){
+      for(int j = 0; j < 2; j++){
+        outletList[i].y[j] = outletList[i].y0[j] + dt * outletList[i].rate[j];
+      }
+    }
+    CheckAreas();
+
+    // Second stage: average with a forward Euler step from the first
+    EvaluateRates(time + dt);
+    for(size_t n = 0; n < S.size(); n++){
+      S[n] = 0.5 * (S0[n] + S[n] + dt * dS[n]);
+      Q[n] = 0.5 * (Q0[n] + Q[n] + dt * dQ[n]);
+    }
+    for(size_t i = 0; i < outletList.size(); i++){
+      for(int j = 0; j < 2; j++){
+        outletList[i].y[j] = 0.5 * (outletList[i].y0[j] + outletList[i].y[j] + dt * outletList[i].rate[j]);
+      }
+    }
+    CheckAreas();
+
+    time += dt;
+    steps++;
+  }
+  // boundary states of the final volume averages, for output
+  EvaluateBoundaries(time);
+  numberOfSteps += steps;
+  return steps;
+}
+
+double cvOneDExplicitEngine::StableTimeStep() const{
+  double dt = 1.0e30;
+  for(size_t k = 0; k < segments.size(); k++){
+    const Segment& seg = segments[k];
+    double speed = 0.0;
+    for(long i = 0; i < seg.nodes; i++){
+      double lmin, lmax;
+      Eigenvalues(seg, S[seg.first + i], Q[seg.first + i], i * seg.h, lmin, lmax);
+      speed = max(speed, max(fabs(lmin), fabs(lmax)));
+    }
+    // the end volumes are half as long
+    dt = min(dt, 0.5 * seg.h / speed);
+  }
+  return courantNumber * dt;
+}
+
+void cvOneDExplicitEngine::CheckAreas() const{
+  for(size_t k = 0; k < segments.size(); k++){
+    const Segment& seg = segments[k];
+    for(long i = 0; i < seg.nodes; i++){
+      if(!(S[seg.first + i] > 0.0)){
+        std::string name = (k < segmentNames.size()) ? segmentNames[k] : std::to_string(k);
+        std::string msg = "ERROR: The area of segment '" + name + "' is negative.";
+        throw cvException(msg.c_str());
+      }
+    }
+  }
+}
+
+void cvOneDExplicitEngine::EvaluateRates(double t){
+  EvaluateBoundaries(t);
+  for(size_t k = 0; k < segments.size(); k++){
+    EvaluateSegment(segments[k]);
+  }
+}
+
+// ================
+// SEGMENT UPDATE
+// ================
+
+void cvOneDExplicitEngine::Flux(const Segment& seg, double s, double q, double z, double* F) const{
+  F[0] = q;
+  F[1] = (1.0 + seg.delta) * q * q / s + seg.material->GetIntegralpS(s, z) / seg.density;
+}
+
+void cvOneDExplicitEngine::Eigenvalues(const Segment& seg, double s, double q, double z, double& lmin, double& lmax) const{
+  double u = q / s;
+  double c2 = s / seg.density * seg.material->GetDpDS(s, z);
+  double root = sqrt(c2 + seg.delta * (1.0 + seg.delta) * u * u);
+  lmin = (1.0 + seg.delta) * u - root;
+  lmax = (1.0 + seg.delta) * u + root;
+}
+
+void cvOneDExplicitEngine::EvaluateSegment(Segment& seg){
+  const long n = seg.nodes;
+  const long f = seg.first;
+  const double h = seg.h;
+
+  slopeS.assign(n, 0.0);
+  slopeQ.assign(n, 0.0);
+  for(long i = 1; i < n - 1; i++){
+    slopeS[i] = minmod(S[f+i] - S[f+i-1], S[f+i+1] - S[f+i]);
+    slopeQ[i] = minmod(Q[f+i] - Q[f+i-1], Q[f+i+1] - Q[f+i]);
+  }
+
+  // HLL fluxes through the volume interfaces, boundary fluxes at the ends
+  double Fleft[2];
+  Flux(seg, seg.inS, seg.inQ, 0.0, Fleft);
+  for(long i = 0; i < n; i++){
+    double Fright[2];
+    if(i == n - 1){
+      Flux(seg, seg.outS, seg.outQ, seg.length, Fright);
+    }else{
+      double z = (i + 0.5) * h;
+      double SL = S[f+i] + 0.5 * slopeS[i];
+      double QL = Q[f+i] + 0.5 * slopeQ[i];
+      double SR = S[f+i+1] - 0.5 * slopeS[i+1];
+      double QR = Q[f+i+1] - 0.5 * slopeQ[i+1];
+      double FL[2], FR[2];
+      Flux(seg, SL, QL, z, FL);
+      Flux(seg, SR, QR, z, FR);
+      double lminL, lmaxL, lminR, lmaxR;
+      Eigenvalues(seg, SL, QL, z, lminL, lmaxL);
+      Eigenvalues(seg, SR, QR, z, lminR, lmaxR);
+      double sL = min(lminL, lminR);
+      double sR = max(lmaxL, lmaxR);
+      if(sL >= 0.0){
+        Fright[0] = FL[0];
+        Fright[1] = FL[1];
+      }else if(sR <= 0.0){
+        Fright[0] = FR[0];
+        Fright[1] = FR[1];
+      }else{
+        Fright[0] = (sR*FL[0] - sL*FR[0] + sL*sR*(SR - SL)) / (sR - sL);
+        Fright[1] = (sR*FL[1] - sL*FR[1] + sL*sR*(QR - QL)) / (sR - sL);
+      }
+    }
+
+    double width = (i == 0 || i == n - 1) ? 0.5 * h : h;
+    double z = i * h;
+    double s = S[f+i];
+    double q = Q[f+i];
+    double pressure = seg.material->GetPressure(s, z);
+    double G1 = -seg.material->GetOutflowFunction(pressure, z);
+    double G2 = seg.N * q / s + seg.material->GetIntegralpD2S(s, z) / seg.density;
+
+    dS[f+i] = -(Fright[0] - Fleft[0]) / width + G1;
+    dQ[f+i] = -(Fright[1] - Fleft[1]) / width + G2;
+
+    Fleft[0] = Fright[0];
+    Fleft[1] = Fright[1];
+  }
+}
+
+// ==================
+// BOUNDARY COUPLING
+// ==================
+
+double cvOneDExplicitEngine::InletValue(double t) const{
+  // the inlet table is periodic, as in cvOneDMthModelBase::GetFlowRate
+  double cycleTime = inletTime.back();
+  double corrected = t - static_cast<long>(t / cycleTime) * cycleTime;
+  size_t ptr = 0;
+  while(ptr + 2 < inletTime.size() && corrected > inletTime[ptr+1]){
+    ptr++;
+  }
+  double xi = (corrected - inletTime[ptr]) / (inletTime[ptr+1] - inletTime[ptr]);
+  return inletValue[ptr] + xi * (inletValue[ptr+1] - inletValue[ptr]);
+}
+
+double cvOneDExplicitEngine::EndPressure(const Segment& seg, bool inlet) const{
+  long node = inlet ? seg.first : seg.first + seg.nodes - 1;
+  return seg.material->GetPressure(S[node], inlet ? 0.0 : seg.length);
+}
+
+void cvOneDExplicitEngine::EndState(const Segment& seg, bool inlet, double p, double& s, double& q, double& dQdp) const{
+  long node = inlet ? seg.first : seg.first + seg.nodes - 1;
+  double z = inlet ? 0.0 : seg.length;
+  double lmin, lmax;
+  Eigenvalues(seg, S[node], Q[node], z, lmin, lmax);
+  double lambdaIn = inlet ? lmax : lmin;
+  s = seg.material->GetArea(p, z);
+  q = Q[node] + lambdaIn * (s - S[node]);
+  dQdp = lambdaIn / seg.material->GetDpDS(s, z);
+}
+
+void cvOneDExplicitEngine::EvaluateBoundaries(double t){
+  // Model inlet
+  Segment& first = segments[0];
+  double lmin, lmax;
+  Eigenvalues(first, S[first.first], Q[first.first], 0.0, lmin, lmax);
+  if(inletType == BoundCondTypeScope::FLOW){
+    first.inQ = InletValue(t);
+    first.inS = S[first.first] + (first.inQ - Q[first.first]) / lmax;
+  }else{
+    double dQdp;
+    EndState(first, true, InletValue(t), first.inS, first.inQ, dQdp);
+  }
+
+  for(size_t j = 0; j < jointList.size(); j++){
+    SolveJoint(j);
+  }
+  for(size_t i = 0; i < outletList.size(); i++){
+    SolveOutlet(outletList[i], t);
+  }
+}
+
+// Mass conservation and a common pressure: the flow into the joint
+// decreases with the pressure, Newton on the pressure is monotone
+void cvOneDExplicitEngine::SolveJoint(long ith){
+  cvOneDFEAJoint* joint = jointList[ith];
+  double p = jointPressure[ith];
+  for(int iter = 0; iter < EXPLICIT_MAX_BOUNDARY_ITERATIONS; iter++){
+    double res = 0.0;
+    double dres = 0.0;
+    double s, q, dQdp;
+    for(int i = 0; i < joint->getNumberOfInletSegments(); i++){
+      Segment& seg = segments[joint->GetInletID(i)];
+      EndState(seg, false, p, s, q, dQdp);
+      seg.outS = s;
+      seg.outQ = q;
+      res += q;
+      dres += dQdp;
+    }
+    for(int i = 0; i < joint->getNumberOfOutletSegments(); i++){
+      Segment& seg = segments[joint->GetOutletID(i)];
+      EndState(seg, true, p, s, q, dQdp);
+      seg.inS = s;
+      seg.inQ = q;
+      res -= q;
+      dres -= dQdp;
+    }
+    double dp = -res / dres;
+    p += dp;
+    if(fabs(dp) <= EXPLICIT_BOUNDARY_TOLERANCE * fabs(p)){
+      break;
+    }
+  }
+  jointPressure[ith] = p;
+}
+
+void cvOneDExplicitEngine::SolveOutlet(Outlet& outlet, double t){
+  Segment& seg = segments[outlet.segment];
+  cvOneDSubdomain* sub = seg.sub;
+  long node = seg.first + seg.nodes - 1;
+  double lmin, lmax;
+  Eigenvalues(seg, S[node], Q[node], seg.length, lmin, lmax);
+
+  // Given area or flow rate
+  switch(outlet.type){
+    case BoundCondTypeScope::PRESSURE:
+    case BoundCondTypeScope::PRESSURE_WAVE:
+      seg.outS = (outlet.type == BoundCondTypeScope::PRESSURE) ? sub->GetBoundArea() : sub->GetBoundAreabyPresWave(t);
+      seg.outQ = Q[node] + lmin * (seg.outS - S[node]);
+      return;
+    case BoundCondTypeScope::FLOW:
+      seg.outQ = sub->GetBoundFlowRate();
+      seg.outS = S[node] + (seg.outQ - Q[node]) / lmin;
+      return;
+    default:
+      break;
+  }
+
+  // Flow rate given by the pressure: Q = (p - pDown)/R
+  double R, pDown;
+  double pim = 0.0;
+  switch(outlet.type){
+    case BoundCondTypeScope::RESISTANCE:
+      R = sub->GetResistanceR();
+      pDown = sub->GetResistancePd();
+      break;
+    case BoundCondTypeScope::RESISTANCE_TIME:
+      R = sub->GetBoundResistance(t);
+      pDown = 0.0;
+      break;
+    case BoundCondTypeScope::RCR:
+      R = sub->GetRp();
+      pDown = outlet.y[0];
+      break;
+    default:
+      // coronary
+      R = sub->GetRa1();
+      pDown = outlet.y[0];
+      pim = sub->getBoundCoronaryValues(t);
+      break;
+  }
+
+  double p = seg.material->GetPressure(seg.outS > 0.0 ? seg.outS : S[node], seg.length);
+  for(int iter = 0; iter < EXPLICIT_MAX_BOUNDARY_ITERATIONS; iter++){
+    double s, q, dQdp;
+    EndState(seg, false, p, s, q, dQdp);
+    seg.outS = s;
+    seg.outQ = q;
+    double res = q - (p - pDown) / R;
+    double dp = -res / (dQdp - 1.0 / R);
+    p += dp;
+    if(fabs(dp) <= EXPLICIT_BOUNDARY_TOLERANCE * fabs(p)){
+      break;
+    }
+  }
+
+  // Rates of the outlet models
+  if(outlet.type == BoundCondTypeScope::RCR){
+    double pd = sub->GetResistancePd();
+    outlet.rate[0] = (seg.outQ - (outlet.y[0] - pd) / sub->GetRd()) / sub->GetCap();
+  }else if(outlet.type == BoundCondTypeScope::CORONARY){
+    double p1 = outlet.y[0];
+    double p2 = outlet.y[1] + pim;
+    double q2 = (p1 - p2) / sub->GetRa2();
+    outlet.rate[0] = (seg.outQ - q2) / sub->GetCa();
+    outlet.rate[1] = (q2 - (p2 - sub->GetP_v()) / sub->GetRv1()) / sub->GetCc();
+  }
+}
@@ -0,0 +1,158 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDEXPLICITENGINE_H
+#define CVONEDEXPLICITENGINE_H
+
+//
+//  cvOneDExplicitEngine.h - Header for an Explicit Finite Volume Network Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~
+//
+//  Second solver engine beside the implicit finite elements. Every node of
+//  a segment carries a control volume (half volumes at the segment ends)
+//  with the conservation form of the equations, the same fluxes and
+//  sources as cvOneDMthSegmentModel. Interface fluxes use MUSCL slopes
+//  with the minmod limiter and the HLL Riemann solver, time integration
+//  is the two-stage SSP Runge-Kutta scheme with the step limited by the
+//  Courant number. Inlet, outlets and joints are coupled through the
+//  outgoing characteristic: the end state keeps the invariant that leaves
+//  the segment and satisfies the boundary condition, or mass conservation
+//  and equal pressure at a joint. Outlet models with memory (RCR,
+//  coronary) are integrated as ordinary differential equations with the
+//  same stages. There is no global system, the cost per step is linear
+//  in the number of nodes and the segment loops are independent.
+//
+
+# include <vector>
+# include <string>
+
+# include "cvOneDEnums.h"
+# include "cvOneDSubdomain.h"
+# include "cvOneDFEAJoint.h"
+# include "cvOneDFEAVector.h"
+
+using namespace std;
+
+class cvOneDExplicitEngine{
+
+  public:
+
+    // the inlet table holds flow rates or pressures by inletType
+    cvOneDExplicitEngine(const vector<cvOneDSubdomain*>& subdomains,
+                         const vector<cvOneDFEAJoint*>& joints,
+                         const vector<int>& outlets,
+                         BoundCondType inletType,
+                         const double* inletTime, const double* inletValue, long inletPoints);
+    ~cvOneDExplicitEngine();
+
+    void SetCourantNumber(double courant);
+    // names for the error messages, indices are used otherwise
+    void SetSegmentNames(const vector<string>& names);
+
+    // nodal areas and flow rates in the equation numbering of the
+    // implicit solver, also starts the outlet models
+    void SetState(const cvOneDFEAVector& solution, double startTime);
+    // end nodes get the boundary states, the other nodes the volume averages
+    void GetState(cvOneDFEAVector& solution) const;
+
+    // advances to endTime, returns the number of steps taken
+    long Advance(double endTime);
+
+    // inlet flow minus the outlet flows
+    double GetMassImbalance() const;
+    double GetTime() const {return time;}
+    long GetNumberOfSteps() const {return numberOfSteps;}
+
+  private:
+
+    struct Segment{
+      cvOneDSubdomain* sub;
+      cvOneDMaterial* material;
+      long first;       // first node in the engine arrays
+      long nodes;
+      long eqOffset;    // first equation in the solution vector
+      double h;
+      double length;
+      double density;
+      double delta;
+      double N;
+      // states at the inlet and outlet, where the boundary fluxes are taken
+      double inS, inQ, outS, outQ;
+    };
+
+    struct Outlet{
+      int segment;
+      BoundCondType type;
+      // RCR: distal capacitor pressure, coronary: pressure at Ca and
+      // pressure difference across Cc
+      double y[2];
+      double y0[2];
+      double rate[2];
+    };
+
+    // rates of the nodal states and of the outlet models at time t
+    void EvaluateRates(double t);
+    void EvaluateBoundaries(double t);
+    void EvaluateSegment(Segment& seg);
+    double StableTimeStep() const;
+    void CheckAreas() const;
+
+    void Flux(const Segment& seg, double S, double Q, double z, double* F) const;
+    void Eigenvalues(const Segment& seg, double S, double Q, double z, double& lmin, double& lmax) const;
+    // state at a segment end from the end volume and the incoming eigenvalue
+    // for a given pressure, with dS/dp
+    void EndState(const Segment& seg, bool inlet, double p, double& S, double& Q, double& dQdp) const;
+    double EndPressure(const Segment& seg, bool inlet) const;
+    void SolveJoint(long ith);
+    void SolveOutlet(Outlet& outlet, double t);
+    double InletValue(double t) const;
+
+    vector<Segment> segments;
+    vector<string> segmentNames;
+    vector<cvOneDFEAJoint*> jointList;
+    vector<Outlet> outletList;
+    vector<double> jointPressure;
+
+    BoundCondType inletType;
+    vector<double> inletTime;
+    vector<double> inletValue;
+
+    // nodal states, their values at the start of the step and the rates
+    vector<double> S, Q, S0, Q0, dS, dQ;
+    // limited slopes, reused by every segment
+    vector<double> slopeS, slopeQ;
+
+    double courantNumber;
+    double time;
+    long numberOfSteps;
+};
+
+#endif // CVONEDEXPLICITENGINE_H
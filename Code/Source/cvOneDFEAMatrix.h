@@ -62,6 +62,8 @@ class cvOneDFEAMatrix{
     virtual void Clear() = 0;
     virtual void ClearRow(long row) = 0;
     virtual void ClearColumn(long column) = 0;
+    // registers the equations touched by the boundary conditions
+    virtual void SetBoundaryEquations(long numEqs, const long* eqs) = 0;
     virtual double GetValue(long row, long column) = 0;
     virtual long GetDimension() const = 0;
     // print matrix
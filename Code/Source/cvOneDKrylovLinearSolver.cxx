@@ -0,0 +1,541 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDKrylovLinearSolver.cxx - Source for a Matrix-Free Krylov Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  Restarted GMRES with right preconditioning. The tangent is never
+//  formed: its products come from directional differences of the
+//  residual, and the manipulations the boundary conditions perform on
+//  the assembled system are replayed on every product.
+//
+
+# include <cmath>
+# include <cstring>
+
+# include "cvOneDKrylovLinearSolver.h"
+# include "cvOneDException.h"
+
+// largest change of an unknown in the directional differences
+#define KRYLOV_FD_STEP 1.0e-5
+// restart cycles before giving up on the current preconditioner
+#define MAX_KRYLOV_CYCLES 10
+
+cvOneDKrylovLinearSolver::cvOneDKrylovLinearSolver(long dim, long firstLagEq,
+                                                   cvOneDResidualFunction residual){
+  dimension = dim;
+  firstLagrangeEquation = firstLagEq;
+  residualFunction = residual;
+
+  restart = 30;
+  tolerance = 1.0e-6;
+  refreshing = false;
+  refreshRequested = false;
+  factored = false;
+  frozenTangent = false;
+  iterations = 0;
+
+  shift = new cvOneDFEAVector(dimension, "shift");
+  forwardResidual = new cvOneDFEAVector(dimension, "forwardResidual");
+  backwardResidual = new cvOneDFEAVector(dimension, "backwardResidual");
+  work = new double[dimension];
+
+  coupling = new cvOneDCouplingMatrix(dimension, "couplingMatrix");
+  numberOfMultipliers = dimension - firstLagrangeEquation;
+  schur = NULL;
+}
+
+cvOneDKrylovLinearSolver::~cvOneDKrylovLinearSolver(){
+  delete shift;
+  delete forwardResidual;
+  delete backwardResidual;
+  delete [] work;
+  delete coupling;
+  delete schur;
+}
+
+void cvOneDKrylovLinearSolver::SetRestart(int r){
+  restart = r;
+}
+
+void cvOneDKrylovLinearSolver::SetTolerance(double tol){
+  tolerance = tol;
+}
+
+void cvOneDKrylovLinearSolver::SetFrozenTangent(bool frozen){
+  frozenTangent = frozen;
+}
+
+void cvOneDKrylovLinearSolver::SetLHS(cvOneDFEAMatrix* matrix){
+  lhsMatrix = matrix;
+  blockSolver.SetLHS(matrix);
+}
+
+void cvOneDKrylovLinearSolver::SetRHS(cvOneDFEAVector *vector){
+  rhsVector = vector;
+  blockSolver.SetRHS(vector);
+}
+
+cvOneDFEAMatrix* cvOneDKrylovLinearSolver::GetLHS(){
+  return lhsMatrix;
+}
+
+cvOneDFEAVector* cvOneDKrylovLinearSolver::GetRHS(){
+  return rhsVector;
+}
+
+void cvOneDKrylovLinearSolver::BeginAssembly(bool refresh){
+  boundaryOperations.clear();
+  refreshing = refresh;
+  if(refresh){
+    factored = false;
+    refreshRequested = false;
+    coupling->Clear();
+  }
+}
+
+cvOneDFEAMatrix* cvOneDKrylovLinearSolver::GetCouplingMatrix(){
+  return coupling;
+}
+
+// While the blocks are being refreshed the skyline solver applies the
+// condition to them and to the RHS. Otherwise the blocks hold their
+// factors and only the RHS is changed here.
+void cvOneDKrylovLinearSolver::SetSolution(long equation, double value){
+  if(value != 0.0){
+    throw cvException("ERROR: JFNK only supports homogeneous essential conditions on the Newton increment.\n");
+  }
+  if(refreshing){
+    blockSolver.SetSolution(equation, value);
+  }else{
+    (*rhsVector)[equation] = value;
+  }
+  BoundaryOperation op = {BC_DIRICHLET, equation, {0.0, 0.0, 0.0, 0.0}};
+  boundaryOperations.push_back(op);
+}
+
+void cvOneDKrylovLinearSolver::Minus1dof(long rbEqnNo, double k_m){
+  if(refreshing){
+    blockSolver.Minus1dof(rbEqnNo, k_m);
+  }else{
+    (*rhsVector)[rbEqnNo-1] += (*rhsVector)[rbEqnNo]*k_m;
+    (*rhsVector)[rbEqnNo] = 0;
+  }
+  BoundaryOperation op = {BC_CONDENSED, rbEqnNo, {k_m, 0.0, 0.0, 0.0}};
+  boundaryOperations.push_back(op);
+}
+
+void cvOneDKrylovLinearSolver::DirectAppResistanceBC(long rbEqnNo, double resistance, double dpds, double rhs){
+  if(refreshing){
+    blockSolver.DirectAppResistanceBC(rbEqnNo, resistance, dpds, rhs);
+  }else{
+    (*rhsVector)[rbEqnNo] = rhs;
+  }
+  BoundaryOperation op = {BC_ROW, rbEqnNo, {dpds, -resistance, 0.0, 0.0}};
+  boundaryOperations.push_back(op);
+}
+
+void cvOneDKrylovLinearSolver::AddFlux(long rbEqnNo, double* OutletLHS11, double* OutletRHS1){
+  if(refreshing){
+    blockSolver.AddFlux(rbEqnNo, OutletLHS11, OutletRHS1);
+  }else{
+    (*rhsVector)[rbEqnNo-1] += *OutletRHS1;
+    (*rhsVector)[rbEqnNo] += *(OutletRHS1+1);
+  }
+  BoundaryOperation op = {BC_FLUX, rbEqnNo, {OutletLHS11[0], OutletLHS11[1], OutletLHS11[2], OutletLHS11[3]}};
+  boundaryOperations.push_back(op);
+}
+
+double cvOneDKrylovLinearSolver::Dot(const double* a, const double* b) const{
+  double sum = 0.0;
+  for(long i = 0; i < dimension; i++){
+    sum += a[i]*b[i];
+  }
+  return sum;
+}
+
+// Every boundary operation changes the tangent K into R*K*S + D, with S
+// acting on the columns, R on the rows and D the entries it sets. The
+// operations of ApplyBoundaryConditions act on distinct nodes, so all the
+// S are applied before the directional difference and all the R and D
+// after it.
+void cvOneDKrylovLinearSolver::Multiply(const double* x, double* y){
+  long i, eq;
+  double* s = shift->GetEntries();
+  memcpy(s, x, dimension*sizeof(double));
+
+  for(i = 0; i < boundaryOperations.size(); i++){
+    const BoundaryOperation& op = boundaryOperations[i];
+    eq = op.equation;
+    switch(op.type){
+      case BC_DIRICHLET:
+        s[eq] = 0.0;
+        break;
+      case BC_CONDENSED:
+        s[eq] = op.values[0]*s[eq-1];
+        break;
+      default:
+        break;
+    }
+  }
+
+  // K*s = -(F(u + eps*s) - F(u - eps*s))/(2*eps), F being minus the
+  // residual. The area to pressure relation is so stiff that the error of
+  // a one-sided difference swamps small Newton corrections, while the
+  // central difference keeps it below the roundoff
+  double norms = 0.0;
+  for(i = 0; i < dimension; i++){
+    norms = fmax(norms, fabs(s[i]));
+  }
+  if(norms > 0.0){
+    double eps = KRYLOV_FD_STEP/norms;
+    for(i = 0; i < dimension; i++){
+      s[i] *= eps;
+    }
+    residualFunction(*shift, *forwardResidual);
+    for(i = 0; i < dimension; i++){
+      s[i] = -s[i];
+    }
+    residualFunction(*shift, *backwardResidual);
+    const double* fp = forwardResidual->GetEntries();
+    const double* fm = backwardResidual->GetEntries();
+    for(i = 0; i < dimension; i++){
+      y[i] = -(fp[i] - fm[i])/(2.0*eps);
+    }
+  }else{
+    memset(y, 0, dimension*sizeof(double));
+  }
+
+  for(i = 0; i < boundaryOperations.size(); i++){
+    const BoundaryOperation& op = boundaryOperations[i];
+    eq = op.equation;
+    switch(op.type){
+      case BC_DIRICHLET:
+        y[eq] = x[eq];
+        break;
+      case BC_CONDENSED:
+        y[eq-1] += op.values[0]*y[eq];
+        y[eq] = x[eq];
+        break;
+      case BC_ROW:
+        y[eq] = op.values[0]*x[eq-1] + op.values[1]*x[eq];
+        break;
+      case BC_FLUX:
+        y[eq-1] += op.values[0]*x[eq-1] + op.values[1]*x[eq];
+        y[eq]   += op.values[2]*x[eq-1] + op.values[3]*x[eq];
+        break;
+    }
+  }
+}
+
+// The multipliers are eliminated from the joints' rows: with the blocks
+// K, J12 and J21 the multiplier columns and rows, and J22 the remainder,
+// the Schur complement S = J22 - J21*K^-1*J12 is assembled a column at a
+// time from block solves. The blocks of segments that do not touch a
+// joint give exact zeros, so S keeps the sparsity of the tree.
+void cvOneDKrylovLinearSolver::FactorPreconditioner(){
+  long i, j, k, p;
+  long L = firstLagrangeEquation;
+  long m = numberOfMultipliers;
+  cvOneDSkylineMatrix* blocks = (cvOneDSkylineMatrix*)lhsMatrix;
+  double* KD = blocks->GetDiagonalEntries();
+
+  // the joint multipliers are not part of any segment block
+  for(i = L; i < dimension; i++){
+    KD[i] = 1.0;
+  }
+
+  // sort the joint entries, the ones on segment unknowns only act on
+  // the diagonal of the blocks
+  multiplierColumnStart.assign(m + 1, 0);
+  multiplierRowStart.assign(m + 1, 0);
+  vector<long> J22Row, J22Column;
+  vector<double> J22Value;
+  long nent = coupling->GetNumberOfEntries();
+  for(p = 0; p < nent; p++){
+    i = coupling->GetRow(p);
+    j = coupling->GetColumn(p);
+    if(i < L && j < L){
+      if(i == j){
+        KD[i] += coupling->GetEntry(p);
+      }
+    }else if(i < L){
+      multiplierColumnStart[j - L + 1]++;
+    }else if(j < L){
+      multiplierRowStart[i - L + 1]++;
+    }else{
+      J22Row.push_back(i - L);
+      J22Column.push_back(j - L);
+      J22Value.push_back(coupling->GetEntry(p));
+    }
+  }
+  for(k = 0; k < m; k++){
+    multiplierColumnStart[k+1] += multiplierColumnStart[k];
+    multiplierRowStart[k+1] += multiplierRowStart[k];
+  }
+  multiplierColumnRow.resize(multiplierColumnStart[m]);
+  multiplierColumnValue.resize(multiplierColumnStart[m]);
+  multiplierRowColumn.resize(multiplierRowStart[m]);
+  multiplierRowValue.resize(multiplierRowStart[m]);
+  vector<long> columnFill(multiplierColumnStart.begin(), multiplierColumnStart.end() - 1);
+  vector<long> rowFill(multiplierRowStart.begin(), multiplierRowStart.end() - 1);
+  for(p = 0; p < nent; p++){
+    i = coupling->GetRow(p);
+    j = coupling->GetColumn(p);
+    if(i < L && j >= L){
+      multiplierColumnRow[columnFill[j - L]] = i;
+      multiplierColumnValue[columnFill[j - L]++] = coupling->GetEntry(p);
+    }else if(i >= L && j < L){
+      multiplierRowColumn[rowFill[i - L]] = j;
+      multiplierRowValue[rowFill[i - L]++] = coupling->GetEntry(p);
+    }
+  }
+
+  if(cvOneDSkylineLinearSolver::Factor(blocks) == 0){
+    throw cvException("ERROR: Singular segment block in the JFNK preconditioner.\n");
+  }
+
+  // without joint entries the multipliers are left unpreconditioned
+  delete schur;
+  schur = NULL;
+  if(m == 0 || nent == 0){
+    return;
+  }
+
+  // columns of S, the entries are kept with their row and column
+  vector<long> schurRow(J22Row), schurColumn(J22Column);
+  vector<double> schurValue(J22Value);
+  vector<double> v(dimension);
+  for(j = 0; j < m; j++){
+    memset(work, 0, dimension*sizeof(double));
+    for(p = multiplierColumnStart[j]; p < multiplierColumnStart[j+1]; p++){
+      work[multiplierColumnRow[p]] += multiplierColumnValue[p];
+    }
+    cvOneDSkylineLinearSolver::SolveFactored(blocks, work, &v[0]);
+    for(k = 0; k < m; k++){
+      double sum = 0.0;
+      for(p = multiplierRowStart[k]; p < multiplierRowStart[k+1]; p++){
+        sum += multiplierRowValue[p]*v[multiplierRowColumn[p]];
+      }
+      if(sum != 0.0){
+        schurRow.push_back(k);
+        schurColumn.push_back(j);
+        schurValue.push_back(-sum);
+      }
+    }
+  }
+
+  // skyline profile of S
+  vector<long> pos(m + 1, 0);
+  for(p = 0; p < schurValue.size(); p++){
+    i = schurRow[p];
+    j = schurColumn[p];
+    k = (i > j) ? i : j;
+    pos[k + 1] = max(pos[k + 1], labs(i - j));
+  }
+  for(k = 0; k < m; k++){
+    pos[k+1] += pos[k];
+  }
+  schur = new cvOneDSkylineMatrix(m, &pos[0], "schurMatrix");
+  schur->Clear();
+  for(p = 0; p < schurValue.size(); p++){
+    schur->AddValue(schurRow[p], schurColumn[p], schurValue[p]);
+  }
+  if(cvOneDSkylineLinearSolver::Factor(schur) == 0){
+    throw cvException("ERROR: Singular joint coupling in the JFNK preconditioner.\n");
+  }
+  schurRhs.resize(m);
+  schurSolution.resize(m);
+}
+
+void cvOneDKrylovLinearSolver::Precondition(const double* x, double* y){
+  long i, k, p;
+  cvOneDSkylineMatrix* blocks = (cvOneDSkylineMatrix*)lhsMatrix;
+  memcpy(work, x, dimension*sizeof(double));
+  cvOneDSkylineLinearSolver::SolveFactored(blocks, work, y);
+  if(schur == NULL){
+    return;
+  }
+
+  // multipliers from S*y2 = x2 - J21*K^-1*x1, then y1 = K^-1*(x1 - J12*y2)
+  for(k = 0; k < numberOfMultipliers; k++){
+    double sum = x[firstLagrangeEquation + k];
+    for(p = multiplierRowStart[k]; p < multiplierRowStart[k+1]; p++){
+      sum -= multiplierRowValue[p]*y[multiplierRowColumn[p]];
+    }
+    schurRhs[k] = sum;
+  }
+  cvOneDSkylineLinearSolver::SolveFactored(schur, &schurRhs[0], &schurSolution[0]);
+
+  memcpy(work, x, dimension*sizeof(double));
+  for(k = 0; k < numberOfMultipliers; k++){
+    for(p = multiplierColumnStart[k]; p < multiplierColumnStart[k+1]; p++){
+      work[multiplierColumnRow[p]] -= multiplierColumnValue[p]*schurSolution[k];
+    }
+    work[firstLagrangeEquation + k] = schurSolution[k];
+  }
+  cvOneDSkylineLinearSolver::SolveFactored(blocks, work, y);
+}
+
+void cvOneDKrylovLinearSolver::Solve(cvOneDFEAVector& sol){
+  long i;
+  int j, k;
+
+  if(!factored){
+    if(!refreshing){
+      throw cvException("ERROR: JFNK preconditioner was not assembled.\n");
+    }
+    FactorPreconditioner();
+    factored = true;
+  }
+  refreshing = false;
+
+  double* x = sol.GetEntries();
+  const double* b = rhsVector->GetEntries();
+  memset(x, 0, dimension*sizeof(double));
+  iterations = 0;
+
+  if(frozenTangent){
+    Precondition(b, x);
+    return;
+  }
+
+  double normb = sqrt(Dot(b, b));
+  if(normb == 0.0){
+    return;
+  }
+  double target = tolerance*normb;
+
+  // Krylov basis and Hessenberg matrix in Givens-rotated form
+  vector<double> V((restart+1)*dimension);
+  vector<double> H((restart+1)*restart);
+  vector<double> cs(restart), sn(restart), g(restart+1), y(restart);
+  vector<double> z(dimension), w(dimension);
+
+  bool converged = false;
+  for(int cycle = 0; cycle < MAX_KRYLOV_CYCLES && !converged; cycle++){
+
+    double* v0 = &V[0];
+    if(cycle == 0){
+      memcpy(v0, b, dimension*sizeof(double));
+    }else{
+      Multiply(x, &w[0]);
+      for(i = 0; i < dimension; i++){
+        v0[i] = b[i] - w[i];
+      }
+    }
+    double beta = sqrt(Dot(v0, v0));
+    if(beta <= target){
+      converged = true;
+      break;
+    }
+    for(i = 0; i < dimension; i++){
+      v0[i] /= beta;
+    }
+    for(j = 0; j <= restart; j++){
+      g[j] = 0.0;
+    }
+    g[0] = beta;
+
+    for(k = 0; k < restart; k++){
+      double* vk = &V[k*dimension];
+      double* vn = &V[(k+1)*dimension];
+      Precondition(vk, &z[0]);
+      Multiply(&z[0], vn);
+      iterations++;
+
+      // modified Gram-Schmidt
+      for(j = 0; j <= k; j++){
+        double* vj = &V[j*dimension];
+        double h = Dot(vn, vj);
+        H[j*restart+k] = h;
+        for(i = 0; i < dimension; i++){
+          vn[i] -= h*vj[i];
+        }
+      }
+      double hn = sqrt(Dot(vn, vn));
+      if(hn > 0.0){
+        for(i = 0; i < dimension; i++){
+          vn[i] /= hn;
+        }
+      }
+
+      for(j = 0; j < k; j++){
+        double h0 = H[j*restart+k];
+        double h1 = H[(j+1)*restart+k];
+        H[j*restart+k]     =  cs[j]*h0 + sn[j]*h1;
+        H[(j+1)*restart+k] = -sn[j]*h0 + cs[j]*h1;
+      }
+      double hk = H[k*restart+k];
+      double r = sqrt(hk*hk + hn*hn);
+      cs[k] = hk/r;
+      sn[k] = hn/r;
+      H[k*restart+k] = r;
+      g[k+1] = -sn[k]*g[k];
+      g[k]   =  cs[k]*g[k];
+
+      if(fabs(g[k+1]) <= target || hn == 0.0){
+        converged = true;
+        k++;
+        break;
+      }
+    }
+
+    // x += M^-1 * V * y, with H*y = g
+    for(j = k-1; j >= 0; j--){
+      double sum = g[j];
+      for(int l = j+1; l < k; l++){
+        sum -= H[j*restart+l]*y[l];
+      }
+      y[j] = sum/H[j*restart+j];
+    }
+    for(i = 0; i < dimension; i++){
+      w[i] = 0.0;
+    }
+    for(j = 0; j < k; j++){
+      double* vj = &V[j*dimension];
+      for(i = 0; i < dimension; i++){
+        w[i] += y[j]*vj[i];
+      }
+    }
+    Precondition(&w[0], &z[0]);
+    for(i = 0; i < dimension; i++){
+      x[i] += z[i];
+    }
+  }
+
+  // the Newton iteration will carry on with the inexact correction,
+  // the preconditioner is refreshed at the next assembly
+  if(!converged){
+    refreshRequested = true;
+  }
+}
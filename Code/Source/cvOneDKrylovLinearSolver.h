@@ -0,0 +1,168 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDKRYLOVLINEARSOLVER_H
+#define CVONEDKRYLOVLINEARSOLVER_H
+
+//
+//  cvOneDKrylovLinearSolver.h - Header for a Matrix-Free Krylov Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  This class solves the Newton correction without the global tangent
+//  (Jacobian-free Newton-Krylov). The products with the tangent are
+//  central directional differences of the assembled residual, the boundary
+//  condition manipulations are recorded and applied to these products,
+//  and restarted GMRES is preconditioned with the block Jacobi of the
+//  segments, kept in a skyline matrix without the joint coupling and
+//  factored only when it is refreshed. The joint multipliers are
+//  eliminated from the preconditioner through their Schur complement,
+//  which only couples the joints sharing a segment.
+//
+
+# include <vector>
+# include <functional>
+
+# include "cvOneDLinearSolver.h"
+# include "cvOneDSkylineLinearSolver.h"
+# include "cvOneDSkylineMatrix.h"
+# include "cvOneDCouplingMatrix.h"
+# include "cvOneDFEAVector.h"
+
+using namespace std;
+
+// evaluates minus the global residual, before the boundary conditions,
+// at the current solution plus shift
+typedef std::function<void(const cvOneDFEAVector& shift, cvOneDFEAVector& residual)> cvOneDResidualFunction;
+
+class cvOneDKrylovLinearSolver: public cvOneDLinearSolver{
+
+  public:
+
+    // the LHS set on this solver is the skyline matrix of the segment
+    // blocks; equations from firstLagrangeEquation on are not preconditioned
+    cvOneDKrylovLinearSolver(long dim, long firstLagrangeEquation,
+                             cvOneDResidualFunction residual);
+    virtual ~cvOneDKrylovLinearSolver();
+
+    void SetRestart(int restart);
+    void SetTolerance(double tolerance);
+    // the correction is the preconditioner alone, i.e. the tangent of the
+    // last refresh (modified Newton)
+    void SetFrozenTangent(bool frozen);
+
+    // starts a Newton iteration, forgetting the previous boundary conditions.
+    // With refresh the segment blocks are being assembled into the LHS, the
+    // joint entries into the coupling matrix, and both are factored again
+    // by the next Solve
+    void BeginAssembly(bool refresh);
+    cvOneDFEAMatrix* GetCouplingMatrix();
+    // the blocks were never factored, or GMRES did not converge with them
+    bool NeedsRefresh() const {return refreshRequested || !factored;}
+    // the next assembly refreshes the blocks, e.g. when the frozen
+    // tangent no longer reduces the residual
+    void RequestRefresh() {refreshRequested = true;}
+    int GetNumberOfIterations() const {return iterations;}
+
+    virtual void SetLHS( cvOneDFEAMatrix* matrix);
+    virtual void SetRHS( cvOneDFEAVector* vector);
+
+    // solution gets overwritten with the solution of the
+    // linear system of equations, the RHS is left unchanged
+    virtual void Solve( cvOneDFEAVector& solution);
+
+    virtual cvOneDFEAMatrix* GetLHS();
+    virtual cvOneDFEAVector* GetRHS();
+    // only homogeneous values are supported, which is what the
+    // Newton increment of an essential condition is
+    virtual void SetSolution( long equation, double value);
+    virtual void Minus1dof( long rightBottomEquationNumber, double k_m);
+    virtual void DirectAppResistanceBC( long rbEqnNo, double resistance, double dpds, double rhs);
+    virtual void AddFlux( long rbEqnNo, double* OutletLHS11, double* OutletRHS1);
+
+  private:
+
+    enum BoundaryOperationType{
+      BC_DIRICHLET = 0, // row and column replaced by the identity
+      BC_CONDENSED = 1, // dQ = k_m*dS condensed into the previous equation
+      BC_ROW       = 2, // row replaced by the linearized constraint
+      BC_FLUX      = 3  // 2x2 outlet flux block added
+    };
+
+    struct BoundaryOperation{
+      BoundaryOperationType type;
+      long equation;
+      double values[4];
+    };
+
+    // y = (tangent with boundary conditions) * x
+    void Multiply( const double* x, double* y);
+    // factors the segment blocks and the Schur complement of the joints
+    void FactorPreconditioner();
+    // y = (segment blocks and joints)^-1 * x
+    void Precondition( const double* x, double* y);
+    double Dot( const double* a, const double* b) const;
+
+    long dimension;
+    long firstLagrangeEquation;
+    cvOneDResidualFunction residualFunction;
+
+    int restart;
+    double tolerance;
+    bool refreshing;
+    bool refreshRequested;
+    bool factored;
+    bool frozenTangent;
+    int iterations;
+
+    vector<BoundaryOperation> boundaryOperations;
+    cvOneDSkylineLinearSolver blockSolver;
+
+    // joint entries in the multiplier columns (J12, by column) and rows
+    // (J21, by row), and the factored J22 - J21*blocks^-1*J12
+    cvOneDCouplingMatrix* coupling;
+    long numberOfMultipliers;
+    vector<long> multiplierColumnStart;
+    vector<long> multiplierColumnRow;
+    vector<double> multiplierColumnValue;
+    vector<long> multiplierRowStart;
+    vector<long> multiplierRowColumn;
+    vector<double> multiplierRowValue;
+    cvOneDSkylineMatrix* schur;
+    vector<double> schurRhs;
+    vector<double> schurSolution;
+
+    cvOneDFEAVector* shift;
+    cvOneDFEAVector* forwardResidual;
+    cvOneDFEAVector* backwardResidual;
+    double* work;
+};
+
+#endif // CVONEDKRYLOVLINEARSOLVER_H
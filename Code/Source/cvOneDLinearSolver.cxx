@@ -31,12 +31,9 @@
 
 # include "cvOneDLinearSolver.h"
 
-// Static Declarations
-cvOneDFEAMatrix* cvOneDLinearSolver::lhsMatrix;
-cvOneDFEAVector* cvOneDLinearSolver::rhsVector;
-
 cvOneDLinearSolver::cvOneDLinearSolver(){
-
+  lhsMatrix = NULL;
+  rhsVector = NULL;
 }
 
 cvOneDLinearSolver::~cvOneDLinearSolver(){
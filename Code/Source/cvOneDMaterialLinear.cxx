@@ -82,7 +82,7 @@ cvOneDMaterialLinear& cvOneDMaterialLinear::operator=(const cvOneDMaterialLinear
     cvOneDMaterial::operator=(that);
     ehr = that.ehr;
     p1_=that.PP1_; //impose P refrence here otherwise p1_ is not the value set in the input file.
-    printf("this that set ehr =%f p1_=%f \n",ehr, p1_);
+    cvOneDPrintf("this that set ehr =%f p1_=%f \n",ehr, p1_);
   }
   return *this;
 }
@@ -165,11 +165,11 @@ double cvOneDMaterialLinear::GetArea(double pressure, double z)const{
   // This is the area computation using the "pressure-strain" modulus, EHR.
   double area = So_*pow(1.0+(pres-p1_)/EHR,2.0);
   if(cvOneDGlobal::debugMode){
-    printf("So_: %e\n",So_);
-    printf("pres: %e\n",pres);
-    printf("p1_: %e\n",p1_);
-    printf("EHR: %e\n",EHR);
-    printf("Area: %e\n",area);
+    cvOneDPrintf("So_: %e\n",So_);
+    cvOneDPrintf("pres: %e\n",pres);
+    cvOneDPrintf("p1_: %e\n",p1_);
+    cvOneDPrintf("EHR: %e\n",EHR);
+    cvOneDPrintf("Area: %e\n",area);
     fflush(stdout);
   }
 
@@ -30,10 +30,10 @@
  */
 
 # include "cvOneDEnums.h"
-# include "cvOneDGlobal.h"
 # include "cvOneDMaterialManager.h"
 # include "cvOneDMaterialOlufsen.h"
 # include "cvOneDMaterialLinear.h"
+# include "cvOneDUtility.h"
 
 
 // Constructor
@@ -46,6 +46,9 @@ cvOneDMaterialManager::cvOneDMaterialManager(){
 
 // Destructor
 cvOneDMaterialManager::~cvOneDMaterialManager(){
+  for (int i=0;i<numMaterials;i++){
+    delete materials[i];
+  }
 }
 
 int cvOneDMaterialManager::AddNewMaterial(MaterialType type, cvOneDMaterial* mat){
@@ -65,8 +68,8 @@ int cvOneDMaterialManager::AddNewMaterialOlufsen(double density, double dynamicV
   olfmat->SetProfileExponent(profile_exponent);
   olfmat->SetReferencePressure(pRef);
   olfmat->SetMaterialType(params,pRef);
-  printf("new cvOneMaterialOlufsen called check pRef %f \n", olfmat->GetReferencePressure());
-  return cvOneDGlobal::gMaterialManager->AddNewMaterial(MaterialType_MATERIAL_OLUFSEN,(cvOneDMaterial*)olfmat);
+  cvOneDPrintf("new cvOneMaterialOlufsen called check pRef %f \n", olfmat->GetReferencePressure());
+  return AddNewMaterial(MaterialType_MATERIAL_OLUFSEN,(cvOneDMaterial*)olfmat);
 }
 
 int cvOneDMaterialManager::AddNewMaterialLinear(double density, double dynamicViscosity,
@@ -78,7 +81,7 @@ int cvOneDMaterialManager::AddNewMaterialLinear(double density, double dynamicVi
   linearmat->SetProfileExponent(profile_exponent);
   linearmat->SetReferencePressure(pRef);
   linearmat->SetEHR(EHR,pRef);
-  return cvOneDGlobal::gMaterialManager->AddNewMaterial(MaterialType_MATERIAL_LINEAR,(cvOneDMaterial*)linearmat);
+  return AddNewMaterial(MaterialType_MATERIAL_LINEAR,(cvOneDMaterial*)linearmat);
 }
 
 // caller must deallocate material instance to avoid memory leak
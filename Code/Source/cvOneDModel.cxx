@@ -40,7 +40,7 @@
 using namespace std;
 
 //Static Declarations
-long cvOneDModel::NumModels;
+std::atomic<long> cvOneDModel::NumModels(0);
 
 cvOneDModel::cvOneDModel(){
   cvOneDModel::NumModels++;
@@ -48,6 +48,15 @@ cvOneDModel::cvOneDModel(){
 
 cvOneDModel::~cvOneDModel(){
   cvOneDModel::NumModels--;
+  for(size_t i = 0; i < SegmentList.size(); i++){
+    delete SegmentList[i];
+  }
+  for(size_t i = 0; i < NodeList.size(); i++){
+    delete NodeList[i];
+  }
+  for(size_t i = 0; i < JointList.size(); i++){
+    delete JointList[i];
+  }
 }
 
 cvOneDModel * cvOneDModel::New(void){
@@ -31,15 +31,17 @@
 
 #include "cvOneDModelManager.h"
 
-cvOneDModelManager::cvOneDModelManager(char *mdlName){
+cvOneDModelManager::cvOneDModelManager(char *mdlName, cvOneDContext* ctx){
+  context = (ctx != NULL) ? ctx : cvOneDContext::Current();
+
   // We're creating a model
-  cvOneDGlobal::isCreating = true;
+  context->isCreating = true;
 
   cvOneDModel* newModel = new cvOneDModel;
   newModel->setModelName(mdlName);
-  cvOneDGlobal::currentModel = cvOneDGlobal::gModelList.size();
-  newModel->setModelID(cvOneDGlobal::currentModel);
-  cvOneDGlobal::gModelList.push_back(newModel);
+  context->currentModel = context->modelList.size();
+  newModel->setModelID(context->currentModel);
+  context->modelList.push_back(newModel);
 }
 
 cvOneDModelManager::~cvOneDModelManager(){
@@ -50,16 +52,13 @@ int cvOneDModelManager::CreateMaterial(char *matName, char *MaterialTypeString,
                                        double profile_exponent, double pRef,
                                        int numParams, double *params, int *matID){
 
-  if (cvOneDGlobal::gMaterialManager == NULL){
-    cvOneDGlobal::gMaterialManager = new cvOneDMaterialManager();
-  }
   if(!strcmp (MaterialTypeString, "MATERIAL_OLUFSEN")){
-    *matID = cvOneDGlobal::gMaterialManager->AddNewMaterialOlufsen(density,dynamicViscosity,
+    *matID = context->materialManager->AddNewMaterialOlufsen(density,dynamicViscosity,
                              profile_exponent,pRef,params);
     return CV_OK;
   }else if(!strcmp (MaterialTypeString, "MATERIAL_LINEAR")){
     double EHR = params[0];
-    *matID = cvOneDGlobal::gMaterialManager->AddNewMaterialLinear(density,dynamicViscosity,
+    *matID = context->materialManager->AddNewMaterialLinear(density,dynamicViscosity,
                                                                   profile_exponent,pRef,EHR);
     return CV_OK;
   }else{
@@ -126,7 +125,7 @@ int cvOneDModelManager::CreateSegment(char   *segName,long segID, double  segLen
   //seg -> setSegmentID(ModelList[currentModel]->getNumberOfSegments());
   seg -> setSegmentID(segID);
   seg -> setSegmentName(segName);
-  seg -> setParentModel((void *)&cvOneDGlobal::gModelList[cvOneDGlobal::currentModel]);
+  seg -> setParentModel((void *)&context->modelList[context->currentModel]);
   seg -> setSegmentLength(segLen);
   seg -> setNumElements(numEls);
   seg -> setInOutJoints(inNode, outNode);
@@ -168,7 +167,7 @@ int cvOneDModelManager::CreateSegment(char   *segName,long segID, double  segLen
 
   seg -> setMeshType(MeshTypeScope::UNIFORM);
 
-  cvOneDGlobal::gModelList[cvOneDGlobal::currentModel]->addSegment(seg);
+  context->modelList[context->currentModel]->addSegment(seg);
 
   return CV_OK;
 }
@@ -182,7 +181,7 @@ int cvOneDModelManager::CreateNode(char * nodeName,double x,double y,double z){
   node -> y = y;
   node -> z = z;
 
-  cvOneDGlobal::gModelList[cvOneDGlobal::currentModel]->addNode(node);
+  context->modelList[context->currentModel]->addNode(node);
 
   return CV_OK;
 }
@@ -208,7 +207,7 @@ int cvOneDModelManager::CreateJoint(const char * jointName,double x,double y,dou
     joint -> OutletSegments.push_back(OutSegs[i]);
   }
 
-  cvOneDGlobal::gModelList[cvOneDGlobal::currentModel]->addJoint(joint);
+  context->modelList[context->currentModel]->addJoint(joint);
 
   return CV_OK;
 }
@@ -224,58 +223,59 @@ int cvOneDModelManager::SolveModel(double dt, long stepSize,
   BoundCondTypeScope::BoundCondType boundT;
 
   // set the creation flag to off.
-  cvOneDGlobal::isCreating = false;
+  context->isCreating = false;
 
   // convert char string to boundary condition type
   if(!strcmp( boundType, "NOBOUND")){
     boundT = BoundCondTypeScope::NOBOUND;
-    printf("Inlet Condition Type: NOBOUND\n");
+    cvOneDPrintf("Inlet Condition Type: NOBOUND\n");
   }else if(!strcmp( boundType, "PRESSURE")){
     boundT = BoundCondTypeScope::PRESSURE;
-    printf("Inlet Condition Type: PRESSURE\n");
+    cvOneDPrintf("Inlet Condition Type: PRESSURE\n");
   }else if(!strcmp( boundType, "PRESSURE_WAVE")){
     boundT = BoundCondTypeScope::PRESSURE_WAVE;
-    printf("Inlet Condition Type: PRESSURE_WAVE\n");
+    cvOneDPrintf("Inlet Condition Type: PRESSURE_WAVE\n");
   }else if(!strcmp( boundType, "FLOW")){
     boundT = BoundCondTypeScope::FLOW;
-    printf("Inlet Condition Type: FLOW\n");
+    cvOneDPrintf("Inlet Condition Type: FLOW\n");
   }else if(!strcmp( boundType, "RESISTANCE")){
     boundT = BoundCondTypeScope::RESISTANCE;
-    printf("Inlet Condition Type: RESISTANCE\n");
+    cvOneDPrintf("Inlet Condition Type: RESISTANCE\n");
   }else if(!strcmp( boundType, "RESISTANCE_TIME")){
     boundT = BoundCondTypeScope::RESISTANCE_TIME;
-    printf("Inlet Condition Type: RESISTANCE_TIME\n");
+    cvOneDPrintf("Inlet Condition Type: RESISTANCE_TIME\n");
   }else if(!strcmp( boundType, "RCR")){
     boundT = BoundCondTypeScope::RCR;
-    printf("Inlet Condition Type: RCR\n");
+    cvOneDPrintf("Inlet Condition Type: RCR\n");
   }else if(!strcmp( boundType, "CORONARY")){
     boundT = BoundCondTypeScope::CORONARY;
-    printf("Inlet Condition Type: CORONARY\n");
+    cvOneDPrintf("Inlet Condition Type: CORONARY\n");
   }else{
     return CV_ERROR;
   }
 
   // Set Solver Options
-  cvOneDMthSegmentModel::STABILIZATION = usestab; // 1=stabilization, 0=none
-  cvOneDGlobal::CONSERVATION_FORM = useIV;
-  cvOneDBFSolver::ASCII = 1;
+  cvOneDBFSolver* solver = context->solver;
+  solver->SetStabilization(usestab); // 1=stabilization, 0=none
+  solver->SetConservationForm(useIV);
+  solver->ASCII = 1;
 
-  cvOneDBFSolver::SetModelPtr(cvOneDGlobal::gModelList[cvOneDGlobal::currentModel]);
+  solver->SetModelPtr(context->modelList[context->currentModel]);
 
   // We need to get these from the solver
-  cvOneDBFSolver::SetDeltaTime(dt);
-  cvOneDBFSolver::SetStepSize(stepSize);
-  cvOneDBFSolver::SetMaxStep(maxStep);
-  cvOneDBFSolver::SetQuadPoints(quadPoints);
-  cvOneDBFSolver::SetInletBCType(boundT);
-  cvOneDBFSolver::DefineInletFlow(times, values, len);
-  cvOneDBFSolver::SetConvergenceCriteria(conv);
+  solver->SetDeltaTime(dt);
+  solver->SetStepSize(stepSize);
+  solver->SetMaxStep(maxStep);
+  solver->SetQuadPoints(quadPoints);
+  solver->SetInletBCType(boundT);
+  solver->DefineInletFlow(times, values, len);
+  solver->SetConvergenceCriteria(conv);
 
-  cvOneDGlobal::isSolving = true;
+  context->isSolving = true;
 
-  cvOneDBFSolver::Solve();
+  solver->Solve();
 
-  cvOneDGlobal::isSolving = false;
+  context->isSolving = false;
 
   return CV_OK;
 }
@@ -309,16 +309,16 @@ int cvOneDModelManager::CreateDataTable(char* dtName,char* dtType, cvDoubleVec v
     table->setValues(tempValues);
     // If Debug: Show Admittance Values
     if(cvOneDGlobal::debugMode){
-      printf("--- Debug\n");
-      printf("%15s %15s\n","Time","Value");
+      cvOneDPrintf("--- Debug\n");
+      cvOneDPrintf("%15s %15s\n","Time","Value");
       for(int loopA=0;loopA<table->getSize();loopA++){
-        printf("%15e %15e\n",table->getTime(loopA),table->getValues(loopA));
+        cvOneDPrintf("%15e %15e\n",table->getTime(loopA),table->getValues(loopA));
       }
     }
   }else{
     throw cvException("ERROR: Invalid data table type.\n");
   }
   // ADD Data Table to the Global List
-  cvOneDGlobal::gDataTables.push_back(table);
+  context->dataTables.push_back(table);
   return CV_OK;
 }
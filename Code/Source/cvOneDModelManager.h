@@ -37,13 +37,17 @@
 
 # include "cvOneDTypes.h"
 # include "cvOneDGlobal.h"
+# include "cvOneDContext.h"
+# include "cvOneDBFSolver.h"
 # include "cvOneDException.h"
 # include "cvOneDModel.h"
+# include "cvOneDUtility.h"
 
 class cvOneDModelManager{
   public:
-    // CONSTRUCTOR
-    cvOneDModelManager(char *mdlName);
+    // CONSTRUCTOR: THE MODEL IS CREATED IN THE CONTEXT OF THE CALLING
+    // THREAD, UNLESS ONE IS GIVEN
+    cvOneDModelManager(char *mdlName, cvOneDContext* ctx = NULL);
     // DESTUCTOR
     ~cvOneDModelManager();
 
@@ -79,6 +83,9 @@ class cvOneDModelManager{
                    int len,char* boundType,double* values,
                    double* times,double conv, int useIV, int usestab);
 
+  private:
+    cvOneDContext* context;
+
 };
 
 #endif // CVONEDMODELMANAGER_H
@@ -106,6 +106,13 @@ void cvOneDMthBranchModel::FormNewton(cvOneDFEAMatrix* lhsMatrix, cvOneDFEAVecto
   }
 }
 
+void cvOneDMthBranchModel::FormResidual(cvOneDFEAVector* rhsVector){
+  for(long i = 0; i < jointList.size(); i++){
+    FormLagrangeRHSbyQ(i, rhsVector);
+    FormLagrangeRHSbyP(i, rhsVector);
+  }
+}
+
 //default: the first one of the inletSegment array will be the node
 //to write mass balance (flow in = flow out), also the pressure of this
 //node will be equal to the pressure of every other node
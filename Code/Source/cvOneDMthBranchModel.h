@@ -54,6 +54,7 @@ class cvOneDMthBranchModel: public cvOneDMthModelBase{
     ~cvOneDMthBranchModel(){}
     int GetNumberOfJoints() {return numOfJoints;}
     void FormNewton(cvOneDFEAMatrix* lhsMatrix, cvOneDFEAVector* rhsVector);
+    void FormResidual(cvOneDFEAVector* rhsVector);
     void GetEquationNumbers(long ele, long* eqNumbers, long ithJoint);
     long GetUpmostEqnNumber(long ele, long ithJoint);
 
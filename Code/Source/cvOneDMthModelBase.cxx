@@ -48,10 +48,6 @@
 # include "cvOneDMaterial.h"
 # include "cvOneDFiniteElement.h"
 
-
-// Static Declarations...
-int cvOneDMthModelBase::impedIncr;
-
 cvOneDMthModelBase::cvOneDMthModelBase(const cvOneDModel* modl){
 }
 
@@ -85,6 +81,16 @@ cvOneDMthModelBase::cvOneDMthModelBase(const vector<cvOneDSubdomain*>& subdList,
 
   flrt = NULL;
   time = NULL;
+  inletType = BoundCondTypeScope::FLOW;
+  impedIncr = 0;
+  steadyState = false;
+  conservationForm = 0;
+  coupledInlet = false;
+  coupledInletValue = 0.0;
+  olderSolution = NULL;
+  historyWeight = 0.0;
+  stepWeight = 1.0;
+  massWeight = 1.0;
 }
 
 cvOneDMthModelBase::~cvOneDMthModelBase(){
@@ -93,11 +99,32 @@ cvOneDMthModelBase::~cvOneDMthModelBase(){
   if(time != NULL) delete [] time;
 }
 
-void cvOneDMthModelBase::TimeUpdate(double pTime, double deltaT){
+void cvOneDMthModelBase::TimeUpdate(double pTime, double deltaT, double oDeltaT){
   previousTime = pTime;
   deltaTime = deltaT;
   currentTime = previousTime + deltaTime;
   impedIncr = 1;
+
+  // Variable step BDF2 with ratio w = dt_{n+1}/dt_n, divided by its
+  // leading coefficient (1+2w)/(1+w)
+  historyWeight = 0.0;
+  stepWeight = 1.0;
+  massWeight = 1.0;
+  if(olderSolution != NULL && oDeltaT > 0.0){
+    double w = deltaTime / oDeltaT;
+    historyWeight = w * w / (1.0 + 2.0 * w);
+    stepWeight = (1.0 + w) / (1.0 + 2.0 * w);
+  }
+}
+
+void cvOneDMthModelBase::SteadyUpdate(double deltaT){
+  previousTime = 0.0;
+  deltaTime = deltaT;
+  currentTime = deltaT;
+  impedIncr = 1;
+  historyWeight = 0.0;
+  stepWeight = 1.0;
+  massWeight = 0.0;
 }
 
 void cvOneDMthModelBase::GetNodalEquationNumbers(long locNode, long* eqNumbers,long ithSubdomain){
@@ -132,7 +159,7 @@ void cvOneDMthModelBase::SetBoundaryConditions(){
   // Set up Inlet Dirichlet boundary condition (the default is flow rate)
   GetNodalEquationNumbers( 0, eqNumbers, 0);
   sub= subdomainList[0];
-  switch(cvOneDBFSolver::inletBCtype){
+  switch(inletType){
     case BoundCondTypeScope::FLOW:
       (*currSolution)[eqNumbers[1]] = GetFlowRate();
       break;
@@ -166,7 +193,7 @@ void cvOneDMthModelBase::SetBoundaryConditions(){
       (*currSolution)[eqNumbers[1]] = sub->GetBoundFlowRate();
       break;
     case BoundCondTypeScope::RESISTANCE:
-            if(cvOneDGlobal::CONSERVATION_FORM==0){
+            if(conservationForm==0){
         currS = (*currSolution)[eqNumbers[0]];
           currP = sub->GetMaterial()->GetPressure(currS, sub->GetLength());
         resistance = sub->GetBoundResistance();
@@ -174,7 +201,7 @@ void cvOneDMthModelBase::SetBoundaryConditions(){
         }
       break;
     case BoundCondTypeScope::RESISTANCE_TIME:
-            if(cvOneDGlobal::CONSERVATION_FORM == 0){
+            if(conservationForm == 0){
         currS = (*currSolution)[eqNumbers[0]];
           currP = sub->GetMaterial()->GetPressure(currS, sub->GetLength());
         resistance = sub->GetBoundResistance(currentTime);
@@ -196,7 +223,7 @@ double cvOneDMthModelBase::CheckMassBalance(){
   long eqNumbers[2];  // Two degress of freedom per node
   double inletFlow = GetFlowRate();
 
-  if(cvOneDBFSolver::inletBCtype == BoundCondTypeScope::FLOW){
+  if(inletType == BoundCondTypeScope::FLOW){
     inletFlow = GetFlowRate();
   }else{
    GetNodalEquationNumbers( 0, eqNumbers, 0);
@@ -209,13 +236,13 @@ double cvOneDMthModelBase::CheckMassBalance(){
     outletFlow += (*currSolution)[eqNumbers[1]];
   }
   if(cvOneDGlobal::debugMode){
-    printf("(Debug) Inlet Flow: %e\n",inletFlow);
-    printf("(Debug) Outlet Flow: %e\n",outletFlow);
+    cvOneDPrintf("(Debug) Inlet Flow: %e\n",inletFlow);
+    cvOneDPrintf("(Debug) Outlet Flow: %e\n",outletFlow);
   }
   return (inletFlow-outletFlow);
 }
 
-void cvOneDMthModelBase::ApplyBoundaryConditions(){
+void cvOneDMthModelBase::ApplyBoundaryConditions(cvOneDLinearSolver* solver){
   char propName[256];
   // Make sure this is called after you have performed the assembly of the
   // global matrix and global vectors.
@@ -229,16 +256,16 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
   double rhsBC;//changed rhs to rhsBC to avoid confusion with other "rhs" IV 052003
 
   // Brooke's BC implementation
-  if(cvOneDGlobal::CONSERVATION_FORM == 0){
+  if(conservationForm == 0){
     // Set up the inlet Dirichlet boundary condition (flow rate)
     // RHS corresponding to imposed Essential BC
     value = 0.0;
-    if(cvOneDBFSolver::inletBCtype == BoundCondTypeScope::FLOW){
+    if(inletType == BoundCondTypeScope::FLOW){
       GetNodalEquationNumbers(0, eqNumbers, 0);
-      cvOneDGlobal::solver->SetSolution(eqNumbers[1], value);
-    }else if (cvOneDBFSolver::inletBCtype == BoundCondTypeScope::PRESSURE_WAVE){
+      solver->SetSolution(eqNumbers[1], value);
+    }else if (inletType == BoundCondTypeScope::PRESSURE_WAVE){
       GetNodalEquationNumbers(0, eqNumbers, 0);
-      cvOneDGlobal::solver->SetSolution(eqNumbers[0], value);
+      solver->SetSolution(eqNumbers[0], value);
     }
 
     // Set up the correct outlet boundary condition
@@ -260,22 +287,22 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
       switch(sub->GetBoundCondition()){
         case BoundCondTypeScope::PRESSURE:
         case BoundCondTypeScope::PRESSURE_WAVE:
-          cvOneDGlobal::solver->SetSolution( eqNumbers[0], value);
+          solver->SetSolution( eqNumbers[0], value);
           break;
         case BoundCondTypeScope::FLOW:
-          cvOneDGlobal::solver->SetSolution( eqNumbers[1], value);
+          solver->SetSolution( eqNumbers[1], value);
           break;
 
         case BoundCondTypeScope::RESISTANCE:
           currS = (*currSolution)[eqNumbers[0]];// dpds shouldn't be affected by p1
           k_m = sub->GetMaterial()->GetDpDS(currS, sub->GetLength())/ sub->GetBoundResistance();
-          cvOneDGlobal::solver->Minus1dof(eqNumbers[1], k_m);
+          solver->Minus1dof(eqNumbers[1], k_m);
           break;
 
         case BoundCondTypeScope::RESISTANCE_TIME:
           currS = (*currSolution)[eqNumbers[0]];
           k_m = sub->GetMaterial()->GetDpDS(currS, sub->GetLength())/ sub->GetBoundResistance(currentTime);
-          cvOneDGlobal::solver->Minus1dof(eqNumbers[1], k_m);
+          solver->Minus1dof(eqNumbers[1], k_m);
           break;
 
         //added by IV 051403
@@ -294,7 +321,7 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
           lhs_QQ = 1;
           lhs_QS = DpDS*((1-exp(-alphaRCR*deltaTime))/(alphaRCR*Cap*Rp*Rp)-1/Rp);
           rhs_Q = -currQ + MemoC*exp(-alphaRCR*deltaTime) + currP/(Rp+Rd);
-          cvOneDGlobal::solver->DirectAppResistanceBC(eqNumbers[1], -lhs_QQ, lhs_QS, rhs_Q);//minus because of current impl of function "try"
+          solver->DirectAppResistanceBC(eqNumbers[1], -lhs_QQ, lhs_QS, rhs_Q);//minus because of current impl of function "try"
           break;
 
         default:
@@ -310,18 +337,18 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
     //IV BC implementation, to specialize Inlet&Outlet fluxes
     //+ treat Dirichlet BC for pressure and flow rate BC
     //IV 03-20-03
-    if(cvOneDGlobal::CONSERVATION_FORM == 1){
+    if(conservationForm == 1){
 
       // set up the inlet Dirichlet boundary condition (flow rate)
       // for these BC the Inlet term doesn't have to be specialized
       // so same treatment as regular Essential BC like in Brooke's
       value = 0.0;  // RHS corresponding to imposed Essential BC
-      if(cvOneDBFSolver::inletBCtype == BoundCondTypeScope::FLOW){
+      if(inletType == BoundCondTypeScope::FLOW){
         GetNodalEquationNumbers( 0, eqNumbers, 0);
-        cvOneDGlobal::solver->SetSolution( eqNumbers[1], value);
-      }else if (cvOneDBFSolver::inletBCtype == BoundCondTypeScope::PRESSURE_WAVE){
+        solver->SetSolution( eqNumbers[1], value);
+      }else if (inletType == BoundCondTypeScope::PRESSURE_WAVE){
         GetNodalEquationNumbers( 0, eqNumbers, 0);
-        cvOneDGlobal::solver->SetSolution( eqNumbers[0], value);
+        solver->SetSolution( eqNumbers[0], value);
       }
 
 
@@ -382,16 +409,22 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
         double MemoI1, MemoI2, dMemoI1dP, dMemoI2dP;
 
         value = 0.0;  // RHS corresponding to imposed Essential BC
-        switch(sub->GetBoundCondition()){
+        BoundCondType boundCond = sub->GetBoundCondition();
+        Resistance = sub->GetResistanceR(); //wgyang get resistance and Pd values;
+        pd = sub->GetResistancePd();
+        if(steadyState && GetSteadyResistance(sub, Resistance, pd)){
+          boundCond = BoundCondTypeScope::RESISTANCE;
+        }
+        switch(boundCond){
           // set up the inlet Dirichlet boundary condition (flow rate)
           // for these BC the Inlet term doesn't have to be specialized
           // so same treatment as regular Essential BC like in Brooke's
           case BoundCondTypeScope::PRESSURE:
           case BoundCondTypeScope::PRESSURE_WAVE:
-            cvOneDGlobal::solver->SetSolution( eqNumbers[0], value);
+            solver->SetSolution( eqNumbers[0], value);
             break;
           case BoundCondTypeScope::FLOW:
-            cvOneDGlobal::solver->SetSolution( eqNumbers[1], value);
+            solver->SetSolution( eqNumbers[1], value);
             break;
 
           case BoundCondTypeScope::RESISTANCE:
@@ -400,8 +433,6 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
             // double Cp = material->GetnonLinCompliance(currS, z);//tried 02-13-03 worse results
 
             //Resistance = sub->GetBoundResistance();
-            Resistance=  sub->GetResistanceR(); //wgyang get resistance and Pd values;
-            pd=sub->GetResistancePd();
 
             // for Resistance with P-P1=Q*R add to Resistance part
             // currP= material->GetPressure( currS, z)-material->p1;//for P-P1=Q*R
@@ -437,7 +468,7 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
             //  cout<<(So_*(currS-So_)/Cp-IntegralpS)/IntegralpS*100<<" "<<endl;
             //cout<<((1.0+delta)*currP*currP/currS/pow(Resistance,2))/IntegralpS*density<<endl;
 
-            cvOneDGlobal::solver->AddFlux( eqNumbers[1],&(OutletLHS[0]),&(OutletRHS[0]));//specialize the Outlet flux term in LHS and RHS
+            AddOutletFlux(solver, eqNumbers[1], OutletLHS, OutletRHS);//specialize the Outlet flux term in LHS and RHS
 
             // Essential way of treating resistance BC- as in Brooke's
             // k_m = sub->GetMaterial()->GetDpDS(currS, sub->GetLength())/ sub->GetBoundResistance();
@@ -458,7 +489,7 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
             OutletRHS[1] = deltaTime*((1.0+delta)*currP*currP/currS/pow(Resistance,2)+IntegralpS/density);
             //-kinViscosity*dpdz/Resistance);
 
-            cvOneDGlobal::solver->AddFlux( eqNumbers[1],&(OutletLHS[0]),&(OutletRHS[0]));//specialize the Outlet flux term in LHS and RHS
+            AddOutletFlux(solver, eqNumbers[1], OutletLHS, OutletRHS);//specialize the Outlet flux term in LHS and RHS
             break;
 
           case BoundCondTypeScope::RCR:
@@ -489,11 +520,22 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
 /////////////////////////////////////////////////////////////////////////////
           //RCR with Pd  wgyang 2019/4
             pd=sub->GetResistancePd();
-            convP=sub->MemIntPexp(currP, deltaTime, currentTime);
+            // the convolution is advanced with the pressure of the previous
+            // step, the current iterate need not start from it
+            if(olderSolution != NULL){
+              // BDF2: second order convolution up to the current time
+              convP=sub->MemIntPexpLinear(currP, prevP, deltaTime, currentTime);
+            }else{
+              convP=sub->MemIntPexp(prevP, deltaTime, currentTime);
+            }
             rhsQ=currP/Rp-pd/(Rp+Rd) +(InitialQ-material->GetReferencePressure()/Rp+pd/(Rp+Rd))*exp(-alphaRCR*currentTime) - convP/(Rp*Rp*Cap);
              // convP(t)=int(P(t')exp(-alphaRCR*(t-t'))dt= convP(t-dt)*exp(-alphaRCR*dt)+int^t_(t-dt) (P(t')exp(-alphaRCR(t-t'))dt,
              // assumming constant P in dt, the second term = P/alpha *(1-exp(-alphaRCR*dt)), dconvP(t-dt)/dS=0 dconvP(t)dS=dconvP/dp*DpDs=(1-exp(-alphaRCR*dt))/alpha*DpDS
-            DQDS=1.0/Rp*DpDS-(1-exp(-alphaRCR*deltaTime))/alphaRCR*DpDS/(Rp*Rp*Cap);
+            if(olderSolution != NULL){
+              DQDS=1.0/Rp*DpDS-sub->dMemIntPexpLineardP(deltaTime)*DpDS/(Rp*Rp*Cap);
+            }else{
+              DQDS=1.0/Rp*DpDS-(1-exp(-alphaRCR*deltaTime))/alphaRCR*DpDS/(Rp*Rp*Cap);
+            }
 
             OutletRHS[0]=deltaTime*rhsQ;
             OutletRHS[1]=deltaTime*((1.0+delta)*rhsQ*rhsQ/currS+IntegralpS/density);
@@ -502,7 +544,7 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
             OutletLHS[2] = -deltaTime*(DpDS*currS/density)+deltaTime*(1+delta)*(rhsQ*rhsQ)/(currS*currS)-2.0*(1+delta)*rhsQ/currS*DQDS*deltaTime;
             OutletLHS[3] = 0.0;
 /////////////////////////////////////////////////////////////////////////
-            cvOneDGlobal::solver->AddFlux( eqNumbers[1],&(OutletLHS[0]),&(OutletRHS[0]));//specialize the Outlet flux term in LHS and RHS
+            AddOutletFlux(solver, eqNumbers[1], OutletLHS, OutletRHS);//specialize the Outlet flux term in LHS and RHS
 
             /* //essential implementation tried like resistance and resistance_other->not ok
             MemoC = sub->MemC(currP, prevP, deltaTime, currentTime);//need MemC to be public
@@ -569,7 +611,7 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
 
             //viscosity term ignored;
 
-            cvOneDGlobal::solver->AddFlux( eqNumbers[1],&(OutletLHS[0]),&(OutletRHS[0]));//specialize the Outlet flux term in LHS and RHS
+            AddOutletFlux(solver, eqNumbers[1], OutletLHS, OutletRHS);//specialize the Outlet flux term in LHS and RHS
             break;
 
 
@@ -585,8 +627,42 @@ void cvOneDMthModelBase::ApplyBoundaryConditions(){
 }//end ApplyBC
 
 
+// The outlet flux terms are integrated over the step like the segment
+// equations, so BDF2 weights them the same way
+void cvOneDMthModelBase::AddOutletFlux(cvOneDLinearSolver* solver, long eqNumber, double* OutletLHS, double* OutletRHS){
+  for(int k = 0; k < 4; k++){
+    OutletLHS[k] *= stepWeight;
+  }
+  OutletRHS[0] *= stepWeight;
+  OutletRHS[1] *= stepWeight;
+  solver->AddFlux(eqNumber, OutletLHS, OutletRHS);
+}
+
+// The outlet models reduce to their total resistance once the flow is
+// steady, the coronary model adds P_v to the outlet pressure
+bool cvOneDMthModelBase::GetSteadyResistance(cvOneDSubdomain* sub, double& resistance, double& pd){
+  switch(sub->GetBoundCondition()){
+    case BoundCondTypeScope::RESISTANCE_TIME:
+      resistance = sub->GetMeanBoundResistance();
+      pd = 0.0;
+      return true;
+    case BoundCondTypeScope::RCR:
+      resistance = sub->GetRp() + sub->GetRd();
+      pd = sub->GetResistancePd();
+      return true;
+    case BoundCondTypeScope::CORONARY:
+      resistance = sub->GetRa1() + sub->GetRa2() + sub->GetRv1();
+      pd = -sub->GetP_v();
+      return true;
+    default:
+      return false;
+  }
+}
+
 void cvOneDMthModelBase::SetInflowRate(double *t, double *flow, int size, double cycleT){
   int i;
+  if(flrt != NULL) delete [] flrt;
+  if(time != NULL) delete [] time;
   time = new double[size];
   flrt = new double[size];
   for(i = 0; i < size; i++){
@@ -599,6 +675,11 @@ void cvOneDMthModelBase::SetInflowRate(double *t, double *flow, int size, double
 
 double cvOneDMthModelBase::GetFlowRate(){
 
+  // Value of the coupled partner
+  if(coupledInlet){
+    return coupledInletValue;
+  }
+
   // Check if flow or time are defined
   if(time == NULL || flrt == NULL){
     cout << "ERROR: inflow information is not prescribed!"<< endl;
@@ -606,6 +687,15 @@ double cvOneDMthModelBase::GetFlowRate(){
     exit(1);
   }
 
+  // Mean of the periodic inflow
+  if(steadyState){
+    double integral = 0.0;
+    for(int i = 0; i < nFlowPts-1; i++){
+      integral += 0.5*(flrt[i] + flrt[i+1])*(time[i+1] - time[i]);
+    }
+    return integral / (time[nFlowPts-1] - time[0]);
+  }
+
   // Flow rate is assumed to be periodic
   double correctedTime = currentTime - static_cast<long>(currentTime / cycleTime) * cycleTime;
   //printf("Corrected Time: %e\n",correctedTime);
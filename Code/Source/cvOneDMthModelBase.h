@@ -49,36 +49,61 @@
 # include "cvOneDFEAMatrix.h"
 # include "cvOneDSubdomain.h"
 # include "cvOneDFEAJoint.h"
+# include "cvOneDLinearSolver.h"
 
 class cvOneDMthModelBase{
 
   public:
 
-    static int impedIncr;
-
     cvOneDMthModelBase(const cvOneDModel* modl);
     cvOneDMthModelBase(const vector<cvOneDSubdomain*>& subdList, const vector<cvOneDFEAJoint*>& jtList,
                        const vector<int>& outletList);
     virtual ~cvOneDMthModelBase();
     virtual long GetTotalNumberOfEquations() const {return numberOfEquations;}
     virtual int  GetNumberOfElementEquations() const {return 4;}
-    virtual void TimeUpdate(double pTime, double deltaT);
+    // a positive oDeltaT is the step to the older solution, for BDF2
+    virtual void TimeUpdate(double pTime, double deltaT, double oDeltaT = 0.0);
+    // drops the time derivative, deltaT only scales the equations
+    virtual void SteadyUpdate(double deltaT);
     // forms minus the global residual vector and an approximation to the global consistent tangent
     virtual void FormNewton(cvOneDFEAMatrix* lhsMatrix, cvOneDFEAVector* rhsVector) = 0;
+    // forms minus the global residual vector only, the tangent is not touched
+    virtual void FormResidual(cvOneDFEAVector* rhsVector) = 0;
     virtual void SetBoundaryConditions();
     virtual double CheckMassBalance();
-    virtual void ApplyBoundaryConditions();
+    // modifies the system of this linear solver
+    virtual void ApplyBoundaryConditions(cvOneDLinearSolver* solver);
     virtual void GetNodalEquationNumbers( long node, long* eqNumbers, long ith);
     virtual void GetEquationNumbers( long element, long* eqNumbers, long ith);
     virtual long GetUpmostEqnNumber(long ele, long ith) =0;
-    virtual void EquationInitialize(const cvOneDFEAVector* pSolution, cvOneDFEAVector* cSolution){prevSolution = pSolution; currSolution = cSolution;}
+    virtual void EquationInitialize(const cvOneDFEAVector* pSolution, cvOneDFEAVector* cSolution,
+                                    const cvOneDFEAVector* oSolution = NULL){prevSolution = pSolution; currSolution = cSolution; olderSolution = oSolution;}
     virtual void SetInflowRate(double *t, double *flow, int size, double cycleT);
+    // flow or pressure wave at the inlet, a flow rate by default
+    void SetInletType(BoundCondType type){inletType = type;}
+    // a coupled partner prescribes the inlet value in place of the table
+    void SetCoupledInlet(double value){coupledInlet = true; coupledInletValue = value;}
+    void ClearCoupledInlet(){coupledInlet = false;}
+    // the mean inflow and the total outlet resistances replace the
+    // time dependent boundary conditions
+    void SetSteadyState(bool steady){steadyState = steady;}
+    // 1 for the conservative form of the momentum equation
+    void SetConservationForm(int form){conservationForm = form;}
+    // the elements are only formed on the subdomains of this process,
+    // all of them by default
+    void SetLocalSubdomains(const vector<bool>& local){localSubdomains = local;}
     typeOfEquation GetType() const {return type;}
     double GetCycleTime() const {return cycleTime;}
 
   protected:
 
     double GetFlowRate();
+    // total resistance and distal pressure of an outlet in the steady state,
+    // false if the outlet is not replaced by a resistance
+    bool GetSteadyResistance(cvOneDSubdomain* sub, double& resistance, double& pd);
+    // outlet flux terms of ApplyBoundaryConditions, scaled for BDF2
+    void AddOutletFlux(cvOneDLinearSolver* solver, long eqNumber, double* OutletLHS, double* OutletRHS);
+    bool IsLocal(int ith) const {return localSubdomains.empty() || localSubdomains[ith];}
 
     typeOfEquation type;
     long numberOfEquations;
@@ -91,6 +116,8 @@ class cvOneDMthModelBase{
     vector<cvOneDSubdomain*> subdomainList;
     vector<cvOneDFEAJoint*> jointList;
     vector<int> outletList;
+    // subdomains whose elements are formed here, empty for all of them
+    vector<bool> localSubdomains;
     // Placement of equations in the globalsystem
     long* equationNumbers;
 
@@ -100,12 +127,29 @@ class cvOneDMthModelBase{
     // Current approximation to the solution at t_{n+1}
     cvOneDFEAVector* currSolution;
 
+    // Solution at time t_{n-1}, only set for BDF2
+    const cvOneDFEAVector* olderSolution;
+
     double previousTime;    // t_{n}
     double deltaTime;        // deltat
+
+    // BDF2 written as backward Euler: the time derivative uses
+    // prevSolution + historyWeight*(prevSolution - olderSolution) and the
+    // spatial terms are scaled by stepWeight, 0 and 1 for backward Euler
+    double historyWeight;
+    double stepWeight;
+    // weight of the time derivative, 0 in a steady solve
+    double massWeight;
     double currentTime;    // t_{n+1}
     double *flrt, *time;
+    BoundCondType inletType;
     double cycleTime;
     int  nFlowPts; // added by bnsteel
+    int impedIncr;
+    bool steadyState;
+    int conservationForm;
+    bool coupledInlet;
+    double coupledInletValue;
 
 };
 
@@ -40,13 +40,12 @@
 // kinematic viscosity
 #define SMALL_KINEMATIC_VISCOSITY 0.0001
 
-int cvOneDMthSegmentModel::STABILIZATION;
-
 cvOneDMthSegmentModel::cvOneDMthSegmentModel(const vector<cvOneDSubdomain*>& subdList,
                                              const vector<cvOneDFEAJoint*>& jtList,
                                              const vector<int>& outletList, long quadPoints_):
                        cvOneDMthModelBase(subdList, jtList, outletList), quadrature_(quadPoints_){
   quadPoints = quadPoints_;
+  STABILIZATION = 0;
   weight = new double[quadPoints];
   xi = new double[quadPoints];
 }
@@ -72,6 +71,9 @@ void cvOneDMthSegmentModel::FormNewton(cvOneDFEAMatrix* lhsMatrix, cvOneDFEAVect
 
 	// no boundary related terms
 	for(int i = 0; i < subdomainList.size(); i++){
+		if(!IsLocal(i)){
+			continue;
+		}
 		for(long element = 0; element < subdomainList[i]->GetNumberOfElements();element++){
 			// analytical jacobian (missing terms)
 //			FormElement(element, i, &elementVector, &elementMatrix, true, true);
@@ -84,6 +86,24 @@ void cvOneDMthSegmentModel::FormNewton(cvOneDFEAMatrix* lhsMatrix, cvOneDFEAVect
 	}
 }
 
+void cvOneDMthSegmentModel::FormResidual(cvOneDFEAVector* rhsVector){
+	rhsVector->Clear();
+
+	cvOneDFEAVector elementVector(4, "eRhsVector");
+	cvOneDDenseMatrix elementMatrix_dummy(4, "eLhsMatrix_dummy");
+
+	// no boundary related terms
+	for(int i = 0; i < subdomainList.size(); i++){
+		if(!IsLocal(i)){
+			continue;
+		}
+		for(long element = 0; element < subdomainList[i]->GetNumberOfElements();element++){
+			FormElement(element, i, &elementVector, &elementMatrix_dummy, true, false);
+			rhsVector->Add(elementVector);
+		}
+	}
+}
+
 
 double cot(double x){
   return cos(x)/sin(x);
@@ -331,6 +351,15 @@ void cvOneDMthSegmentModel::FormElement(long element,
 	Sn[1] = prevSolution->Get(eqNumbers[2]);
 	Qn[1] = prevSolution->Get(eqNumbers[3]);
 
+	// BDF2: extrapolated previous values and a shorter effective step
+	if(historyWeight != 0.0){
+		Sn[0] += historyWeight*(Sn[0] - olderSolution->Get(eqNumbers[0]));
+		Qn[0] += historyWeight*(Qn[0] - olderSolution->Get(eqNumbers[1]));
+		Sn[1] += historyWeight*(Sn[1] - olderSolution->Get(eqNumbers[2]));
+		Qn[1] += historyWeight*(Qn[1] - olderSolution->Get(eqNumbers[3]));
+	}
+	const double dt = stepWeight*deltaTime;
+
 	// set the equation numbers for the element matrix
 	elementMatrix->SetEquationNumbers( eqNumbers);
 	elementMatrix->Clear();
@@ -375,7 +404,7 @@ void cvOneDMthSegmentModel::FormElement(long element,
 		double IntegralpS = material->GetIntegralpS( U[0], z); //0.0;
 		double IntegralpD2S = 0;
 
-		if(cvOneDGlobal::CONSERVATION_FORM==1) {
+		if(conservationForm==1) {
 			IntegralpD2S = material->GetIntegralpD2S( U[0], z); //0.0;
 		}
 
@@ -437,10 +466,10 @@ void cvOneDMthSegmentModel::FormElement(long element,
 			}
 
 			// this is actually the inverse of tau...
-			tau[0] = (2.0/deltaTime) + 2.0/h*modA[0] + modC[0];
+			tau[0] = massWeight*(2.0/deltaTime) + 2.0/h*modA[0] + modC[0];
 			tau[1] = 2.0/h*modA[1] + modC[1];
 			tau[2] = 2.0/h*modA[2] + modC[2];
-			tau[3] = (2.0/deltaTime)+2.0/h*modA[3]+12.0/(h*h)*K22+modC[3];
+			tau[3] = massWeight*(2.0/deltaTime)+2.0/h*modA[3]+12.0/(h*h)*K22+modC[3];
 
 			double det = tau[0]*tau[3]-tau[1]*tau[2];
 
@@ -458,17 +487,17 @@ void cvOneDMthSegmentModel::FormElement(long element,
 				double rDG1=0.0;
 				double rDG2=0.0;
 
-				if(cvOneDGlobal::CONSERVATION_FORM){
+				if(conservationForm){
 					// IV formulation 01-31-03
-					rDG1 = deltaTime*(DxShape[a]*F1+shape[a]*GF1)-shape[a]*(U[0]-Un[0]);
+					rDG1 = dt*(DxShape[a]*F1+shape[a]*GF1)-massWeight*shape[a]*(U[0]-Un[0]);
 					// GF2 contains NNN
-					rDG2 = deltaTime*(DxShape[a]*F2-DxShape[a]*K22*DxU[1]+shape[a]*GF2)-shape[a]*(U[1]-Un[1]);
+					rDG2 = dt*(DxShape[a]*F2-DxShape[a]*K22*DxU[1]+shape[a]*GF2)-massWeight*shape[a]*(U[1]-Un[1]);
 				}
 				else{
 					// Brooke's formulation that I am not using IV 01-31-03
-					rDG1 = deltaTime*(shape[a]*(DxU[1])-shape[a]*G1)+shape[a]*(U[0]-Un[0]);
+					rDG1 = dt*(shape[a]*(DxU[1])-shape[a]*G1)+massWeight*shape[a]*(U[0]-Un[0]);
 					// G2 contains NNN
-					rDG2 = deltaTime*(shape[a]*(A21*DxU[0]+A22*DxU[1])+DxShape[a]*K22*DxU[1]-shape[a]*G2)+shape[a]*(U[1]-Un[1]);
+					rDG2 = dt*(shape[a]*(A21*DxU[0]+A22*DxU[1])+DxShape[a]*K22*DxU[1]-shape[a]*G2)+massWeight*shape[a]*(U[1]-Un[1]);
 				}
 
 				double rGLS1 = 0.0;
@@ -498,8 +527,8 @@ void cvOneDMthSegmentModel::FormElement(long element,
 					auxc[3] = auxa[2]*tau[1]+auxa[3]*tau[3];
 
 					// sum the GLS terms to the DG terms
-					rGLS1 = deltaTime*(auxc[0]*auxb[0]+auxc[1]*auxb[1]);
-					rGLS2 = deltaTime*(auxc[2]*auxb[0]+auxc[3]*auxb[1]);
+					rGLS1 = dt*(auxc[0]*auxb[0]+auxc[1]*auxb[1]);
+					rGLS2 = dt*(auxc[2]*auxb[0]+auxc[3]*auxb[1]);
 
 				}//end stabilization
 
@@ -517,18 +546,18 @@ void cvOneDMthSegmentModel::FormElement(long element,
 				for( int b = 0; b < numberOfNodes; b++){
 
 					// DG terms
-					if(cvOneDGlobal::CONSERVATION_FORM == 1){
+					if(conservationForm == 1){
 						// IV's formulation 01-18-03
-						k11 = deltaTime*(shape[a]*CF11*shape[b])-shape[a]*shape[b];
-						k12 = deltaTime*(A12*shape[b]*DxShape[a]);
-						k21 = deltaTime*(DxShape[a]*A21*shape[b]+shape[a]*CF21*shape[b]+shape[a]*dN[0]*aux*shape[b]);
-						k22 = deltaTime*(DxShape[a]*A22*shape[b]-DxShape[a]*(K22)*DxShape[b]+shape[a]*CF22*shape[b]+shape[a]*dN[1]*aux*shape[b]) - shape[a]*shape[b];
+						k11 = dt*(shape[a]*CF11*shape[b])-massWeight*shape[a]*shape[b];
+						k12 = dt*(A12*shape[b]*DxShape[a]);
+						k21 = dt*(DxShape[a]*A21*shape[b]+shape[a]*CF21*shape[b]+shape[a]*dN[0]*aux*shape[b]);
+						k22 = dt*(DxShape[a]*A22*shape[b]-DxShape[a]*(K22)*DxShape[b]+shape[a]*CF22*shape[b]+shape[a]*dN[1]*aux*shape[b]) - massWeight*shape[a]*shape[b];
 					} else{
 						// Here is Brooke's version that I am not using IV 01-30-03
-						k11 = deltaTime*(-shape[a]*C11*shape[b])+shape[a]*shape[b];
-						k12 = deltaTime*(shape[a]*DxShape[b]);
-						k21 = deltaTime*(shape[a]*A21*DxShape[b]-shape[a]*C21*shape[b]);
-						k22 = deltaTime*(shape[a]*A22*DxShape[b]+DxShape[a]*(K22)*DxShape[b]-shape[a]*C22*shape[b]) + shape[a]*shape[b];
+						k11 = dt*(-shape[a]*C11*shape[b])+massWeight*shape[a]*shape[b];
+						k12 = dt*(shape[a]*DxShape[b]);
+						k21 = dt*(shape[a]*A21*DxShape[b]-shape[a]*C21*shape[b]);
+						k22 = dt*(shape[a]*A22*DxShape[b]+DxShape[a]*(K22)*DxShape[b]-shape[a]*C22*shape[b]) + massWeight*shape[a]*shape[b];
 					}
 
 					if(STABILIZATION == 1){
@@ -561,10 +590,10 @@ void cvOneDMthSegmentModel::FormElement(long element,
 						auxa[3] = auxc[2]*auxb[1]+auxc[3]*auxb[3];
 
 						// now sum the GLS terms to the DG terms
-						k11 += deltaTime*auxa[0];
-						k12 += deltaTime*auxa[1];
-						k21 += deltaTime*auxa[2];
-						k22 += deltaTime*auxa[3];
+						k11 += dt*auxa[0];
+						k12 += dt*auxa[1];
+						k21 += dt*auxa[2];
+						k22 += dt*auxa[3];
 
 					} // end stabilization
 
@@ -577,7 +606,7 @@ void cvOneDMthSegmentModel::FormElement(long element,
 			}
 		}
 
-		if(cvOneDGlobal::CONSERVATION_FORM){
+		if(conservationForm){
 
 			//Inlet flux term (at z=z_inlet) which is the linearized F-KU IV 01-28-03
 			if (element == 0){
@@ -598,10 +627,10 @@ void cvOneDMthSegmentModel::FormElement(long element,
 					//double Inlet22 = 2*(1.0+ delta)*aux*(1.0-(double)b)- kinViscosity*DxShape[b];
 					double Inlet22 = 2*(1.0+ delta)*aux*(1.0-(double)b);//without viscosity in flux term
 
-					elementMatrix->Add( 2*a  , 2*b  , Inlet11*deltaTime);
-					elementMatrix->Add( 2*a  , 2*b+1, Inlet12*deltaTime);
-					elementMatrix->Add( 2*a+1, 2*b  , Inlet21*deltaTime);
-					elementMatrix->Add( 2*a+1, 2*b+1, Inlet22*deltaTime);
+					elementMatrix->Add( 2*a  , 2*b  , Inlet11*dt);
+					elementMatrix->Add( 2*a  , 2*b+1, Inlet12*dt);
+					elementMatrix->Add( 2*a+1, 2*b  , Inlet21*dt);
+					elementMatrix->Add( 2*a+1, 2*b+1, Inlet22*dt);
 				}
 			}
 
@@ -624,10 +653,10 @@ void cvOneDMthSegmentModel::FormElement(long element,
 						double Outlet21 = (double)b*(-(1.0+ delta)*aux*aux + S[1]/density*DpDS);
 						double Outlet22 = 2*(1.0+ delta)*aux*(double)b ;//without viscosity in flux
 
-						elementMatrix->Add( 2*a  , 2*b  , -Outlet11*deltaTime);
-						elementMatrix->Add( 2*a  , 2*b+1, -Outlet12*deltaTime);
-						elementMatrix->Add( 2*a+1, 2*b  , -Outlet21*deltaTime);
-						elementMatrix->Add( 2*a+1, 2*b+1, -Outlet22*deltaTime);
+						elementMatrix->Add( 2*a  , 2*b  , -Outlet11*dt);
+						elementMatrix->Add( 2*a  , 2*b+1, -Outlet12*dt);
+						elementMatrix->Add( 2*a+1, 2*b  , -Outlet21*dt);
+						elementMatrix->Add( 2*a+1, 2*b+1, -Outlet22*dt);
 					}//end for
 				}//end outlet term
 			}//end for compute full flux if no outlet BC or Dirichlet BC
@@ -635,7 +664,7 @@ void cvOneDMthSegmentModel::FormElement(long element,
 	}
 
 	if (get_vec){
-		if(cvOneDGlobal::CONSERVATION_FORM){
+		if(conservationForm){
 			//Inlet flux term (at z=z_inlet) which is the linearized F-KU
 			if(element == 0){
 				long node = 0;
@@ -649,8 +678,8 @@ void cvOneDMthSegmentModel::FormElement(long element,
 
 				double InletR1 = Q[0];
 				double InletR2 = (1.0+delta)*Q[0]*aux + IntegralpS/density;//without viscosity in flux
-				elementVector->Add(2*a  , -InletR1*deltaTime);
-				elementVector->Add(2*a+1, -InletR2*deltaTime);
+				elementVector->Add(2*a  , -InletR1*dt);
+				elementVector->Add(2*a+1, -InletR2*dt);
 			}// end inlet flux
 
 			if(bound==BoundCondTypeScope::NOBOUND||bound==BoundCondTypeScope::PRESSURE
@@ -681,8 +710,8 @@ void cvOneDMthSegmentModel::FormElement(long element,
 	        // double Cp = material->GetnonLinCompliance( S[1],z);//tried 02-13-03 worse results
 	        double OutletR2 = S[1]*S[1]/(2.0*density*Cp) - pow(material->GetArea(material->p1,z),2)/(2*density*Cp);//linear downstream domain-Hughes
 					 */
-					elementVector->Add( 2*a  , OutletR1*deltaTime);
-					elementVector->Add( 2*a+1, OutletR2*deltaTime);
+					elementVector->Add( 2*a  , OutletR1*dt);
+					elementVector->Add( 2*a+1, OutletR2*dt);
 				}//end outlet flux term
 			}//end if no outletBC or Dirichlet
 		}//end   if(CONSERVATION_FORM)
@@ -29,41 +29,45 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef CVONEDMTHSEGMENTMODEL_H
-#define CVONEDMTHSEGMENTMODEL_H
-
-//
-//  cvOneDMthSegmentModel.h
-//  ~~~~~~~~~~~~
-//  This class is a derived class of mthModelBase. It handles the mathematical formulations
-//  of segment model. Essentially it creates the stiffness matrix and
-//  right-hand side for each element
-//
-
-
-# include <iostream>
-
-# include "cvOneDMthModelBase.h"
-# include "cvOneDUtility.h"
-
-class cvOneDMthSegmentModel : public cvOneDMthModelBase{
-
-  public:
-
-    cvOneDMthSegmentModel(const vector<cvOneDSubdomain*> &subdList,
-                          const vector<cvOneDFEAJoint*> &jtList,
-                          const vector<int> &outletList,
-                          long quadPoints_);
-    ~cvOneDMthSegmentModel();
+#ifndef CVONEDMTHSEGMENTMODEL_H
+#define CVONEDMTHSEGMENTMODEL_H
+
+//
+//  cvOneDMthSegmentModel.h
+//  ~~~~~~~~~~~~
+//  This class is a derived class of mthModelBase. It handles the mathematical formulations
+//  of segment model. Essentially it creates the stiffness matrix and
+//  right-hand side for each element
+//
+
+
+# include <iostream>
+
+# include "cvOneDMthModelBase.h"
+# include "cvOneDUtility.h"
+
+class cvOneDMthSegmentModel : public cvOneDMthModelBase{
+
+  public:
+
+    cvOneDMthSegmentModel(const vector<cvOneDSubdomain*> &subdList,
+                          const vector<cvOneDFEAJoint*> &jtList,
+                          const vector<int> &outletList,
+                          long quadPoints_);
+    ~cvOneDMthSegmentModel();
 
     // forms minus the global residual vector and an approximation to the global consistent tangent
     void FormNewton(cvOneDFEAMatrix* lhsMatrix, cvOneDFEAVector* rhsVector);
-    void SetEquationNumbers( long element, cvOneDDenseMatrix* elementMatrix, int ith);
-    long GetUpmostEqnNumber(long ele, long ith) { return -2;}
-    // 1=Brooke's one, 0=none IV 04-28-03
-    static int STABILIZATION;
-
-  private:
+    // forms minus the global residual vector only
+    void FormResidual(cvOneDFEAVector* rhsVector);
+    void SetEquationNumbers( long element, cvOneDDenseMatrix* elementMatrix, int ith);
+    long GetUpmostEqnNumber(long ele, long ith) { return -2;}
+    // 1=Brooke's one, 0=none IV 04-28-03
+    void SetStabilization(int stab){STABILIZATION = stab;}
+
+  private:
+
+    int STABILIZATION;
 
     void FormElement_FD(long element,
     					long ith,
@@ -74,19 +78,19 @@ class cvOneDMthSegmentModel : public cvOneDMthModelBase{
 					 cvOneDFEAVector* elementVector,
 					 cvOneDDenseMatrix* elementMatrix,
 					 bool get_vec,
-					 bool get_mat);
-    void FormMixedBCLHS(int ith, cvOneDSubdomain* sub, cvOneDDenseMatrix* elementMatrix){;}
-    void FormMixedBCRHS(int ith, cvOneDSubdomain* sub, cvOneDDenseMatrix* elementMatrix){;}
-    double N_Stenosis( long ith);
+					 bool get_mat);
+    void FormMixedBCLHS(int ith, cvOneDSubdomain* sub, cvOneDDenseMatrix* elementMatrix){;}
+    void FormMixedBCRHS(int ith, cvOneDSubdomain* sub, cvOneDDenseMatrix* elementMatrix){;}
+    double N_Stenosis( long ith);
     void N_MinorLoss(long ith, double* N_vec);
-    double GetInflowRate();
-
-  private:
-
-    long quadPoints;
-    double* weight;
-    double* xi;
-    cvOneDQuadrature quadrature_;
-};
-
-#endif // CVONEDMTHSEGMENTMODEL_H
+    double GetInflowRate();
+
+  private:
+
+    long quadPoints;
+    double* weight;
+    double* xi;
+    cvOneDQuadrature quadrature_;
+};
+
+#endif // CVONEDMTHSEGMENTMODEL_H
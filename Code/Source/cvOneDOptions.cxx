@@ -30,6 +30,7 @@
  */
 
 #include "cvOneDOptions.h"
+#include "cvOneDUtility.h"
 
 namespace cvOneD{
 
@@ -123,8 +124,8 @@ namespace{
       nodeDist = sqrt(dx*dx + dy*dy + dz*dz);
     }
     if(inconsistencyFound){
-      printf("WARNING: Inconsistency detected between segment length and end node distance.\n");
-      printf("Changing the segment lengths.\n");
+      cvOneDPrintf("WARNING: Inconsistency detected between segment length and end node distance.\n");
+      cvOneDPrintf("Changing the segment lengths.\n");
     }
   }
 
@@ -116,6 +116,91 @@ struct options{
     int    useIV;
     int    useStab;
 
+    // Optional nonlinear solver settings: NEWTON (default) assembles
+    // and factors the tangent, JFNK solves the corrections matrix-free,
+    // MODIFIED_NEWTON reuses the tangent factored at the last refresh
+    std::optional<string> nonlinearSolver = std::nullopt;
+    std::optional<int>    krylovRestart = std::nullopt;
+    std::optional<double> krylovTolerance = std::nullopt;
+    std::optional<long>   preconditionerRefresh = std::nullopt;
+
+    // Optional initial guess of the Newton iterations: NONE (the previous
+    // solution), LINEAR or QUADRATIC extrapolation, or CYCLE for the
+    // change over the same step of the previous cycle
+    std::optional<string> solutionPredictor = std::nullopt;
+
+    // Optional Anderson mixing of the Newton corrections: number of
+    // previous corrections combined, zero turns it off
+    std::optional<int>    andersonDepth = std::nullopt;
+
+    // Optional backtracking line search on the Newton updates: maximum
+    // number of step halvings, zero turns it off
+    std::optional<int>    lineSearch = std::nullopt;
+
+    // Optional time discretization: BACKWARD_EULER (default) or BDF2,
+    // which requires useStab 0
+    std::optional<string> timeIntegrator = std::nullopt;
+
+    // Optional linearly implicit stepping: fixed number of linear solves
+    // per time step without a convergence check, zero iterates to
+    // convergence as before
+    std::optional<int>    linearSolves = std::nullopt;
+
+    // Optional solver engine: IMPLICIT_FEM (default) or EXPLICIT_FV, the
+    // explicit finite volumes take their own steps at courantNumber and
+    // only use timeStep and stepSize for the output
+    std::optional<string> solverEngine = std::nullopt;
+    std::optional<double> courantNumber = std::nullopt;
+
+    // Optional steady state with the mean inflow and the total outlet
+    // resistances: NONE (default), INITIAL_CONDITION to start the time
+    // loop from it, or ONLY to write it as the single result
+    std::optional<string> steadyState = std::nullopt;
+
+    // Optional warm start: result file prefix (the model name, with its
+    // directory) of a previous text run, whose last saved step is mapped
+    // by segment name and relative position onto this mesh
+    std::optional<string> warmStart = std::nullopt;
+
+    // Optional adaptive time stepping: timeStep is then the initial step
+    // and, unless minTimeStep is given, the smallest one; output is still
+    // written every timeStep*stepSize. The stabilization weakens with the
+    // step, so a model that fails with fixed steps of minTimeStep fails
+    // once the controller reaches it too.
+    std::optional<int>    adaptiveTimeStep = std::nullopt;
+    std::optional<double> timeStepTolerance = std::nullopt;
+    std::optional<double> minTimeStep = std::nullopt;
+    std::optional<double> maxTimeStep = std::nullopt;
+
+    // Optional early termination: stop once successive cardiac cycles
+    // differ by less than this relative tolerance, only the last cycle
+    // is then written
+    std::optional<double> periodicTolerance = std::nullopt;
+
+    // Optional shooting for the periodic state: after the first cycle,
+    // Newton-Krylov iterations on the cycle map replace marching, only
+    // the periodic cycle is written
+    std::optional<int>    periodicShooting = std::nullopt;
+
+    // Optional Parareal iterations over the cardiac cycles: maximum number
+    // of iterations, zero turns it off. The coarse propagator takes steps
+    // pararealCoarseFactor times larger, the fine ones run concurrently on
+    // pararealWorkers threads, by default one per core
+    std::optional<int>    parareal = std::nullopt;
+    std::optional<int>    pararealCoarseFactor = std::nullopt;
+    std::optional<int>    pararealWorkers = std::nullopt;
+
+    // Optional waveform relaxation: the network is cut at the joints named
+    // in waveformCuts into subtrees, integrated separately over windows of
+    // waveformWindow steps and iterated on the pressures and flow rates at
+    // the cuts, JACOBI all at once on their own threads or GAUSS_SEIDEL
+    // from the inlet downstream. JACOBI takes more sweeps, about 1.6 times
+    // as many on bifurcation_RCR, and only gains with subtrees of similar
+    // cost on separate cores. NONE (default) solves the whole network
+    std::optional<string> waveformRelaxation = std::nullopt;
+    std::optional<cvStringVec> waveformCuts = std::nullopt;
+    std::optional<long>   waveformWindow = std::nullopt;
+
     // These are to preserve legacy behavior and are 
     // expected to be eventually migrated into a 
     // post-processing step.
@@ -4,6 +4,7 @@
 
 #include <nlohmann/json.hpp>
 
+#include "cvOneDOptionsJsonParser.h"
 #include "cvOneDOptionsJsonSerializer.h"
 
 using json = nlohmann::ordered_json;
@@ -206,6 +207,82 @@ void parseSolverOptions(const nlohmann::ordered_json& jsonData, options& opts) t
     opts.useIV = solverOptions.at("useIV").get<int>();
     opts.useStab = solverOptions.at("useStab").get<int>();
 
+    if(solverOptions.contains("nonlinearSolver")){
+        opts.nonlinearSolver = solverOptions.at("nonlinearSolver").get<std::string>();
+    }
+    if(solverOptions.contains("krylovRestart")){
+        opts.krylovRestart = solverOptions.at("krylovRestart").get<int>();
+    }
+    if(solverOptions.contains("krylovTolerance")){
+        opts.krylovTolerance = solverOptions.at("krylovTolerance").get<double>();
+    }
+    if(solverOptions.contains("preconditionerRefresh")){
+        opts.preconditionerRefresh = solverOptions.at("preconditionerRefresh").get<long>();
+    }
+    if(solverOptions.contains("solutionPredictor")){
+        opts.solutionPredictor = solverOptions.at("solutionPredictor").get<std::string>();
+    }
+    if(solverOptions.contains("andersonDepth")){
+        opts.andersonDepth = solverOptions.at("andersonDepth").get<int>();
+    }
+    if(solverOptions.contains("lineSearch")){
+        opts.lineSearch = solverOptions.at("lineSearch").get<int>();
+    }
+    if(solverOptions.contains("timeIntegrator")){
+        opts.timeIntegrator = solverOptions.at("timeIntegrator").get<std::string>();
+    }
+    if(solverOptions.contains("linearSolves")){
+        opts.linearSolves = solverOptions.at("linearSolves").get<int>();
+    }
+    if(solverOptions.contains("solverEngine")){
+        opts.solverEngine = solverOptions.at("solverEngine").get<std::string>();
+    }
+    if(solverOptions.contains("courantNumber")){
+        opts.courantNumber = solverOptions.at("courantNumber").get<double>();
+    }
+    if(solverOptions.contains("steadyState")){
+        opts.steadyState = solverOptions.at("steadyState").get<std::string>();
+    }
+    if(solverOptions.contains("warmStart")){
+        opts.warmStart = solverOptions.at("warmStart").get<std::string>();
+    }
+    if(solverOptions.contains("adaptiveTimeStep")){
+        opts.adaptiveTimeStep = solverOptions.at("adaptiveTimeStep").get<int>();
+    }
+    if(solverOptions.contains("timeStepTolerance")){
+        opts.timeStepTolerance = solverOptions.at("timeStepTolerance").get<double>();
+    }
+    if(solverOptions.contains("minTimeStep")){
+        opts.minTimeStep = solverOptions.at("minTimeStep").get<double>();
+    }
+    if(solverOptions.contains("maxTimeStep")){
+        opts.maxTimeStep = solverOptions.at("maxTimeStep").get<double>();
+    }
+    if(solverOptions.contains("periodicTolerance")){
+        opts.periodicTolerance = solverOptions.at("periodicTolerance").get<double>();
+    }
+    if(solverOptions.contains("periodicShooting")){
+        opts.periodicShooting = solverOptions.at("periodicShooting").get<int>();
+    }
+    if(solverOptions.contains("parareal")){
+        opts.parareal = solverOptions.at("parareal").get<int>();
+    }
+    if(solverOptions.contains("pararealCoarseFactor")){
+        opts.pararealCoarseFactor = solverOptions.at("pararealCoarseFactor").get<int>();
+    }
+    if(solverOptions.contains("pararealWorkers")){
+        opts.pararealWorkers = solverOptions.at("pararealWorkers").get<int>();
+    }
+    if(solverOptions.contains("waveformRelaxation")){
+        opts.waveformRelaxation = solverOptions.at("waveformRelaxation").get<std::string>();
+    }
+    if(solverOptions.contains("waveformCuts")){
+        opts.waveformCuts = solverOptions.at("waveformCuts").get<cvStringVec>();
+    }
+    if(solverOptions.contains("waveformWindow")){
+        opts.waveformWindow = solverOptions.at("waveformWindow").get<long>();
+    }
+
     // Until this is migrated elsewhere, we'll (optionally) store the solver options.
     if(solverOptions.contains("outputType")){
         opts.outputType = solverOptions.at("outputType").get<std::string>();    
@@ -218,6 +295,8 @@ void parseSolverOptions(const nlohmann::ordered_json& jsonData, options& opts) t
     throw std::runtime_error("Error parsing 'solverOptions': " + std::string(e.what()));
 }
 
+} // namespace
+
 options parseJsonOptions(const std::string& jsonString) {
     json jsonData;
     options opts;
@@ -239,8 +318,6 @@ options parseJsonOptions(const std::string& jsonString) {
     return opts;
 }
 
-} // namespace
-
 options readJsonOptions(std::string const& inputFile){
     auto const jsonStr = readFileContents(inputFile);
 
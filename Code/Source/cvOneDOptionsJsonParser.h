@@ -41,6 +41,9 @@ namespace cvOneD{
 
 options readJsonOptions(string const& inputFile);
 
+// Options from the text of a JSON input
+options parseJsonOptions(string const& jsonString);
+
 } // namespace cvOneD
 
 #endif // CVONEDOPTIONSJSONPARSER_H
@@ -219,6 +219,82 @@ nlohmann::ordered_json serializeSolverOptions(options const& opts) {
     solverOptions["useIV"] = opts.useIV;
     solverOptions["useStab"] = opts.useStab;
 
+    if(opts.nonlinearSolver){
+        solverOptions["nonlinearSolver"] = *opts.nonlinearSolver;
+    }
+    if(opts.krylovRestart){
+        solverOptions["krylovRestart"] = *opts.krylovRestart;
+    }
+    if(opts.krylovTolerance){
+        solverOptions["krylovTolerance"] = *opts.krylovTolerance;
+    }
+    if(opts.preconditionerRefresh){
+        solverOptions["preconditionerRefresh"] = *opts.preconditionerRefresh;
+    }
+    if(opts.solutionPredictor){
+        solverOptions["solutionPredictor"] = *opts.solutionPredictor;
+    }
+    if(opts.andersonDepth){
+        solverOptions["andersonDepth"] = *opts.andersonDepth;
+    }
+    if(opts.lineSearch){
+        solverOptions["lineSearch"] = *opts.lineSearch;
+    }
+    if(opts.timeIntegrator){
+        solverOptions["timeIntegrator"] = *opts.timeIntegrator;
+    }
+    if(opts.linearSolves){
+        solverOptions["linearSolves"] = *opts.linearSolves;
+    }
+    if(opts.solverEngine){
+        solverOptions["solverEngine"] = *opts.solverEngine;
+    }
+    if(opts.courantNumber){
+        solverOptions["courantNumber"] = *opts.courantNumber;
+    }
+    if(opts.steadyState){
+        solverOptions["steadyState"] = *opts.steadyState;
+    }
+    if(opts.warmStart){
+        solverOptions["warmStart"] = *opts.warmStart;
+    }
+    if(opts.adaptiveTimeStep){
+        solverOptions["adaptiveTimeStep"] = *opts.adaptiveTimeStep;
+    }
+    if(opts.timeStepTolerance){
+        solverOptions["timeStepTolerance"] = *opts.timeStepTolerance;
+    }
+    if(opts.minTimeStep){
+        solverOptions["minTimeStep"] = *opts.minTimeStep;
+    }
+    if(opts.maxTimeStep){
+        solverOptions["maxTimeStep"] = *opts.maxTimeStep;
+    }
+    if(opts.periodicTolerance){
+        solverOptions["periodicTolerance"] = *opts.periodicTolerance;
+    }
+    if(opts.periodicShooting){
+        solverOptions["periodicShooting"] = *opts.periodicShooting;
+    }
+    if(opts.parareal){
+        solverOptions["parareal"] = *opts.parareal;
+    }
+    if(opts.pararealCoarseFactor){
+        solverOptions["pararealCoarseFactor"] = *opts.pararealCoarseFactor;
+    }
+    if(opts.pararealWorkers){
+        solverOptions["pararealWorkers"] = *opts.pararealWorkers;
+    }
+    if(opts.waveformRelaxation){
+        solverOptions["waveformRelaxation"] = *opts.waveformRelaxation;
+    }
+    if(opts.waveformCuts){
+        solverOptions["waveformCuts"] = *opts.waveformCuts;
+    }
+    if(opts.waveformWindow){
+        solverOptions["waveformWindow"] = *opts.waveformWindow;
+    }
+
     // For now, we're serializing the output data.
     // In the future, we'll want to migrate these.
     solverOptions["outputType"] = opts.outputType;
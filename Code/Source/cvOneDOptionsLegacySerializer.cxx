@@ -459,6 +459,85 @@ void printSolverOptions(options const& opts,FILE* f){
   fprintf(f,"CONVERGENCE TOLERANCE: %f\n",opts.convergenceTolerance);
   fprintf(f,"USE IV: %d\n",opts.useIV);
   fprintf(f,"USE STABILIZATION: %d\n",opts.useStab);
+  if(opts.nonlinearSolver){
+    fprintf(f,"NONLINEAR SOLVER: %s\n",opts.nonlinearSolver->c_str());
+  }
+  if(opts.krylovRestart){
+    fprintf(f,"KRYLOV RESTART: %d\n",*opts.krylovRestart);
+  }
+  if(opts.krylovTolerance){
+    fprintf(f,"KRYLOV TOLERANCE: %e\n",*opts.krylovTolerance);
+  }
+  if(opts.preconditionerRefresh){
+    fprintf(f,"PRECONDITIONER REFRESH: %ld\n",*opts.preconditionerRefresh);
+  }
+  if(opts.solutionPredictor){
+    fprintf(f,"SOLUTION PREDICTOR: %s\n",opts.solutionPredictor->c_str());
+  }
+  if(opts.andersonDepth){
+    fprintf(f,"ANDERSON DEPTH: %d\n",*opts.andersonDepth);
+  }
+  if(opts.lineSearch){
+    fprintf(f,"LINE SEARCH: %d\n",*opts.lineSearch);
+  }
+  if(opts.timeIntegrator){
+    fprintf(f,"TIME INTEGRATOR: %s\n",opts.timeIntegrator->c_str());
+  }
+  if(opts.linearSolves){
+    fprintf(f,"LINEAR SOLVES: %d\n",*opts.linearSolves);
+  }
+  if(opts.solverEngine){
+    fprintf(f,"SOLVER ENGINE: %s\n",opts.solverEngine->c_str());
+  }
+  if(opts.courantNumber){
+    fprintf(f,"COURANT NUMBER: %e\n",*opts.courantNumber);
+  }
+  if(opts.steadyState){
+    fprintf(f,"STEADY STATE: %s\n",opts.steadyState->c_str());
+  }
+  if(opts.warmStart){
+    fprintf(f,"WARM START: %s\n",opts.warmStart->c_str());
+  }
+  if(opts.adaptiveTimeStep){
+    fprintf(f,"ADAPTIVE TIME STEP: %d\n",*opts.adaptiveTimeStep);
+  }
+  if(opts.timeStepTolerance){
+    fprintf(f,"TIME STEP TOLERANCE: %e\n",*opts.timeStepTolerance);
+  }
+  if(opts.minTimeStep){
+    fprintf(f,"MIN TIME STEP: %e\n",*opts.minTimeStep);
+  }
+  if(opts.maxTimeStep){
+    fprintf(f,"MAX TIME STEP: %e\n",*opts.maxTimeStep);
+  }
+  if(opts.periodicTolerance){
+    fprintf(f,"PERIODIC TOLERANCE: %e\n",*opts.periodicTolerance);
+  }
+  if(opts.periodicShooting){
+    fprintf(f,"PERIODIC SHOOTING: %d\n",*opts.periodicShooting);
+  }
+  if(opts.parareal){
+    fprintf(f,"PARAREAL: %d\n",*opts.parareal);
+  }
+  if(opts.pararealCoarseFactor){
+    fprintf(f,"PARAREAL COARSE FACTOR: %d\n",*opts.pararealCoarseFactor);
+  }
+  if(opts.pararealWorkers){
+    fprintf(f,"PARAREAL WORKERS: %d\n",*opts.pararealWorkers);
+  }
+  if(opts.waveformRelaxation){
+    fprintf(f,"WAVEFORM RELAXATION: %s\n",opts.waveformRelaxation->c_str());
+  }
+  if(opts.waveformCuts){
+    fprintf(f,"WAVEFORM CUTS:");
+    for(size_t loopA=0;loopA<opts.waveformCuts->size();loopA++){
+      fprintf(f," %s",(*opts.waveformCuts)[loopA].c_str());
+    }
+    fprintf(f,"\n");
+  }
+  if(opts.waveformWindow){
+    fprintf(f,"WAVEFORM WINDOW: %ld\n",*opts.waveformWindow);
+  }
 }
 
 // PRINT MATERIAL DATA
@@ -0,0 +1,217 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDPeriodicShooting.cxx - Source for a Newton-Krylov Shooting Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  Inexact Newton on the cycle map residual. The unknowns are scaled by
+//  the typical size of each entry, GMRES is not restarted and stops at a
+//  fixed fraction of the residual, since every product costs a cycle.
+//
+
+# include <cmath>
+# include <iostream>
+
+# include "cvOneDPeriodicShooting.h"
+
+// change of the scaled state in the directional differences
+#define SHOOTING_FD_STEP 1.0e-6
+// GMRES stops at this fraction of the Newton residual
+#define SHOOTING_FORCING 1.0e-2
+
+cvOneDPeriodicShooting::cvOneDPeriodicShooting(cvOneDCycleMapFunction map){
+  cycleMap = map;
+  tolerance = 1.0e-4;
+  maxIterations = 10;
+  krylovDimension = 20;
+  numberOfCycles = 0;
+  residual = 0.0;
+}
+
+void cvOneDPeriodicShooting::SetTolerance(double tol){
+  tolerance = tol;
+}
+
+void cvOneDPeriodicShooting::SetMaxIterations(int its){
+  maxIterations = its;
+}
+
+void cvOneDPeriodicShooting::SetKrylovDimension(int dim){
+  krylovDimension = dim;
+}
+
+void cvOneDPeriodicShooting::SetScale(const vector<double>& s){
+  scale = s;
+}
+
+double cvOneDPeriodicShooting::MaxNorm(const vector<double>& v) const{
+  double norm = 0.0;
+  for(size_t i = 0; i < v.size(); i++){
+    norm = max(norm, fabs(v[i]));
+  }
+  return norm;
+}
+
+void cvOneDPeriodicShooting::Evaluate(const vector<double>& start, vector<double>& end, vector<double>& res){
+  cycleMap(start, end);
+  numberOfCycles++;
+  for(size_t i = 0; i < start.size(); i++){
+    res[i] = (end[i] - start[i]) / scale[i];
+  }
+}
+
+bool cvOneDPeriodicShooting::Solve(vector<double>& state){
+  size_t n = state.size();
+  if(scale.size() != n){
+    scale.assign(n, 1.0);
+  }
+  numberOfCycles = 0;
+
+  vector<double> end(n), res(n), correction(n);
+  Evaluate(state, end, res);
+  residual = MaxNorm(res);
+
+  for(int iter = 0; ; iter++){
+    cout << "  Shooting iteration " << iter << ": periodicity residual = " << residual << endl;
+    if(residual < tolerance){
+      return true;
+    }
+    if(iter >= maxIterations){
+      return false;
+    }
+    SolveCorrection(state, end, res, correction);
+    for(size_t i = 0; i < n; i++){
+      state[i] += correction[i] * scale[i];
+    }
+    Evaluate(state, end, res);
+    residual = MaxNorm(res);
+  }
+}
+
+// GMRES on the scaled tangent J*v = (map(x + h*v) - map(x))/h - v,
+// starting from zero, with the same Givens rotated Hessenberg update
+// as the linear Krylov solver
+void cvOneDPeriodicShooting::SolveCorrection(const vector<double>& state, const vector<double>& end,
+                                             const vector<double>& res, vector<double>& correction){
+  size_t n = state.size();
+  int m = krylovDimension;
+  int j, k;
+
+  vector<vector<double> > V(m+1, vector<double>(n));
+  vector<double> H((m+1)*m, 0.0);
+  vector<double> cs(m), sn(m), g(m+1, 0.0), y(m);
+  vector<double> shifted(n), shiftedEnd(n);
+
+  double beta = 0.0;
+  for(size_t i = 0; i < n; i++){
+    V[0][i] = -res[i];
+    beta += res[i] * res[i];
+  }
+  beta = sqrt(beta);
+  correction.assign(n, 0.0);
+  if(beta == 0.0){
+    return;
+  }
+  for(size_t i = 0; i < n; i++){
+    V[0][i] /= beta;
+  }
+  g[0] = beta;
+  double target = SHOOTING_FORCING * beta;
+
+  for(k = 0; k < m; k++){
+    vector<double>& vk = V[k];
+    vector<double>& vn = V[k+1];
+    for(size_t i = 0; i < n; i++){
+      shifted[i] = state[i] + SHOOTING_FD_STEP * vk[i] * scale[i];
+    }
+    cycleMap(shifted, shiftedEnd);
+    numberOfCycles++;
+    for(size_t i = 0; i < n; i++){
+      vn[i] = (shiftedEnd[i] - end[i]) / (SHOOTING_FD_STEP * scale[i]) - vk[i];
+    }
+
+    // modified Gram-Schmidt
+    for(j = 0; j <= k; j++){
+      double h = 0.0;
+      for(size_t i = 0; i < n; i++){
+        h += vn[i] * V[j][i];
+      }
+      H[j*m+k] = h;
+      for(size_t i = 0; i < n; i++){
+        vn[i] -= h * V[j][i];
+      }
+    }
+    double hn = 0.0;
+    for(size_t i = 0; i < n; i++){
+      hn += vn[i] * vn[i];
+    }
+    hn = sqrt(hn);
+    if(hn > 0.0){
+      for(size_t i = 0; i < n; i++){
+        vn[i] /= hn;
+      }
+    }
+
+    for(j = 0; j < k; j++){
+      double h0 = H[j*m+k];
+      double h1 = H[(j+1)*m+k];
+      H[j*m+k]     =  cs[j]*h0 + sn[j]*h1;
+      H[(j+1)*m+k] = -sn[j]*h0 + cs[j]*h1;
+    }
+    double hk = H[k*m+k];
+    double r = sqrt(hk*hk + hn*hn);
+    cs[k] = hk/r;
+    sn[k] = hn/r;
+    H[k*m+k] = r;
+    g[k+1] = -sn[k]*g[k];
+    g[k]   =  cs[k]*g[k];
+
+    if(fabs(g[k+1]) <= target || hn == 0.0){
+      k++;
+      break;
+    }
+  }
+
+  // correction = V * y, with H*y = g
+  for(j = k-1; j >= 0; j--){
+    double sum = g[j];
+    for(int l = j+1; l < k; l++){
+      sum -= H[j*m+l]*y[l];
+    }
+    y[j] = sum/H[j*m+j];
+  }
+  for(j = 0; j < k; j++){
+    for(size_t i = 0; i < n; i++){
+      correction[i] += y[j] * V[j][i];
+    }
+  }
+}
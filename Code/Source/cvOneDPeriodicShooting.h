@@ -0,0 +1,95 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDPERIODICSHOOTING_H
+#define CVONEDPERIODICSHOOTING_H
+
+//
+//  cvOneDPeriodicShooting.h - Header for a Newton-Krylov Shooting Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  This class finds the periodic state as the fixed point of the map from
+//  the state at the start of a cycle to the state one cycle later. The
+//  residual map(x) - x is solved with Newton, each correction with GMRES
+//  whose products are directional differences of one more cycle, so the
+//  tangent (monodromy matrix minus identity) is never formed. Slowly
+//  decaying modes, like those of RCR and coronary outlets, only add a few
+//  GMRES iterations instead of many cycles of marching.
+//
+
+# include <vector>
+# include <functional>
+
+using namespace std;
+
+// integrates one cycle from the state start, end gets the final state
+typedef std::function<void(const vector<double>& start, vector<double>& end)> cvOneDCycleMapFunction;
+
+class cvOneDPeriodicShooting{
+
+  public:
+
+    cvOneDPeriodicShooting(cvOneDCycleMapFunction map);
+
+    // largest change over a cycle, relative to the scale, for convergence
+    void SetTolerance(double tolerance);
+    void SetMaxIterations(int iterations);
+    void SetKrylovDimension(int dimension);
+    // typical size of every state entry, the default is one
+    void SetScale(const vector<double>& scale);
+
+    // state is the initial guess on entry and the start of the last cycle
+    // integrated on exit, returns true if it is periodic within tolerance
+    bool Solve(vector<double>& state);
+
+    int GetNumberOfCycles() const {return numberOfCycles;}
+    double GetResidual() const {return residual;}
+
+  private:
+
+    // one cycle from start, returns the scaled residual end - start
+    void Evaluate(const vector<double>& start, vector<double>& end, vector<double>& res);
+    double MaxNorm(const vector<double>& v) const;
+    // approximately solves (monodromy - I)*dx = -res in scaled unknowns
+    void SolveCorrection(const vector<double>& state, const vector<double>& end,
+                         const vector<double>& res, vector<double>& correction);
+
+    cvOneDCycleMapFunction cycleMap;
+    double tolerance;
+    int maxIterations;
+    int krylovDimension;
+    vector<double> scale;
+
+    int numberOfCycles;
+    double residual;
+};
+
+#endif // CVONEDPERIODICSHOOTING_H
@@ -0,0 +1,275 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDResultFile.cxx - Source for the Indexed Binary Result File
+//  ~~~~~~~~~~~~~~~~~~~~
+//
+
+# include <string.h>
+# include <sys/types.h>
+# include <algorithm>
+
+# include "cvOneDResultFile.h"
+# include "cvOneDException.h"
+
+namespace {
+
+const char FILE_MAGIC[8] = {'O','N','E','D','R','E','S','1'};
+const int64_t FILE_VERSION = 1;
+const int FIELD_NAME_LENGTH = 16;
+// the index offset follows the magic and five integers of the header
+const int64_t INDEX_POSITION_OFFSET = 8 + 5*sizeof(int64_t);
+// values of one field in a chunk, about half a megabyte
+const long CHUNK_VALUES = 65536;
+
+void writeOrThrow(FILE* file, const void* data, size_t size, size_t count){
+  if(count > 0 && fwrite(data, size, count, file) != count){
+    throw cvException("ERROR: Cannot write the result file.\n");
+  }
+}
+
+void readOrThrow(FILE* file, void* data, size_t size, size_t count){
+  if(count > 0 && fread(data, size, count, file) != count){
+    throw cvException("ERROR: Cannot read the result file.\n");
+  }
+}
+
+void writeInteger(FILE* file, int64_t value){
+  writeOrThrow(file, &value, sizeof(int64_t), 1);
+}
+
+int64_t readInteger(FILE* file){
+  int64_t value;
+  readOrThrow(file, &value, sizeof(int64_t), 1);
+  return value;
+}
+
+} // namespace
+
+const char* cvOneDResultFile::GetFieldName(int field){
+  static const char* names[NUM_FIELDS] = {"flow", "area", "pressure", "Re", "wss"};
+  if(field < 0 || field >= NUM_FIELDS){
+    throw cvException("ERROR: Invalid result field.\n");
+  }
+  return names[field];
+}
+
+// ======
+// WRITER
+// ======
+cvOneDResultFileWriter::cvOneDResultFileWriter(const string& fileName, const cvDoubleVec& times,
+                                               const cvStringVec& segmentNames, const cvLongVec& segmentNodes){
+  if(segmentNames.size() != segmentNodes.size()){
+    throw cvException("ERROR: Invalid segments of the result file.\n");
+  }
+  numSteps = times.size();
+  nodes = segmentNodes;
+  long maxNodes = 1;
+  for(size_t i = 0; i < nodes.size(); i++){
+    maxNodes = max(maxNodes, nodes[i]);
+  }
+  stepsPerChunk = max(1L, CHUNK_VALUES/maxNodes);
+  numChunks = (numSteps + stepsPerChunk - 1)/stepsPerChunk;
+  index.assign(nodes.size()*numChunks*cvOneDResultFile::NUM_FIELDS, -1);
+
+  file = fopen(fileName.c_str(), "wb");
+  if(file == NULL){
+    throw cvException(string("ERROR: Cannot open the result file " + fileName + ".\n").c_str());
+  }
+  writeOrThrow(file, FILE_MAGIC, 1, sizeof(FILE_MAGIC));
+  writeInteger(file, FILE_VERSION);
+  writeInteger(file, nodes.size());
+  writeInteger(file, numSteps);
+  writeInteger(file, cvOneDResultFile::NUM_FIELDS);
+  writeInteger(file, stepsPerChunk);
+  // the offset of the index is known once the chunks are written
+  writeInteger(file, 0);
+  writeOrThrow(file, times.data(), sizeof(double), numSteps);
+  for(int f = 0; f < cvOneDResultFile::NUM_FIELDS; f++){
+    char name[FIELD_NAME_LENGTH];
+    memset(name, 0, FIELD_NAME_LENGTH);
+    strncpy(name, cvOneDResultFile::GetFieldName(f), FIELD_NAME_LENGTH - 1);
+    writeOrThrow(file, name, 1, FIELD_NAME_LENGTH);
+  }
+  for(size_t i = 0; i < nodes.size(); i++){
+    writeInteger(file, nodes[i]);
+    writeInteger(file, segmentNames[i].size());
+    writeOrThrow(file, segmentNames[i].data(), 1, segmentNames[i].size());
+  }
+}
+
+cvOneDResultFileWriter::~cvOneDResultFileWriter(){
+  if(file != NULL){
+    fclose(file);
+  }
+}
+
+void cvOneDResultFileWriter::WriteChunk(long segment, long chunk, const double* values){
+  if(file == NULL || segment < 0 || segment >= (long)nodes.size() || chunk < 0 || chunk >= numChunks){
+    throw cvException("ERROR: Invalid chunk of the result file.\n");
+  }
+  long steps = min(stepsPerChunk, numSteps - chunk*stepsPerChunk);
+  long fieldValues = steps*nodes[segment];
+  int64_t position = ftello(file);
+  for(int f = 0; f < cvOneDResultFile::NUM_FIELDS; f++){
+    index[(segment*numChunks + chunk)*cvOneDResultFile::NUM_FIELDS + f] = position + f*fieldValues*sizeof(double);
+  }
+  writeOrThrow(file, values, sizeof(double), cvOneDResultFile::NUM_FIELDS*fieldValues);
+}
+
+void cvOneDResultFileWriter::Close(){
+  if(file == NULL){
+    return;
+  }
+  if(find(index.begin(), index.end(), -1) != index.end()){
+    throw cvException("ERROR: Chunks are missing from the result file.\n");
+  }
+  int64_t indexPosition = ftello(file);
+  writeOrThrow(file, index.data(), sizeof(int64_t), index.size());
+  if(fseeko(file, INDEX_POSITION_OFFSET, SEEK_SET) != 0){
+    throw cvException("ERROR: Cannot write the result file.\n");
+  }
+  writeInteger(file, indexPosition);
+  if(fclose(file) != 0){
+    file = NULL;
+    throw cvException("ERROR: Cannot write the result file.\n");
+  }
+  file = NULL;
+}
+
+// ======
+// READER
+// ======
+cvOneDResultFileReader::cvOneDResultFileReader(const string& fileName){
+  file = fopen(fileName.c_str(), "rb");
+  if(file == NULL){
+    throw cvException(string("ERROR: Cannot open the result file " + fileName + ".\n").c_str());
+  }
+  try{
+    char magic[sizeof(FILE_MAGIC)];
+    readOrThrow(file, magic, 1, sizeof(FILE_MAGIC));
+    if(memcmp(magic, FILE_MAGIC, sizeof(FILE_MAGIC)) != 0 || readInteger(file) != FILE_VERSION){
+      throw cvException(string("ERROR: " + fileName + " is not a result file of this version.\n").c_str());
+    }
+    long numSegments = readInteger(file);
+    long numSteps = readInteger(file);
+    if(readInteger(file) != cvOneDResultFile::NUM_FIELDS){
+      throw cvException("ERROR: Invalid fields of the result file.\n");
+    }
+    stepsPerChunk = readInteger(file);
+    int64_t indexPosition = readInteger(file);
+    if(numSegments < 0 || numSteps < 0 || stepsPerChunk < 1 || indexPosition <= 0){
+      throw cvException("ERROR: Invalid header of the result file.\n");
+    }
+    numChunks = (numSteps + stepsPerChunk - 1)/stepsPerChunk;
+
+    times.resize(numSteps);
+    readOrThrow(file, times.data(), sizeof(double), numSteps);
+    char fieldNames[cvOneDResultFile::NUM_FIELDS*FIELD_NAME_LENGTH];
+    readOrThrow(file, fieldNames, 1, sizeof(fieldNames));
+    names.resize(numSegments);
+    nodes.resize(numSegments);
+    for(long i = 0; i < numSegments; i++){
+      nodes[i] = readInteger(file);
+      names[i].resize(readInteger(file));
+      readOrThrow(file, &names[i][0], 1, names[i].size());
+    }
+
+    index.resize(numSegments*numChunks*cvOneDResultFile::NUM_FIELDS);
+    if(fseeko(file, indexPosition, SEEK_SET) != 0){
+      throw cvException("ERROR: Cannot read the result file.\n");
+    }
+    readOrThrow(file, index.data(), sizeof(int64_t), index.size());
+  }catch(...){
+    fclose(file);
+    throw;
+  }
+}
+
+cvOneDResultFileReader::~cvOneDResultFileReader(){
+  fclose(file);
+}
+
+string cvOneDResultFileReader::GetSegmentName(long segment){
+  if(segment < 0 || segment >= GetNumberOfSegments()){
+    throw cvException("ERROR: Invalid segment index.\n");
+  }
+  return names[segment];
+}
+
+long cvOneDResultFileReader::GetSegmentIndex(const string& name){
+  for(size_t i = 0; i < names.size(); i++){
+    if(names[i] == name){
+      return i;
+    }
+  }
+  throw cvException(string("ERROR: No segment is named " + name + ".\n").c_str());
+}
+
+long cvOneDResultFileReader::GetNumberOfNodes(long segment){
+  GetSegmentName(segment);
+  return nodes[segment];
+}
+
+long cvOneDResultFileReader::GetFieldIndex(const string& name){
+  for(int f = 0; f < cvOneDResultFile::NUM_FIELDS; f++){
+    if(name == cvOneDResultFile::GetFieldName(f)){
+      return f;
+    }
+  }
+  throw cvException(string("ERROR: Invalid result field " + name + ".\n").c_str());
+}
+
+void cvOneDResultFileReader::Read(long segment, long field, long firstStep, long numSteps, cvDoubleVec& values){
+  long segNodes = GetNumberOfNodes(segment);
+  cvOneDResultFile::GetFieldName(field);
+  if(firstStep < 0 || numSteps < 0 || firstStep + numSteps > GetNumberOfSteps()){
+    throw cvException("ERROR: Invalid steps of the result file.\n");
+  }
+  values.resize(numSteps*segNodes);
+  long step = firstStep;
+  long done = 0;
+  while(done < numSteps){
+    // the steps of the range held by this chunk are contiguous in it
+    long chunk = step/stepsPerChunk;
+    long chunkSteps = min(stepsPerChunk, GetNumberOfSteps() - chunk*stepsPerChunk);
+    long count = min(numSteps - done, chunkSteps - (step - chunk*stepsPerChunk));
+    int64_t position = index[(segment*numChunks + chunk)*cvOneDResultFile::NUM_FIELDS + field] +
+                       (step - chunk*stepsPerChunk)*segNodes*sizeof(double);
+    if(fseeko(file, position, SEEK_SET) != 0){
+      throw cvException("ERROR: Cannot read the result file.\n");
+    }
+    readOrThrow(file, &values[done*segNodes], sizeof(double), count*segNodes);
+    step += count;
+    done += count;
+  }
+}
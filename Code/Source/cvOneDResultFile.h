@@ -0,0 +1,143 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDRESULTFILE_H
+#define CVONEDRESULTFILE_H
+
+//
+//  cvOneDResultFile.h - Header for the Indexed Binary Result File
+//  ~~~~~~~~~~~~~~~~~~
+//
+//  All the results of a model in a single file, instead of five text
+//  files per segment. The values of a segment are cut into chunks of
+//  consecutive saved steps, each written at once, and an index of the
+//  chunks closes the file, so that any range of steps of a field of a
+//  segment is read with one seek per chunk it spans.
+//
+//  Layout, in 64 bit integers and doubles of the host byte order:
+//
+//    "ONEDRES1", version, segments, steps, fields, steps per chunk,
+//    offset of the index
+//    time of each saved step
+//    16 character name of each field
+//    nodes, name length and name of each segment
+//    chunks: for each segment and chunk, each field in turn holds the
+//            node values of each of its steps in turn
+//    index: offset of each field of each chunk of each segment
+//
+
+# include <stdio.h>
+# include <stdint.h>
+# include <string>
+# include <vector>
+
+# include "cvOneDTypes.h"
+
+using namespace std;
+
+namespace cvOneDResultFile{
+
+// the fields of a segment, in the order of their chunks
+enum Field{FLOW = 0, AREA = 1, PRESSURE = 2, REYNOLDS = 3, WSS = 4, NUM_FIELDS = 5};
+
+// the suffix of the text result file of a field
+const char* GetFieldName(int field);
+
+} // namespace cvOneDResultFile
+
+class cvOneDResultFileWriter{
+
+  public:
+
+    // writes the header, the segments follow the order of the results
+    cvOneDResultFileWriter(const string& fileName, const cvDoubleVec& times,
+                           const cvStringVec& segmentNames, const cvLongVec& segmentNodes);
+    ~cvOneDResultFileWriter();
+
+    long GetStepsPerChunk(){return stepsPerChunk;}
+    long GetNumberOfChunks(){return numChunks;}
+
+    // the values of all fields of a chunk of a segment, laid out as in
+    // the file; the chunks may come in any order
+    void WriteChunk(long segment, long chunk, const double* values);
+    // writes the index once all chunks are written
+    void Close();
+
+  private:
+
+    FILE* file;
+    long numSteps;
+    long stepsPerChunk;
+    long numChunks;
+    cvLongVec nodes;
+    vector<int64_t> index;
+
+    cvOneDResultFileWriter(const cvOneDResultFileWriter&);
+    cvOneDResultFileWriter& operator=(const cvOneDResultFileWriter&);
+};
+
+class cvOneDResultFileReader{
+
+  public:
+
+    // reads the header and the index, throws if the file is not valid
+    cvOneDResultFileReader(const string& fileName);
+    ~cvOneDResultFileReader();
+
+    long GetNumberOfSegments(){return names.size();}
+    string GetSegmentName(long segment);
+    // throws if no segment has the name
+    long GetSegmentIndex(const string& name);
+    long GetNumberOfNodes(long segment);
+    long GetNumberOfSteps(){return times.size();}
+    const cvDoubleVec& GetTimes(){return times;}
+    // field of a name of GetFieldName, throws if there is none
+    long GetFieldIndex(const string& name);
+
+    // The values of a field of a segment from firstStep, numSteps of
+    // them: the node values of each step in turn
+    void Read(long segment, long field, long firstStep, long numSteps, cvDoubleVec& values);
+
+  private:
+
+    FILE* file;
+    long stepsPerChunk;
+    long numChunks;
+    cvDoubleVec times;
+    cvStringVec names;
+    cvLongVec nodes;
+    vector<int64_t> index;
+
+    cvOneDResultFileReader(const cvOneDResultFileReader&);
+    cvOneDResultFileReader& operator=(const cvOneDResultFileReader&);
+};
+
+#endif // CVONEDRESULTFILE_H
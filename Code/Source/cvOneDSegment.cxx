@@ -42,7 +42,7 @@
 #include "cvOneDMthModelBase.h"
 
 // Static Declarations
-long cvOneDSegment::NumSegments;
+std::atomic<long> cvOneDSegment::NumSegments(0);
 
 cvOneDSegment::cvOneDSegment(){
 
@@ -39,6 +39,8 @@
 //  This the C representation of a model segment.  
 //
 
+#include <atomic>
+
 #include "cvOneDEnums.h"
 #include "cvOneDMesh.h"
 
@@ -255,7 +257,7 @@ class cvOneDSegment{
     bool isTesselated;
 
     // How Many Segments?
-    static long NumSegments;
+    static std::atomic<long> NumSegments;
 
     // Some other info
     double InitialPressure;
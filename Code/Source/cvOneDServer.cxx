@@ -0,0 +1,369 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDServer.cxx - Source for the Solver Daemon on a Local Socket
+//  ~~~~~~~~~~~~~~~~
+//
+
+# include <errno.h>
+# include <stdio.h>
+# include <string.h>
+# include <unistd.h>
+# include <sys/socket.h>
+# include <sys/stat.h>
+# include <sys/un.h>
+# include <condition_variable>
+# include <fstream>
+# include <memory>
+# include <queue>
+# include <sstream>
+# include <thread>
+# include <vector>
+# include <nlohmann/json.hpp>
+
+# include "cvOneDServer.h"
+# include "cvOneDContext.h"
+# include "cvOneDBFSolver.h"
+# include "cvOneDOptionsJsonParser.h"
+# include "cvOneDUtility.h"
+# include "cvOneDException.h"
+
+namespace{
+
+bool SendMessage(int connection, const nlohmann::json& message){
+  string line = message.dump() + "\n";
+  size_t sent = 0;
+  while(sent < line.size()){
+    // a client that went away must not stop the server with SIGPIPE
+    ssize_t count = send(connection, line.data() + sent, line.size() - sent, MSG_NOSIGNAL);
+    if(count < 0 && errno == EINTR){
+      continue;
+    }
+    if(count <= 0){
+      return false;
+    }
+    sent += count;
+  }
+  return true;
+}
+
+// pending keeps what was read past the end of the message
+bool ReadMessage(int connection, string& pending, nlohmann::json& message){
+  size_t end;
+  char buffer[65536];
+  while((end = pending.find('\n')) == string::npos){
+    ssize_t count = recv(connection, buffer, sizeof(buffer), 0);
+    if(count < 0 && errno == EINTR){
+      continue;
+    }
+    if(count <= 0){
+      return false;
+    }
+    pending.append(buffer, count);
+  }
+  message = nlohmann::json::parse(pending.substr(0, end));
+  pending.erase(0, end + 1);
+  return true;
+}
+
+sockaddr_un SocketAddress(const string& socketPath){
+  sockaddr_un address;
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if(socketPath.size() >= sizeof(address.sun_path)){
+    throw cvException(("ERROR: Socket path too long: " + socketPath + ".\n").c_str());
+  }
+  strcpy(address.sun_path, socketPath.c_str());
+  return address;
+}
+
+int Connect(const string& socketPath){
+  sockaddr_un address = SocketAddress(socketPath);
+  int connection = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(connection < 0 || connect(connection, (sockaddr*)&address, sizeof(address)) < 0){
+    if(connection >= 0){
+      close(connection);
+    }
+    throw cvException(("ERROR: Cannot connect to the server at " + socketPath + ".\n").c_str());
+  }
+  return connection;
+}
+
+// A socket left at the path by a server that is gone is removed. Any
+// other file, or the socket of a server that still accepts connections,
+// is kept and the new server refuses to start.
+void RemoveStaleSocket(const string& socketPath){
+  struct stat info;
+  if(lstat(socketPath.c_str(), &info) != 0){
+    if(errno == ENOENT){
+      return;
+    }
+    throw cvException(("ERROR: Cannot check the socket path " + socketPath + ".\n").c_str());
+  }
+  if(!S_ISSOCK(info.st_mode)){
+    throw cvException(("ERROR: " + socketPath + " exists and is not a socket.\n").c_str());
+  }
+  sockaddr_un address = SocketAddress(socketPath);
+  int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(probe < 0){
+    throw cvException(("ERROR: Cannot check the socket path " + socketPath + ".\n").c_str());
+  }
+  bool listening = (connect(probe, (sockaddr*)&address, sizeof(address)) == 0);
+  int error = errno;
+  close(probe);
+  if(listening){
+    throw cvException(("ERROR: A server is already listening on " + socketPath + ".\n").c_str());
+  }
+  // only a socket nobody listens on refuses the connection
+  if(error != ECONNREFUSED){
+    throw cvException(("ERROR: Cannot check the socket path " + socketPath + ".\n").c_str());
+  }
+  if(unlink(socketPath.c_str()) != 0 && errno != ENOENT){
+    throw cvException(("ERROR: Cannot remove the stale socket " + socketPath + ".\n").c_str());
+  }
+}
+
+} // namespace
+
+cvOneDServer::cvOneDServer(const string& path){
+  socketPath = path;
+  stopping = false;
+}
+
+void cvOneDServer::SetWorkers(int count){
+  if(count < 0){
+    throw cvException("ERROR: Invalid number of server workers.\n");
+  }
+  workers = count;
+}
+
+void cvOneDServer::SetCacheSize(long size){
+  if(size < 0){
+    throw cvException("ERROR: Invalid server cache size.\n");
+  }
+  cacheSize = size;
+}
+
+void cvOneDServer::Serve(const JobSolver& solveJob){
+  sockaddr_un address = SocketAddress(socketPath);
+  RemoveStaleSocket(socketPath);
+  listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(listener < 0 || bind(listener, (sockaddr*)&address, sizeof(address)) < 0 || listen(listener, SOMAXCONN) < 0){
+    if(listener >= 0){
+      close(listener);
+      listener = -1;
+    }
+    throw cvException(("ERROR: Cannot listen on " + socketPath + ".\n").c_str());
+  }
+
+  size_t count = workers > 0 ? workers : thread::hardware_concurrency();
+  count = max((size_t)1, count);
+  printf("Serving on %s with %zu Workers ...\n", socketPath.c_str(), count);
+  fflush(stdout);
+
+  mutex queueLock;
+  condition_variable queued;
+  queue<int> connections;
+  vector<thread> pool;
+  for(size_t w = 0; w < count; w++){
+    pool.push_back(thread([&](){
+      while(true){
+        int connection;
+        {
+          unique_lock<mutex> guard(queueLock);
+          queued.wait(guard, [&](){return stopping || !connections.empty();});
+          if(connections.empty()){
+            return;
+          }
+          connection = connections.front();
+          connections.pop();
+        }
+        HandleConnection(connection, solveJob);
+        close(connection);
+      }
+    }));
+  }
+
+  while(!stopping){
+    int connection = accept(listener, NULL, NULL);
+    if(connection < 0){
+      if(stopping){
+        break;
+      }
+      if(errno == EINTR || errno == ECONNABORTED){
+        continue;
+      }
+      stopping = true;
+      break;
+    }
+    lock_guard<mutex> guard(queueLock);
+    connections.push(connection);
+    queued.notify_one();
+  }
+
+  // the connections already accepted are still served
+  {
+    lock_guard<mutex> guard(queueLock);
+    queued.notify_all();
+  }
+  for(size_t w = 0; w < pool.size(); w++){
+    pool[w].join();
+  }
+  close(listener);
+  unlink(socketPath.c_str());
+  printf("Server Stopped.\n");
+}
+
+void cvOneDServer::HandleConnection(int connection, const JobSolver& solveJob){
+  string pending;
+  nlohmann::json request;
+  try{
+    while(ReadMessage(connection, pending, request)){
+      string type = request.at("type").get<string>();
+      if(type == "run"){
+        RunJob(connection, request.at("input").get<string>(), solveJob);
+      }else if(type == "stop"){
+        stopping = true;
+        // wakes up the accept of the server loop
+        shutdown(listener, SHUT_RDWR);
+        SendMessage(connection, {{"type", "done"}, {"cached", false}});
+        return;
+      }else{
+        SendMessage(connection, {{"type", "error"}, {"message", "ERROR: Unknown request " + type + "."}});
+      }
+    }
+  }catch(const nlohmann::json::exception& e){
+    SendMessage(connection, {{"type", "error"}, {"message", string("ERROR: Invalid request: ") + e.what()}});
+  }
+}
+
+// Options of an input, parsed and validated once
+bool cvOneDServer::GetOptions(const string& input, cvOneD::options& opts){
+  {
+    lock_guard<mutex> guard(cacheLock);
+    auto found = cache.find(input);
+    if(found != cache.end()){
+      opts = found->second;
+      return true;
+    }
+  }
+  opts = cvOneD::parseJsonOptions(input);
+  cvOneD::validateOptions(opts);
+  if(upper_string(opts.outputType) != "TEXT"){
+    throw cvException("ERROR: The server only returns TEXT results.\n");
+  }
+  if(cacheSize > 0){
+    lock_guard<mutex> guard(cacheLock);
+    auto inserted = cache.insert(make_pair(input, opts));
+    if(inserted.second){
+      cacheOrder.push_back(&inserted.first->first);
+      if((long)cacheOrder.size() > cacheSize){
+        cache.erase(*cacheOrder.front());
+        cacheOrder.pop_front();
+      }
+    }
+  }
+  return false;
+}
+
+void cvOneDServer::RunJob(int connection, const string& input, const JobSolver& solveJob){
+  try{
+    cvOneD::options opts;
+    bool cached = GetOptions(input, opts);
+    // the results are streamed, not written by the solver
+    opts.outputType = "NONE";
+
+    cvOneDContext context;
+    cvOneDContext::Scope scope(&context);
+    solveJob(opts);
+
+    vector<pair<string, shared_ptr<ostringstream> > > files;
+    context.solver->WriteTextResults([&](const string& fileName){
+      shared_ptr<ostringstream> file(new ostringstream());
+      files.push_back(make_pair(fileName, file));
+      return shared_ptr<ostream>(file);
+    });
+    for(size_t i = 0; i < files.size(); i++){
+      if(!SendMessage(connection, {{"type", "file"}, {"name", files[i].first}, {"content", files[i].second->str()}})){
+        return;
+      }
+    }
+    SendMessage(connection, {{"type", "done"}, {"cached", cached}});
+  }catch(exception& e){
+    string message = e.what();
+    // the messages of the solver end with a new line
+    while(!message.empty() && message.back() == '\n'){
+      message.pop_back();
+    }
+    SendMessage(connection, {{"type", "error"}, {"message", message}});
+  }
+}
+
+bool cvOneDServer::SubmitJob(const string& socketPath, const string& jsonInput){
+  ifstream file(jsonInput.c_str());
+  if(!file){
+    throw cvException(("ERROR: Cannot open input file " + jsonInput + ".\n").c_str());
+  }
+  stringstream input;
+  input << file.rdbuf();
+
+  int connection = Connect(socketPath);
+  string pending;
+  nlohmann::json message;
+  SendMessage(connection, {{"type", "run"}, {"input", input.str()}});
+  while(ReadMessage(connection, pending, message)){
+    string type = message.at("type").get<string>();
+    if(type == "file"){
+      string fileName = message.at("name").get<string>();
+      ofstream result(fileName.c_str(), ios::out);
+      result << message.at("content").get<string>();
+      cout << fileName << endl;
+    }else if(type == "done"){
+      close(connection);
+      return message.at("cached").get<bool>();
+    }else{
+      close(connection);
+      throw cvException((message.at("message").get<string>() + "\n").c_str());
+    }
+  }
+  close(connection);
+  throw cvException("ERROR: The server closed the connection.\n");
+}
+
+void cvOneDServer::StopServer(const string& socketPath){
+  int connection = Connect(socketPath);
+  string pending;
+  nlohmann::json message;
+  SendMessage(connection, {{"type", "stop"}});
+  ReadMessage(connection, pending, message);
+  close(connection);
+}
@@ -0,0 +1,107 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDSERVER_H
+#define CVONEDSERVER_H
+
+//
+//  cvOneDServer.h - Header for the Solver Daemon on a Local Socket
+//  ~~~~~~~~~~~~~~
+//
+//  A long-running process accepts jobs on a Unix domain socket, each the
+//  text of a JSON input, and solves them on a pool of workers, each job
+//  in its own context. The parsed and validated options are kept by
+//  input text, so resubmitted inputs skip parsing and validation. The
+//  text result files are streamed back and written by the client where
+//  the solver itself would write them.
+//
+//  Messages are JSON objects, one per line:
+//    client: {"type": "run", "input": "<JSON input>"} or {"type": "stop"}
+//    server: {"type": "file", "name": ..., "content": ...} per result
+//            file, then {"type": "done", "cached": ...} or
+//            {"type": "error", "message": ...}
+//
+
+# include <atomic>
+# include <deque>
+# include <functional>
+# include <mutex>
+# include <string>
+# include <unordered_map>
+
+# include "cvOneDOptions.h"
+
+using namespace std;
+
+class cvOneDServer{
+
+  public:
+
+    // creates and solves the model of a job in the context bound to
+    // the calling thread
+    typedef std::function<void(const cvOneD::options&)> JobSolver;
+
+    cvOneDServer(const string& socketPath);
+
+    // zero uses one worker per core
+    void SetWorkers(int count);
+    // number of inputs whose options are kept
+    void SetCacheSize(long size);
+
+    // accepts connections until a client asks to stop, the jobs of a
+    // connection are solved one after the other by one worker
+    void Serve(const JobSolver& solveJob);
+
+    // client side: solves a JSON input file on the server listening at
+    // socketPath and writes the result files, returns whether the
+    // options of the input were cached
+    static bool SubmitJob(const string& socketPath, const string& jsonInput);
+    static void StopServer(const string& socketPath);
+
+  private:
+
+    void HandleConnection(int connection, const JobSolver& solveJob);
+    void RunJob(int connection, const string& input, const JobSolver& solveJob);
+    bool GetOptions(const string& input, cvOneD::options& opts);
+
+    string socketPath;
+    int workers = 0;
+    int listener = -1;
+    atomic<bool> stopping;
+
+    mutex cacheLock;
+    long cacheSize = 256;
+    unordered_map<string, cvOneD::options> cache;
+    // inputs in the order they were cached, the oldest go first
+    deque<const string*> cacheOrder;
+};
+
+#endif // CVONEDSERVER_H
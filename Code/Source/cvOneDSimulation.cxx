@@ -0,0 +1,865 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDSimulation.cxx - Source for Solving a Model from its Options
+//  ~~~~~~~~~~~~~~~~~~~~
+//
+
+# include <math.h>
+# include <stdio.h>
+# include <algorithm>
+
+# include "cvOneDSimulation.h"
+# include "cvOneDGlobal.h"
+# include "cvOneDContext.h"
+# include "cvOneDModelManager.h"
+# include "cvOneDBFSolver.h"
+# include "cvOneDUtility.h"
+# include "cvOneDCouplingChannel.h"
+
+// ===============================
+// CREATE MODEL AND RUN SIMULATION
+// ===============================
+namespace{
+
+// ====================================
+// GET DATA TABLE ENTRY FROM STRING KEY
+// ====================================
+int getDataTableIDFromStringKey(string key){
+  const vector<cvOneDDataTable*>& dataTables = cvOneDContext::Current()->dataTables;
+  bool found = false;
+  int count = 0;
+  while((!found)&&(count<dataTables.size())){
+    found = upper_string(key) == upper_string(dataTables[count]->getName());
+    // Update Counter
+    if(!found){
+      count++;
+    }
+  }
+  if(!found){
+    throw cvException(string("ERROR: Cannot find data table entry from string key: " + key + ".\n").c_str());
+    return -1;
+  }else{
+    return count;
+  }
+}
+
+size_t findJointNodeIndexOrThrow(const auto& jointNodeName, const auto& nodeNames, const auto& jointName){
+  // Return the index of "nodeNames" that corresponds to the "jointNodeName"
+  // or throw a context-specific error.
+
+  auto const iter = std::find(nodeNames.begin(), nodeNames.end(), jointNodeName);
+  if (iter == nodeNames.end()) {
+    std::string const errMsg = "ERROR: The node '" + jointNodeName + "' required by joint '" 
+      + jointName + "' was not found in the list of nodes.";
+    throw cvException(errMsg.c_str());
+  }
+  return std::distance(nodeNames.begin(), iter); 
+}
+
+} // namespace
+
+void cvOneD::createAndRunModel(const cvOneD::options& opts) {
+
+  // MESSAGE
+  cvOneDPrintf("\n");
+  cvOneDPrintf("Creating and Running Model ...\n");
+
+  // CREATE MODEL MANAGER
+  cvOneDModelManager* oned = new cvOneDModelManager((char*)opts.modelName.c_str());
+  const vector<cvOneDDataTable*>& dataTables = cvOneDContext::Current()->dataTables;
+
+  // CREATE NODES
+  cvOneDPrintf("Creating Nodes ... \n");
+  int totNodes = opts.nodeName.size();
+  int nodeError = CV_OK;
+  for(int loopA = 0; loopA < totNodes; loopA++) {
+    // Finally Create Joint
+    nodeError = oned->CreateNode((char*)opts.nodeName[loopA].c_str(),
+                                 opts.nodeXcoord[loopA], opts.nodeYcoord[loopA], opts.nodeZcoord[loopA]);
+    if(nodeError == CV_ERROR) {
+      throw cvException(string("ERROR: Error Creating NODE " + to_string(loopA) + "\n").c_str());
+    }
+  }
+
+  // CREATE JOINTS
+  cvOneDPrintf("Creating Joints ... \n");
+  int totJoints = opts.jointName.size();
+  int jointError = CV_OK;
+  int* asInlets = nullptr;
+  int* asOutlets = nullptr;
+  string currInletName;
+  string currOutletName;
+  int jointInletID = 0;
+  int jointOutletID = 0;
+  int totJointInlets = 0;
+  int totJointOutlets = 0;
+  for(int loopA = 0; loopA < totJoints; loopA++) {
+    // GET NAMES FOR INLET AND OUTLET
+    currInletName = opts.jointInletName[loopA];
+    currOutletName = opts.jointOutletName[loopA];
+    // FIND JOINTINLET INDEX
+    jointInletID = getListIDWithStringKey(currInletName, opts.jointInletListNames);
+    if(jointInletID < 0) {
+      throw cvException(string("ERROR: Cannot Find JOINTINLET for key " + currInletName).c_str());
+    }
+    totJointInlets = opts.jointInletListNumber[jointInletID];
+    // FIND JOINTOUTLET INDEX
+    jointOutletID = getListIDWithStringKey(currOutletName, opts.jointOutletListNames);
+    if(jointInletID < 0) {
+      throw cvException(string("ERROR: Cannot Find JOINTOUTLET for key " + currOutletName).c_str());
+    }
+    // GET TOTALS
+    totJointInlets = opts.jointInletListNumber[jointInletID];
+    totJointOutlets = opts.jointOutletListNumber[jointOutletID];
+    // ALLOCATE INLETS AND OUTLET LIST
+    asInlets = nullptr;
+    asOutlets = nullptr;
+    if(totJointInlets > 0) {
+      asInlets = new int[totJointInlets];
+      for(int loopB = 0; loopB < totJointInlets; loopB++) {
+        asInlets[loopB] = opts.jointInletList[jointInletID][loopB];
+      }
+    }
+    if(totJointOutlets > 0) {
+      asOutlets = new int[totJointOutlets];
+      for(int loopB = 0; loopB < totJointOutlets; loopB++) {
+        asOutlets[loopB] = opts.jointOutletList[jointOutletID][loopB];
+      }
+    }
+
+    // Find the index of the indicated node.
+    auto const jointName = opts.jointName.at(loopA);
+    auto const nodeIndex = findJointNodeIndexOrThrow( 
+      opts.jointNode.at(loopA), opts.nodeName, jointName);
+
+    // Finally Create Joint
+    jointError = oned->CreateJoint(jointName.c_str(),
+                                   opts.nodeXcoord[nodeIndex], opts.nodeYcoord[nodeIndex], opts.nodeZcoord[nodeIndex],
+                                   totJointInlets, totJointOutlets, asInlets, asOutlets);
+    if(jointError == CV_ERROR) {
+      throw cvException(string("ERROR: Error Creating JOINT " + to_string(loopA) + "\n").c_str());
+    }
+    // Deallocate
+    delete[] asInlets;
+    delete[] asOutlets;
+    asInlets = nullptr;
+    asOutlets = nullptr;
+  }
+
+  // CREATE MATERIAL
+  cvOneDPrintf("Creating Materials ... \n");
+  int totMaterials = opts.materialName.size();
+  int matError = CV_OK;
+  double doubleParams[3];
+  int matID = 0;
+  string currMatType = "MATERIAL_OLUFSEN";
+  int numParams = 0;
+  for(int loopA = 0; loopA < totMaterials; loopA++) {
+    if(upper_string(opts.materialType[loopA]) == "OLUFSEN") {
+      currMatType = "MATERIAL_OLUFSEN";
+      numParams = 3;
+    } else {
+      currMatType = "MATERIAL_LINEAR";
+      numParams = 1;
+    }
+    doubleParams[0] = opts.materialParam1[loopA];
+    doubleParams[1] = opts.materialParam2[loopA];
+    doubleParams[2] = opts.materialParam3[loopA];
+    // CREATE MATERIAL
+    matError = oned->CreateMaterial((char*)opts.materialName[loopA].c_str(),
+                                    (char*)currMatType.c_str(),
+                                    opts.materialDensity[loopA],
+                                    opts.materialViscosity[loopA],
+                                    opts.materialExponent[loopA],
+                                    opts.materialPRef[loopA],
+                                    numParams, doubleParams,
+                                    &matID);
+    if(matError == CV_ERROR) {
+      throw cvException(string("ERROR: Error Creating MATERIAL " + to_string(loopA) + "\n").c_str());
+    }
+
+  }
+
+  // CREATE DATATABLES
+  cvOneDPrintf("Creating Data Tables ... \n");
+  int totCurves = opts.dataTableName.size();
+  int curveError = CV_OK;
+  for(int loopA = 0; loopA < totCurves; loopA++) {
+    curveError = oned->CreateDataTable((char*)opts.dataTableName[loopA].c_str(),(char*)opts.dataTableType[loopA].c_str(), opts.dataTableVals[loopA]);
+    if(curveError == CV_ERROR) {
+      throw cvException(string("ERROR: Error Creating DATATABLE " + to_string(loopA) + "\n").c_str());
+    }
+  }
+
+  // SEGMENT DATA
+  cvOneDPrintf("Creating Segments ... \n");
+  int segmentError = CV_OK;
+  int totalSegments = opts.segmentName.size();
+  int curveTotals = 0;
+  double* curveTime = nullptr;
+  double* curveValue = nullptr;
+  string matName;
+  string curveName;
+  int currMatID = 0;
+  int dtIDX = 0;
+  for(int loopA = 0; loopA < totalSegments; loopA++) {
+
+    // GET MATERIAL
+    matName = opts.segmentMatName[loopA];
+    currMatID = getListIDWithStringKey(matName, opts.materialName);
+    if(currMatID < 0) {
+      throw cvException(string("ERROR: Cannot Find Material for key " + matName).c_str());
+    }
+
+    // GET CURVE DATA
+    curveName = opts.segmentDataTableName[loopA];
+
+    if(upper_string(curveName) != "NONE") {
+      dtIDX = getDataTableIDFromStringKey(curveName);
+      curveTotals = dataTables[dtIDX]->getSize();
+      curveTime = new double[curveTotals];
+      curveValue = new double[curveTotals];
+      for(int loopA = 0; loopA < curveTotals; loopA++) {
+        curveTime[loopA] = dataTables[dtIDX]->getTime(loopA);
+        curveValue[loopA] = dataTables[dtIDX]->getValues(loopA);
+      }
+    } else {
+      curveTotals = 1;
+      curveTime = new double[curveTotals];
+      curveValue = new double[curveTotals];
+      curveTime[0] = 0.0;
+      curveValue[0] = 0.0;
+    }
+    segmentError = oned->CreateSegment((char*)opts.segmentName[loopA].c_str(),
+                                       (long)opts.segmentID[loopA],
+                                       opts.segmentLength[loopA],
+                                       (long)opts.segmentTotEls[loopA],
+                                       (long)opts.segmentInNode[loopA],
+                                       (long)opts.segmentOutNode[loopA],
+                                       opts.segmentInInletArea[loopA],
+                                       opts.segmentInOutletArea[loopA],
+                                       opts.segmentInFlow[loopA],
+                                       currMatID,
+                                       (char*)opts.segmentLossType[loopA].c_str(),
+                                       opts.segmentBranchAngle[loopA],
+                                       opts.segmentUpstreamSegment[loopA],
+                                       opts.segmentBranchSegment[loopA],
+                                       (char*)opts.segmentBoundType[loopA].c_str(),
+                                       curveValue,
+                                       curveTime,
+                                       curveTotals);
+    if(segmentError == CV_ERROR) {
+      throw cvException(string("ERROR: Error Creating SEGMENT " + to_string(loopA) + "\n").c_str());
+    }
+    // Deallocate
+    delete[] curveTime;
+    curveTime = nullptr;
+    delete[] curveValue;
+    curveValue = nullptr;
+  }
+
+  double* vals;
+  int tot;
+
+  // SOLVE MODEL
+  cvOneDPrintf("Solving Model ... \n");
+  int solveError = CV_OK;
+  string inletCurveName = opts.inletDataTableName;
+  int inletCurveIDX = getDataTableIDFromStringKey(inletCurveName);
+  int inletCurveTotals = dataTables[inletCurveIDX]->getSize();
+  double* inletCurveTime = new double[inletCurveTotals];
+  double* inletCurveValue = new double[inletCurveTotals];
+  for(int loopB = 0; loopB < inletCurveTotals; loopB++) {
+    inletCurveTime[loopB] = dataTables[inletCurveIDX]->getTime(loopB);
+    inletCurveValue[loopB] = dataTables[inletCurveIDX]->getValues(loopB);
+  }
+  // Solve Model
+  solveError = oned->SolveModel(opts.timeStep,
+                                opts.stepSize,
+                                opts.maxStep,
+                                opts.quadPoints,
+                                inletCurveTotals,
+                                (char*)opts.boundaryType.c_str(),
+                                inletCurveValue,
+                                inletCurveTime,
+                                opts.convergenceTolerance,
+                                // Formulation Type
+                                opts.useIV,
+                                // Stabilization
+                                opts.useStab);
+  if(solveError == CV_ERROR) {
+    throw cvException(string("ERROR: Error Solving Model\n").c_str());
+  }
+  delete[] inletCurveTime;
+  delete[] inletCurveValue;
+}
+
+// =======================
+// SOLVER SETTINGS OPTIONS
+// =======================
+
+namespace {
+
+void setOutputGlobals(const cvOneD::options& opts){
+
+  cvOneDBFSolver* solver = cvOneDContext::Current()->solver;
+
+  if(upper_string(opts.outputType) == "TEXT"){
+    solver->SetOutputType(OutputTypeScope::OUTPUT_TEXT);
+  }else if(upper_string(opts.outputType) == "VTK"){
+    solver->SetOutputType(OutputTypeScope::OUTPUT_VTK);
+  }else if(upper_string(opts.outputType) == "BOTH"){
+    solver->SetOutputType(OutputTypeScope::OUTPUT_BOTH);
+  }else if(upper_string(opts.outputType) == "NONE"){
+    solver->SetOutputType(OutputTypeScope::OUTPUT_NONE);
+  }else if(upper_string(opts.outputType) == "BINARY"){
+    solver->SetOutputType(OutputTypeScope::OUTPUT_BINARY);
+  }else{
+    throw cvException("ERROR: Invalid OUTPUT Type.\n");
+  }
+
+  if(opts.vtkOutputType){
+    if(*opts.vtkOutputType > 1){
+      throw cvException("ERROR: Invalid OUTPUT VTK Type.\n");
+    }
+    solver->SetVtkOutputType(*opts.vtkOutputType);
+  }
+  
+}
+
+void setNonlinearSolverGlobals(const cvOneD::options& opts){
+
+  cvOneDBFSolver* solver = cvOneDContext::Current()->solver;
+
+  if(opts.nonlinearSolver){
+    if(upper_string(*opts.nonlinearSolver) == "NEWTON"){
+      solver->SetNonlinearSolver(NonlinearSolverTypeScope::NEWTON);
+    }else if(upper_string(*opts.nonlinearSolver) == "JFNK"){
+      solver->SetNonlinearSolver(NonlinearSolverTypeScope::JFNK);
+    }else if(upper_string(*opts.nonlinearSolver) == "MODIFIED_NEWTON"){
+      solver->SetNonlinearSolver(NonlinearSolverTypeScope::MODIFIED_NEWTON);
+    }else{
+      throw cvException("ERROR: Invalid Nonlinear Solver Type.\n");
+    }
+  }
+
+  if(opts.krylovRestart){
+    if(*opts.krylovRestart < 1){
+      throw cvException("ERROR: Invalid Krylov Restart.\n");
+    }
+    solver->SetKrylovRestart(*opts.krylovRestart);
+  }
+
+  if(opts.krylovTolerance){
+    if(*opts.krylovTolerance <= 0.0){
+      throw cvException("ERROR: Invalid Krylov Tolerance.\n");
+    }
+    solver->SetKrylovTolerance(*opts.krylovTolerance);
+  }
+
+  if(opts.preconditionerRefresh){
+    if(*opts.preconditionerRefresh < 1){
+      throw cvException("ERROR: Invalid Preconditioner Refresh.\n");
+    }
+    solver->SetPreconditionerRefresh(*opts.preconditionerRefresh);
+  }
+
+  if(opts.solutionPredictor){
+    if(upper_string(*opts.solutionPredictor) == "NONE"){
+      solver->SetSolutionPredictor(PredictorTypeScope::NONE);
+    }else if(upper_string(*opts.solutionPredictor) == "LINEAR"){
+      solver->SetSolutionPredictor(PredictorTypeScope::LINEAR);
+    }else if(upper_string(*opts.solutionPredictor) == "QUADRATIC"){
+      solver->SetSolutionPredictor(PredictorTypeScope::QUADRATIC);
+    }else if(upper_string(*opts.solutionPredictor) == "CYCLE"){
+      solver->SetSolutionPredictor(PredictorTypeScope::CYCLE);
+    }else{
+      throw cvException("ERROR: Invalid Solution Predictor.\n");
+    }
+  }
+
+  if(opts.andersonDepth){
+    if(*opts.andersonDepth < 0){
+      throw cvException("ERROR: Invalid Anderson Depth.\n");
+    }
+    solver->SetAndersonDepth(*opts.andersonDepth);
+  }
+
+  if(opts.lineSearch){
+    if(*opts.lineSearch < 0){
+      throw cvException("ERROR: Invalid Line Search.\n");
+    }
+    solver->SetLineSearch(*opts.lineSearch);
+  }
+
+}
+
+void setTimeSteppingGlobals(const cvOneD::options& opts){
+
+  cvOneDBFSolver* solver = cvOneDContext::Current()->solver;
+
+  if(opts.timeIntegrator){
+    if(upper_string(*opts.timeIntegrator) == "BACKWARD_EULER"){
+      solver->SetTimeIntegrator(TimeIntegratorTypeScope::BACKWARD_EULER);
+    }else if(upper_string(*opts.timeIntegrator) == "BDF2"){
+      // the GLS terms vanish with the step, at the shorter effective step
+      // of BDF2 the stabilized scheme is unstable at usual step sizes
+      if(opts.useStab != 0){
+        throw cvException("ERROR: The BDF2 Time Integrator requires useStab 0.\n");
+      }
+      solver->SetTimeIntegrator(TimeIntegratorTypeScope::BDF2);
+    }else{
+      throw cvException("ERROR: Invalid Time Integrator.\n");
+    }
+  }
+
+  if(opts.linearSolves){
+    if(*opts.linearSolves < 0){
+      throw cvException("ERROR: Invalid Linear Solves.\n");
+    }
+    solver->SetLinearSolves(*opts.linearSolves);
+  }
+
+  if(opts.solverEngine){
+    if(upper_string(*opts.solverEngine) == "IMPLICIT_FEM"){
+      solver->SetSolverEngine(SolverEngineTypeScope::IMPLICIT_FEM);
+    }else if(upper_string(*opts.solverEngine) == "EXPLICIT_FV"){
+      solver->SetSolverEngine(SolverEngineTypeScope::EXPLICIT_FV);
+    }else{
+      throw cvException("ERROR: Invalid Solver Engine.\n");
+    }
+  }
+
+  if(opts.courantNumber){
+    if(*opts.courantNumber <= 0.0 || *opts.courantNumber > 1.0){
+      throw cvException("ERROR: Invalid Courant Number.\n");
+    }
+    solver->SetCourantNumber(*opts.courantNumber);
+  }
+
+  if(opts.steadyState){
+    if(upper_string(*opts.steadyState) == "NONE"){
+      solver->SetSteadyState(SteadyStateTypeScope::NONE);
+    }else if(upper_string(*opts.steadyState) == "INITIAL_CONDITION"){
+      solver->SetSteadyState(SteadyStateTypeScope::INITIAL_CONDITION);
+    }else if(upper_string(*opts.steadyState) == "ONLY"){
+      solver->SetSteadyState(SteadyStateTypeScope::ONLY);
+    }else{
+      throw cvException("ERROR: Invalid Steady State.\n");
+    }
+  }
+
+  if(opts.warmStart){
+    if(opts.steadyState && upper_string(*opts.steadyState) != "NONE"){
+      throw cvException("ERROR: Warm Start cannot be combined with a Steady State.\n");
+    }
+    solver->SetWarmStart(*opts.warmStart);
+  }
+
+  if(opts.adaptiveTimeStep){
+    solver->SetAdaptiveTimeStep(*opts.adaptiveTimeStep != 0);
+  }
+
+  if(opts.timeStepTolerance){
+    if(*opts.timeStepTolerance <= 0.0){
+      throw cvException("ERROR: Invalid Time Step Tolerance.\n");
+    }
+    solver->SetTimeStepTolerance(*opts.timeStepTolerance);
+  }
+
+  if(opts.minTimeStep){
+    if(*opts.minTimeStep <= 0.0){
+      throw cvException("ERROR: Invalid Minimum Time Step.\n");
+    }
+    solver->SetMinTimeStep(*opts.minTimeStep);
+  }
+
+  if(opts.maxTimeStep){
+    if(*opts.maxTimeStep <= 0.0 || (opts.minTimeStep && *opts.maxTimeStep < *opts.minTimeStep)){
+      throw cvException("ERROR: Invalid Maximum Time Step.\n");
+    }
+    solver->SetMaxTimeStep(*opts.maxTimeStep);
+  }
+
+  if(opts.periodicTolerance){
+    if(*opts.periodicTolerance <= 0.0){
+      throw cvException("ERROR: Invalid Periodic Tolerance.\n");
+    }
+    solver->SetPeriodicTolerance(*opts.periodicTolerance);
+  }
+
+  if(opts.periodicShooting && *opts.periodicShooting != 0){
+    if(opts.adaptiveTimeStep && *opts.adaptiveTimeStep != 0){
+      throw cvException("ERROR: Periodic Shooting requires a fixed time step.\n");
+    }
+    solver->SetPeriodicShooting(true);
+  }
+
+  if(opts.parareal && *opts.parareal != 0){
+    if(*opts.parareal < 0){
+      throw cvException("ERROR: Invalid Parareal.\n");
+    }
+    if((opts.adaptiveTimeStep && *opts.adaptiveTimeStep != 0) || opts.periodicTolerance ||
+       (opts.periodicShooting && *opts.periodicShooting != 0) ||
+       (opts.solverEngine && upper_string(*opts.solverEngine) == "EXPLICIT_FV")){
+      throw cvException("ERROR: Parareal requires the implicit engine with a fixed time step and all cycles.\n");
+    }
+    solver->SetParareal(*opts.parareal);
+  }
+
+  if(opts.pararealCoarseFactor){
+    if(*opts.pararealCoarseFactor < 1){
+      throw cvException("ERROR: Invalid Parareal Coarse Factor.\n");
+    }
+    solver->SetPararealCoarseFactor(*opts.pararealCoarseFactor);
+  }
+
+  if(opts.pararealWorkers){
+    if(*opts.pararealWorkers < 0){
+      throw cvException("ERROR: Invalid Parareal Workers.\n");
+    }
+    solver->SetPararealWorkers(*opts.pararealWorkers);
+  }
+
+  if(opts.waveformRelaxation && upper_string(*opts.waveformRelaxation) != "NONE"){
+    if(upper_string(*opts.waveformRelaxation) == "JACOBI"){
+      solver->SetWaveformRelaxation(WaveformRelaxationTypeScope::JACOBI);
+    }else if(upper_string(*opts.waveformRelaxation) == "GAUSS_SEIDEL"){
+      solver->SetWaveformRelaxation(WaveformRelaxationTypeScope::GAUSS_SEIDEL);
+    }else{
+      throw cvException("ERROR: Invalid Waveform Relaxation.\n");
+    }
+    if(!opts.waveformCuts || opts.waveformCuts->empty()){
+      throw cvException("ERROR: Waveform Relaxation requires the joints to cut in Waveform Cuts.\n");
+    }
+    bool minorLoss = false;
+    for(size_t loopA = 0; loopA < opts.segmentLossType.size(); loopA++){
+      minorLoss = minorLoss || upper_string(opts.segmentLossType[loopA]) != "NONE";
+    }
+    if(minorLoss || (opts.solutionPredictor && upper_string(*opts.solutionPredictor) != "NONE") ||
+       (opts.andersonDepth && *opts.andersonDepth != 0) ||
+       (opts.adaptiveTimeStep && *opts.adaptiveTimeStep != 0) || opts.periodicTolerance ||
+       (opts.periodicShooting && *opts.periodicShooting != 0) || (opts.parareal && *opts.parareal != 0) ||
+       (opts.solverEngine && upper_string(*opts.solverEngine) == "EXPLICIT_FV")){
+      throw cvException("ERROR: Waveform Relaxation requires the implicit engine with a fixed time step, without minor losses, predictor or Anderson mixing.\n");
+    }
+    solver->SetWaveformCuts(*opts.waveformCuts);
+  }
+
+  if(opts.waveformWindow){
+    if(*opts.waveformWindow < 1){
+      throw cvException("ERROR: Invalid Waveform Window.\n");
+    }
+    solver->SetWaveformWindow(*opts.waveformWindow);
+  }
+
+  // The processes of a distributed run share one Newton tangent over
+  // their segments, while the worker threads of Parareal and Jacobi each
+  // solve a copy of the whole model in their own context, and the
+  // waveform relaxation subtrees have a numbering of their own
+  if(cvOneDGlobal::numberOfRanks > 1){
+    if((opts.nonlinearSolver && upper_string(*opts.nonlinearSolver) != "NEWTON") ||
+       (opts.solverEngine && upper_string(*opts.solverEngine) == "EXPLICIT_FV") ||
+       (opts.parareal && *opts.parareal != 0) ||
+       (opts.waveformRelaxation && upper_string(*opts.waveformRelaxation) != "NONE")){
+      throw cvException("ERROR: A distributed run requires the implicit engine with Newton, without Parareal or Waveform Relaxation.\n");
+    }
+  }
+
+}
+
+} // namespace
+
+void cvOneD::solveInCurrentContext(const cvOneD::options& opts){
+  cvOneD::validateOptions(opts);
+  setOutputGlobals(opts);
+  setNonlinearSolverGlobals(opts);
+  setTimeSteppingGlobals(opts);
+  // the workers of Parareal and Jacobi waveform relaxation create the same
+  // model in their own contexts, without writing results
+  cvOneD::options workerOpts = opts;
+  workerOpts.outputType = "NONE";
+  cvOneDContext::Current()->solver->SetWorkerFactory([workerOpts](){
+    cvOneD::solveInCurrentContext(workerOpts);
+  });
+  createAndRunModel(opts);
+}
+
+// ==================
+// SIMULATION MEMBERS
+// ==================
+cvOneDSimulation::cvOneDSimulation(const cvOneD::options& options){
+  cvOneD::validateOptions(options);
+  opts = options;
+  context.reset(new cvOneDContext());
+  solved = false;
+  stepping = false;
+}
+
+cvOneDSimulation::~cvOneDSimulation(){
+}
+
+void cvOneDSimulation::Run(){
+  if(solved || stepping){
+    throw cvException("ERROR: The simulation was already solved.\n");
+  }
+  cvOneDContext::Scope scope(context.get());
+  cvOneD::solveInCurrentContext(opts);
+  solved = true;
+}
+
+void cvOneDSimulation::CheckSolved(){
+  if(!solved && !stepping){
+    throw cvException("ERROR: The simulation has no results before it is solved.\n");
+  }
+}
+
+long cvOneDSimulation::GetNumberOfSegments(){
+  CheckSolved();
+  return context->solver->GetModelPtr()->getNumberOfSegments();
+}
+
+string cvOneDSimulation::GetSegmentName(long segment){
+  if(segment < 0 || segment >= GetNumberOfSegments()){
+    throw cvException("ERROR: Invalid segment index.\n");
+  }
+  return context->solver->GetModelPtr()->getSegment(segment)->getSegmentName();
+}
+
+long cvOneDSimulation::GetSegmentIndex(const string& name){
+  long count = GetNumberOfSegments();
+  for(long loopA = 0; loopA < count; loopA++){
+    if(upper_string(GetSegmentName(loopA)) == upper_string(name)){
+      return loopA;
+    }
+  }
+  throw cvException(string("ERROR: Cannot find segment " + name + ".\n").c_str());
+}
+
+long cvOneDSimulation::GetNumberOfNodes(long segment){
+  GetSegmentName(segment);
+  return context->solver->GetModelPtr()->getSegment(segment)->getNumElements() + 1;
+}
+
+long cvOneDSimulation::GetNumberOfSavedSteps(){
+  CheckSolved();
+  return context->solver->GetNumberOfSavedSteps();
+}
+
+void cvOneDSimulation::GetSegmentResults(long segment, cvDoubleVec& flow, cvDoubleVec& area, cvDoubleVec& pressure){
+  GetSegmentName(segment);
+  context->solver->GetSegmentResults(segment, flow, area, pressure);
+}
+
+const double* cvOneDSimulation::GetSegmentResultData(long segment, const string& quantity){
+  if(!solved){
+    throw cvException("ERROR: The result arrays are only kept for a simulation solved with Run.\n");
+  }
+  GetSegmentName(segment);
+  if(results.empty()){
+    results.resize(GetNumberOfSegments());
+  }
+  if(!results[segment]){
+    unique_ptr<SegmentResults> segmentResults(new SegmentResults());
+    context->solver->GetSegmentResults(segment, segmentResults->flow, segmentResults->area, segmentResults->pressure);
+    context->solver->GetSegmentShearResults(segment, segmentResults->reynolds, segmentResults->wss);
+    results[segment] = std::move(segmentResults);
+  }
+  SegmentResults& segmentResults = *results[segment];
+  if(quantity == "flow"){
+    return segmentResults.flow.data();
+  }else if(quantity == "area"){
+    return segmentResults.area.data();
+  }else if(quantity == "pressure"){
+    return segmentResults.pressure.data();
+  }else if(quantity == "Re"){
+    return segmentResults.reynolds.data();
+  }else if(quantity == "wss"){
+    return segmentResults.wss.data();
+  }
+  throw cvException(string("ERROR: Invalid result quantity " + quantity + ".\n").c_str());
+}
+
+// =============
+// CO-SIMULATION
+// =============
+void cvOneDSimulation::Initialize(){
+  if(solved || stepping){
+    throw cvException("ERROR: The simulation was already solved.\n");
+  }
+  cvOneDContext::Scope scope(context.get());
+  context->solver->SetSteppable(true);
+  cvOneD::solveInCurrentContext(opts);
+  stepping = true;
+}
+
+void cvOneDSimulation::CheckStepping(){
+  if(!stepping){
+    throw cvException("ERROR: The simulation is not initialized for co-simulation.\n");
+  }
+}
+
+int cvOneDSimulation::Step(double dt){
+  CheckStepping();
+  cvOneDContext::Scope scope(context.get());
+  return context->solver->Step(dt);
+}
+
+void cvOneDSimulation::UndoStep(){
+  CheckStepping();
+  context->solver->UndoStep();
+}
+
+double cvOneDSimulation::GetCurrentTime(){
+  CheckStepping();
+  return context->solver->GetCurrentTime();
+}
+
+void cvOneDSimulation::SetInletValue(double value){
+  CheckStepping();
+  context->solver->SetInletValue(value);
+}
+
+void cvOneDSimulation::ClearInletValue(){
+  CheckStepping();
+  context->solver->ClearInletValue();
+}
+
+void cvOneDSimulation::SetOutletPressure(long segment, double pressure){
+  CheckStepping();
+  context->solver->SetOutletPressure(segment, pressure);
+}
+
+double cvOneDSimulation::GetInletFlow(){
+  CheckStepping();
+  return context->solver->GetInletFlow();
+}
+
+double cvOneDSimulation::GetInletPressure(){
+  CheckStepping();
+  return context->solver->GetInletPressure();
+}
+
+double cvOneDSimulation::GetOutletFlow(long segment){
+  GetSegmentName(segment);
+  CheckStepping();
+  return context->solver->GetOutletFlow(segment);
+}
+
+double cvOneDSimulation::GetOutletPressure(long segment){
+  GetSegmentName(segment);
+  CheckStepping();
+  return context->solver->GetOutletPressure(segment);
+}
+
+long cvOneDSimulation::GetNumberOfOutlets(){
+  CheckSolved();
+  return context->solver->GetNumberOfOutlets();
+}
+
+long cvOneDSimulation::GetOutletSegment(long outlet){
+  if(outlet < 0 || outlet >= GetNumberOfOutlets()){
+    throw cvException("ERROR: Invalid outlet index.\n");
+  }
+  return context->solver->GetOutletSegment(outlet);
+}
+
+void cvOneDSimulation::GetState(cvDoubleVec& state){
+  CheckStepping();
+  context->solver->GetState(state);
+}
+
+void cvOneDSimulation::GetInterfaceValues(cvDoubleVec& values){
+  cvOneDBFSolver* solver = context->solver;
+  values.clear();
+  values.push_back(solver->GetCurrentTime());
+  values.push_back(solver->GetInletFlow());
+  values.push_back(solver->GetInletPressure());
+  for(long k = 0; k < solver->GetNumberOfOutlets(); k++){
+    values.push_back(solver->GetOutletFlow(solver->GetOutletSegment(k)));
+    values.push_back(solver->GetOutletPressure(solver->GetOutletSegment(k)));
+  }
+}
+
+void cvOneDSimulation::ServeCoupling(const string& channelName){
+  if(!stepping){
+    Initialize();
+  }
+  cvOneDContext::Scope scope(context.get());
+  cvOneDBFSolver* solver = context->solver;
+  unique_ptr<cvOneDCouplingChannel> channel(cvOneDCouplingChannel::Create(channelName));
+  cvOneDPrintf("Co-simulation on %s with %ld Outlets ...\n", channelName.c_str(), solver->GetNumberOfOutlets());
+  fflush(stdout);
+
+  double dt;
+  cvDoubleVec inputs;
+  cvDoubleVec outputs;
+  while(true){
+    int command = channel->WaitRequest(dt, inputs);
+    try{
+      if(command == cvOneDCouplingChannel::STEP){
+        if((long)inputs.size() != 1 + solver->GetNumberOfOutlets()){
+          throw cvException("ERROR: A co-simulation step takes the inlet value and a pressure per outlet.\n");
+        }
+        if(isnan(inputs[0])){
+          solver->ClearInletValue();
+        }else{
+          solver->SetInletValue(inputs[0]);
+        }
+        for(long k = 0; k < solver->GetNumberOfOutlets(); k++){
+          if(!isnan(inputs[1 + k])){
+            solver->SetOutletPressure(solver->GetOutletSegment(k), inputs[1 + k]);
+          }
+        }
+        solver->Step(dt);
+      }else if(command == cvOneDCouplingChannel::UNDO){
+        solver->UndoStep();
+      }else if(command == cvOneDCouplingChannel::STOP){
+        solver->WriteResults();
+      }else if(command != cvOneDCouplingChannel::STATE){
+        throw cvException("ERROR: Unknown co-simulation command.\n");
+      }
+      GetInterfaceValues(outputs);
+      channel->Reply(outputs);
+    }catch(exception& e){
+      string message = e.what();
+      while(!message.empty() && message.back() == '\n'){
+        message.pop_back();
+      }
+      channel->ReplyError(message);
+    }
+    if(command == cvOneDCouplingChannel::STOP){
+      break;
+    }
+  }
+}
@@ -0,0 +1,160 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDSIMULATION_H
+#define CVONEDSIMULATION_H
+
+//
+//  cvOneDSimulation.h - Header for Solving a Model from its Options
+//  ~~~~~~~~~~~~~~~~~~
+//
+//  The entry point of the solver library. A simulation creates the model
+//  described by a set of options in memory, solves it in a context of its
+//  own and keeps the solution, so that the results are read as arrays
+//  rather than from result files. The files are only written when the
+//  output type of the options is not NONE. For co-simulation, the model
+//  is advanced one step at a time with the interface values of a
+//  partner, in this process or in another one through shared memory.
+//
+
+# include <memory>
+# include <string>
+# include <vector>
+
+# include "cvOneDOptions.h"
+
+using namespace std;
+
+class cvOneDContext;
+
+namespace cvOneD{
+
+// Creates and solves the model of the options in the context bound to
+// the calling thread, with the solver settings already in place
+void createAndRunModel(const options& opts);
+
+// Validates the options, sets the solver settings of the context bound
+// to the calling thread from them, then creates and solves the model
+void solveInCurrentContext(const options& opts);
+
+} // namespace cvOneD
+
+class cvOneDSimulation{
+
+  public:
+
+    // the options are validated when the simulation is created
+    cvOneDSimulation(const cvOneD::options& opts);
+    ~cvOneDSimulation();
+
+    // creates and solves the model, once
+    void Run();
+    bool IsSolved(){return solved;}
+
+    // Co-simulation: creates the model and its initial solution, instead
+    // of Run, then each Step advances it by dt with the implicit engine.
+    // UndoStep goes back before the last step to take it again with new
+    // interface values. The loop settings of the options, e.g. adaptive
+    // steps or Parareal, are not used.
+    void Initialize();
+    int Step(double dt);
+    void UndoStep();
+    double GetCurrentTime();
+    // the inlet value is a flow rate or a pressure as the inlet type of the
+    // options, the outlet pressure that of an outlet with a PRESSURE
+    // condition
+    void SetInletValue(double value);
+    void ClearInletValue();
+    void SetOutletPressure(long segment, double pressure);
+    double GetInletFlow();
+    double GetInletPressure();
+    double GetOutletFlow(long segment);
+    double GetOutletPressure(long segment);
+    long GetNumberOfOutlets();
+    long GetOutletSegment(long outlet);
+    // area and flow rate of each node, then the joint unknowns
+    void GetState(cvDoubleVec& state);
+
+    // Serves a partner process through a shared memory channel until it
+    // sends STOP, then writes the result files of the output type. The
+    // inputs of a STEP are the inlet value and the pressure of each
+    // outlet in the order of GetOutletSegment, NaN to keep the inlet table
+    // or the outlet condition. Every reply is the time, the inlet flow
+    // rate and pressure, then the flow rate and pressure of each outlet.
+    void ServeCoupling(const string& channelName);
+
+    // segments in the order of their results
+    long GetNumberOfSegments();
+    string GetSegmentName(long segment);
+    // throws if no segment has the name
+    long GetSegmentIndex(const string& name);
+    // finite element nodes of a segment, from its inlet to its outlet
+    long GetNumberOfNodes(long segment);
+    // saved steps of the solution, the initial conditions first
+    long GetNumberOfSavedSteps();
+
+    // Flow rates, areas and pressures of a segment laid out as in its
+    // text result files: the saved steps of each node in turn, so the
+    // value of node n at saved step s is at n*GetNumberOfSavedSteps()+s
+    void GetSegmentResults(long segment, cvDoubleVec& flow, cvDoubleVec& area, cvDoubleVec& pressure);
+
+    // The same layout without copies, e.g. for NumPy views in Python: the
+    // arrays of a segment are assembled at the first request and kept by
+    // the simulation, which must outlive the pointer. The quantity is the
+    // suffix of the result file: "flow", "area", "pressure", "Re" or
+    // "wss". Only for simulations solved with Run.
+    const double* GetSegmentResultData(long segment, const string& quantity);
+
+  private:
+
+    struct SegmentResults{
+      cvDoubleVec flow;
+      cvDoubleVec area;
+      cvDoubleVec pressure;
+      cvDoubleVec reynolds;
+      cvDoubleVec wss;
+    };
+
+    void CheckSolved();
+    void CheckStepping();
+    void GetInterfaceValues(cvDoubleVec& values);
+
+    cvOneD::options opts;
+    unique_ptr<cvOneDContext> context;
+    bool solved;
+    bool stepping;
+    vector<unique_ptr<SegmentResults> > results;
+
+    cvOneDSimulation(const cvOneDSimulation&);
+    cvOneDSimulation& operator=(const cvOneDSimulation&);
+};
+
+#endif // CVONEDSIMULATION_H
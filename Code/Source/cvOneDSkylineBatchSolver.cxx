@@ -0,0 +1,276 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDSkylineBatchSolver.cxx - Source for Skyline Systems Solved in Lanes
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The lane kernels follow cvOneDSkylineLinearSolver operation by
+//  operation, so each lane gets the same solution as a single solve.
+//
+
+# include <algorithm>
+# include <cassert>
+
+# include "cvOneDSkylineBatchSolver.h"
+# include "cvOneDSolverDefinitions.h"
+
+cvOneDSkylineBatchSolver::cvOneDSkylineBatchSolver(int lanes){
+  live = lanes;
+  waiting = 0;
+  round = 0;
+  requests.resize(lanes);
+  for(int i = 0; i < lanes; i++){
+    requests[i].pending = false;
+  }
+}
+
+void cvOneDSkylineBatchSolver::Solve(int lane, cvOneDSkylineMatrix* matrix, cvOneDFEAVector* rhs, cvOneDFEAVector* solution){
+  unique_lock<mutex> guard(lock);
+  requests[lane].matrix = matrix;
+  requests[lane].rhs = rhs;
+  requests[lane].solution = solution;
+  requests[lane].pending = true;
+  waiting++;
+  if(waiting == live){
+    RunRound();
+  }else{
+    long current = round;
+    solved.wait(guard, [&](){return round != current;});
+  }
+}
+
+void cvOneDSkylineBatchSolver::Leave(int lane){
+  lock_guard<mutex> guard(lock);
+  live--;
+  if(waiting > 0 && waiting == live){
+    RunRound();
+  }
+}
+
+// Called with the lock held by the last lane to arrive
+void cvOneDSkylineBatchSolver::RunRound(){
+  vector<int> group;
+  while(true){
+    // lanes with the skyline of the first pending one
+    group.clear();
+    for(int i = 0; i < (int)requests.size(); i++){
+      if(!requests[i].pending){
+        continue;
+      }
+      if(group.empty()){
+        group.push_back(i);
+        continue;
+      }
+      cvOneDSkylineMatrix* first = requests[group[0]].matrix;
+      cvOneDSkylineMatrix* other = requests[i].matrix;
+      long neq = first->GetDimension();
+      if(other->GetDimension() == neq &&
+         equal(first->GetPosition(), first->GetPosition() + neq + 1, other->GetPosition())){
+        group.push_back(i);
+      }
+    }
+    if(group.empty()){
+      break;
+    }
+    SolveGroup(group);
+  }
+  waiting = 0;
+  round++;
+  solved.notify_all();
+}
+
+void cvOneDSkylineBatchSolver::SolveGroup(const vector<int>& group){
+  int width = group.size();
+  cvOneDSkylineMatrix* first = requests[group[0]].matrix;
+  long neq = first->GetDimension();
+  const long* maxa = first->GetPosition();
+  long nnz = maxa[neq];
+
+  KU.resize(nnz*width);
+  KL.resize(nnz*width);
+  KD.resize(neq*width);
+  F.resize(neq*width);
+  u.resize(neq*width);
+  for(int l = 0; l < width; l++){
+    const Request& req = requests[group[l]];
+    const double* laneKU = req.matrix->GetUpperDiagonalEntries();
+    const double* laneKL = req.matrix->GetLowerDiagonalEntries();
+    const double* laneKD = req.matrix->GetDiagonalEntries();
+    const double* laneF = req.rhs->GetEntries();
+    for(long k = 0; k < nnz; k++){
+      KU[k*width+l] = laneKU[k];
+      KL[k*width+l] = laneKL[k];
+    }
+    for(long k = 0; k < neq; k++){
+      KD[k*width+l] = laneKD[k];
+      F[k*width+l] = laneF[k];
+    }
+  }
+
+  FactorLanes(&KU[0], &KL[0], &KD[0], maxa, neq, width);
+  SolveLanes(&KU[0], &KL[0], &KD[0], &F[0], &u[0], maxa, neq, width);
+
+  for(int l = 0; l < width; l++){
+    Request& req = requests[group[l]];
+    double* laneKU = req.matrix->GetUpperDiagonalEntries();
+    double* laneKL = req.matrix->GetLowerDiagonalEntries();
+    double* laneKD = req.matrix->GetDiagonalEntries();
+    double* laneF = req.rhs->GetEntries();
+    double* laneU = req.solution->GetEntries();
+    for(long k = 0; k < nnz; k++){
+      laneKU[k] = KU[k*width+l];
+      laneKL[k] = KL[k*width+l];
+    }
+    for(long k = 0; k < neq; k++){
+      laneKD[k] = KD[k*width+l];
+      laneF[k] = F[k*width+l];
+      laneU[k] = u[k*width+l];
+    }
+    req.pending = false;
+  }
+}
+
+void cvOneDSkylineBatchSolver::FactorLanes(double* KS, double* KI, double* KD, const long* maxa, long neq, int width){
+  vector<double> sumI(width), sumS(width), sumD(width);
+  // lanes still decomposing, masked once their pivot vanishes
+  vector<char> active(width, 1);
+
+  for(long it = 1; it < neq; it++){
+
+    long firstp = it - (maxa[it+1] - maxa[it]);
+    long posd1 = maxa[it + 1];
+
+    for(long i = firstp; i < it; i++){
+
+      long fpvec = i - (maxa[i+1] - maxa[i]);
+      long firstpscalp = max(fpvec, firstp);
+      long len = (i - 1) - firstpscalp + 1;
+
+      long posd2 = maxa[i + 1];
+      long pos1 = it - firstpscalp;
+      long pos2 = i - firstpscalp;
+
+      const double* vecLI = &KI[(posd1 - pos1)*width];
+      const double* vecCI = &KS[(posd2 - pos2)*width];
+      const double* vecLS = &KI[(posd2 - pos2)*width];
+      const double* vecCS = &KS[(posd1 - pos1)*width];
+
+      fill(sumI.begin(), sumI.end(), 0.0);
+      fill(sumS.begin(), sumS.end(), 0.0);
+      for(long k = 0; k < len; k++){
+        for(int l = 0; l < width; l++){
+          sumI[l] += vecLI[k*width+l] * vecCI[k*width+l];
+          sumS[l] += vecLS[k*width+l] * vecCS[k*width+l];
+        }
+      }
+
+      long pos = (posd1 - (it - i))*width;
+      for(int l = 0; l < width; l++){
+        if(active[l]){
+          KI[pos+l] = (KI[pos+l] - sumI[l]) / KD[i*width+l];
+          KS[pos+l] -= sumS[l];
+        }
+      }
+    }
+
+    long len = (it - 1) - firstp + 1;
+    long posd = posd1 - (it - firstp);
+
+    const double* vecLD = &KI[posd*width];
+    const double* vecCD = &KS[posd*width];
+
+    fill(sumD.begin(), sumD.end(), 0.0);
+    for(long k = 0; k < len; k++){
+      for(int l = 0; l < width; l++){
+        sumD[l] += vecLD[k*width+l] * vecCD[k*width+l];
+      }
+    }
+    for(int l = 0; l < width; l++){
+      if(active[l]){
+        KD[it*width+l] -= sumD[l];
+        if(fabs(KD[it*width+l]) < EPSILON){
+          active[l] = 0;
+        }
+      }
+    }
+  }
+}
+
+void cvOneDSkylineBatchSolver::SolveLanes(const double* KS, const double* KI, const double* KD, double* F, double* u,
+                                          const long* maxa, long neq, int width){
+  vector<double> sum(width);
+
+  // L u' = F, F := u'
+  for(long i = 0; i < neq; i++){
+    long firstp = i - (maxa[i+1] - maxa[i]);
+    const double* vecA = &KI[maxa[i]*width];
+    const double* vecB = &F[firstp*width];
+    long len = (i - 1) - firstp + 1;
+    fill(sum.begin(), sum.end(), 0.0);
+    for(long k = 0; k < len; k++){
+      for(int l = 0; l < width; l++){
+        sum[l] += vecA[k*width+l] * vecB[k*width+l];
+      }
+    }
+    for(int l = 0; l < width; l++){
+      F[i*width+l] -= sum[l];
+    }
+  }
+
+  // U u = u'
+  for(int l = 0; l < width; l++){
+    u[(neq-1)*width+l] = F[(neq-1)*width+l] / KD[(neq-1)*width+l];
+  }
+  for(long i = neq - 2; i > -1; i--){
+    long it = i + 1;
+    long firstp = it - (maxa[it + 1] - maxa[it]);
+    for(long j = firstp; j < it; j++){
+      const double* column = &KS[(maxa[it + 1] - it + j)*width];
+      for(int l = 0; l < width; l++){
+        F[j*width+l] -= u[it*width+l] * column[l];
+      }
+    }
+    for(int l = 0; l < width; l++){
+      u[i*width+l] = F[i*width+l] / KD[i*width+l];
+    }
+  }
+}
+
+cvOneDSkylineLaneSolver::cvOneDSkylineLaneSolver(cvOneDSkylineBatchSolver* laneBatch, int laneID){
+  batch = laneBatch;
+  lane = laneID;
+}
+
+void cvOneDSkylineLaneSolver::Solve(cvOneDFEAVector& sol){
+  assert( rhsVector->GetDimension() == lhsMatrix->GetDimension());
+  batch->Solve(lane, (cvOneDSkylineMatrix*)lhsMatrix, rhsVector, &sol);
+}
@@ -0,0 +1,112 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDSKYLINEBATCHSOLVER_H
+#define CVONEDSKYLINEBATCHSOLVER_H
+
+//
+//  cvOneDSkylineBatchSolver.h - Header for Skyline Systems Solved in Lanes
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The members of a lock-step ensemble assemble their Newton systems on
+//  their own threads. Their solves meet in rounds: once every member
+//  still running waits for a solution, the matrices with the same
+//  skyline are interleaved entry by entry and decomposed together, the
+//  members being the innermost (vector) loop over one set of positions.
+//  Members that converged or finished do not join a round.
+//
+
+# include <mutex>
+# include <condition_variable>
+# include <vector>
+
+# include "cvOneDSkylineLinearSolver.h"
+
+using namespace std;
+
+class cvOneDSkylineBatchSolver{
+
+  public:
+
+    cvOneDSkylineBatchSolver(int lanes);
+
+    // waits for the round in which the system of the lane is solved, the
+    // matrix and right hand side are overwritten as by the skyline solver
+    void Solve(int lane, cvOneDSkylineMatrix* matrix, cvOneDFEAVector* rhs, cvOneDFEAVector* solution);
+
+    // the lane has no more systems, the others stop waiting for it
+    void Leave(int lane);
+
+    // LU decomposition and solution of width interleaved systems sharing
+    // the positions maxa, entry k of lane l at k*width+l. Lanes with a
+    // vanishing pivot stop their decomposition there, as a single one does
+    static void FactorLanes(double* KU, double* KL, double* KD, const long* maxa, long neq, int width);
+    static void SolveLanes(const double* KU, const double* KL, const double* KD, double* F, double* u,
+                           const long* maxa, long neq, int width);
+
+  private:
+
+    struct Request{
+      cvOneDSkylineMatrix* matrix;
+      cvOneDFEAVector* rhs;
+      cvOneDFEAVector* solution;
+      bool pending;
+    };
+
+    void RunRound();
+    void SolveGroup(const vector<int>& group);
+
+    mutex lock;
+    condition_variable solved;
+    int live;
+    int waiting;
+    long round;
+    vector<Request> requests;
+    vector<double> KU, KL, KD, F, u;
+};
+
+// Skyline solver of one lane, boundary conditions are applied on its own
+// matrix and the decomposition is left to the batch
+class cvOneDSkylineLaneSolver: public cvOneDSkylineLinearSolver{
+
+  public:
+
+    cvOneDSkylineLaneSolver(cvOneDSkylineBatchSolver* batch, int lane);
+
+    virtual void Solve(cvOneDFEAVector& solution);
+
+  private:
+
+    cvOneDSkylineBatchSolver* batch;
+    int lane;
+};
+
+#endif // CVONEDSKYLINEBATCHSOLVER_H
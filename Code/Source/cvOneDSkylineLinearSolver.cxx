@@ -81,6 +81,19 @@ void cvOneDSkylineLinearSolver::Solve(cvOneDFEAVector& sol){
   SolNonSymSysSkyLine( KU, KL, KD, F, position, solution, numberOfEquations, 1, EPSILON);
 }
 
+int cvOneDSkylineLinearSolver::Factor(cvOneDSkylineMatrix* matrix){
+  return SolNonSymSysSkyLine( matrix->GetUpperDiagonalEntries(), matrix->GetLowerDiagonalEntries(),
+                              matrix->GetDiagonalEntries(), NULL, matrix->GetPosition(), NULL,
+                              matrix->GetDimension(), 0, EPSILON);
+}
+
+// rhs is used as work space and is overwritten
+void cvOneDSkylineLinearSolver::SolveFactored(cvOneDSkylineMatrix* matrix, double* rhs, double* solution){
+  SolNonSymSysSkyLine( matrix->GetUpperDiagonalEntries(), matrix->GetLowerDiagonalEntries(),
+                       matrix->GetDiagonalEntries(), rhs, matrix->GetPosition(), solution,
+                       matrix->GetDimension(), 1, EPSILON);
+}
+
 cvOneDFEAMatrix* cvOneDSkylineLinearSolver::GetLHS(){
   return lhsMatrix;
 }
@@ -91,6 +104,31 @@ cvOneDFEAVector* cvOneDSkylineLinearSolver::GetRHS(){
 
 void cvOneDSkylineLinearSolver::SetSolution(long equation, double value){
 
+  // boundary equations registered with the matrix: the column values
+  // are read, subtracted from the right hand side and cleared in place
+  const long* indices;
+  const long* positions;
+  long nbc = ((cvOneDSkylineMatrix*)lhsMatrix)->GetBoundaryEntries( equation, &indices, &positions);
+  if( nbc >= 0){
+    double* KU = ((cvOneDSkylineMatrix*)lhsMatrix)->GetUpperDiagonalEntries();
+    double* KL = ((cvOneDSkylineMatrix*)lhsMatrix)->GetLowerDiagonalEntries();
+    double* KD = ((cvOneDSkylineMatrix*)lhsMatrix)->GetDiagonalEntries();
+    double columnValue;
+    for( long i = 0; i < nbc; i++){
+      if( indices[i] < equation){
+        columnValue = KU[positions[i]];
+      }else{
+        columnValue = KL[positions[i]];
+      }
+      (*rhsVector)[indices[i]] -= value * columnValue;
+      KU[positions[i]] = 0.0;
+      KL[positions[i]] = 0.0;
+    }
+    KD[equation] = 1.0;
+    (*rhsVector)[equation] = value;
+    return;
+  }
+
   // nent is the same for the corresponding column
   long nent = ((cvOneDSkylineMatrix*)lhsMatrix)->GetNumberOfEntriesIn(equation);
 
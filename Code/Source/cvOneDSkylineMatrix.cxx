@@ -42,10 +42,20 @@ using namespace std;
 
 cvOneDSkylineMatrix::cvOneDSkylineMatrix(const char* tit): cvOneDFEAMatrix(tit){
   wasSet = false;
+  numBCEquations = 0;
+  bcSlot = NULL;
+  bcStart = NULL;
+  bcIndex = NULL;
+  bcPos = NULL;
 }
 
 cvOneDSkylineMatrix::cvOneDSkylineMatrix(long dim, long* pos, const char* tit): cvOneDFEAMatrix(tit){
   wasSet = false;  
+  numBCEquations = 0;
+  bcSlot = NULL;
+  bcStart = NULL;
+  bcIndex = NULL;
+  bcPos = NULL;
   Set( dim, pos);
 }
 
@@ -56,6 +66,105 @@ cvOneDSkylineMatrix::~cvOneDSkylineMatrix(){
     delete [] KL;
     delete [] position;
   }
+  DeleteBoundaryEquations();
+}
+
+void cvOneDSkylineMatrix::DeleteBoundaryEquations(){
+  delete [] bcSlot;
+  delete [] bcStart;
+  delete [] bcIndex;
+  delete [] bcPos;
+  bcSlot = NULL;
+  bcStart = NULL;
+  bcIndex = NULL;
+  bcPos = NULL;
+  numBCEquations = 0;
+}
+
+// The structure only depends on the position array, so it is
+// built once and reused at every Newton iteration. Row eq and
+// column eq share the same positions: (eq,j) and (j,eq) are both
+// stored at GetPosition(eq,j), in KL/KU for j < eq and KU/KL for j > eq.
+void cvOneDSkylineMatrix::SetBoundaryEquations(long numEqs, const long* eqs){
+  assert( wasSet);
+
+  long i, j, k, eq;
+  DeleteBoundaryEquations();
+
+  bcSlot = new long[dimension];
+  for( i = 0; i < dimension; i++){
+    bcSlot[i] = -1;
+  }
+  for( i = 0; i < numEqs; i++){
+    assert( eqs[i] >= 0 && eqs[i] < dimension);
+    if( bcSlot[eqs[i]] < 0){
+      bcSlot[eqs[i]] = numBCEquations++;
+    }
+  }
+
+  bcStart = new long[numBCEquations + 1];
+  long* slotEq = new long[numBCEquations];
+  for( i = 0; i < dimension; i++){
+    if( bcSlot[i] >= 0){
+      slotEq[bcSlot[i]] = i;
+    }
+  }
+
+  // a single pass on the column heights is enough to count the
+  // entries below the skyline of all the boundary equations
+  long* count = new long[numBCEquations];
+  for( k = 0; k < numBCEquations; k++){
+    count[k] = position[slotEq[k] + 1] - position[slotEq[k]];
+  }
+  for( j = 0; j < dimension; j++){
+    for( i = j - (position[j+1] - position[j]); i < j; i++){
+      if( bcSlot[i] >= 0){
+        count[bcSlot[i]]++;
+      }
+    }
+  }
+
+  bcStart[0] = 0;
+  for( k = 0; k < numBCEquations; k++){
+    bcStart[k + 1] = bcStart[k] + count[k];
+    count[k] = bcStart[k];
+  }
+  bcIndex = new long[bcStart[numBCEquations]];
+  bcPos = new long[bcStart[numBCEquations]];
+
+  // entries before the diagonal, in increasing order
+  for( k = 0; k < numBCEquations; k++){
+    eq = slotEq[k];
+    for( j = eq - (position[eq+1] - position[eq]); j < eq; j++){
+      bcIndex[count[k]] = j;
+      bcPos[count[k]] = GetPosition( eq, j);
+      count[k]++;
+    }
+  }
+  // entries after the diagonal, in increasing order
+  for( j = 0; j < dimension; j++){
+    for( i = j - (position[j+1] - position[j]); i < j; i++){
+      if( bcSlot[i] >= 0){
+        k = bcSlot[i];
+        bcIndex[count[k]] = j;
+        bcPos[count[k]] = GetPosition( i, j);
+        count[k]++;
+      }
+    }
+  }
+
+  delete [] count;
+  delete [] slotEq;
+}
+
+long cvOneDSkylineMatrix::GetBoundaryEntries(long equation, const long** indices, const long** positions) const{
+  if( bcSlot == NULL || bcSlot[equation] < 0){
+    return -1;
+  }
+  long k = bcSlot[equation];
+  *indices = &bcIndex[bcStart[k]];
+  *positions = &bcPos[bcStart[k]];
+  return bcStart[k + 1] - bcStart[k];
 }
 
 long cvOneDSkylineMatrix::GetDimension()const{
@@ -273,6 +382,20 @@ void cvOneDSkylineMatrix::GetColumnEntries(long column, long* rows, double* valu
 
 void cvOneDSkylineMatrix::ClearRow(long row){
   // this method does not modify the column height and therefore the position array
+  const long* indices;
+  const long* positions;
+  long nent = GetBoundaryEntries( row, &indices, &positions);
+  if( nent >= 0){
+    for( long i = 0; i < nent; i++){
+      if( indices[i] < row){
+        KL[positions[i]] = 0.0;
+      }else{
+        KU[positions[i]] = 0.0;
+      }
+    }
+    return;
+  }
+
   long numEntries = GetNumberOfEntriesIn(row);
   long* columns = new long[numEntries];
   assert( columns != 0);
@@ -287,6 +410,20 @@ void cvOneDSkylineMatrix::ClearRow(long row){
 
 void cvOneDSkylineMatrix::ClearColumn(long column){
   // this method does not modify the column height and therefore the position array
+  const long* indices;
+  const long* positions;
+  long nent = GetBoundaryEntries( column, &indices, &positions);
+  if( nent >= 0){
+    for( long i = 0; i < nent; i++){
+      if( indices[i] < column){
+        KU[positions[i]] = 0.0;
+      }else{
+        KL[positions[i]] = 0.0;
+      }
+    }
+    return;
+  }
+
   long numEntries = GetNumberOfEntriesIn( column);
   long* rows = new long[numEntries];
   assert( rows != 0);
@@ -56,6 +56,17 @@ class cvOneDSkylineMatrix: public cvOneDFEAMatrix{
     double* KU; // upper diagonal part
     double* KD; // diagonal components
     double* KL; // lower diagonal part
+
+    // precomputed row/column structure of the boundary equations
+    // bcSlot[eq] is -1 unless eq was registered, bcStart indexes into
+    // bcIndex (the other row/column) and bcPos (the KU/KL position
+    // shared by the row entry and the column entry)
+    long numBCEquations;
+    long* bcSlot;
+    long* bcStart;
+    long* bcIndex;
+    long* bcPos;
+    void DeleteBoundaryEquations();
   
   public:
 
@@ -82,6 +93,9 @@ class cvOneDSkylineMatrix: public cvOneDFEAMatrix{
     long GetRowEntries( long row, long* columns) const;
     void GetColumnEntries( long column, long* rows, double* values) const;
     long GetColumnEntries( long column, long* rows) const;
+    // returns the number of off-diagonal entries of a registered equation
+    // and their indices/positions, -1 if the equation was not registered
+    long GetBoundaryEntries( long equation, const long** indices, const long** positions) const;
     // this is to perform a quick test
     void SetArrays( double* upperEntries, double* lowerEntries, double* diagonalEntries);
 
@@ -93,6 +107,9 @@ class cvOneDSkylineMatrix: public cvOneDFEAMatrix{
     // helper functions for applying dirichlet b.c.
     virtual void ClearRow(long row);
     virtual void ClearColumn(long column);    
+    // precomputes the off-diagonal entries of the given equations so that
+    // the boundary conditions can be applied without traversing the skyline
+    virtual void SetBoundaryEquations(long numEqs, const long* eqs);
     virtual double GetValue(long row, long column);
     virtual long GetDimension() const;
     // print matrix
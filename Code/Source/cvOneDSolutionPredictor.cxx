@@ -0,0 +1,128 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDSolutionPredictor.cxx - Source for the Newton Initial Guess
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  The extrapolations use the stored times, so they also hold with
+//  adaptive time steps. The phase-matched predictor assumes a fixed step
+//  and falls back to the quadratic one until a full cycle is stored.
+//
+
+# include "cvOneDSolutionPredictor.h"
+
+cvOneDSolutionPredictor::cvOneDSolutionPredictor(PredictorType predictorType, long steps){
+  type = predictorType;
+  cycleSteps = steps;
+  long capacity = 3;
+  if(type == PredictorTypeScope::CYCLE && cycleSteps + 1 > capacity){
+    capacity = cycleSteps + 1;
+  }
+  history.resize(capacity);
+  times.resize(capacity);
+  numberOfPredictions = 0;
+  Reset();
+}
+
+void cvOneDSolutionPredictor::Reset(void){
+  head = -1;
+  count = 0;
+}
+
+void cvOneDSolutionPredictor::Push(const cvOneDFEAVector& solution, double time){
+  head = (head + 1) % (long)history.size();
+  history[head].assign(solution.GetEntries(), solution.GetEntries() + solution.GetDimension());
+  times[head] = time;
+  if(count < (long)history.size()){
+    count++;
+  }
+}
+
+const vector<double>& cvOneDSolutionPredictor::Past(long k) const{
+  long size = history.size();
+  return history[(head - k + size) % size];
+}
+
+bool cvOneDSolutionPredictor::Predict(cvOneDFEAVector& solution, double time, long areaEnd){
+  if(type == PredictorTypeScope::NONE || count < 2){
+    return false;
+  }
+  long size = history.size();
+  long dim = solution.GetDimension();
+  const vector<double>& u0 = Past(0);
+  // a step that left the solution unchanged means it is stationary, the
+  // extrapolation would only amplify round-off above the tolerance
+  if(u0 == Past(1)){
+    return false;
+  }
+  guess.resize(dim);
+
+  if(type == PredictorTypeScope::CYCLE && cycleSteps > 0 && count > cycleSteps){
+    const vector<double>& u1 = Past(cycleSteps - 1);
+    const vector<double>& u2 = Past(cycleSteps);
+    for(long i = 0; i < dim; i++){
+      guess[i] = u0[i] + u1[i] - u2[i];
+    }
+  }else if(type != PredictorTypeScope::LINEAR && count >= 3){
+    // Lagrange extrapolation through the last three steps
+    double t0 = times[head];
+    double t1 = times[(head - 1 + size) % size];
+    double t2 = times[(head - 2 + size) % size];
+    double l0 = (time - t1) * (time - t2) / ((t0 - t1) * (t0 - t2));
+    double l1 = (time - t0) * (time - t2) / ((t1 - t0) * (t1 - t2));
+    double l2 = (time - t0) * (time - t1) / ((t2 - t0) * (t2 - t1));
+    const vector<double>& u1 = Past(1);
+    const vector<double>& u2 = Past(2);
+    for(long i = 0; i < dim; i++){
+      guess[i] = l0 * u0[i] + l1 * u1[i] + l2 * u2[i];
+    }
+  }else{
+    double t0 = times[head];
+    double t1 = times[(head - 1 + size) % size];
+    double r = (time - t0) / (t0 - t1);
+    const vector<double>& u1 = Past(1);
+    for(long i = 0; i < dim; i++){
+      guess[i] = u0[i] + r * (u0[i] - u1[i]);
+    }
+  }
+
+  for(long i = 0; i < areaEnd; i += 2){
+    if(!(guess[i] > 0.0)){
+      return false;
+    }
+  }
+  for(long i = 0; i < dim; i++){
+    solution.Set(i, guess[i]);
+  }
+  numberOfPredictions++;
+  return true;
+}
@@ -0,0 +1,86 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDSOLUTIONPREDICTOR_H
+#define CVONEDSOLUTIONPREDICTOR_H
+
+//
+//  cvOneDSolutionPredictor.h - Header for the Newton Initial Guess
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  Keeps the accepted solutions of the last steps in a ring buffer and
+//  extrapolates them to the new time level, which gives Newton a better
+//  starting point than the previous solution. The phase-matched
+//  predictor adds to the previous solution the change over the same
+//  step one cycle earlier, which is exact for a periodic solution.
+//
+
+# include <vector>
+
+# include "cvOneDEnums.h"
+# include "cvOneDFEAVector.h"
+
+using namespace std;
+
+class cvOneDSolutionPredictor{
+
+  public:
+
+    // cycleSteps is the number of steps per cycle, needed for CYCLE only
+    cvOneDSolutionPredictor(PredictorType type, long cycleSteps);
+
+    // forgets the history, e.g. when the state is set from outside
+    void Reset(void);
+    // stores an accepted solution at the given time
+    void Push(const cvOneDFEAVector& solution, double time);
+    // overwrites solution with the guess at time, returns false and
+    // leaves it untouched without enough history or if an area of the
+    // first areaEnd entries would not be positive
+    bool Predict(cvOneDFEAVector& solution, double time, long areaEnd);
+
+    long GetNumberOfPredictions(void) const {return numberOfPredictions;}
+
+  private:
+
+    // entry k steps before the last one pushed
+    const vector<double>& Past(long k) const;
+
+    PredictorType type;
+    long cycleSteps;
+    vector<vector<double> > history;
+    vector<double> times;
+    vector<double> guess;
+    long head;
+    long count;
+    long numberOfPredictions;
+};
+
+#endif // CVONEDSOLUTIONPREDICTOR_H
@@ -29,20 +29,31 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
-#ifndef CVONEDSOLVERDEFINITIONS_H
-#define CVONEDSOLVERDEFINITIONS_H
-
-
-//
-//  cvOneDSolverDefinitions.h - Some definitions used throughout the solver
-//
-
-#define MAX_STRING_SIZE          20
-#define EPSILON                  1.0e-10
-#define OUTPUT_PRECISION         12
-#define MAX_NONLINEAR_ITERATIONS 30
-#define RELATIVE_TOLERANCE       1.0e-7
-#define ABSOLUTE_TOLERANCE       5.0e-6
-
-#endif // CVONEDSOLVERDEFINITIONS_H
-
+#ifndef CVONEDSOLVERDEFINITIONS_H
+#define CVONEDSOLVERDEFINITIONS_H
+
+
+//
+//  cvOneDSolverDefinitions.h - Some definitions used throughout the solver
+//
+
+#define MAX_STRING_SIZE          20
+#define EPSILON                  1.0e-10
+#define OUTPUT_PRECISION         12
+#define MAX_NONLINEAR_ITERATIONS 30
+#define NONLINEAR_FAILURE_RATIO  1.0e2
+#define FROZEN_TANGENT_RATIO     0.5
+#define LINE_SEARCH_DECREASE     1.0e-4
+#define LINE_SEARCH_BOUNDARY     0.9
+#define RELATIVE_TOLERANCE       1.0e-7
+#define ABSOLUTE_TOLERANCE       5.0e-6
+#define STEP_GROWTH_HOLD         10
+#define STEADY_MAX_PSEUDO_STEPS  50
+#define STEADY_TOLERANCE         1.0e-10
+#define STEADY_STEP_GROWTH       4.0
+#define PARAREAL_TOLERANCE       1.0e-6
+#define WAVEFORM_TOLERANCE       1.0e-6
+#define WAVEFORM_MAX_ITERATIONS  50
+
+#endif // CVONEDSOLVERDEFINITIONS_H
+
@@ -46,6 +46,9 @@ using namespace std;
 
 cvOneDSubdomain::cvOneDSubdomain(){
   mat = NULL;
+  nodes = NULL;
+  connectivities = NULL;
+  presslv = NULL;
   pressureWave = NULL;
   pressureTime = NULL;
   resistanceWave = NULL;
@@ -56,6 +59,9 @@ cvOneDSubdomain::cvOneDSubdomain(){
   PressLVTime=NULL;
   numPressLVPts=0;
   branchAngle = 90.0;
+  MemD = MemD1 = MemD2 = MemConvP = MemConvS = MemConvPrevP = 0.0;
+  rcrTime = rcrTime2 = rcrTime3 = corTime = 0.0;
+  rcrStep = rcrStep2 = rcrStep3 = corStep = 0.0;
 }
 
 cvOneDSubdomain::~cvOneDSubdomain(){
@@ -68,6 +74,7 @@ cvOneDSubdomain::~cvOneDSubdomain(){
   if(presslv != NULL) delete [] presslv;// Added by Jongmin Seo 04062020 & Hyunjin Kim 09022005
   if(PressLVWave != NULL)  delete [] PressLVWave;// Added by Jongmin Seo 04062020 & Hyunjin Kim 09022005
   if(PressLVTime != NULL)  delete [] PressLVTime;// Added by Jongmin Seo 04062020 & Hyunjin Kim 09022005
+  if(mat != NULL) delete mat;
 }
 
 void cvOneDSubdomain::SetInitInletS(double So){
@@ -91,8 +98,8 @@ void cvOneDSubdomain::SetInitialdFlowdT(double dQ0dT){
   dQ_dT_initial = 0;
 }
 
-void cvOneDSubdomain::SetupMaterial(int matID){
-  mat = cvOneDGlobal::gMaterialManager->GetNewInstance(matID);
+void cvOneDSubdomain::SetupMaterial(int matID, cvOneDMaterialManager* materials){
+  mat = materials->GetNewInstance(matID);
  // printf("subdomain cpp setupMaterial matID=%i  \n", matID);
   mat->SetAreas_and_length(S_initial, S_final, fabs(z_out - z_in));
 }
@@ -398,6 +405,21 @@ double cvOneDSubdomain::GetBoundResistance(double currentTime){
   return resistance;
 }
 
+// Time average of the resistance wave over its cycle, the interval before
+// the first point interpolates back from the last one like above
+double cvOneDSubdomain::GetMeanBoundResistance(void){
+  if(resistanceTime == NULL || resistanceWave == NULL){
+    cout << "ERROR: resistance information is not prescribed"<< endl;
+    exit(1);
+  }
+  double cycleTime = resistanceTime[numPressurePts-1];
+  double integral = 0.5*(resistanceWave[numPressurePts-1] + resistanceWave[0])*resistanceTime[0];
+  for(int i = 0; i < numPressurePts-1; i++){
+    integral += 0.5*(resistanceWave[i] + resistanceWave[i+1])*(resistanceTime[i+1] - resistanceTime[i]);
+  }
+  return integral / cycleTime;
+}
+
 double cvOneDSubdomain::GetBoundAreabyPresWave(double currentTime){
   double pressure =  GetPressure(currentTime);
   return mat->GetArea(pressure, GetLength());
@@ -447,11 +469,12 @@ double cvOneDSubdomain::dMemCdP(void){
 double cvOneDSubdomain::ConvPressRCR(double previousP, double deltaTime, double currentTime){
   // Initialization
   if(currentTime <= deltaTime ){MemD = 0.0;}
-  // Convoluted pressure
+  // Convoluted pressure, advanced over the previous time step
   if(currentTime > deltaTime && currentTime != rcrTime){
-    MemD = MemD*exp(-alphaRCR*deltaTime)+previousP*expmDtOne(deltaTime);//all the deltaTime are from previous time step
+    MemD = MemD*exp(-alphaRCR*rcrStep)+previousP*expmDtOne(rcrStep);
     rcrTime = currentTime;
   }
+  rcrStep = deltaTime;
   return MemD;
 }
 // wgyang convolution int(p(t')exp(-alphaRCR(t-t')dt'
@@ -473,10 +496,11 @@ double cvOneDSubdomain::ConvPressCoronary(double previousP, double deltaTime, do
   }
 
   if (currentTime > deltaTime && currentTime!=corTime) {
-    MemD1=MemD1*exp(expo1COR*deltaTime)+expmDtOneCoronary(deltaTime, expo1COR)*(CoefZ1*previousP+CoefY1*getBoundCoronaryValues(prevTime));
-    MemD2=MemD2*exp(expo2COR*deltaTime)+expmDtOneCoronary(deltaTime, expo2COR)*(CoefZ2*previousP+CoefY2*getBoundCoronaryValues(prevTime));
+    MemD1=MemD1*exp(expo1COR*corStep)+expmDtOneCoronary(corStep, expo1COR)*(CoefZ1*previousP+CoefY1*getBoundCoronaryValues(prevTime));
+    MemD2=MemD2*exp(expo2COR*corStep)+expmDtOneCoronary(corStep, expo2COR)*(CoefZ2*previousP+CoefY2*getBoundCoronaryValues(prevTime));
     corTime=currentTime;
   }
+  corStep = deltaTime;
   if (exponent==expo1COR){ return MemD1; }
   else if (exponent==expo2COR){ return MemD2; }
   cout << "ConvPressCoronary return value undefined!" << std::endl;
@@ -591,11 +615,50 @@ double cvOneDSubdomain::ConvPressexp(double previousP, double deltaTime, double
   if(currentTime <= deltaTime ){MemConvP = 0.0;}
   // Convoluted pressure
   if(currentTime > deltaTime && currentTime != rcrTime2){
-    MemConvP = MemConvP*exp(-alphaRCR*deltaTime)+previousP/alphaRCR*expmDtOne(deltaTime);//all the deltaTime are from previous time step
+    MemConvP = MemConvP*exp(-alphaRCR*rcrStep2)+previousP/alphaRCR*expmDtOne(rcrStep2);//advanced over the previous time step
     rcrTime2 = currentTime;
   }
+  rcrStep2 = deltaTime;
   return MemConvP;
 }
+
+// Second order version of the convolution above, for BDF2: the pressure is
+// interpolated linearly over each step and the current step is included,
+// so the result depends on currP. MemConvP still holds the convolution up
+// to the previous time, advanced once per step.
+double cvOneDSubdomain::MemIntPexpLinear(double currP, double previousP, double deltaTime, double currentTime){
+  return ConvPressexpLinear(currP, previousP, deltaTime, currentTime);
+}
+
+double cvOneDSubdomain::dMemIntPexpLineardP(double deltaTime){
+  return LinearConvWeight(deltaTime);
+}
+
+// int_0^dt exp(-alphaRCR*(dt-s))*s/dt ds
+double cvOneDSubdomain::LinearConvWeight(double deltaTime){
+  return (deltaTime - expmDtOne(deltaTime)/alphaRCR)/(alphaRCR*deltaTime);
+}
+
+double cvOneDSubdomain::ConvPressexpLinear(double currP, double previousP, double deltaTime, double currentTime){
+  // Initialization
+  if(currentTime <= deltaTime ){
+    MemConvP = 0.0;
+    MemConvPrevP = previousP;
+  }
+  // Advanced over the previous time step, between its two pressures
+  if(currentTime > deltaTime && currentTime != rcrTime2){
+    double w1 = LinearConvWeight(rcrStep2);
+    double w0 = expmDtOne(rcrStep2)/alphaRCR - w1;
+    MemConvP = MemConvP*exp(-alphaRCR*rcrStep2) + w0*MemConvPrevP + w1*previousP;
+    MemConvPrevP = previousP;
+    rcrTime2 = currentTime;
+  }
+  rcrStep2 = deltaTime;
+  double w1 = LinearConvWeight(deltaTime);
+  double w0 = expmDtOne(deltaTime)/alphaRCR - w1;
+  return MemConvP*exp(-alphaRCR*deltaTime) + w0*previousP + w1*currP;
+}
+
 // wgyang convolution int(S(t')^(-3/2)exp(-alphaRCR(t-t')dt'
 double cvOneDSubdomain::MemIntSexp( double previousS, double deltaTime, double currentTime){
   double MemIrcr;
@@ -609,13 +672,87 @@ double cvOneDSubdomain::ConvSexp(double previousS, double deltaTime, double curr
   // Convoluted pressure
   if(currentTime > deltaTime && currentTime != rcrTime3){
     //MemConvS = MemConvS*exp(-alphaRCR*deltaTime)+pow(previousS,-1.5)/alphaRCR*expmDtOne(deltaTime);//all the deltaTime are from previous time step  convolution  int S(t)^(-3/2)exp(-alpha*(t-t')dt
-    MemConvS=MemConvS*exp(-alphaRCR*deltaTime)+previousS/alphaRCR*expmDtOne(deltaTime);
+    MemConvS=MemConvS*exp(-alphaRCR*rcrStep3)+previousS/alphaRCR*expmDtOne(rcrStep3);
     rcrTime3 = currentTime;
   }
+  rcrStep3 = deltaTime;
 
   return MemConvS;
 }
 
+void cvOneDSubdomain::CompleteBoundaryMemory(double p, double time, bool linear){
+  // Any step size will do, the convolutions advance over the stored one
+  double step = 1.0;
+  if(boundType == BoundCondTypeScope::RCR){
+    ConvPressRCR(p, step, time + step);
+    if(linear){
+      ConvPressexpLinear(p, p, step, time + step);
+    }else{
+      ConvPressexp(p, step, time + step);
+    }
+  }else if(boundType == BoundCondTypeScope::CORONARY){
+    ConvPressCoronary(p, step, time + step, expo1COR);
+  }
+}
+
+void cvOneDSubdomain::ResumeBoundaryMemory(double time, double deltaTime){
+  time += deltaTime;
+  rcrTime = rcrTime2 = rcrTime3 = corTime = time;
+  rcrStep = rcrStep2 = rcrStep3 = corStep = deltaTime;
+}
+
+void cvOneDSubdomain::SaveBoundaryMemory(void){
+  savedMemory.MemD = MemD;
+  savedMemory.MemD1 = MemD1;
+  savedMemory.MemD2 = MemD2;
+  savedMemory.MemConvP = MemConvP;
+  savedMemory.MemConvS = MemConvS;
+  savedMemory.MemConvPrevP = MemConvPrevP;
+  savedMemory.rcrTime = rcrTime;
+  savedMemory.rcrTime2 = rcrTime2;
+  savedMemory.rcrTime3 = rcrTime3;
+  savedMemory.corTime = corTime;
+  savedMemory.rcrStep = rcrStep;
+  savedMemory.rcrStep2 = rcrStep2;
+  savedMemory.rcrStep3 = rcrStep3;
+  savedMemory.corStep = corStep;
+}
+
+void cvOneDSubdomain::RestoreBoundaryMemory(void){
+  MemD = savedMemory.MemD;
+  MemD1 = savedMemory.MemD1;
+  MemD2 = savedMemory.MemD2;
+  MemConvP = savedMemory.MemConvP;
+  MemConvS = savedMemory.MemConvS;
+  MemConvPrevP = savedMemory.MemConvPrevP;
+  rcrTime = savedMemory.rcrTime;
+  rcrTime2 = savedMemory.rcrTime2;
+  rcrTime3 = savedMemory.rcrTime3;
+  corTime = savedMemory.corTime;
+  rcrStep = savedMemory.rcrStep;
+  rcrStep2 = savedMemory.rcrStep2;
+  rcrStep3 = savedMemory.rcrStep3;
+  corStep = savedMemory.corStep;
+}
+
+void cvOneDSubdomain::GetBoundaryMemory(double* values){
+  values[0] = MemD;
+  values[1] = MemD1;
+  values[2] = MemD2;
+  values[3] = MemConvP;
+  values[4] = MemConvS;
+  values[5] = MemConvPrevP;
+}
+
+void cvOneDSubdomain::SetBoundaryMemory(const double* values){
+  MemD = values[0];
+  MemD1 = values[1];
+  MemD2 = values[2];
+  MemConvP = values[3];
+  MemConvS = values[4];
+  MemConvPrevP = values[5];
+}
+
 double cvOneDSubdomain::dMemIntRCRdP(double deltaTime){
   double dMemIdP;
   dMemIdP = (deltaTime - expmDtOne(deltaTime)/alphaRCR)/alphaRCR;
@@ -50,6 +50,8 @@
 #include "cvOneDMaterialOlufsen.h"
 #include "cvOneDError.h"
 
+class cvOneDMaterialManager;
+
 class cvOneDSubdomain{
 
   public:
@@ -95,7 +97,8 @@ class cvOneDSubdomain{
     void SetGlobal1stNodeID(const long id){global1stNodeID = id;}
 
     cvOneDMaterial* GetMaterial(void) const {return mat;}// didn't change
-    void SetupMaterial(int matID);
+    // a copy of the material matID of the manager
+    void SetupMaterial(int matID, cvOneDMaterialManager* materials);
 
     // Boundary conditions if existent
     void  SetBoundCondition(BoundCondType bound){boundType = bound;}
@@ -112,6 +115,7 @@ class cvOneDSubdomain{
 	double GetBoundArea(){return boundValue;}
     double GetBoundResistance(){return boundValue;}
     double GetBoundResistance(double currentTime);
+    double GetMeanBoundResistance(void);
 	double GetBoundFlowRate(){return boundValue;}
     double getBoundCoronaryValues(double currentTime);
     double GetBoundAreabyPresWave(double currentTime);
@@ -143,6 +147,8 @@ class cvOneDSubdomain{
 	*/
 	double MemIntRCR(double currP, double previousP, double deltaTime, double currentTime);//compute integral over one time step of the pressure convolution in time int(P(t')*exp(-alphaRCR(t-t')),0,t)
 	double MemIntPexp(double previousP, double deltaTime, double currentTime);//compute integral over one time step of the pressure convolution in time int(P(t')*exp(-alphaRCR(t-t')),0,t) wgyang 2019/4
+	double MemIntPexpLinear(double currP, double previousP, double deltaTime, double currentTime);//same convolution up to the current time, P linear over each step, for BDF2
+	double dMemIntPexpLineardP(double deltaTime);//its derivative with respect to currP
 	double MemIntSexp(double previousS, double deltaTime, double currentTime);//compute integral over one time step of the area convolution in time int(A(t')^(-3/2)*exp(-alphaRCR(t-t')),0,t) wgyang 2019/4
 	double MemAdvRCR(double currP, double previousP, double deltaTime, double currentTime);//compute part of the advective term integral over one time step of Q^2, Q=couplingFunction(P)
 	double dMemIntRCRdP(double deltaTime);//used for contribution to LHS
@@ -203,6 +209,22 @@ class cvOneDSubdomain{
 	double* impedancePressure;
 	double  lastImpedancePressure;
 
+    // Keep a copy of the outlet convolution memory before a time step, so
+    // that a rejected step can be retried from the same state
+    void SaveBoundaryMemory(void);
+    void RestoreBoundaryMemory(void);
+    // The convolution integrals themselves, to treat them as unknowns of
+    // the periodic state
+    static const int BOUNDARY_MEMORY_SIZE = 6;
+    void GetBoundaryMemory(double* values);
+    void SetBoundaryMemory(const double* values);
+    // Advance the convolutions over the last step, which ended at time
+    // with outlet pressure p (with the venous pressure for the coronary),
+    // so that they do not depend on its size. ResumeBoundaryMemory then
+    // starts the next step from time with them as they are.
+    void CompleteBoundaryMemory(double p, double time, bool linear);
+    void ResumeBoundaryMemory(double time, double deltaTime);
+
   private:
     // The initial state & dimensions.
     int ID;
@@ -259,6 +281,8 @@ class cvOneDSubdomain{
     double Pd;
     double rcrTime2;
     double rcrTime3;
+    // length of the last time step, the memory is advanced over it on the next one
+    double rcrStep, rcrStep2, rcrStep3;
 
 	//Coronary BC kimhj 08312005
 	double p0COR, p1COR, p2COR;
@@ -268,6 +292,7 @@ class cvOneDSubdomain{
 	double CoefZ1, CoefY1, CoefZ2, CoefY2, CoefR;
 	double Ra1, Ra2, Ca, Cc, Rv1, P_v;
 	double corTime;
+	double corStep;
 
     //wave BC added IV 080603, parameters for the downstream tube
     //reference corss sectional area, number of modes in the "infinite" sum, domain length, end S BC, viscosity coeff, damping factor, wave speed
@@ -279,6 +304,7 @@ class cvOneDSubdomain{
     //double MemC(double currP, double previousP, double deltaTime, double currentTime);//for RCR BC -natural, made public to run in Brooke's formulation as well IV
     double MemD, MemD1, MemD2;//for RCR BC
     double MemConvP;//convolution P(t)*exp(-alpharcr*t) for RCR BC wgyang 2019/4 test!
+    double MemConvPrevP;//pressure at the start of the step MemConvP is advanced over next, second order only
     double MemConvS;//convolution S(t)^(-3/2)*exp(-alpharcr*t) for RCR BC wgyang 2019/4 test!
 	double MemDImp;//for impedance BC
     double MemDWave, MemDWave1, MemDWave2;//for Wave BC
@@ -295,6 +321,8 @@ class cvOneDSubdomain{
     double ConvPressCoronary(double previousP, double deltaTime, double currentTime, double exponent); //added kimhj 09022005
     double expmDtOneCoronary(double deltaTime, double exponent); //added kimhj 09022005
     double ConvPressexp(double previousP, double deltaTime, double currentTime);//convolution pressure = int(P(t')exp(-alpharcr(t-t')) in time for RCR BC wgyang test!
+    double ConvPressexpLinear(double currP, double previousP, double deltaTime, double currentTime);//same, second order
+    double LinearConvWeight(double deltaTime);//weight of the pressure at the end of a step in the second order convolution
     double ConvSexp(double previousS, double deltaTime, double currentTime);//convolution S^(-3/2) = int(S(t')^(-3/2)exp(-alpharcr(t-t')) in time for RCR BC wgyang test!
     double dMemCoronary1dP(void);
     double dMemCoronary2dP(void);
@@ -310,6 +338,13 @@ class cvOneDSubdomain{
     double dblConvolWave(double currS, double previousS, double deltaTime, double currentTime, double Time);//compute the double integral convolution in Q at time t
     double QWave(double currS, double prevS, double initS, double deltaTime, double currentTime,double Time);//compute Q at time t in time slab tn to tn+1
 
+    // Copy of the RCR and coronary memory from SaveBoundaryMemory()
+    struct BoundaryMemory{
+      double MemD, MemD1, MemD2, MemConvP, MemConvS, MemConvPrevP;
+      double rcrTime, rcrTime2, rcrTime3, corTime;
+      double rcrStep, rcrStep2, rcrStep3, corStep;
+    } savedMemory;
+
 };
 
 #endif // CVONEDSUBDOMAIN_H
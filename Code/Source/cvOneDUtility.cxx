@@ -30,9 +30,12 @@
  */
 
 # include "cvOneDUtility.h"
+# include "cvOneDContext.h"
 #include <regex>
+#include <stdio.h>
 #include <string.h>
 #include <cctype>
+#include <algorithm>
 
 //
 //  Utility.cxx - Source for Some Utility functions 
@@ -103,6 +106,22 @@ long sum(long size, long* values){
   return s;
 }
 
+cvLongVec balanced_partition(const cvLongVec& weights, int parts){
+  cvLongVec owner(weights.size(), 0);
+  vector<long> order(weights.size());
+  for( long i = 0; i < order.size(); i++){
+    order[i] = i;
+  }
+  stable_sort(order.begin(), order.end(), [&weights](long a, long b){return weights[a] > weights[b];});
+  vector<long> load(parts, 0);
+  for( long i = 0; i < order.size(); i++){
+    long lightest = (min_element(load.begin(), load.end()) - load.begin());
+    owner[order[i]] = lightest;
+    load[lightest] += weights[order[i]];
+  }
+  return owner;
+}
+
 void GetModulus( double* A, double* modulusA){
   double A2[4];	    // A2 = A*A
   A2[0] = A[0] * A[0] + A[1] * A[2];
@@ -262,3 +281,14 @@ int getListIDWithStringKey(string key,cvStringVec list){
     return -1;
   }
 }
+
+int cvOneDPrintf(const char* format, ...){
+  if(cvOneDContext::IsQuiet()){
+    return 0;
+  }
+  va_list args;
+  va_start(args, format);
+  int written = vprintf(format, args);
+  va_end(args);
+  return written;
+}
@@ -57,6 +57,9 @@ long max( long a, long b);
 long min( long size, long* values);
 long sum( long size, long* values);	
 void clear( long size, long* vec);	
+// owner of every item among parts, heaviest items first to the least
+// loaded part, so that the parts carry about the same weight
+cvLongVec balanced_partition(const cvLongVec& weights, int parts);
 // Calculates the modulus of the 2x2 matrix A and put the results
 // in modulusA using Cayley-Hamilton theory
 void GetModulus(double* A, double* modulusA);
@@ -76,4 +79,8 @@ class cvOneDQuadrature{
 
 int getListIDWithStringKey(string key,cvStringVec list);
 
+// printf for the solver output, which writes nothing on a thread bound to
+// a quiet context
+int cvOneDPrintf(const char* format, ...);
+
 #endif // CVONEDUTILITY_H
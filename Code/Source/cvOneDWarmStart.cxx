@@ -0,0 +1,91 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDWarmStart.cxx - Source for the Warm Start from Previous Results
+//  ~~~~~~~~~~~~~~~~~~~
+//
+//  The results are written at uniformly spaced nodes, so the row index
+//  gives the relative position of a node.
+//
+
+# include <fstream>
+# include <sstream>
+
+# include "cvOneDWarmStart.h"
+# include "cvOneDException.h"
+
+cvOneDWarmStart::cvOneDWarmStart(const string& filePrefix){
+  prefix = filePrefix;
+}
+
+void cvOneDWarmStart::Load(const string& segmentName){
+  ReadFinalColumn(prefix + segmentName + "_area.dat", area);
+  ReadFinalColumn(prefix + segmentName + "_flow.dat", flow);
+  if(area.size() < 2 || area.size() != flow.size()){
+    throw cvException(("ERROR: Inconsistent warm start results for segment " + segmentName + ".\n").c_str());
+  }
+}
+
+void cvOneDWarmStart::ReadFinalColumn(const string& fileName, vector<double>& values){
+  ifstream file(fileName.c_str());
+  if(!file){
+    throw cvException(("ERROR: Cannot open warm start file " + fileName + ".\n").c_str());
+  }
+  values.clear();
+  string line;
+  while(getline(file, line)){
+    istringstream row(line);
+    double value, last;
+    bool found = false;
+    while(row >> value){
+      last = value;
+      found = true;
+    }
+    if(found){
+      values.push_back(last);
+    }
+  }
+}
+
+double cvOneDWarmStart::Interpolate(const vector<double>& values, double s){
+  long last = values.size() - 1;
+  double x = s * last;
+  if(x <= 0.0){
+    return values[0];
+  }
+  if(x >= last){
+    return values[last];
+  }
+  long i = (long)x;
+  double w = x - i;
+  return (1.0 - w) * values[i] + w * values[i+1];
+}
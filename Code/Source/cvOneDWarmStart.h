@@ -0,0 +1,76 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDWARMSTART_H
+#define CVONEDWARMSTART_H
+
+//
+//  cvOneDWarmStart.h - Header for the Warm Start from Previous Results
+//  ~~~~~~~~~~~~~~~~~
+//
+//  Reads the final area and flow of a segment from the text results of a
+//  previous run, one row per node and one column per saved step, and
+//  interpolates them at a relative position along the segment, so the
+//  new mesh may have a different number of elements.
+//
+
+# include <string>
+# include <vector>
+
+using namespace std;
+
+class cvOneDWarmStart{
+
+  public:
+
+    // prefix of the result files, i.e. the model name of the previous run
+    cvOneDWarmStart(const string& prefix);
+
+    // reads <prefix><segmentName>_area.dat and _flow.dat, throws if a
+    // file is missing or the two do not have the same number of nodes
+    void Load(const string& segmentName);
+
+    // final values at s = z / segment length, linear between the nodes
+    double GetArea(double s) const {return Interpolate(area, s);}
+    double GetFlow(double s) const {return Interpolate(flow, s);}
+
+  private:
+
+    // last column of every row of a result file
+    static void ReadFinalColumn(const string& fileName, vector<double>& values);
+    static double Interpolate(const vector<double>& values, double s);
+
+    string prefix;
+    vector<double> area;
+    vector<double> flow;
+};
+
+#endif // CVONEDWARMSTART_H
@@ -0,0 +1,586 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDWaveformRelaxation.cxx - Source for a Waveform Relaxation Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  Over a window of steps, the segments below a cut take the outlet
+//  pressure of the segment above it as inlet pressure wave, and this one
+//  ends in a resistance equal to the characteristic impedance of the
+//  segments below, with the distal pressure that matches their last
+//  pressure and summed inlet flow rate. Without the impedance, a flow
+//  rate condition reflects the waves back at every iteration. The
+//  subtrees are integrated over the window from the last iterates at the
+//  cuts until these stop changing: all at once on worker threads for
+//  JACOBI, from the inlet downstream with the new pressures for
+//  GAUSS_SEIDEL.
+//
+
+# include <cmath>
+# include <iostream>
+# include <string>
+
+# include "cvOneDWaveformRelaxation.h"
+# include "cvOneDBFSolver.h"
+# include "cvOneDContext.h"
+# include "cvOneDException.h"
+# include "cvOneDMaterial.h"
+# include "cvOneDMthSegmentModel.h"
+# include "cvOneDMthBranchModel.h"
+# include "cvOneDSolverDefinitions.h"
+
+namespace {
+
+// Largest change of a waveform relative to its largest value
+double WaveformChange(const vector<double>& oldValues, const vector<double>& newValues){
+  double diff = 0.0;
+  double size = 0.0;
+  for(size_t m = 0; m < newValues.size(); m++){
+    diff = max(diff, fabs(newValues[m] - oldValues[m]));
+    size = max(size, fabs(newValues[m]));
+  }
+  return (size > 0.0) ? diff / size : diff;
+}
+
+} // namespace
+
+cvOneDWaveformRelaxation::cvOneDWaveformRelaxation(cvOneDBFSolver* solver_, WaveformRelaxationType type_,
+                                                   const cvStringVec& cuts_, long window_){
+  solver = solver_;
+  type = type_;
+  cuts = cuts_;
+  window = window_;
+}
+
+// The subtrees own their models, joints and systems, the subdomains are
+// those of the network
+cvOneDWaveformRelaxation::~cvOneDWaveformRelaxation(){
+  workers.clear();
+  if(!subtrees.empty()){
+    for(size_t t = 0; t < subtrees.size(); t++){
+      LoadSystem(subtrees[t]);
+      for(size_t k = 0; k < solver->jointList.size(); k++){
+        delete solver->jointList[k];
+      }
+      solver->FreeSystem();
+    }
+    LoadSystem(network);
+  }
+}
+
+void cvOneDWaveformRelaxation::Solve(void){
+  StoreSystem(network);
+  vector<long> firstNodes;
+  for(size_t i = 0; i < solver->subdomainList.size(); i++){
+    firstNodes.push_back(solver->subdomainList[i]->GetGlobal1stNodeID());
+  }
+  BuildSubtrees();
+  long windowSteps = (window > 0) ? window : solver->stepSize;
+  bool jacobi = (type == WaveformRelaxationTypeScope::JACOBI);
+  cout << "Using " << (jacobi ? "Jacobi" : "Gauss-Seidel") << " waveform relaxation over ";
+  cout << std::to_string(subtrees.size()) << " subtrees and windows of " << std::to_string(windowSteps) << " steps ..." << endl;
+
+  long iterTotal = 0;
+  long sweptSteps = 0;
+  long step = 0;
+  size_t t, k;
+  for(t = 0; t < subtrees.size(); t++){
+    LoadSystem(subtrees[t]);
+    solver->PackSliceState(subtrees[t].start, solver->currentTime);
+  }
+  while(step < solver->maxStep){
+    long steps = min(windowSteps, solver->maxStep - step);
+    double startTime = solver->currentTime;
+
+    // the values at the cuts at the start of the window are the first
+    // iterates over all of it
+    for(t = 0; t < subtrees.size(); t++){
+      cvOneDWaveformSubtree& tree = subtrees[t];
+      LoadSystem(tree);
+      tree.outletPressure.assign(tree.outletCuts.size(), vector<double>(steps + 1, 0.0));
+      tree.inletFlow.assign(steps + 1, 0.0);
+      solver->UnpackSliceState(tree.start, startTime, solver->deltaTime);
+      RecordCutValues(tree, 0);
+    }
+    for(k = 0; k < cutJoints.size(); k++){
+      cutFlow[k].assign(steps + 1, 0.0);
+      cutImpedance[k] = 0.0;
+    }
+    for(t = 0; t < subtrees.size(); t++){
+      cvOneDWaveformSubtree& tree = subtrees[t];
+      for(k = 0; k < tree.outletCuts.size(); k++){
+        cutPressure[tree.outletCuts[k]].assign(steps + 1, tree.outletPressure[k][0]);
+      }
+      if(tree.inletCut >= 0){
+        vector<double>& flow = cutFlow[tree.inletCut];
+        for(long m = 0; m <= steps; m++){
+          flow[m] += tree.inletFlow[0];
+        }
+        // the admittances of the segments below a cut add up
+        cvOneDMaterial* material = tree.subdomainList[0]->GetMaterial();
+        double S = tree.previousSolution->Get(0);
+        cutImpedance[tree.inletCut] += sqrt(S / (material->GetDensity() * material->GetDpDS(S, 0.0)));
+      }
+    }
+    for(k = 0; k < cutJoints.size(); k++){
+      cutImpedance[k] = 1.0 / cutImpedance[k];
+      cutDistalPressure[k].assign(steps + 1, cutPressure[k][0] - cutImpedance[k] * cutFlow[k][0]);
+    }
+
+    double change = 0.0;
+    int iter;
+    for(iter = 1; iter <= WAVEFORM_MAX_ITERATIONS; iter++){
+      change = RunSubtrees(startTime, step, steps, iterTotal);
+      sweptSteps += steps;
+      if(change < WAVEFORM_TOLERANCE){
+        break;
+      }
+    }
+    for(t = 0; t < subtrees.size(); t++){
+      subtrees[t].start.swap(subtrees[t].end);
+    }
+    step += steps;
+    solver->currentTime = startTime + steps * solver->deltaTime;
+    if(iter > WAVEFORM_MAX_ITERATIONS){
+      cout << "WARNING: Waveform relaxation not converged at time " << solver->currentTime << ", change = " << change << endl;
+      iter = WAVEFORM_MAX_ITERATIONS;
+    }
+    cout << "  Time = " << solver->currentTime << ", ";
+    cout << "Waveform iters = " << std::to_string(iter) << endl;
+  }
+
+  // Back to the numbering, outlets and arrays of the network, with the
+  // final state of the subtrees
+  vector<double> final(network.currentSolution->GetDimension(), 0.0);
+  for(t = 0; t < subtrees.size(); t++){
+    cvOneDWaveformSubtree& tree = subtrees[t];
+    for(k = 0; k < tree.outletSegments.size(); k++){
+      tree.subdomainList[tree.outletSegments[k]]->SetBoundCondition(BoundCondTypeScope::NOBOUND);
+    }
+    for(size_t j = 0; j < tree.globalEqs.size(); j++){
+      final[tree.globalEqs[j]] = tree.start[j];
+    }
+  }
+  for(size_t i = 0; i < firstNodes.size(); i++){
+    network.subdomainList[i]->SetGlobal1stNodeID(firstNodes[i]);
+  }
+  LoadSystem(network);
+  for(size_t j = 0; j < final.size(); j++){
+    solver->previousSolution->Set(j, final[j]);
+  }
+  *solver->currentSolution = *solver->previousSolution;
+
+  cout << "\nAvgerage number of Newton-Raphson iterations per time step and sweep = ";
+  cout << (double)iterTotal / (double)sweptSteps << "\n" << endl;
+}
+
+void cvOneDWaveformRelaxation::BuildSubtrees(void){
+  vector<cvOneDSubdomain*>& subdomainList = solver->subdomainList;
+  vector<cvOneDFEAJoint*>& jointList = solver->jointList;
+  long numSegs = subdomainList.size();
+  long numJoints = jointList.size();
+  size_t c, k;
+  long i;
+
+  cutJoints.clear();
+  vector<bool> isCut(numJoints, false);
+  for(c = 0; c < cuts.size(); c++){
+    long found = -1;
+    for(i = 0; i < numJoints; i++){
+      if(cuts[c] == solver->model->getJoint(i)->Name){
+        found = i;
+      }
+    }
+    if(found < 0){
+      throw cvException(string("ERROR: Unknown waveform relaxation cut: " + cuts[c] + "\n").c_str());
+    }
+    if(isCut[found] || jointList[found]->getNumberOfInletSegments() != 1){
+      throw cvException(string("ERROR: Invalid waveform relaxation cut: " + cuts[c] + "\n").c_str());
+    }
+    isCut[found] = true;
+    cutJoints.push_back(found);
+  }
+  if(cutJoints.empty()){
+    throw cvException("ERROR: Waveform relaxation requires at least one cut joint.\n");
+  }
+
+  // segments joined by the other joints share the smallest index as label
+  vector<long> label(numSegs);
+  for(i = 0; i < numSegs; i++){
+    label[i] = i;
+  }
+  bool changed = true;
+  while(changed){
+    changed = false;
+    for(i = 0; i < numJoints; i++){
+      if(isCut[i]){
+        continue;
+      }
+      cvOneDFEAJoint* joint = jointList[i];
+      long smallest = numSegs;
+      for(int j = 0; j < joint->getNumberOfSegments(); j++){
+        int id = (j < joint->getNumberOfInletSegments()) ? joint->GetInletID(j) : joint->GetOutletID(j - joint->getNumberOfInletSegments());
+        smallest = min(smallest, label[id]);
+      }
+      for(int j = 0; j < joint->getNumberOfSegments(); j++){
+        int id = (j < joint->getNumberOfInletSegments()) ? joint->GetInletID(j) : joint->GetOutletID(j - joint->getNumberOfInletSegments());
+        if(label[id] != smallest){
+          label[id] = smallest;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // roots in order from the inlet: the inlet segment, then the segments
+  // below the cuts of the subtrees already found
+  vector<long> roots(1, 0);
+  vector<long> rootCut(1, -1);
+  vector<long> treeOfLabel(numSegs, -1);
+  treeOfLabel[label[0]] = 0;
+  for(size_t r = 0; r < roots.size(); r++){
+    for(c = 0; c < cutJoints.size(); c++){
+      cvOneDFEAJoint* joint = jointList[cutJoints[c]];
+      if(label[joint->GetInletID(0)] != label[roots[r]]){
+        continue;
+      }
+      for(int j = 0; j < joint->getNumberOfOutletSegments(); j++){
+        long child = joint->GetOutletID(j);
+        if(treeOfLabel[label[child]] >= 0){
+          throw cvException("ERROR: The waveform relaxation cuts must split the network into trees.\n");
+        }
+        treeOfLabel[label[child]] = roots.size();
+        roots.push_back(child);
+        rootCut.push_back(c);
+      }
+    }
+  }
+  for(i = 0; i < numSegs; i++){
+    if(treeOfLabel[label[i]] < 0){
+      throw cvException("ERROR: The waveform relaxation cuts must split the network into trees.\n");
+    }
+  }
+
+  // local lists and the network equations of the local ones, before
+  // the segments are renumbered
+  subtrees.assign(roots.size(), cvOneDWaveformSubtree());
+  vector<long> localIndex(numSegs, -1);
+  for(size_t r = 0; r < roots.size(); r++){
+    cvOneDWaveformSubtree& tree = subtrees[r];
+    tree.inletCut = rootCut[r];
+    localIndex[roots[r]] = 0;
+    tree.subdomainList.push_back(subdomainList[roots[r]]);
+    for(i = 0; i < numSegs; i++){
+      if(i != roots[r] && treeOfLabel[label[i]] == (long)r){
+        localIndex[i] = tree.subdomainList.size();
+        tree.subdomainList.push_back(subdomainList[i]);
+      }
+    }
+    for(k = 0; k < tree.subdomainList.size(); k++){
+      long first = tree.subdomainList[k]->GetGlobal1stNodeID();
+      for(long n = 0; n < 2 * tree.subdomainList[k]->GetNumberOfNodes(); n++){
+        tree.globalEqs.push_back(2 * first + n);
+      }
+    }
+  }
+  for(i = 0; i < numJoints; i++){
+    cvOneDFEAJoint* joint = jointList[i];
+    cvOneDWaveformSubtree& tree = subtrees[treeOfLabel[label[joint->GetInletID(0)]]];
+    if(isCut[i]){
+      continue;
+    }
+    cvOneDFEAJoint* local = new cvOneDFEAJoint();
+    for(int j = 0; j < joint->getNumberOfInletSegments(); j++){
+      local->AddInletSubdomains(localIndex[joint->GetInletID(j)]);
+    }
+    for(int j = 0; j < joint->getNumberOfOutletSegments(); j++){
+      local->AddOutletSubdomains(localIndex[joint->GetOutletID(j)]);
+    }
+    tree.jointList.push_back(local);
+    for(int j = 0; j < joint->getNumberOfSegments(); j++){
+      tree.globalEqs.push_back(joint->GetGlobal1stLagNodeID() + j);
+    }
+  }
+  for(k = 0; k < solver->outletList.size(); k++){
+    subtrees[treeOfLabel[label[solver->outletList[k]]]].outletList.push_back(localIndex[solver->outletList[k]]);
+  }
+  cutPressure.assign(cutJoints.size(), vector<double>());
+  cutFlow.assign(cutJoints.size(), vector<double>());
+  cutImpedance.assign(cutJoints.size(), 0.0);
+  cutDistalPressure.assign(cutJoints.size(), vector<double>());
+  for(c = 0; c < cutJoints.size(); c++){
+    long parent = jointList[cutJoints[c]]->GetInletID(0);
+    cvOneDWaveformSubtree& tree = subtrees[treeOfLabel[label[parent]]];
+    tree.outletList.push_back(localIndex[parent]);
+    tree.outletCuts.push_back(c);
+    tree.outletSegments.push_back(localIndex[parent]);
+    subdomainList[parent]->SetBoundCondition(BoundCondTypeScope::RESISTANCE);
+  }
+
+  // local numbering, models and systems
+  const cvOneDFEAVector* networkSolution = solver->previousSolution;
+  for(size_t r = 0; r < subtrees.size(); r++){
+    cvOneDWaveformSubtree& tree = subtrees[r];
+    long first = 0;
+    for(k = 0; k < tree.subdomainList.size(); k++){
+      tree.subdomainList[k]->SetGlobal1stNodeID(first);
+      first += tree.subdomainList[k]->GetNumberOfNodes();
+    }
+    first *= 2;
+    for(k = 0; k < tree.jointList.size(); k++){
+      tree.jointList[k]->SetGlobal1stLagNodeID(first);
+      first += tree.jointList[k]->getNumberOfSegments();
+    }
+
+    cvOneDMthSegmentModel* segM = new cvOneDMthSegmentModel(tree.subdomainList, tree.jointList, tree.outletList, solver->quadPoints);
+    cvOneDMthBranchModel* branchM = new cvOneDMthBranchModel(tree.subdomainList, tree.jointList, tree.outletList);
+    solver->SetupModel(segM);
+    solver->SetupModel(branchM);
+    segM->SetStabilization(solver->stabilization);
+    if(tree.inletCut < 0){
+      segM->SetInflowRate(solver->flowTime, solver->flowRate, solver->numFlowPts, solver->flowTime[solver->numFlowPts-1]);
+    }else{
+      segM->SetInletType(BoundCondTypeScope::PRESSURE_WAVE);
+    }
+    tree.mathModels.push_back(segM);
+    tree.mathModels.push_back(branchM);
+    LoadSystem(tree);
+    solver->CreateSystemArrays();
+    StoreSystem(tree);
+    for(k = 0; k < tree.globalEqs.size(); k++){
+      solver->previousSolution->Set(k, networkSolution->Get(tree.globalEqs[k]));
+    }
+    *solver->currentSolution = *solver->previousSolution;
+    for(k = 0; k < tree.mathModels.size(); k++){
+      tree.mathModels[k]->EquationInitialize(solver->previousSolution, solver->currentSolution, solver->olderSolution);
+    }
+  }
+}
+
+// Integration of a subtree over the window from its start state to its
+// end state, with the current iterates at the cuts, saving its rows of
+// the results
+long cvOneDWaveformRelaxation::IntegrateSubtree(cvOneDWaveformSubtree& tree, double startTime, long firstStep, long steps){
+  LoadSystem(tree);
+  double deltaTime = solver->deltaTime;
+  solver->UnpackSliceState(tree.start, startTime, deltaTime);
+  solver->currentTime = startTime;
+
+  // the inlet pressure wave is held one step beyond the window; the
+  // joints take the pressure at the inlet coordinate of the segment, the
+  // inlet condition at zero
+  if(tree.inletCut >= 0){
+    const vector<double>& pressure = cutPressure[tree.inletCut];
+    cvOneDSubdomain* root = solver->subdomainList[0];
+    cvOneDMaterial* material = root->GetMaterial();
+    vector<double> times(steps + 3);
+    vector<double> values(steps + 3);
+    for(long s = -1; s <= steps + 1; s++){
+      double p = pressure[min(max(s, 0L), steps)];
+      times[s + 1] = startTime + s * deltaTime;
+      values[s + 1] = material->GetPressure(material->GetArea(p, root->GetInletZ()), 0.0);
+    }
+    solver->mathModels[0]->SetInflowRate(&times[0], &values[0], steps + 3, times[steps + 2] + deltaTime);
+  }
+
+  long iterTotal = 0;
+  int numMath = solver->mathModels.size();
+  long dim = solver->currentSolution->GetDimension();
+  for(long s = 1; s <= steps; s++){
+    for(size_t k = 0; k < tree.outletCuts.size(); k++){
+      long c = tree.outletCuts[k];
+      double resistPd[2] = {cutImpedance[c], cutDistalPressure[c][s]};
+      solver->subdomainList[tree.outletSegments[k]]->SetBoundResistPdValues(resistPd, 2);
+    }
+    solver->increment->Clear();
+    // a window starts from a single state, its first step is backward Euler
+    for(int i = 0; i < numMath; i++){
+      solver->mathModels[i]->TimeUpdate(solver->currentTime, deltaTime, (s > 1) ? deltaTime : 0.0);
+    }
+    solver->currentTime += deltaTime;
+    iterTotal += solver->SolveTimeStep(firstStep + s, deltaTime, false);
+    RecordCutValues(tree, s);
+    long step = firstStep + s;
+    if(step % solver->stepSize == 0){
+      double* tmp = solver->currentSolution->GetEntries();
+      for(long j = 0; j < dim; j++){
+        solver->TotalSolution[step / solver->stepSize][tree.globalEqs[j]] = tmp[j];
+      }
+    }
+    if(solver->olderSolution != NULL){
+      *solver->olderSolution = *solver->previousSolution;
+    }
+    *solver->previousSolution = *solver->currentSolution;
+  }
+  solver->PackSliceState(tree.end, solver->currentTime);
+  return iterTotal;
+}
+
+// One sweep over the subtrees, returns the largest relative change of
+// the pressures and flow rates at the cuts
+double cvOneDWaveformRelaxation::RunSubtrees(double startTime, long firstStep, long steps, long& iterTotal){
+  bool jacobi = (type == WaveformRelaxationTypeScope::JACOBI);
+  size_t numTrees = subtrees.size();
+  size_t t, k;
+  bool done = false;
+  if(jacobi && solver->workerFactory){
+    // worker t integrates its copy of subtree t with the iterates at the
+    // cuts, and hands back the values at the cuts, the end state and the
+    // rows of the results of the subtree
+    long firstRow = firstStep / solver->stepSize + 1;
+    long lastRow = (firstStep + steps) / solver->stepSize;
+    vector<long> iters(numTrees, 0);
+    workers.resize(numTrees);
+    solver->RunWorkers(workerContexts, numTrees, [&](cvOneDBFSolver* worker, size_t w){
+      if(!workers[w]){
+        workers[w].reset(new cvOneDWaveformRelaxation(worker, type, cuts, window));
+        workers[w]->StoreSystem(workers[w]->network);
+        workers[w]->BuildSubtrees();
+      }
+      cvOneDWaveformRelaxation& relaxation = *workers[w];
+      cvOneDWaveformSubtree& tree = subtrees[w];
+      cvOneDWaveformSubtree& copy = relaxation.subtrees[w];
+      relaxation.cutPressure = cutPressure;
+      relaxation.cutImpedance = cutImpedance;
+      relaxation.cutDistalPressure = cutDistalPressure;
+      copy.start = tree.start;
+      copy.outletPressure = tree.outletPressure;
+      copy.inletFlow = tree.inletFlow;
+      iters[w] = relaxation.IntegrateSubtree(copy, startTime, firstStep, steps);
+      tree.outletPressure = copy.outletPressure;
+      tree.inletFlow = copy.inletFlow;
+      tree.end = copy.end;
+      for(long q = firstRow; q <= lastRow; q++){
+        for(size_t j = 0; j < tree.globalEqs.size(); j++){
+          solver->TotalSolution[q][tree.globalEqs[j]] = worker->TotalSolution[q][tree.globalEqs[j]];
+        }
+      }
+    });
+    for(t = 0; t < numTrees; t++){
+      iterTotal += iters[t];
+    }
+    done = true;
+  }
+
+  // Gauss-Seidel passes the new outlet pressures on to the subtrees below
+  double change = 0.0;
+  for(t = 0; t < numTrees; t++){
+    cvOneDWaveformSubtree& tree = subtrees[t];
+    if(!done){
+      iterTotal += IntegrateSubtree(tree, startTime, firstStep, steps);
+    }
+    if(!jacobi){
+      for(k = 0; k < tree.outletCuts.size(); k++){
+        change = max(change, WaveformChange(cutPressure[tree.outletCuts[k]], tree.outletPressure[k]));
+        cutPressure[tree.outletCuts[k]] = tree.outletPressure[k];
+      }
+    }
+  }
+
+  // the flow rates below the cuts and the distal pressures are updated
+  // at the end of the sweep. The distal pressure pairs the flow rates
+  // with the pressures the segments below were integrated with, the new
+  // ones for Gauss-Seidel and the old ones for Jacobi, so that the parent
+  // sees the wave that actually comes back up.
+  vector<vector<double> > flow(cutJoints.size(), vector<double>(steps + 1, 0.0));
+  for(t = 0; t < numTrees; t++){
+    cvOneDWaveformSubtree& tree = subtrees[t];
+    if(tree.inletCut >= 0){
+      for(long m = 0; m <= steps; m++){
+        flow[tree.inletCut][m] += tree.inletFlow[m];
+      }
+    }
+  }
+  for(k = 0; k < cutJoints.size(); k++){
+    change = max(change, WaveformChange(cutFlow[k], flow[k]));
+    cutFlow[k] = flow[k];
+    for(long m = 0; m <= steps; m++){
+      cutDistalPressure[k][m] = cutPressure[k][m] - cutImpedance[k] * cutFlow[k][m];
+    }
+  }
+  if(jacobi){
+    for(t = 0; t < numTrees; t++){
+      cvOneDWaveformSubtree& tree = subtrees[t];
+      for(k = 0; k < tree.outletCuts.size(); k++){
+        change = max(change, WaveformChange(cutPressure[tree.outletCuts[k]], tree.outletPressure[k]));
+        cutPressure[tree.outletCuts[k]] = tree.outletPressure[k];
+      }
+    }
+  }
+  return change;
+}
+
+// Pressures at the outlet cuts and inlet flow rate of the current solution
+void cvOneDWaveformRelaxation::RecordCutValues(cvOneDWaveformSubtree& tree, long s){
+  long eqNumbers[2];
+  for(size_t k = 0; k < tree.outletSegments.size(); k++){
+    cvOneDSubdomain* sub = solver->subdomainList[tree.outletSegments[k]];
+    solver->mathModels[0]->GetNodalEquationNumbers(sub->GetNumberOfNodes() - 1, eqNumbers, tree.outletSegments[k]);
+    tree.outletPressure[k][s] = sub->GetMaterial()->GetPressure(solver->currentSolution->Get(eqNumbers[0]), sub->GetOutletZ());
+  }
+  if(tree.inletCut >= 0){
+    solver->mathModels[0]->GetNodalEquationNumbers(0, eqNumbers, 0);
+    tree.inletFlow[s] = solver->currentSolution->Get(eqNumbers[1]);
+  }
+}
+
+void cvOneDWaveformRelaxation::StoreSystem(cvOneDWaveformSubtree& tree){
+  tree.subdomainList = solver->subdomainList;
+  tree.jointList = solver->jointList;
+  tree.outletList = solver->outletList;
+  tree.mathModels = solver->mathModels;
+  tree.currentSolution = solver->currentSolution;
+  tree.previousSolution = solver->previousSolution;
+  tree.olderSolution = solver->olderSolution;
+  tree.increment = solver->increment;
+  tree.rhs = solver->rhs;
+  tree.searchOrigin = solver->searchOrigin;
+  tree.savedSolution = solver->savedSolution;
+  tree.lhs = solver->lhs;
+  tree.solver = solver->linearSolver;
+}
+
+void cvOneDWaveformRelaxation::LoadSystem(const cvOneDWaveformSubtree& tree){
+  solver->subdomainList = tree.subdomainList;
+  solver->jointList = tree.jointList;
+  solver->outletList = tree.outletList;
+  solver->mathModels = tree.mathModels;
+  solver->currentSolution = tree.currentSolution;
+  solver->previousSolution = tree.previousSolution;
+  solver->olderSolution = tree.olderSolution;
+  solver->increment = tree.increment;
+  solver->rhs = tree.rhs;
+  solver->searchOrigin = tree.searchOrigin;
+  solver->savedSolution = tree.savedSolution;
+  solver->lhs = tree.lhs;
+  solver->linearSolver = tree.solver;
+}
@@ -0,0 +1,147 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDWAVEFORMRELAXATION_H
+#define CVONEDWAVEFORMRELAXATION_H
+
+//
+//  cvOneDWaveformRelaxation.h - Header for a Waveform Relaxation Solver
+//  ~~~~~~~~~~~~~~~~~~~~~~~~~~
+//
+//  This class cuts the network of a solver at the named joints into
+//  subtrees, each with its own numbering, models and system, and
+//  integrates them over windows of steps until the pressures and flow
+//  rates at the cuts stop changing. The subtrees take turns on the
+//  arrays of the solver, which is back on the whole network once the
+//  relaxation is destroyed.
+//
+
+# include <vector>
+# include <memory>
+
+# include "cvOneDTypes.h"
+# include "cvOneDEnums.h"
+
+using namespace std;
+
+class cvOneDBFSolver;
+class cvOneDContext;
+class cvOneDSubdomain;
+class cvOneDFEAJoint;
+class cvOneDMthModelBase;
+class cvOneDFEAVector;
+class cvOneDFEAMatrix;
+class cvOneDLinearSolver;
+
+// A subtree of the network cut at the waveform relaxation joints, with
+// its own numbering, mathematical models and system arrays
+struct cvOneDWaveformSubtree{
+  // local lists, the root segment first
+  vector<cvOneDSubdomain*> subdomainList;
+  vector<cvOneDFEAJoint*> jointList;
+  vector<int> outletList;
+  vector<cvOneDMthModelBase*> mathModels;
+  // network equation of every local equation
+  vector<long> globalEqs;
+  // cut joint that feeds the root, -1 at the inlet of the network
+  long inletCut;
+  // cut joints below the subtree and the local index of their inlet segment,
+  // which ends in a resistance
+  vector<long> outletCuts;
+  vector<int> outletSegments;
+  cvOneDFEAVector *currentSolution = NULL;
+  cvOneDFEAVector *previousSolution = NULL;
+  cvOneDFEAVector *olderSolution = NULL;
+  cvOneDFEAVector *increment = NULL;
+  cvOneDFEAVector *rhs = NULL;
+  cvOneDFEAVector *searchOrigin = NULL;
+  cvOneDFEAVector *savedSolution = NULL;
+  cvOneDFEAMatrix *lhs = NULL;
+  cvOneDLinearSolver *solver = NULL;
+  // states at the start and at the end of the window, pressures at the
+  // outlet cuts and inlet flow rate at every step of the window
+  vector<double> start;
+  vector<double> end;
+  vector<vector<double> > outletPressure;
+  vector<double> inletFlow;
+};
+
+class cvOneDWaveformRelaxation{
+
+  public:
+
+    // window is the number of steps iterated at once, zero for the
+    // output interval of the solver
+    cvOneDWaveformRelaxation(cvOneDBFSolver* solver, WaveformRelaxationType type,
+                             const cvStringVec& cuts, long window);
+    ~cvOneDWaveformRelaxation();
+
+    // Time loop of the solver from previousSolution, saving the rows of
+    // the results and leaving the final state in previousSolution
+    void Solve(void);
+
+  private:
+
+    // Subtrees and their systems from the cut joints, each starting from
+    // its part of previousSolution
+    void BuildSubtrees(void);
+    long IntegrateSubtree(cvOneDWaveformSubtree& tree, double startTime, long firstStep, long steps);
+    double RunSubtrees(double startTime, long firstStep, long steps, long& iterTotal);
+    void RecordCutValues(cvOneDWaveformSubtree& tree, long s);
+    // Lists, models and arrays of the solver to and from a subtree
+    void StoreSystem(cvOneDWaveformSubtree& tree);
+    void LoadSystem(const cvOneDWaveformSubtree& tree);
+
+    cvOneDBFSolver* solver;
+    WaveformRelaxationType type;
+    cvStringVec cuts;
+    long window;
+
+    // the subtrees in order from the inlet, the system of the whole
+    // network while they are loaded, their cut joints, the pressures and
+    // flow rates at the cuts over the window, the current iterates the
+    // subtrees are integrated with, the characteristic impedances below
+    // the cuts and the distal pressures of the resistances above them
+    vector<cvOneDWaveformSubtree> subtrees;
+    cvOneDWaveformSubtree network;
+    vector<long> cutJoints;
+    vector<vector<double> > cutPressure;
+    vector<vector<double> > cutFlow;
+    vector<double> cutImpedance;
+    vector<vector<double> > cutDistalPressure;
+
+    // Jacobi: the worker contexts and the relaxations of their solvers,
+    // which go before the contexts
+    vector<unique_ptr<cvOneDContext> > workerContexts;
+    vector<unique_ptr<cvOneDWaveformRelaxation> > workers;
+};
+
+#endif // CVONEDWAVEFORMRELAXATION_H
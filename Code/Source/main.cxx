@@ -30,15 +30,21 @@
  */
 
 #include <string.h>
+#include <iostream>
 #include <optional>
 #include <algorithm>
+#ifdef USE_MPI
+#include <mpi.h>
+#endif
 
 #include "cvOneDGlobal.h"
-#include "cvOneDModelManager.h"
+#include "cvOneDEnsemble.h"
 #include "cvOneDOptions.h"
 #include "cvOneDOptionsJsonParser.h"
 #include "cvOneDOptionsJsonSerializer.h"
 #include "cvOneDOptionsLegacySerializer.h"
+#include "cvOneDServer.h"
+#include "cvOneDSimulation.h"
 
 using namespace std;
 
@@ -52,336 +58,81 @@ void WriteHeader(){
   printf("---------------------------------\n");
 }
 
-// ====================================
-// GET DATA TABLE ENTRY FROM STRING KEY
-// ====================================
-int getDataTableIDFromStringKey(string key){
-  bool found = false;
-  int count = 0;
-  while((!found)&&(count<cvOneDGlobal::gDataTables.size())){
-    found = upper_string(key) == upper_string(cvOneDGlobal::gDataTables[count]->getName());
-    // Update Counter
-    if(!found){
-      count++;
-    }
-  }
-  if(!found){
-    throw cvException(string("ERROR: Cannot find data table entry from string key: " + key + ".\n").c_str());
-    return -1;
-  }else{
-    return count;
-  }
-}
+namespace {
 
-// ===============================
-// CREATE MODEL AND RUN SIMULATION
-// ===============================
-namespace{
+void writeOptionsEcho(const cvOneD::options& opts){
 
-size_t findJointNodeIndexOrThrow(const auto& jointNodeName, const auto& nodeNames, const auto& jointName){
-  // Return the index of "nodeNames" that corresponds to the "jointNodeName"
-  // or throw a context-specific error.
+  // Print Input Data Echo, once in a distributed run
+  if(cvOneDGlobal::rank == 0){
+    string fileName("echo.out");
+    cvOneD::printToLegacyFile(opts,fileName);
 
-  auto const iter = std::find(nodeNames.begin(), nodeNames.end(), jointNodeName);
-  if (iter == nodeNames.end()) {
-    std::string const errMsg = "ERROR: The node '" + jointNodeName + "' required by joint '" 
-      + jointName + "' was not found in the list of nodes.";
-    throw cvException(errMsg.c_str());
+    // For now, we'll just duplicate the printing of
+    // the echo of the options to JSON as well
+    string jsonFilename("echo.json");
+    cvOneD::writeJsonOptions(opts, jsonFilename);
   }
-  return std::distance(nodeNames.begin(), iter); 
+
 }
 
 } // namespace
 
-void createAndRunModel(const cvOneD::options& opts) {
-
-  // MESSAGE
-  printf("\n");
-  printf("Creating and Running Model ...\n");
-
-  // CREATE MODEL MANAGER
-  cvOneDModelManager* oned = new cvOneDModelManager((char*)opts.modelName.c_str());
-
-  // CREATE NODES
-  printf("Creating Nodes ... \n");
-  int totNodes = opts.nodeName.size();
-  int nodeError = CV_OK;
-  for(int loopA = 0; loopA < totNodes; loopA++) {
-    // Finally Create Joint
-    nodeError = oned->CreateNode((char*)opts.nodeName[loopA].c_str(),
-                                 opts.nodeXcoord[loopA], opts.nodeYcoord[loopA], opts.nodeZcoord[loopA]);
-    if(nodeError == CV_ERROR) {
-      throw cvException(string("ERROR: Error Creating NODE " + to_string(loopA) + "\n").c_str());
-    }
-  }
-
-  // CREATE JOINTS
-  printf("Creating Joints ... \n");
-  int totJoints = opts.jointName.size();
-  int jointError = CV_OK;
-  int* asInlets = nullptr;
-  int* asOutlets = nullptr;
-  string currInletName;
-  string currOutletName;
-  int jointInletID = 0;
-  int jointOutletID = 0;
-  int totJointInlets = 0;
-  int totJointOutlets = 0;
-  for(int loopA = 0; loopA < totJoints; loopA++) {
-    // GET NAMES FOR INLET AND OUTLET
-    currInletName = opts.jointInletName[loopA];
-    currOutletName = opts.jointOutletName[loopA];
-    // FIND JOINTINLET INDEX
-    jointInletID = getListIDWithStringKey(currInletName, opts.jointInletListNames);
-    if(jointInletID < 0) {
-      throw cvException(string("ERROR: Cannot Find JOINTINLET for key " + currInletName).c_str());
-    }
-    totJointInlets = opts.jointInletListNumber[jointInletID];
-    // FIND JOINTOUTLET INDEX
-    jointOutletID = getListIDWithStringKey(currOutletName, opts.jointOutletListNames);
-    if(jointInletID < 0) {
-      throw cvException(string("ERROR: Cannot Find JOINTOUTLET for key " + currOutletName).c_str());
-    }
-    // GET TOTALS
-    totJointInlets = opts.jointInletListNumber[jointInletID];
-    totJointOutlets = opts.jointOutletListNumber[jointOutletID];
-    // ALLOCATE INLETS AND OUTLET LIST
-    asInlets = nullptr;
-    asOutlets = nullptr;
-    if(totJointInlets > 0) {
-      asInlets = new int[totJointInlets];
-      for(int loopB = 0; loopB < totJointInlets; loopB++) {
-        asInlets[loopB] = opts.jointInletList[jointInletID][loopB];
-      }
-    }
-    if(totJointOutlets > 0) {
-      asOutlets = new int[totJointOutlets];
-      for(int loopB = 0; loopB < totJointOutlets; loopB++) {
-        asOutlets[loopB] = opts.jointOutletList[jointOutletID][loopB];
-      }
-    }
-
-    // Find the index of the indicated node.
-    auto const jointName = opts.jointName.at(loopA);
-    auto const nodeIndex = findJointNodeIndexOrThrow( 
-      opts.jointNode.at(loopA), opts.nodeName, jointName);
-
-    // Finally Create Joint
-    jointError = oned->CreateJoint(jointName.c_str(),
-                                   opts.nodeXcoord[nodeIndex], opts.nodeYcoord[nodeIndex], opts.nodeZcoord[nodeIndex],
-                                   totJointInlets, totJointOutlets, asInlets, asOutlets);
-    if(jointError == CV_ERROR) {
-      throw cvException(string("ERROR: Error Creating JOINT " + to_string(loopA) + "\n").c_str());
-    }
-    // Deallocate
-    delete[] asInlets;
-    delete[] asOutlets;
-    asInlets = nullptr;
-    asOutlets = nullptr;
-  }
-
-  // CREATE MATERIAL
-  printf("Creating Materials ... \n");
-  int totMaterials = opts.materialName.size();
-  int matError = CV_OK;
-  double doubleParams[3];
-  int matID = 0;
-  string currMatType = "MATERIAL_OLUFSEN";
-  int numParams = 0;
-  for(int loopA = 0; loopA < totMaterials; loopA++) {
-    if(upper_string(opts.materialType[loopA]) == "OLUFSEN") {
-      currMatType = "MATERIAL_OLUFSEN";
-      numParams = 3;
-    } else {
-      currMatType = "MATERIAL_LINEAR";
-      numParams = 1;
-    }
-    doubleParams[0] = opts.materialParam1[loopA];
-    doubleParams[1] = opts.materialParam2[loopA];
-    doubleParams[2] = opts.materialParam3[loopA];
-    // CREATE MATERIAL
-    matError = oned->CreateMaterial((char*)opts.materialName[loopA].c_str(),
-                                    (char*)currMatType.c_str(),
-                                    opts.materialDensity[loopA],
-                                    opts.materialViscosity[loopA],
-                                    opts.materialExponent[loopA],
-                                    opts.materialPRef[loopA],
-                                    numParams, doubleParams,
-                                    &matID);
-    if(matError == CV_ERROR) {
-      throw cvException(string("ERROR: Error Creating MATERIAL " + to_string(loopA) + "\n").c_str());
-    }
+void runOneDSolver(const cvOneD::options& opts){
 
-  }
+  // Model Checking
+  cvOneD::validateOptions(opts);
 
-  // CREATE DATATABLES
-  printf("Creating Data Tables ... \n");
-  int totCurves = opts.dataTableName.size();
-  int curveError = CV_OK;
-  for(int loopA = 0; loopA < totCurves; loopA++) {
-    curveError = oned->CreateDataTable((char*)opts.dataTableName[loopA].c_str(),(char*)opts.dataTableType[loopA].c_str(), opts.dataTableVals[loopA]);
-    if(curveError == CV_ERROR) {
-      throw cvException(string("ERROR: Error Creating DATATABLE " + to_string(loopA) + "\n").c_str());
-    }
-  }
+  writeOptionsEcho(opts);
 
-  // SEGMENT DATA
-  printf("Creating Segments ... \n");
-  int segmentError = CV_OK;
-  int totalSegments = opts.segmentName.size();
-  int curveTotals = 0;
-  double* curveTime = nullptr;
-  double* curveValue = nullptr;
-  string matName;
-  string curveName;
-  int currMatID = 0;
-  int dtIDX = 0;
-  for(int loopA = 0; loopA < totalSegments; loopA++) {
-
-    // GET MATERIAL
-    matName = opts.segmentMatName[loopA];
-    currMatID = getListIDWithStringKey(matName, opts.materialName);
-    if(currMatID < 0) {
-      throw cvException(string("ERROR: Cannot Find Material for key " + matName).c_str());
-    }
+  // The library sets up the solver of the context from the options, then
+  // creates the model and runs the simulation.
+  cvOneD::solveInCurrentContext(opts);
 
-    // GET CURVE DATA
-    curveName = opts.segmentDataTableName[loopA];
-
-    if(upper_string(curveName) != "NONE") {
-      dtIDX = getDataTableIDFromStringKey(curveName);
-      curveTotals = cvOneDGlobal::gDataTables[dtIDX]->getSize();
-      curveTime = new double[curveTotals];
-      curveValue = new double[curveTotals];
-      for(int loopA = 0; loopA < curveTotals; loopA++) {
-        curveTime[loopA] = cvOneDGlobal::gDataTables[dtIDX]->getTime(loopA);
-        curveValue[loopA] = cvOneDGlobal::gDataTables[dtIDX]->getValues(loopA);
-      }
-    } else {
-      curveTotals = 1;
-      curveTime = new double[curveTotals];
-      curveValue = new double[curveTotals];
-      curveTime[0] = 0.0;
-      curveValue[0] = 0.0;
-    }
-    segmentError = oned->CreateSegment((char*)opts.segmentName[loopA].c_str(),
-                                       (long)opts.segmentID[loopA],
-                                       opts.segmentLength[loopA],
-                                       (long)opts.segmentTotEls[loopA],
-                                       (long)opts.segmentInNode[loopA],
-                                       (long)opts.segmentOutNode[loopA],
-                                       opts.segmentInInletArea[loopA],
-                                       opts.segmentInOutletArea[loopA],
-                                       opts.segmentInFlow[loopA],
-                                       currMatID,
-                                       (char*)opts.segmentLossType[loopA].c_str(),
-                                       opts.segmentBranchAngle[loopA],
-                                       opts.segmentUpstreamSegment[loopA],
-                                       opts.segmentBranchSegment[loopA],
-                                       (char*)opts.segmentBoundType[loopA].c_str(),
-                                       curveValue,
-                                       curveTime,
-                                       curveTotals);
-    if(segmentError == CV_ERROR) {
-      throw cvException(string("ERROR: Error Creating SEGMENT " + to_string(loopA) + "\n").c_str());
-    }
-    // Deallocate
-    delete[] curveTime;
-    curveTime = nullptr;
-    delete[] curveValue;
-    curveValue = nullptr;
-  }
-
-  double* vals;
-  int tot;
-
-  // SOLVE MODEL
-  printf("Solving Model ... \n");
-  int solveError = CV_OK;
-  string inletCurveName = opts.inletDataTableName;
-  int inletCurveIDX = getDataTableIDFromStringKey(inletCurveName);
-  int inletCurveTotals = cvOneDGlobal::gDataTables[inletCurveIDX]->getSize();
-  double* inletCurveTime = new double[inletCurveTotals];
-  double* inletCurveValue = new double[inletCurveTotals];
-  for(int loopB = 0; loopB < inletCurveTotals; loopB++) {
-    inletCurveTime[loopB] = cvOneDGlobal::gDataTables[inletCurveIDX]->getTime(loopB);
-    inletCurveValue[loopB] = cvOneDGlobal::gDataTables[inletCurveIDX]->getValues(loopB);
-  }
-  // Solve Model
-  solveError = oned->SolveModel(opts.timeStep,
-                                opts.stepSize,
-                                opts.maxStep,
-                                opts.quadPoints,
-                                inletCurveTotals,
-                                (char*)opts.boundaryType.c_str(),
-                                inletCurveValue,
-                                inletCurveTime,
-                                opts.convergenceTolerance,
-                                // Formulation Type
-                                opts.useIV,
-                                // Stabilization
-                                opts.useStab);
-  if(solveError == CV_ERROR) {
-    throw cvException(string("ERROR: Error Solving Model\n").c_str());
-  }
-  delete[] inletCurveTime;
-  delete[] inletCurveValue;
 }
 
-// ==============
-// RUN ONEDSOLVER
-// ==============
+// Solves the members of a parameter sweep of the options on threads,
+// each in its own context, with the combined results in one file
+void runOneDEnsemble(const cvOneD::options& opts, const std::string& sweepFile){
 
-namespace {
+  // Model Checking
+  cvOneD::validateOptions(opts);
 
-void setOutputGlobals(const cvOneD::options& opts){  
+  writeOptionsEcho(opts);
 
-  if(upper_string(opts.outputType) == "TEXT"){
-    cvOneDGlobal::outputType = OutputTypeScope::OUTPUT_TEXT;
-  }else if(upper_string(opts.outputType) == "VTK"){
-    cvOneDGlobal::outputType = OutputTypeScope::OUTPUT_VTK;
-  }else if(upper_string(opts.outputType) == "BOTH"){
-    cvOneDGlobal::outputType = OutputTypeScope::OUTPUT_BOTH;
-  }else{
-    throw cvException("ERROR: Invalid OUTPUT Type.\n");
-  }
+  cvOneDEnsemble ensemble(opts);
+  ensemble.ReadSweep(sweepFile);
+  ensemble.Run(cvOneD::solveInCurrentContext, opts.modelName + "ensemble.dat");
 
-  if(opts.vtkOutputType){
-    cvOneDGlobal::vtkOutputType = *opts.vtkOutputType;
-    if(cvOneDGlobal::vtkOutputType > 1){
-      throw cvException("ERROR: Invalid OUTPUT VTK Type.\n");
-    }
-  }
-  
 }
 
-} // namespace
-
-void runOneDSolver(const cvOneD::options& opts){
+// Advances the model with the steps a partner process requests through
+// the shared memory channel, until it stops
+void runOneDCoupling(const cvOneD::options& opts, const std::string& channelName){
 
   // Model Checking
   cvOneD::validateOptions(opts);
 
-  // Print Input Data Echo
-  string fileName("echo.out");
-  cvOneD::printToLegacyFile(opts,fileName);
+  writeOptionsEcho(opts);
 
-  // For now, we'll just duplicate the printing of
-  // the echo of the options to JSON as well
-  string jsonFilename("echo.json");
-  cvOneD::writeJsonOptions(opts, jsonFilename);
+  cvOneDSimulation simulation(opts);
+  simulation.ServeCoupling(channelName);
 
-  // Per the existing behavior, we'll set output globals 
-  // from the options. TODO: we should really just
-  // consume option data from the options rather
-  // than setting it in a global variable. Besides that,
-  // we should move the VTK options to a postprocessor
-  // rather than have them in the solver options.
-  setOutputGlobals(opts);
+}
 
-  // Create Model and Run Simulation
-  createAndRunModel(opts);
+// Solves the JSON inputs sent to the socket until a client stops it
+void runOneDServer(const std::string& socketPath, int workers){
+  cvOneDServer server(socketPath);
+  server.SetWorkers(workers);
+  server.Serve(cvOneD::solveInCurrentContext);
+}
 
+// Sends the JSON input to the server at the socket, the result files
+// are written here as the solver would write them
+void runOneDClient(const std::string& socketPath, const std::string& jsonInput){
+  bool cached = cvOneDServer::SubmitJob(socketPath, jsonInput);
+  if(cached){
+    std::cout << "The options of " << jsonInput << " were cached by the server." << std::endl;
+  }
 }
 
 void convertLegacyToJsonOptions(const std::string& legacyFilename, const std::string& jsonFilename){
@@ -400,6 +151,15 @@ struct ArgOptions{
 
   std::optional<std::string> legacyConversionInput = std::nullopt;
   std::optional<std::string> jsonConversionOutput = std::nullopt;
+
+  std::optional<std::string> ensembleInput = std::nullopt;
+
+  std::optional<std::string> couplingChannel = std::nullopt;
+
+  std::optional<std::string> serveSocket = std::nullopt;
+  int workers = 0;
+  std::optional<std::string> connectSocket = std::nullopt;
+  bool shutdown = false;
 };
 
 std::string removeQuotesIfPresent(const std::string& str) {
@@ -429,6 +189,35 @@ ArgOptions parseInputArgs(int argc, char** argv) {
             i++;
         }
 
+        if (arg == "-ensemble" && i + 1 < argc) {
+            options.ensembleInput = removeQuotesIfPresent(argv[i + 1]);
+            i++;
+        }
+
+        if (arg == "-couple" && i + 1 < argc) {
+            options.couplingChannel = removeQuotesIfPresent(argv[i + 1]);
+            i++;
+        }
+
+        if (arg == "-serve" && i + 1 < argc) {
+            options.serveSocket = removeQuotesIfPresent(argv[i + 1]);
+            i++;
+        }
+
+        if (arg == "-workers" && i + 1 < argc) {
+            options.workers = std::stoi(removeQuotesIfPresent(argv[i + 1]));
+            i++;
+        }
+
+        if (arg == "-connect" && i + 1 < argc) {
+            options.connectSocket = removeQuotesIfPresent(argv[i + 1]);
+            i++;
+        }
+
+        if (arg == "-shutdown") {
+            options.shutdown = true;
+        }
+
     }
 
     return options;
@@ -451,6 +240,18 @@ cvOneD::options readLegacyOptions(std::string const& inputFile){
 //       -jsonInput inputFilename
 //    * Convert legacy input to JSON input:
 //       -legacyToJson legacyInput.in jsonInput.json
+//    * Run a parameter sweep of the JSON input, together
+//      with -jsonInput:
+//       -ensemble sweepFilename
+//    * Step the JSON input as a partner process requests through
+//      a shared memory channel, together with -jsonInput:
+//       -couple channelName
+//    * Serve JSON inputs on a Unix domain socket, with zero
+//      or no workers using one per core:
+//       -serve socketPath [-workers count]
+//    * Solve a JSON input on a server, or stop the server:
+//       -connect socketPath -jsonInput inputFilename
+//       -connect socketPath -shutdown
 //
 // Preserved legacy behavior: 
 //   Single input that is a legacy input file, e.g.:
@@ -488,13 +289,40 @@ std::optional<cvOneD::options> parseArgsAndHandleOptions(int argc, char** argv){
 // =============
 int main(int argc, char** argv){
 
+#ifdef USE_MPI
+  // Only the first process of a distributed run reports
+  MPI_Init(&argc, &argv);
+  MPI_Comm_rank(MPI_COMM_WORLD, &cvOneDGlobal::rank);
+  MPI_Comm_size(MPI_COMM_WORLD, &cvOneDGlobal::numberOfRanks);
+  if(cvOneDGlobal::rank != 0){
+    freopen("/dev/null", "w", stdout);
+  }
+#endif
+
   // Write Program Header
   WriteHeader();
 
   try{
 
-    auto const simulationOptions = parseArgsAndHandleOptions(argc,argv);
-    if(simulationOptions){
+    // The server and its clients read the inputs on their own
+    auto const argOptions = parseInputArgs(argc,argv);
+    bool const remote = argOptions.serveSocket || argOptions.connectSocket;
+    auto const simulationOptions = remote ? std::nullopt : parseArgsAndHandleOptions(argc,argv);
+    if(argOptions.serveSocket){
+      runOneDServer(*argOptions.serveSocket, argOptions.workers);
+    }else if(argOptions.connectSocket && argOptions.shutdown){
+      cvOneDServer::StopServer(*argOptions.connectSocket);
+    }else if(argOptions.connectSocket && argOptions.jsonInput){
+      runOneDClient(*argOptions.connectSocket, *argOptions.jsonInput);
+    }else if(argOptions.connectSocket){
+      throw cvException("ERROR: A client requires -jsonInput or -shutdown.\n");
+    }else if(simulationOptions && argOptions.couplingChannel){
+      // The partner drives the time steps
+      runOneDCoupling(*simulationOptions, *argOptions.couplingChannel);
+    }else if(simulationOptions && argOptions.ensembleInput){
+      // The members of the sweep are solved in this process
+      runOneDEnsemble(*simulationOptions, *argOptions.ensembleInput);
+    }else if(simulationOptions){
       // The simulation options were defined so we can run the simulation
       runOneDSolver(*simulationOptions);
     } else{
@@ -510,9 +338,21 @@ int main(int argc, char** argv){
     printf("%s\n",e.what());
     // Execution Terminated
     printf("Terminated.\n");
+#ifdef USE_MPI
+    // the message of the other processes goes to the error stream,
+    // any of them stops all the others
+    if(cvOneDGlobal::rank != 0){
+      fprintf(stderr, "Process %d: %s\n", cvOneDGlobal::rank, e.what());
+    }
+    fflush(stdout);
+    MPI_Abort(MPI_COMM_WORLD, 1);
+#endif
     return 1;
   }
   printf("Completed!\n");
+#ifdef USE_MPI
+  MPI_Finalize();
+#endif
   return 0;
 
 }
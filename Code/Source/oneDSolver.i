@@ -3,21 +3,142 @@
  %{
  /* Includes the header in the wrapper code */
  #include "cvOneDOptions.h"
- #include "main.h"
+ #include "cvOneDOptionsJsonParser.h"
+ #include "cvOneDOptionsLegacySerializer.h"
+ #include "cvOneDSimulation.h"
+ #include "cvOneDException.h"
  using namespace std;
+
+ /* A read-only buffer over a result array of a simulation, two dimensional
+    with one row per node and one column per saved step. It holds the Python
+    simulation, so that no view outlives the array. */
+ typedef struct{
+   PyObject_HEAD
+   PyObject* owner;
+   const double* data;
+   Py_ssize_t shape[2];
+   Py_ssize_t strides[2];
+ } oneDResultBuffer;
+
+ static PyTypeObject oneDResultBufferType = {PyVarObject_HEAD_INIT(NULL, 0)};
+
+ static void oneDResultBuffer_dealloc(PyObject* obj){
+   Py_XDECREF(((oneDResultBuffer*)obj)->owner);
+   Py_TYPE(obj)->tp_free(obj);
+ }
+
+ static int oneDResultBuffer_getbuffer(PyObject* obj, Py_buffer* view, int flags){
+   oneDResultBuffer* self = (oneDResultBuffer*)obj;
+   if(flags & PyBUF_WRITABLE){
+     PyErr_SetString(PyExc_BufferError, "The results of a simulation are read-only.");
+     view->obj = NULL;
+     return -1;
+   }
+   view->obj = obj;
+   Py_INCREF(obj);
+   view->buf = (void*)self->data;
+   view->len = self->shape[0]*self->shape[1]*(Py_ssize_t)sizeof(double);
+   view->readonly = 1;
+   view->itemsize = sizeof(double);
+   view->format = (flags & PyBUF_FORMAT) ? (char*)"d" : NULL;
+   view->ndim = 2;
+   /* the rows are contiguous, so the shape and strides may be left out */
+   view->shape = ((flags & PyBUF_ND) == PyBUF_ND) ? self->shape : NULL;
+   view->strides = ((flags & PyBUF_STRIDES) == PyBUF_STRIDES) ? self->strides : NULL;
+   view->suboffsets = NULL;
+   view->internal = NULL;
+   return 0;
+ }
+
+ static PyBufferProcs oneDResultBufferProcs;
+ %}
+
+ %init %{
+   oneDResultBufferProcs.bf_getbuffer = oneDResultBuffer_getbuffer;
+   oneDResultBufferProcs.bf_releasebuffer = NULL;
+   oneDResultBufferType.tp_name = "oneDSolver.ResultBuffer";
+   oneDResultBufferType.tp_basicsize = sizeof(oneDResultBuffer);
+   oneDResultBufferType.tp_dealloc = oneDResultBuffer_dealloc;
+   oneDResultBufferType.tp_as_buffer = &oneDResultBufferProcs;
+   oneDResultBufferType.tp_flags = Py_TPFLAGS_DEFAULT;
+   oneDResultBufferType.tp_doc = "Read-only result array of a simulation";
+   if(PyType_Ready(&oneDResultBufferType) < 0){
+     return NULL;
+   }
  %}
 
+ /* Solver errors are raised as Python exceptions */
+ %exception {
+   try{
+     $action
+   }catch(cvException& e){
+     SWIG_exception(SWIG_RuntimeError, e.what());
+   }
+ }
+
  /* Parse the header file to generate wrappers */
  %include <typemaps.i>
  %include <std_string.i>
  %include <std_vector.i>
  %include <std_map.i>
+ %include <exception.i>
+
+ %apply const int & { int & };
+ %apply const double & { double & };
 
- %apply const int & { int & }; 
- %apply const double & { double & }; 
- 
  %include "cvOneDOptions.h"
- %include "main.h"
+ %include "cvOneDOptionsJsonParser.h"
+ %include "cvOneDOptionsLegacySerializer.h"
+ %include "cvOneDSimulation.h"
+
+ %inline %{
+ /* The buffer of a result array of a solved simulation, see
+    cvOneDSimulation::GetSegmentResultData */
+ PyObject* segmentResultBuffer(PyObject* simulation, long segment, const std::string& quantity){
+   void* ptr = NULL;
+   if(!SWIG_IsOK(SWIG_ConvertPtr(simulation, &ptr, SWIGTYPE_p_cvOneDSimulation, 0))){
+     PyErr_SetString(PyExc_TypeError, "Expected a cvOneDSimulation.");
+     return NULL;
+   }
+   cvOneDSimulation* sim = (cvOneDSimulation*)ptr;
+   const double* data = NULL;
+   long nodes = 0;
+   long steps = 0;
+   try{
+     data = sim->GetSegmentResultData(segment, quantity);
+     nodes = sim->GetNumberOfNodes(segment);
+     steps = sim->GetNumberOfSavedSteps();
+   }catch(cvException& e){
+     PyErr_SetString(PyExc_RuntimeError, e.what());
+     return NULL;
+   }
+   oneDResultBuffer* buffer = PyObject_New(oneDResultBuffer, &oneDResultBufferType);
+   if(buffer == NULL){
+     return NULL;
+   }
+   Py_INCREF(simulation);
+   buffer->owner = simulation;
+   buffer->data = data;
+   buffer->shape[0] = nodes;
+   buffer->shape[1] = steps;
+   buffer->strides[0] = steps*(Py_ssize_t)sizeof(double);
+   buffer->strides[1] = sizeof(double);
+   return (PyObject*)buffer;
+ }
+ %}
+
+ %extend cvOneDSimulation {
+ %pythoncode %{
+     def GetSegmentArray(self, segment, quantity):
+         """NumPy view of the flow, area, pressure, Re or wss results of a
+         segment, by index or name: one row per node, one column per saved
+         step. The view shares the memory of the simulation."""
+         import numpy
+         if isinstance(segment, str):
+             segment = self.GetSegmentIndex(segment)
+         return numpy.asarray(segmentResultBuffer(self, segment, quantity))
+ %}
+ }
 
  namespace std{
    typedef std::string String;
@@ -29,5 +150,4 @@
    %template(cvStringMat) vector< vector< string > >;
    %template(cvLongMat)   vector< vector< long > >;
    %template(cvDoubleMat) vector< vector< double > >;
- }  
-
+ }
@@ -52,6 +52,10 @@
   # include "csparse/csparseSolve.h"
 # endif
 
+# ifdef USE_KLU
+  # include "klu/kluSolve.h"
+# endif
+
 #define dmax(a,b) ((a<b) ? (b) : (a))
 #include <time.h>
 
@@ -125,6 +129,15 @@ void cvOneDSparseLinearSolver::Solve(cvOneDFEAVector& sol){
                dim, soln);
 # endif
 
+# ifdef USE_KLU
+  kluSolve(kluFactor,
+           ((cvOneDSparseMatrix*)lhsMatrix)->GetKentries(), 
+           Fglobal, 
+           ((cvOneDSparseMatrix*)lhsMatrix)->GetNumberOfEntries(),
+           ((cvOneDSparseMatrix*)lhsMatrix)->GetNumberOfNonzeros(), 
+           dim, soln);
+# endif
+
   tend_LU = clock();
 
   //cout << "t(LU)/t(solve): " << float(tend_LU-tstart_LU)/float(tend_LU-tstart_solve)<<", "<<"t(solve)="<<((float)(tend_LU-tstart_solve))/CLOCKS_PER_SEC<< endl;
@@ -158,6 +171,23 @@ cvOneDFEAVector* cvOneDSparseLinearSolver::GetRHS(){
 
 void cvOneDSparseLinearSolver::SetSolution(long equation, double value){
   int i;
+
+  // Boundary equations registered with the matrix only visit their own entries
+  const cvLongVec* bcEntries = ((cvOneDSparseMatrix*)lhsMatrix)->GetBoundaryEntries(equation);
+  if (bcEntries != NULL){
+    cvOneDKentry* Kentries = ((cvOneDSparseMatrix*)lhsMatrix)->GetKentries();
+    for (size_t k = 0; k < bcEntries->size(); k++){
+      cvOneDKentry& entry = Kentries[(*bcEntries)[k]];
+      if ((entry.col == equation) && (entry.row != equation)) {
+        (*rhsVector)[entry.row] -= value * entry.value;
+      }
+      entry.value = 0.0;
+    }
+    lhsMatrix->SetValue(equation, equation, 1.0);
+    (*rhsVector)[equation] = value;
+    return;
+  }
+
   cvOneDKentry* columnValues = NULL;
 
   int numEntries = 0;
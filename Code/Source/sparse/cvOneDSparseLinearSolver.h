@@ -48,6 +48,10 @@
 # include "../cvOneDFEAMatrix.h"
 # include "../cvOneDFEAVector.h"
 
+# ifdef USE_KLU
+  # include "klu/cvOneDKLU.h"
+# endif
+
 class cvOneDSparseLinearSolver: public cvOneDLinearSolver{
 
   public:
@@ -75,6 +79,14 @@ class cvOneDSparseLinearSolver: public cvOneDLinearSolver{
     // is still 4x4.
     virtual void DirectAppResistanceBC(long rbEqnNo, double resistance, double dpds, double rhs);
 	virtual void AddFlux(long rbEqnNo, double* OutletLHS11, double* OutletRHS1);
+
+# ifdef USE_KLU
+  private:
+
+    // Factorization of the matrix of this solver, reused at every Newton
+    // iteration of its model
+    cvOneDKLU kluFactor;
+# endif
 };
 
 #endif // CVONEDSPARSELINEARSOLVER_H
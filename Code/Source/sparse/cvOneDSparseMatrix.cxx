@@ -48,6 +48,7 @@ cvOneDSparseMatrix::cvOneDSparseMatrix(const char* tit): cvOneDFEAMatrix(tit){
   allocatedSizeEntries_ = 0;
   Kentries_ = NULL;
   dim_ = 0;
+  bcSlot_ = NULL;
   allocateKentries();
 }
 
@@ -57,6 +58,7 @@ cvOneDSparseMatrix::cvOneDSparseMatrix(long dim, long* pos, const char* tit): cv
   allocatedSizeEntries_ = dim*40;
   Kentries_ = NULL;
   dim_ = dim;
+  bcSlot_ = NULL;
   allocateKentries();
 }
 
@@ -64,6 +66,9 @@ cvOneDSparseMatrix::~cvOneDSparseMatrix(){
   if (Kentries_ != NULL){
     delete [] Kentries_;
   }
+  if (bcSlot_ != NULL){
+    delete [] bcSlot_;
+  }
 }
 
 void cvOneDSparseMatrix::allocateKentries(){
@@ -86,6 +91,9 @@ void cvOneDSparseMatrix::AddValue( long row, long column, double value){
     Kentries_[numEntries_].row = row;
     Kentries_[numEntries_].col = column;
     Kentries_[numEntries_].value = value;
+    if (bcSlot_ != NULL) {
+      RecordBoundaryEntry(numEntries_);
+    }
     numEntries_++;
     
     if (numEntries_ == allocatedSizeEntries_) {
@@ -95,7 +103,66 @@ void cvOneDSparseMatrix::AddValue( long row, long column, double value){
   }
 }
 
+void cvOneDSparseMatrix::SetBoundaryEquations(long numEqs, const long* eqs){
+  int i;
+  if (bcSlot_ != NULL){
+    delete [] bcSlot_;
+  }
+  bcSlot_ = new long[dim_];
+  for (i = 0; i < dim_; i++){
+    bcSlot_[i] = -1;
+  }
+  bcEntries_.clear();
+  for (i = 0; i < numEqs; i++){
+    assert((eqs[i] >= 0) && (eqs[i] < dim_));
+    if (bcSlot_[eqs[i]] < 0) {
+      bcSlot_[eqs[i]] = bcEntries_.size();
+      bcEntries_.push_back(cvLongVec());
+    }
+  }
+  RebuildBoundaryEntries();
+}
+
+void cvOneDSparseMatrix::RecordBoundaryEntry(int entry){
+  long row = Kentries_[entry].row;
+  long col = Kentries_[entry].col;
+  if (bcSlot_[row] >= 0) {
+    bcEntries_[bcSlot_[row]].push_back(entry);
+  }
+  if ((col >= 0) && (col != row) && (bcSlot_[col] >= 0)) {
+    bcEntries_[bcSlot_[col]].push_back(entry);
+  }
+}
+
+void cvOneDSparseMatrix::RebuildBoundaryEntries(){
+  if (bcSlot_ == NULL){
+    return;
+  }
+  for (size_t k = 0; k < bcEntries_.size(); k++){
+    bcEntries_[k].clear();
+  }
+  for (int i = 0; i < numEntries_; i++){
+    RecordBoundaryEntry(i);
+  }
+}
+
+const cvLongVec* cvOneDSparseMatrix::GetBoundaryEntries(long equation) const{
+  if ((bcSlot_ == NULL) || (bcSlot_[equation] < 0)){
+    return NULL;
+  }
+  return &bcEntries_[bcSlot_[equation]];
+}
+
 void cvOneDSparseMatrix::ClearRow(long row){
+  const cvLongVec* bcEntries = GetBoundaryEntries(row);
+  if (bcEntries != NULL){
+    for (size_t k = 0; k < bcEntries->size(); k++){
+      if (Kentries_[(*bcEntries)[k]].row == row) {
+        Kentries_[(*bcEntries)[k]].value = 0.0;
+      }
+    }
+    return;
+  }
   for (int i = 0; i < numEntries_; i++){
     if (Kentries_[i].row == row) {
       Kentries_[i].value = 0.0;
@@ -104,6 +171,15 @@ void cvOneDSparseMatrix::ClearRow(long row){
 }
 
 void cvOneDSparseMatrix::ClearColumn(long column){
+  const cvLongVec* bcEntries = GetBoundaryEntries(column);
+  if (bcEntries != NULL){
+    for (size_t k = 0; k < bcEntries->size(); k++){
+      if (Kentries_[(*bcEntries)[k]].col == column) {
+        Kentries_[(*bcEntries)[k]].value = 0.0;
+      }
+    }
+    return;
+  }
   for (int i = 0; i < numEntries_; i++){
     if (Kentries_[i].col == column) {
       Kentries_[i].value = 0.0;
@@ -113,9 +189,27 @@ void cvOneDSparseMatrix::ClearColumn(long column){
 
 void cvOneDSparseMatrix::Clear(){
   numEntries_ = 0;
+  // the capacity of the lists is kept between assemblies
+  for (size_t k = 0; k < bcEntries_.size(); k++){
+    bcEntries_[k].clear();
+  }
 }
 
 void cvOneDSparseMatrix::SetValue(long row, long column, double value){
+  const cvLongVec* bcEntries = GetBoundaryEntries(row);
+  if (bcEntries == NULL){
+    bcEntries = GetBoundaryEntries(column);
+  }
+  if (bcEntries != NULL){
+    for (size_t k = 0; k < bcEntries->size(); k++){
+      cvOneDKentry& entry = Kentries_[(*bcEntries)[k]];
+      if ((entry.row == row) && (entry.col == column)) {
+        entry.value = 0.0;
+      }
+    }
+    AddValue(row,column,value);
+    return;
+  }
   for (int i = 0; i < numEntries_; i++){
     if ((Kentries_[i].row == row) && (Kentries_[i].col == column)) {
       Kentries_[i].value = 0.0;
@@ -126,6 +220,19 @@ void cvOneDSparseMatrix::SetValue(long row, long column, double value){
 
 double cvOneDSparseMatrix::GetValue(long row, long column){
   double rtnval = 0.0;
+  const cvLongVec* bcEntries = GetBoundaryEntries(row);
+  if (bcEntries == NULL){
+    bcEntries = GetBoundaryEntries(column);
+  }
+  if (bcEntries != NULL){
+    for (size_t k = 0; k < bcEntries->size(); k++){
+      cvOneDKentry& entry = Kentries_[(*bcEntries)[k]];
+      if ((entry.row == row) && (entry.col == column)) {
+        rtnval += entry.value;
+      }
+    }
+    return rtnval;
+  }
   for (int i = 0; i < numEntries_; i++){
    if ((Kentries_[i].row == row) && (Kentries_[i].col == column)) {
      rtnval += Kentries_[i].value;
@@ -274,6 +381,9 @@ void cvOneDSparseMatrix::CondenseMatrix(){
  //cout << "t(label duplicate): " <<((float)(clock()-tstart_sum))/CLOCKS_PER_SEC<< endl;
 
   numNonzeros_ = array_size;
+
+  // the sort moved the entries around
+  RebuildBoundaryEntries();
   //   for (i=0;i<numNonzeros;i++){
  // if (Kentries_[i].row ==6583 && Kentries_[i].col==6582){
  //  printf("after row sort and condense index=%i,IA=%i,JA=%i,K=%f \n",i,Kentries_[i].row,Kentries_[i].col,Kentries_[i].value);
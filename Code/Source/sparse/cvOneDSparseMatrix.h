@@ -60,7 +60,15 @@ class cvOneDSparseMatrix: public cvOneDFEAMatrix{
     int allocatedSizeEntries_;
     int dim_;
 
+    // entries lying in the row or column of each boundary equation,
+    // kept up to date by AddValue so that the boundary conditions
+    // never have to scan the whole triplet list
+    long* bcSlot_;
+    cvLongMat bcEntries_;
+
   private:
+    void RecordBoundaryEntry(int entry);
+    void RebuildBoundaryEntries();
     void allocateKentries();
     void siftDownKentries(cvOneDKentry Kentries[], int root, int bottom);
 
@@ -75,6 +83,8 @@ class cvOneDSparseMatrix: public cvOneDFEAMatrix{
 
     // query function to apply dirichlet b.c.
     int GetColumnEntries( long column, cvOneDKentry** Kentries);
+    // entries in row/column of a registered equation, NULL otherwise
+    const cvLongVec* GetBoundaryEntries( long equation) const;
 
     // functions to set values
     int GetNumberOfEntries() {return numEntries_;}
@@ -91,6 +101,7 @@ class cvOneDSparseMatrix: public cvOneDFEAMatrix{
     // helper functions for applying dirichlet b.c.
     virtual void ClearRow(long row);
     virtual void ClearColumn(long column);
+    virtual void SetBoundaryEquations(long numEqs, const long* eqs);
     // query methods
     virtual double GetValue(long row, long column);
     virtual long GetDimension() const;
@@ -0,0 +1,397 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+//
+//  cvOneDKLU.cxx - Block triangular sparse LU factorization
+//  ~~~~~~~~~~~~~
+//
+
+# include <math.h>
+# include <stdlib.h>
+
+# include "cvOneDKLU.h"
+
+cvOneDKLU::cvOneDKLU(){
+  n = 0;
+  nb = 0;
+  pattern = NULL;
+  C = NULL;
+  P = NULL;
+  Q = NULL;
+  R = NULL;
+  cmap = NULL;
+  blockA = NULL;
+  blockMap = NULL;
+  blockS = NULL;
+  blockN = NULL;
+  diagPos = NULL;
+  x = NULL;
+  w = NULL;
+  isFactored = 0;
+  numFactor = 0;
+  numRefactor = 0;
+}
+
+cvOneDKLU::~cvOneDKLU(){
+  Free();
+}
+
+void cvOneDKLU::Free(){
+  for(int k = 0; k < nb; k++){
+    if(blockA != NULL) cs_spfree(blockA[k]);
+    if(blockMap != NULL) cs_free(blockMap[k]);
+    if(blockS != NULL) cs_sfree(blockS[k]);
+    if(blockN != NULL) cs_nfree(blockN[k]);
+  }
+  cs_free(blockA);
+  cs_free(blockMap);
+  cs_free(blockS);
+  cs_free(blockN);
+  cs_free(diagPos);
+  cs_spfree(pattern);
+  cs_spfree(C);
+  cs_free(P);
+  cs_free(Q);
+  cs_free(R);
+  cs_free(cmap);
+  cs_free(x);
+  cs_free(w);
+  pattern = NULL;
+  C = NULL;
+  P = NULL;
+  Q = NULL;
+  R = NULL;
+  cmap = NULL;
+  blockA = NULL;
+  blockMap = NULL;
+  blockS = NULL;
+  blockN = NULL;
+  diagPos = NULL;
+  x = NULL;
+  w = NULL;
+  n = 0;
+  nb = 0;
+  isFactored = 0;
+}
+
+int cvOneDKLU::Analyze(const cs* A){
+  int i, j, k, p, r0, r1, cnt;
+
+  // The pattern only grows, so that entries dropped from the
+  // assembly at some iteration do not trigger a new analysis
+  cs* U;
+  if((pattern != NULL) && (pattern->n == A->n)){
+    U = cs_add(pattern, A, 1.0, 1.0);
+  }else{
+    U = cs_add(A, A, 1.0, 0.0);
+  }
+  if(U == NULL){
+    return 0;
+  }
+  Free();
+  pattern = U;
+  n = pattern->n;
+  int nnz = pattern->p[n];
+
+  x = (double*)cs_malloc(2*n, sizeof(double));
+  w = (int*)cs_malloc(n, sizeof(int));
+  for(i = 0; i < n; i++){
+    w[i] = -1;
+  }
+
+  // Block triangular form from the Dulmage-Mendelsohn decomposition,
+  // a structurally singular matrix is kept as a single block
+  P = (int*)cs_malloc(n, sizeof(int));
+  Q = (int*)cs_malloc(n, sizeof(int));
+  csd* D = cs_dmperm(pattern);
+  int isBTF = (D != NULL);
+  if(isBTF){
+    for(k = 0; k <= D->nb; k++){
+      isBTF = isBTF && (D->R[k] == D->S[k]);
+    }
+    isBTF = isBTF && (D->R[D->nb] == n);
+  }
+  if(isBTF){
+    nb = D->nb;
+    R = (int*)cs_malloc(nb + 1, sizeof(int));
+    for(i = 0; i < n; i++){
+      P[i] = D->P[i];
+      Q[i] = D->Q[i];
+    }
+    for(k = 0; k <= nb; k++){
+      R[k] = D->R[k];
+    }
+  }else{
+    nb = 1;
+    R = (int*)cs_malloc(2, sizeof(int));
+    for(i = 0; i < n; i++){
+      P[i] = i;
+      Q[i] = i;
+    }
+    R[0] = 0;
+    R[1] = n;
+  }
+  cs_dfree(D);
+
+  // C = pattern(P,Q), permuting the entry numbers gives the
+  // position of each entry of the pattern in C
+  int* pinv = cs_pinv(P, n);
+  double* values = pattern->x;
+  double* index = (double*)cs_malloc(nnz, sizeof(double));
+  for(p = 0; p < nnz; p++){
+    index[p] = p;
+  }
+  pattern->x = index;
+  C = cs_permute(pattern, pinv, Q, 1);
+  pattern->x = values;
+  cmap = (int*)cs_malloc(nnz, sizeof(int));
+  for(p = 0; p < nnz; p++){
+    cmap[(int)C->x[p]] = p;
+  }
+  cs_free(index);
+  cs_free(pinv);
+
+  // Diagonal blocks and their AMD ordering
+  blockA = (cs**)cs_calloc(nb, sizeof(cs*));
+  blockMap = (int**)cs_calloc(nb, sizeof(int*));
+  blockS = (css**)cs_calloc(nb, sizeof(css*));
+  blockN = (csn**)cs_calloc(nb, sizeof(csn*));
+  diagPos = (int*)cs_malloc(nb, sizeof(int));
+  for(k = 0; k < nb; k++){
+    r0 = R[k];
+    r1 = R[k+1];
+    diagPos[k] = -1;
+    if(r1 - r0 == 1){
+      for(p = C->p[r0]; p < C->p[r0+1]; p++){
+        if(C->i[p] == r0){
+          diagPos[k] = p;
+        }
+      }
+      continue;
+    }
+    cnt = 0;
+    for(j = r0; j < r1; j++){
+      for(p = C->p[j]; p < C->p[j+1]; p++){
+        if(C->i[p] >= r0) cnt++;
+      }
+    }
+    blockA[k] = cs_spalloc(r1 - r0, r1 - r0, cnt, 1, 0);
+    blockMap[k] = (int*)cs_malloc(cnt, sizeof(int));
+    cnt = 0;
+    for(j = r0; j < r1; j++){
+      blockA[k]->p[j - r0] = cnt;
+      for(p = C->p[j]; p < C->p[j+1]; p++){
+        if(C->i[p] >= r0){
+          blockA[k]->i[cnt] = C->i[p] - r0;
+          blockA[k]->x[cnt] = 0.0;
+          blockMap[k][cnt] = p;
+          cnt++;
+        }
+      }
+    }
+    blockA[k]->p[r1 - r0] = cnt;
+    blockS[k] = cs_sqr(blockA[k], 1, 0);
+    if(blockS[k] == NULL){
+      return 0;
+    }
+  }
+
+  return Load(A);
+}
+
+int cvOneDKLU::Load(const cs* A){
+  int i, j, p, pos;
+  if((pattern == NULL) || (A->n != n)){
+    return 0;
+  }
+  int* Pp = pattern->p;
+  int* Pi = pattern->i;
+  double* Px = pattern->x;
+  for(p = 0; p < Pp[n]; p++){
+    Px[p] = 0.0;
+  }
+  for(j = 0; j < n; j++){
+    for(p = Pp[j]; p < Pp[j+1]; p++){
+      w[Pi[p]] = p;
+    }
+    for(p = A->p[j]; p < A->p[j+1]; p++){
+      i = A->i[p];
+      pos = w[i];
+      if((pos < Pp[j]) || (pos >= Pp[j+1]) || (Pi[pos] != i)){
+        return 0;
+      }
+      Px[pos] += A->x[p];
+    }
+  }
+  for(p = 0; p < Pp[n]; p++){
+    C->x[cmap[p]] = Px[p];
+  }
+  return 1;
+}
+
+int cvOneDKLU::Factor(){
+  int k, p;
+  isFactored = 0;
+  if(pattern == NULL){
+    return 0;
+  }
+  for(k = 0; k < nb; k++){
+    if(blockA[k] == NULL){
+      if((diagPos[k] < 0) || (C->x[diagPos[k]] == 0.0)){
+        return 0;
+      }
+      continue;
+    }
+    for(p = 0; p < blockA[k]->p[blockA[k]->n]; p++){
+      blockA[k]->x[p] = C->x[blockMap[k][p]];
+    }
+    cs_nfree(blockN[k]);
+    blockN[k] = cs_lu(blockA[k], blockS[k], KLU_PIVOT_TOLERANCE);
+    if(blockN[k] == NULL){
+      return 0;
+    }
+  }
+  isFactored = 1;
+  numFactor++;
+  return 1;
+}
+
+int cvOneDKLU::Refactor(){
+  int k, p;
+  if(!isFactored){
+    return 0;
+  }
+  for(k = 0; k < nb; k++){
+    if(blockA[k] == NULL){
+      if(C->x[diagPos[k]] == 0.0){
+        isFactored = 0;
+        return 0;
+      }
+      continue;
+    }
+    for(p = 0; p < blockA[k]->p[blockA[k]->n]; p++){
+      blockA[k]->x[p] = C->x[blockMap[k][p]];
+    }
+    if(!RefactorBlock(k)){
+      isFactored = 0;
+      return 0;
+    }
+  }
+  numRefactor++;
+  return 1;
+}
+
+// Left-looking numeric factorization on the existing L and U.
+// L and U hold permuted row indices, the entries of U(:,k) are
+// stored in the topological order of the original triangular
+// solve and U(k,k) is the last one, L(k,k) = 1 is the first entry
+// of L(:,k).
+int cvOneDKLU::RefactorBlock(int k){
+  int j, p, q, col;
+  double ukj, pivot, amax;
+
+  cs* A = blockA[k];
+  cs* L = blockN[k]->L;
+  cs* U = blockN[k]->U;
+  int* pinv = blockN[k]->Pinv;
+  int* colPerm = blockS[k]->Q;
+  int* Lp = L->p;
+  int* Li = L->i;
+  double* Lx = L->x;
+  int* Up = U->p;
+  int* Ui = U->i;
+  double* Ux = U->x;
+
+  for(j = 0; j < A->n; j++){
+    for(p = Up[j]; p < Up[j+1]; p++) x[Ui[p]] = 0.0;
+    for(p = Lp[j]; p < Lp[j+1]; p++) x[Li[p]] = 0.0;
+    col = colPerm ? colPerm[j] : j;
+    for(p = A->p[col]; p < A->p[col+1]; p++){
+      x[pinv[A->i[p]]] = A->x[p];
+    }
+    for(p = Up[j]; p < Up[j+1] - 1; p++){
+      ukj = x[Ui[p]];
+      Ux[p] = ukj;
+      for(q = Lp[Ui[p]] + 1; q < Lp[Ui[p]+1]; q++){
+        x[Li[q]] -= Lx[q] * ukj;
+      }
+    }
+    pivot = x[j];
+    amax = 0.0;
+    for(q = Lp[j] + 1; q < Lp[j+1]; q++){
+      amax = fmax(amax, fabs(x[Li[q]]));
+    }
+    if((pivot == 0.0) || (fabs(pivot) < KLU_PIVOT_TOLERANCE * amax)){
+      return 0;
+    }
+    Ux[Up[j+1] - 1] = pivot;
+    for(q = Lp[j] + 1; q < Lp[j+1]; q++){
+      Lx[q] = x[Li[q]] / pivot;
+    }
+  }
+  return 1;
+}
+
+// Block back substitution on C = A(P,Q)
+int cvOneDKLU::Solve(double* b){
+  int i, j, k, p, r0, r1;
+  if(!isFactored){
+    return 0;
+  }
+  double* y = x + n;
+  for(i = 0; i < n; i++){
+    x[i] = b[P[i]];
+  }
+  for(k = nb - 1; k >= 0; k--){
+    r0 = R[k];
+    r1 = R[k+1];
+    if(blockA[k] == NULL){
+      x[r0] /= C->x[diagPos[k]];
+    }else{
+      cs_ipvec(r1 - r0, blockN[k]->Pinv, x + r0, y);
+      cs_lsolve(blockN[k]->L, y);
+      cs_usolve(blockN[k]->U, y);
+      cs_ipvec(r1 - r0, blockS[k]->Q, y, x + r0);
+    }
+    // remove the contribution of this block from the rows above
+    for(j = r0; j < r1; j++){
+      for(p = C->p[j]; p < C->p[j+1]; p++){
+        if(C->i[p] < r0){
+          x[C->i[p]] -= C->x[p] * x[j];
+        }
+      }
+    }
+  }
+  for(j = 0; j < n; j++){
+    b[Q[j]] = x[j];
+  }
+  return 1;
+}
@@ -0,0 +1,111 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef CVONEDKLU_H
+#define CVONEDKLU_H
+
+//
+//  cvOneDKLU.h - Block triangular sparse LU factorization
+//  ~~~~~~~~~~~
+//
+//  The matrix is permuted to block upper triangular form (maximum
+//  transversal + strongly connected components) and only the diagonal
+//  blocks are factored, each with an AMD ordering and a left-looking
+//  Gilbert-Peierls LU with threshold partial pivoting. The kernels are
+//  the ones shipped in ../csparse. Once a matrix has been factored,
+//  Refactor() computes new values on the same L/U pattern and pivot
+//  sequence, which is what happens between Newton iterations.
+//
+
+# include <stdio.h>
+
+extern "C" {
+  # include "../csparse/csparse.h"
+}
+
+// threshold for the partial pivoting, the diagonal entry is kept
+// if it is at least this fraction of the largest candidate
+#define KLU_PIVOT_TOLERANCE 0.001
+
+class cvOneDKLU{
+
+  public:
+
+    cvOneDKLU();
+    ~cvOneDKLU();
+
+    // BTF and AMD orderings of the union of A and of the
+    // previously analyzed pattern, then loads the values of A
+    int Analyze(const cs* A);
+    // copies the values of A in the analyzed pattern, returns 0
+    // if an entry of A does not belong to it
+    int Load(const cs* A);
+    // numeric factorization with partial pivoting
+    int Factor();
+    // numeric factorization reusing the last pivot sequence, returns 0
+    // when no factorization is available or a pivot became too small
+    int Refactor();
+    // b is overwritten with the solution
+    int Solve(double* b);
+
+    int GetNumberOfBlocks() const {return nb;}
+    long GetNumberOfFactorizations() const {return numFactor;}
+    long GetNumberOfRefactorizations() const {return numRefactor;}
+
+  private:
+
+    void Free();
+    int RefactorBlock(int k);
+
+    int n;
+    cs* pattern;   // analyzed pattern, holds the values loaded by Load
+    cs* C;         // pattern(P,Q) in block upper triangular form
+    int* P;        // row permutation
+    int* Q;        // column permutation
+    int* R;        // block k is R[k]..R[k+1]-1
+    int nb;
+    int* cmap;     // position in C of each entry of pattern
+
+    // diagonal blocks, singletons are not factored
+    cs** blockA;
+    int** blockMap; // position in C of each entry of blockA[k]
+    css** blockS;
+    csn** blockN;
+    int* diagPos;   // position in C of the singleton pivots
+
+    double* x;      // workspace
+    int* w;
+    int isFactored;
+    long numFactor;
+    long numRefactor;
+};
+
+#endif // CVONEDKLU_H
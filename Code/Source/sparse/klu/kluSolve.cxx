@@ -0,0 +1,72 @@
+/* Copyright (c) Stanford University, The Regents of the University of
+ *               California, and others.
+ *
+ * All Rights Reserved.
+ *
+ * See Copyright-SimVascular.txt for additional details.
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining
+ * a copy of this software and associated documentation files (the
+ * "Software"), to deal in the Software without restriction, including
+ * without limitation the rights to use, copy, modify, merge, publish,
+ * distribute, sublicense, and/or sell copies of the Software, and to
+ * permit persons to whom the Software is furnished to do so, subject
+ * to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included
+ * in all copies or substantial portions of the Software.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+ * IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED
+ * TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+ * PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+ * OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+ * EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+ * PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+ * LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+ * NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "kluSolve.h"
+#include "../../cvOneDException.h"
+
+int kluSolve(cvOneDKLU& kluFactor, cvOneDKentry* Kentries,double *b,int numEntries, int NNZ,int nunknown,double u[]){
+
+  // Assign Matrix Entries in Triplet Format
+  cs* T = cs_spalloc(nunknown, nunknown, NNZ, 1, 1);
+  for(int i=0;i<numEntries;i++){
+    if(Kentries[i].col!=-1){
+      cs_entry(T, Kentries[i].row, Kentries[i].col, Kentries[i].value);
+    }
+  }
+
+  // Convert Matrix in Compressed Column Format
+  cs* A = cs_triplet(T);
+  cs_spfree(T);
+
+  // Refactor when the pattern is unchanged, analyze and factor otherwise
+  int ok;
+  if(kluFactor.Load(A)){
+    ok = kluFactor.Refactor() || kluFactor.Factor();
+  }else{
+    ok = kluFactor.Analyze(A) && kluFactor.Factor();
+  }
+  cs_spfree(A);
+
+  // Solve system
+  ok = ok && kluFactor.Solve(b);
+  if (ok == 0){
+    std::string errorMsg("Error: Cannot Solve Linear System\n");
+    throw cvException(errorMsg.c_str());
+  }
+
+  // Copy Solution Back
+  for(int loopA=0;loopA<nunknown;loopA++){
+    u[loopA] = b[loopA];
+  }
+
+  // Return Result
+  return ok;
+}
@@ -1,6 +1,7 @@
 import shutil
 import csv
 import glob
+import json
 import os
 import re
 import subprocess
@@ -70,6 +71,32 @@ def run_converted_json_input(inputFilePath, testDir, exePath):
         raise RuntimeError('Test failed. svOneDSolver returned error:\n' + err.output.decode("utf-8"))
 
 
+def run_json_with_options(name, testDir, exePath, solverOptions):
+    """
+    Convert the legacy input of a test case to JSON, update its solver
+    options and run it
+    Args:
+        name: test case name
+        testDir: directory to run in
+        exePath: path to the solver
+        solverOptions: dictionary of solver options to set
+    Returns:
+        standard output of the solver
+    """
+    inputFilePath = os.path.join(os.path.dirname(__file__), 'cases', name + '.in')
+    jsonFilePath = os.path.join(testDir, name + '.json')
+    try:
+        subprocess.check_output([exePath, "-legacyToJson", inputFilePath, jsonFilePath], cwd=testDir)
+        with open(jsonFilePath) as f:
+            options = json.load(f)
+        options['solverOptions'].update(solverOptions)
+        with open(jsonFilePath, 'w') as f:
+            json.dump(options, f)
+        return subprocess.check_output([exePath, "-jsonInput", jsonFilePath], cwd=testDir).decode("utf-8")
+    except subprocess.CalledProcessError as err:
+        raise RuntimeError('Test failed. svOneDSolver returned error:\n' + err.output.decode("utf-8"))
+
+
 def read_results_1d(res_dir, name):
     """
     Read results from oneDSolver and store in dictionary
@@ -258,3 +285,193 @@ def test_simulation_results_legacy_input(tmpdir, exePath, testCaseName, resultDa
 def test_simulation_results_converted_to_json_input(tmpdir, exePath, testCaseName, resultData):
     run_simulation_and_assert_results(testCaseName, tmpdir, exePath, resultData, run_converted_json_input)
 
+
+
+# The binary result file read with py/oneDResultFile.py holds the values of
+# the text result files. The tube is refined so that its saved steps fill
+# several chunks of the file, and the steps are read across a chunk boundary.
+def test_binary_result_file_chunks(tmpdir, exePath):
+    import sys
+    sys.path.insert(0, os.path.join(os.path.dirname(__file__), '..', '..', 'py'))
+    from oneDResultFile import resultFile
+
+    inputFilePath = os.path.join(os.path.dirname(__file__), 'cases', 'tube_r.in')
+    jsonFilePath = os.path.join(tmpdir, 'tube_r.json')
+    subprocess.check_output([exePath, "-legacyToJson", inputFilePath, jsonFilePath], cwd=tmpdir)
+    with open(jsonFilePath) as f:
+        options = json.load(f)
+    options['segments'][0]['totalElements'] = 2000
+    options['solverOptions']['stepSize'] = 1
+    options['solverOptions']['maxStep'] = 40
+    for outputType in ['TEXT', 'BINARY']:
+        options['solverOptions']['outputType'] = outputType
+        with open(jsonFilePath, 'w') as f:
+            json.dump(options, f)
+        subprocess.check_output([exePath, "-jsonInput", jsonFilePath], cwd=tmpdir)
+
+    # the text results read here leave out the initial step
+    text = read_results_1d(tmpdir, 'results_tube_r_seg*')
+    binary = resultFile(os.path.join(tmpdir, 'results_tube_r_results.bin'))
+    steps = len(binary.times)
+    assert binary.numChunks > 1
+    assert steps - 1 == text['flow'][0].shape[1]
+    first = binary.stepsPerChunk - 2
+    for field in resultFile.FIELDS:
+        values = binary.read('seg0', field, first, 4)
+        assert values == pytest.approx(text[field][0][:, first - 1:first + 3].T, rel=1e-5, abs=1e-8)
+        values = binary.read(0, field, 1)
+        assert values == pytest.approx(text[field][0].T, rel=1e-5, abs=1e-8)
+    binary.close()
+
+
+# The adaptive time step controller takes fewer steps than the fixed step
+# loop on bifurcation_RCR and stays close to its results
+def test_adaptive_time_step(tmpdir, exePath):
+    name = 'bifurcation_RCR'
+    run_json_with_options(name, tmpdir, exePath, {})
+    fixed = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+    output = run_json_with_options(name, tmpdir, exePath, {'adaptiveTimeStep': 1})
+    adaptive = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+
+    accepted, rejected = [int(n) for n in re.search(
+        r'Accepted time steps = (\d+), rejected time steps = (\d+)', output).groups()]
+    assert accepted + rejected < 2000
+    # largest difference relative to the largest value of the field
+    for field, rtol in [('pressure', 0.02), ('flow', 0.05)]:
+        for seg in fixed[field]:
+            scale = np.max(np.abs(fixed[field][seg]))
+            assert np.max(np.abs(adaptive[field][seg] - fixed[field][seg])) < rtol * scale, \
+                f"{field} of segment {seg} differs from the fixed step run"
+
+
+# With a periodic tolerance, bifurcation_RCR stops long before the end of
+# twenty cycles and writes only its last cycle
+def test_periodic_tolerance(tmpdir, exePath):
+    name = 'bifurcation_RCR'
+    output = run_json_with_options(name, tmpdir, exePath, {'maxStep': 20000, 'periodicTolerance': 1e-2})
+    results = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+
+    time = float(re.search(r'Periodic state reached at time ([\d.]+)', output).group(1))
+    assert time < 0.5 * 20000 * 0.001087
+    # the 100 saved steps of a cycle of 1000 steps, after its start
+    for field in ['pressure', 'flow']:
+        for seg in results[field]:
+            assert results[field][seg].shape[1] == 100
+
+
+# Plain Newton runs into the iteration limit at the stenosis of
+# tube_stenosis_r, with the line search every step converges within it
+def test_line_search(tmpdir, exePath):
+    name = 'tube_stenosis_r'
+    maxIterations = 30
+
+    def iterations(solverOptions):
+        output = run_json_with_options(name, tmpdir, exePath, solverOptions)
+        read_results_1d(tmpdir, 'results_' + name + '_seg*')
+        return [int(n) for n in re.findall(r'Tot iters = (\d+)', output)], output
+
+    plain, _ = iterations({})
+    assert max(plain) > maxIterations
+    searched, output = iterations({'lineSearch': 4})
+    assert len(searched) == len(plain)
+    assert max(searched) <= maxIterations
+    assert int(re.search(r'Shortened Newton updates = (\d+)', output).group(1)) > 0
+
+
+# BDF2 at four times the step of bifurcation_RCR without stabilization is
+# more accurate than backward Euler at the step of the case. The reference
+# is backward Euler at a tenth of the step, all runs save the same times.
+def test_bdf2_time_integrator(tmpdir, exePath):
+    name = 'bifurcation_RCR'
+
+    def run(timeIntegrator, factor):
+        run_json_with_options(name, tmpdir, exePath, {
+            'useStab': 0, 'timeIntegrator': timeIntegrator, 'timeStep': 0.001087 * factor,
+            'maxStep': int(round(2000 / factor)), 'stepSize': int(round(20 / factor))})
+        return read_results_1d(tmpdir, 'results_' + name + '_seg*')
+
+    def error(results, reference, field):
+        return max(np.max(np.abs(results[field][seg] - reference[field][seg])) /
+                   np.max(np.abs(reference[field][seg])) for seg in reference[field])
+
+    reference = run('BACKWARD_EULER', 0.1)
+    euler = run('BACKWARD_EULER', 1)
+    bdf2 = run('BDF2', 4)
+    for field in ['pressure', 'flow']:
+        assert error(bdf2, reference, field) < 0.5 * error(euler, reference, field)
+
+    # the stabilized scheme is rejected
+    with pytest.raises(RuntimeError, match='requires useStab 0'):
+        run_json_with_options(name, tmpdir, exePath, {'timeIntegrator': 'BDF2'})
+
+
+# Two linear solves per step from the linear predictor give the results
+# of the Newton iterations to convergence on bifurcation_RCR
+def test_linear_solves(tmpdir, exePath):
+    name = 'bifurcation_RCR'
+    run_json_with_options(name, tmpdir, exePath, {})
+    converged = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+    output = run_json_with_options(name, tmpdir, exePath, {'linearSolves': 2, 'solutionPredictor': 'LINEAR'})
+    linear = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+
+    assert max(int(n) for n in re.findall(r'Tot iters = (\d+)', output)) <= 2
+    # largest difference relative to the largest value of the field
+    for field in ['pressure', 'flow']:
+        for seg in converged[field]:
+            scale = np.max(np.abs(converged[field][seg]))
+            assert np.max(np.abs(linear[field][seg] - converged[field][seg])) < 1e-5 * scale, \
+                f"{field} of segment {seg} differs from the converged run"
+
+
+# The steady state of bifurcation_R under its constant inflow is written
+# as the single saved step with ONLY, and the time loop started from it
+# with INITIAL_CONDITION keeps it
+def test_steady_state(tmpdir, exePath):
+    name = 'bifurcation_R'
+
+    def run(steadyState):
+        run_json_with_options(name, tmpdir, exePath, {'steadyState': steadyState})
+        # the saved steps of each node, including the initial one
+        results = defaultdict(dict)
+        for field in ['pressure', 'flow']:
+            for f_res in glob.glob(os.path.join(tmpdir, 'results_' + name + '_seg*_' + field + '.dat')):
+                results[field][int(re.findall(r'\d+', f_res)[-1])] = np.loadtxt(f_res, ndmin=2)
+        read_results_1d(tmpdir, 'results_' + name + '_seg*')
+        return results
+
+    steady = run('ONLY')
+    initial = run('INITIAL_CONDITION')
+    for field in ['pressure', 'flow']:
+        for seg in steady[field]:
+            assert steady[field][seg].shape[1] == 1
+            scale = np.max(np.abs(steady[field][seg]))
+            assert np.max(np.abs(initial[field][seg] - steady[field][seg])) < 1e-6 * scale, \
+                f"{field} of segment {seg} leaves the steady state"
+
+
+# Both waveform relaxations of bifurcation_RCR cut at its joint stay close
+# to the monolithic solution, Gauss-Seidel in about five sweeps per window
+# and Jacobi in at most twice as many
+def test_waveform_relaxation(tmpdir, exePath):
+    name = 'bifurcation_RCR'
+    steps = {'maxStep': 1000}
+    run_json_with_options(name, tmpdir, exePath, steps)
+    monolithic = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+
+    sweeps = {}
+    for relaxation in ['GAUSS_SEIDEL', 'JACOBI']:
+        output = run_json_with_options(name, tmpdir, exePath, dict(
+            steps, waveformRelaxation=relaxation, waveformCuts=['JOINT1']))
+        results = read_results_1d(tmpdir, 'results_' + name + '_seg*')
+        assert 'not converged' not in output
+        iters = [int(n) for n in re.findall(r'Waveform iters = (\d+)', output)]
+        assert len(iters) == 100
+        sweeps[relaxation] = sum(iters)
+        # largest difference relative to the largest value of the field
+        for field, rtol in [('pressure', 0.005), ('flow', 0.02)]:
+            for seg in monolithic[field]:
+                scale = np.max(np.abs(monolithic[field][seg]))
+                assert np.max(np.abs(results[field][seg] - monolithic[field][seg])) < rtol * scale, \
+                    f"{field} of segment {seg} differs from the monolithic run with {relaxation}"
+    assert sweeps['GAUSS_SEIDEL'] <= 6 * 100
+    assert sweeps['JACOBI'] <= 2 * sweeps['GAUSS_SEIDEL']
@@ -75,6 +75,31 @@ void expectEqOptions(const cvOneD::options& actual, const cvOneD::options& expec
     EXPECT_EQ(expected.convergenceTolerance, actual.convergenceTolerance);
     EXPECT_EQ(expected.useIV, actual.useIV);
     EXPECT_EQ(expected.useStab, actual.useStab);
+    EXPECT_EQ(expected.nonlinearSolver, actual.nonlinearSolver);
+    EXPECT_EQ(expected.krylovRestart, actual.krylovRestart);
+    EXPECT_EQ(expected.krylovTolerance, actual.krylovTolerance);
+    EXPECT_EQ(expected.preconditionerRefresh, actual.preconditionerRefresh);
+    EXPECT_EQ(expected.solutionPredictor, actual.solutionPredictor);
+    EXPECT_EQ(expected.andersonDepth, actual.andersonDepth);
+    EXPECT_EQ(expected.lineSearch, actual.lineSearch);
+    EXPECT_EQ(expected.timeIntegrator, actual.timeIntegrator);
+    EXPECT_EQ(expected.linearSolves, actual.linearSolves);
+    EXPECT_EQ(expected.solverEngine, actual.solverEngine);
+    EXPECT_EQ(expected.courantNumber, actual.courantNumber);
+    EXPECT_EQ(expected.steadyState, actual.steadyState);
+    EXPECT_EQ(expected.warmStart, actual.warmStart);
+    EXPECT_EQ(expected.adaptiveTimeStep, actual.adaptiveTimeStep);
+    EXPECT_EQ(expected.timeStepTolerance, actual.timeStepTolerance);
+    EXPECT_EQ(expected.minTimeStep, actual.minTimeStep);
+    EXPECT_EQ(expected.maxTimeStep, actual.maxTimeStep);
+    EXPECT_EQ(expected.periodicTolerance, actual.periodicTolerance);
+    EXPECT_EQ(expected.periodicShooting, actual.periodicShooting);
+    EXPECT_EQ(expected.parareal, actual.parareal);
+    EXPECT_EQ(expected.pararealCoarseFactor, actual.pararealCoarseFactor);
+    EXPECT_EQ(expected.pararealWorkers, actual.pararealWorkers);
+    EXPECT_EQ(expected.waveformRelaxation, actual.waveformRelaxation);
+    EXPECT_EQ(expected.waveformCuts, actual.waveformCuts);
+    EXPECT_EQ(expected.waveformWindow, actual.waveformWindow);
     // For now, we're not going to verify the outputType. Why not? Because, currently
     // the legacy serializer does not record the outputType. Instead, it stores it
     // in the global settings. 
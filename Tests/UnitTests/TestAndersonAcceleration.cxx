@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "cvOneDAndersonAcceleration.h"
+
+namespace {
+
+// Residual of a small nonlinear system with root (1, 2, 3, 4)
+void residual(const cvOneDFEAVector& x, double* r){
+    r[0] = 4.0 * (x.Get(0) - 1.0) + 0.5 * (x.Get(1) - 2.0) + 0.2 * std::pow(x.Get(0) - 1.0, 2);
+    r[1] = 0.5 * (x.Get(0) - 1.0) + 3.0 * (x.Get(1) - 2.0) + 0.1 * (x.Get(2) - 3.0);
+    r[2] = 0.1 * (x.Get(1) - 2.0) + 2.0 * (x.Get(2) - 3.0) + 0.3 * std::pow(x.Get(3) - 4.0, 2);
+    r[3] = (x.Get(3) - 4.0) * (1.0 + 0.1 * x.Get(3));
+}
+
+// Corrections with a crude fixed "tangent", as with a frozen Jacobian:
+// the plain iteration only converges linearly
+void frozenCorrection(const cvOneDFEAVector& x, cvOneDFEAVector& dx){
+    double r[4];
+    residual(x, r);
+    double diag[4] = {12.0, 10.0, 8.0, 6.0};
+    for(int i = 0; i < 4; i++){
+        dx.Set(i, -r[i] / diag[i]);
+    }
+}
+
+int iterate(int depth, cvOneDFEAVector& x){
+    cvOneDAndersonAcceleration anderson(depth);
+    cvOneDFEAVector dx(4, "dx");
+    for(int iter = 1; iter <= 200; iter++){
+        frozenCorrection(x, dx);
+        double norm = 0.0;
+        for(int i = 0; i < 4; i++){
+            norm = std::max(norm, std::fabs(dx.Get(i)));
+        }
+        if(norm < 1.0e-12){
+            return iter;
+        }
+        if(depth > 0){
+            anderson.Update(x, dx, 0);
+        }else{
+            x.Add(dx);
+        }
+    }
+    return -1;
+}
+
+} // namespace
+
+TEST(AndersonAcceleration, AcceleratesFrozenTangentIteration) {
+    cvOneDFEAVector plain(4, "plain");
+    cvOneDFEAVector mixed(4, "mixed");
+    for(int i = 0; i < 4; i++){
+        plain.Set(i, 2.0 + i);
+        mixed.Set(i, 2.0 + i);
+    }
+    int plainIterations = iterate(0, plain);
+    int mixedIterations = iterate(4, mixed);
+    ASSERT_GT(plainIterations, 0);
+    ASSERT_GT(mixedIterations, 0);
+    EXPECT_LT(mixedIterations, plainIterations / 4);
+    for(int i = 0; i < 4; i++){
+        EXPECT_NEAR(mixed.Get(i), 1.0 + i, 1.0e-10);
+    }
+}
+
+TEST(AndersonAcceleration, FallsBackOnNegativeArea) {
+    cvOneDAndersonAcceleration anderson(2);
+    cvOneDFEAVector x(2, "x");
+    cvOneDFEAVector dx(2, "dx");
+    // the corrections of the area barely shrink, 1 -> 0.5 -> 0.05
+    x.Set(0, 1.0);
+    dx.Set(0, -0.5);
+    anderson.Update(x, dx, 2);
+    dx.Set(0, -0.45);
+    anderson.Update(x, dx, 2);
+    // the secant extrapolation of the area would be -4
+    EXPECT_DOUBLE_EQ(x.Get(0), 0.05);
+    EXPECT_EQ(anderson.GetNumberOfMixedUpdates(), 0);
+}
@@ -0,0 +1,28 @@
+#include <gtest/gtest.h>
+
+#include "cvOneDUtility.h"
+
+// Segments shared among the processes of a distributed run: the heaviest
+// go first to the least loaded process.
+TEST(BalancedPartition, BalancesElementCounts) {
+    cvLongVec elements = {10, 40, 20, 30, 10, 10};
+    cvLongVec owner = balanced_partition(elements, 3);
+
+    ASSERT_EQ(owner.size(), elements.size());
+    long load[3] = {0, 0, 0};
+    for (size_t i = 0; i < elements.size(); i++) {
+        ASSERT_GE(owner[i], 0);
+        ASSERT_LT(owner[i], 3);
+        load[owner[i]] += elements[i];
+    }
+    EXPECT_EQ(load[0], 40);
+    EXPECT_EQ(load[1], 40);
+    EXPECT_EQ(load[2], 40);
+}
+
+// More processes than segments leaves the last ones empty.
+TEST(BalancedPartition, MoreProcessesThanSegments) {
+    cvLongVec owner = balanced_partition(cvLongVec{5, 7}, 4);
+    EXPECT_EQ(owner[0], 1);
+    EXPECT_EQ(owner[1], 0);
+}
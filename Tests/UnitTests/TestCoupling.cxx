@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <string>
+#include <thread>
+
+#include "cvOneDCouplingChannel.h"
+#include "cvOneDOptionsLegacySerializer.h"
+#include "cvOneDSimulation.h"
+
+namespace {
+
+cvOneD::options arteryOptions(){
+    cvOneD::options opts{};
+    cvOneD::readOptionsLegacyFormat("TestFiles/SimpleArtery.in", &opts);
+    opts.outputType = "NONE";
+    return opts;
+}
+
+} // namespace
+
+// The steps of the partner at the time step of the options give the
+// solution of the fixed step loop, an undone step is taken again.
+TEST(Coupling, StepsMatchRun) {
+    cvOneD::options opts = arteryOptions();
+    cvOneDSimulation run(opts);
+    run.Run();
+    cvDoubleVec runFlow, runArea, runPressure;
+    run.GetSegmentResults(0, runFlow, runArea, runPressure);
+
+    cvOneDSimulation stepped(opts);
+    EXPECT_THROW(stepped.Step(opts.timeStep), cvException);
+    stepped.Initialize();
+    EXPECT_THROW(stepped.SetOutletPressure(0, 1.0e5), cvException);
+    cvDoubleVec before, after;
+    for(long s = 0; s < opts.maxStep; s++){
+        stepped.Step(opts.timeStep);
+        if(s == opts.maxStep/2){
+            stepped.GetState(before);
+            stepped.UndoStep();
+            EXPECT_THROW(stepped.UndoStep(), cvException);
+            stepped.Step(opts.timeStep);
+            stepped.GetState(after);
+            EXPECT_EQ(before, after);
+        }
+    }
+    EXPECT_NEAR(stepped.GetCurrentTime(), opts.maxStep*opts.timeStep, 1.0e-9);
+    cvDoubleVec flow, area, pressure;
+    stepped.GetSegmentResults(0, flow, area, pressure);
+    EXPECT_EQ(flow, runFlow);
+    EXPECT_EQ(pressure, runPressure);
+}
+
+// A partner drives the solver through shared memory: the inlet table is
+// kept with NaN and replaced by the value it sends.
+TEST(Coupling, SharedMemoryPartner) {
+    std::string channelName = "/oneDCouplingTest_" + std::to_string(getpid());
+    cvOneDSimulation simulation(arteryOptions());
+    std::thread serving([&](){simulation.ServeCoupling(channelName);});
+
+    std::unique_ptr<cvOneDCouplingChannel> channel(cvOneDCouplingChannel::Open(channelName, 30.0));
+    cvDoubleVec outputs;
+    channel->Request(cvOneDCouplingChannel::STATE, 0.0, {}, outputs);
+    // time, inlet flow and pressure, flow and pressure of the outlet
+    ASSERT_EQ(outputs.size(), 5u);
+    for(int s = 0; s < 5; s++){
+        channel->Request(cvOneDCouplingChannel::STEP, 0.01, {NAN, NAN}, outputs);
+    }
+    EXPECT_NEAR(outputs[0], 0.05, 1.0e-12);
+    EXPECT_NEAR(outputs[1], 200.0, 1.0e-8);
+    channel->Request(cvOneDCouplingChannel::STEP, 0.01, {150.0, NAN}, outputs);
+    EXPECT_NEAR(outputs[1], 150.0, 1.0e-8);
+    channel->Request(cvOneDCouplingChannel::UNDO, 0.0, {}, outputs);
+    EXPECT_NEAR(outputs[0], 0.05, 1.0e-12);
+    EXPECT_THROW(channel->Request(cvOneDCouplingChannel::STEP, 0.01, {150.0}, outputs), cvException);
+    channel->Request(cvOneDCouplingChannel::STOP, 0.0, {}, outputs);
+    serving.join();
+}
+
+// A block is never taken over, and a wait ends on timeout or once the
+// other process is gone.
+TEST(Coupling, ChannelFailures) {
+    std::string channelName = "/oneDCouplingFailures_" + std::to_string(getpid());
+    std::unique_ptr<cvOneDCouplingChannel> solver(cvOneDCouplingChannel::Create(channelName));
+    EXPECT_THROW(cvOneDCouplingChannel::Create(channelName), cvException);
+
+    double dt;
+    cvDoubleVec inputs;
+    solver->SetTimeout(0.2);
+    EXPECT_THROW(solver->WaitRequest(dt, inputs), cvException);
+
+    std::unique_ptr<cvOneDCouplingChannel> partner(cvOneDCouplingChannel::Open(channelName, 1.0));
+    partner->SetTimeout(0.2);
+    cvDoubleVec outputs;
+    EXPECT_THROW(partner->Request(cvOneDCouplingChannel::STATE, 0.0, {}, outputs), cvException);
+    partner.reset();
+    // the unanswered request is taken
+    solver->WaitRequest(dt, inputs);
+    solver->Reply({});
+
+    // a partner that exits without closing the channel
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if(child == 0){
+        cvOneDCouplingChannel::Open(channelName, 1.0);
+        _exit(0);
+    }
+    waitpid(child, NULL, 0);
+    solver->SetTimeout(30.0);
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_THROW(solver->WaitRequest(dt, inputs), cvException);
+    EXPECT_LT(std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count(), 5.0);
+}
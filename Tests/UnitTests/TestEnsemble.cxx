@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "cvOneDContext.h"
+#include "cvOneDEnsemble.h"
+#include "cvOneDModelManager.h"
+
+namespace {
+
+// Straight tube with a resistance outlet, the inflow is the second entry
+// of the INFLOW data table and the resistance the RESISTANCE one.
+cvOneD::options tubeOptions(){
+    cvOneD::options opts{};
+    opts.modelName = "ensembleTube_";
+    opts.segmentName = {"tube"};
+    opts.segmentInInletArea = {1.0};
+    opts.segmentInOutletArea = {1.0};
+    opts.dataTableName = {"INFLOW", "RESISTANCE"};
+    opts.dataTableVals = {{0.0, 50.0}, {0.0, 100.0}};
+    return opts;
+}
+
+void solveTube(const cvOneD::options& opts){
+    cvOneDModelManager oned((char*)opts.modelName.c_str());
+    oned.CreateNode((char*)"IN", 0.0, 0.0, 0.0);
+    oned.CreateNode((char*)"OUT", 0.0, 0.0, 10.0);
+    double params[3] = {1.0e15, -20.0, 1.0e9};
+    int matID = 0;
+    oned.CreateMaterial((char*)"MAT", (char*)"MATERIAL_OLUFSEN", 1.06, 0.04, 2.0, 0.0, 3, params, &matID);
+    double resistance = opts.dataTableVals[1][1];
+    double outletTime = 0.0;
+    oned.CreateSegment((char*)"tube", 0, 10.0, 20, 0, 1, opts.segmentInInletArea[0], opts.segmentInOutletArea[0],
+                       0.0, matID, (char*)"NONE", 0.0, 0, 0, (char*)"RESISTANCE", &resistance, &outletTime, 1);
+    cvOneDContext::Current()->solver->SetOutputType(OutputTypeScope::OUTPUT_NONE);
+    double times[2] = {0.0, 1.0};
+    double flows[2] = {opts.dataTableVals[0][1], opts.dataTableVals[0][1]};
+    oned.SolveModel(1.0e-3, 10, 100, 2, 2, (char*)"FLOW", flows, times, 1.0e-8, 1, 1);
+}
+
+cvOneDEnsembleParameter tableParameter(const std::string& name, const cvDoubleVec& values){
+    cvOneDEnsembleParameter param;
+    param.type = "DATATABLE";
+    param.name = name;
+    param.index = 1;
+    param.values = values;
+    return param;
+}
+
+} // namespace
+
+// The grid varies the last parameter fastest, samples replace it.
+TEST(Ensemble, MemberOptions) {
+    cvOneDEnsemble grid(tubeOptions());
+    grid.AddParameter(tableParameter("INFLOW", {50.0, 100.0}));
+    grid.AddParameter(tableParameter("RESISTANCE", {100.0, 200.0, 300.0}));
+    ASSERT_EQ(grid.GetNumberOfMembers(), 6);
+    cvOneD::options member = grid.GetMemberOptions(4);
+    EXPECT_EQ(member.dataTableVals[0][1], 100.0);
+    EXPECT_EQ(member.dataTableVals[1][1], 200.0);
+    EXPECT_EQ(member.outputType, "NONE");
+
+    grid.AddSample({75.0, 150.0});
+    EXPECT_EQ(grid.GetNumberOfMembers(), 1);
+    EXPECT_EQ(grid.GetMemberOptions(0).dataTableVals[1][1], 150.0);
+
+    cvOneDEnsembleParameter missing = tableParameter("NOTATABLE", {1.0});
+    EXPECT_THROW(grid.AddParameter(missing), cvException);
+}
+
+// The members solved on several threads or in lanes are those solved on
+// one, the outlet flow of the last step is the inflow.
+TEST(Ensemble, ThreadsMatchSerialRun) {
+    std::string fileName = "ensembleTube_ensemble.dat";
+    cvOneDEnsemble serial(tubeOptions());
+    serial.AddParameter(tableParameter("INFLOW", {50.0, 100.0, 150.0}));
+    serial.SetThreads(1);
+    serial.Run(solveTube, fileName);
+
+    cvOneDEnsemble threaded(tubeOptions());
+    threaded.AddParameter(tableParameter("INFLOW", {50.0, 100.0, 150.0}));
+    threaded.SetThreads(2);
+    threaded.Run(solveTube, fileName);
+
+    for(long m = 0; m < 3; m++){
+        const cvOneDEnsembleResult& one = serial.GetResult(m);
+        const cvOneDEnsembleResult& two = threaded.GetResult(m);
+        ASSERT_TRUE(one.solved) << one.message;
+        ASSERT_TRUE(two.solved) << two.message;
+        ASSERT_EQ(one.segmentName.size(), 1);
+        EXPECT_EQ(one.outletFlow, two.outletFlow);
+        EXPECT_EQ(one.outletPressure, two.outletPressure);
+        EXPECT_NEAR(one.outletFlow[0].back(), 50.0*(m + 1), 1.0e-3);
+    }
+
+    // the same members in lock-step, two lanes and a single one
+    cvOneDEnsemble lanes(tubeOptions());
+    lanes.AddParameter(tableParameter("INFLOW", {50.0, 100.0, 150.0}));
+    lanes.SetThreads(1);
+    lanes.SetLanes(2);
+    lanes.Run(solveTube, fileName);
+    for(long m = 0; m < 3; m++){
+        const cvOneDEnsembleResult& lane = lanes.GetResult(m);
+        ASSERT_TRUE(lane.solved) << lane.message;
+#ifdef USE_SKYLINE
+        EXPECT_EQ(lane.outletFlow, serial.GetResult(m).outletFlow);
+        EXPECT_EQ(lane.inletPressure, serial.GetResult(m).inletPressure);
+#else
+        // the lanes decompose with the skyline solver, so they only agree
+        // with the sparse solver of a single member to roundoff
+        const cvOneDEnsembleResult& single = serial.GetResult(m);
+        ASSERT_EQ(lane.outletFlow[0].size(), single.outletFlow[0].size());
+        for(size_t i = 0; i < single.outletFlow[0].size(); i++){
+            EXPECT_NEAR(lane.outletFlow[0][i], single.outletFlow[0][i], 1.0e-8*fabs(single.outletFlow[0][i]) + 1.0e-10);
+            EXPECT_NEAR(lane.inletPressure[0][i], single.inletPressure[0][i], 1.0e-8*fabs(single.inletPressure[0][i]) + 1.0e-10);
+        }
+#endif
+    }
+
+    std::ifstream file(fileName.c_str());
+    std::string header;
+    std::getline(file, header);
+    EXPECT_EQ(header, "# ENSEMBLE MEMBERS 3 PARAMETERS 1");
+    file.close();
+    std::remove(fileName.c_str());
+}
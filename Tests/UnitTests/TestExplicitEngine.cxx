@@ -0,0 +1,126 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "cvOneDExplicitEngine.h"
+#include "cvOneDMaterialManager.h"
+
+namespace {
+
+const double length = 10.0;
+const double area = 1.0;
+const double inflow = 5.0;
+const double resistance = 1000.0;
+
+cvOneDMaterialManager materials;
+
+int linearMaterial(){
+    return materials.AddNewMaterialLinear(1.06, 0.04, 2.0, 0.0, 1.0e7);
+}
+
+void setupSegment(cvOneDSubdomain& sub, int matID, long firstNode, double segLength, double segArea){
+    sub.SetNumberOfNodes(21);
+    sub.SetNumberOfElements(20);
+    sub.SetMeshType(MeshTypeScope::UNIFORM);
+    sub.Init(0.0, segLength);
+    sub.SetInitInletS(segArea);
+    sub.SetInitOutletS(segArea);
+    sub.SetInitialFlow(0.0);
+    sub.SetMinorLossType(MinorLossScope::NONE);
+    sub.SetGlobal1stNodeID(firstNode);
+    sub.SetupMaterial(matID, &materials);
+}
+
+void setupResistance(cvOneDSubdomain& sub){
+    double values[2] = {resistance, 0.0};
+    sub.SetBoundCondition(BoundCondTypeScope::RESISTANCE);
+    sub.SetBoundResistPdValues(values, 2);
+}
+
+// Segments at rest with their reference area
+void restState(const std::vector<cvOneDSubdomain*>& subs, cvOneDFEAVector& sol){
+    sol.Clear();
+    for(size_t k = 0; k < subs.size(); k++){
+        for(long i = 0; i < subs[k]->GetNumberOfNodes(); i++){
+            sol[2 * (subs[k]->GetGlobal1stNodeID() + i)] = subs[k]->GetInitInletS();
+        }
+    }
+}
+
+} // namespace
+
+// A tube with constant inflow and a resistance outlet settles to the
+// Poiseuille pressure drop and the outlet pressure R*Q.
+TEST(ExplicitEngine, TubeReachesSteadyFlow) {
+    int matID = linearMaterial();
+    cvOneDSubdomain sub;
+    setupSegment(sub, matID, 0, length, area);
+    setupResistance(sub);
+
+    std::vector<cvOneDSubdomain*> subs(1, &sub);
+    std::vector<cvOneDFEAJoint*> joints;
+    std::vector<int> outlets(1, 0);
+    double time[2] = {0.0, 1.0};
+    double flow[2] = {inflow, inflow};
+    cvOneDExplicitEngine engine(subs, joints, outlets, BoundCondTypeScope::FLOW, time, flow, 2);
+
+    cvOneDFEAVector sol(42);
+    restState(subs, sol);
+    engine.SetState(sol, 0.0);
+    engine.Advance(1.0);
+    engine.GetState(sol);
+
+    for(long i = 0; i < 21; i++){
+        EXPECT_NEAR(sol[2*i + 1], inflow, 1.0e-3 * inflow) << "node " << i;
+    }
+    EXPECT_NEAR(engine.GetMassImbalance(), 0.0, 1.0e-6 * inflow);
+
+    cvOneDMaterial* mat = sub.GetMaterial();
+    double pIn = mat->GetPressure(sol[0], 0.0);
+    double pOut = mat->GetPressure(sol[40], length);
+    EXPECT_NEAR(pOut, resistance * inflow, 1.0e-6 * resistance * inflow);
+    // N = -8 pi nu for the parabolic profile
+    double drop = 8.0 * M_PI * 0.04 * length * inflow / (area * area);
+    EXPECT_NEAR(pIn - pOut, drop, 0.05 * drop);
+}
+
+// The joint splits the flow between two equal daughters with a common
+// pressure and without losing mass.
+TEST(ExplicitEngine, JointConservesMassAndPressure) {
+    int matID = linearMaterial();
+    cvOneDSubdomain parent, left, right;
+    setupSegment(parent, matID, 0, length, area);
+    setupSegment(left, matID, 21, length, 0.5 * area);
+    setupSegment(right, matID, 42, length, 0.5 * area);
+    setupResistance(left);
+    setupResistance(right);
+
+    cvOneDFEAJoint joint;
+    joint.AddInletSubdomains(0);
+    joint.AddOutletSubdomains(1);
+    joint.AddOutletSubdomains(2);
+
+    std::vector<cvOneDSubdomain*> subs = {&parent, &left, &right};
+    std::vector<cvOneDFEAJoint*> joints(1, &joint);
+    std::vector<int> outlets = {1, 2};
+    double time[2] = {0.0, 1.0};
+    double flow[2] = {inflow, inflow};
+    cvOneDExplicitEngine engine(subs, joints, outlets, BoundCondTypeScope::FLOW, time, flow, 2);
+
+    cvOneDFEAVector sol(2 * 63);
+    restState(subs, sol);
+    engine.SetState(sol, 0.0);
+    engine.Advance(0.05);
+    engine.GetState(sol);
+
+    double parentQ = sol[2*20 + 1];
+    double leftQ = sol[2*21 + 1];
+    double rightQ = sol[2*42 + 1];
+    EXPECT_NEAR(parentQ, leftQ + rightQ, 1.0e-10 * inflow);
+    EXPECT_NEAR(leftQ, rightQ, 1.0e-10 * inflow);
+
+    double p = parent.GetMaterial()->GetPressure(sol[2*20], length);
+    EXPECT_NEAR(left.GetMaterial()->GetPressure(sol[2*21], 0.0), p, 1.0e-8 * p);
+    EXPECT_NEAR(right.GetMaterial()->GetPressure(sol[2*42], 0.0), p, 1.0e-8 * p);
+}
@@ -81,6 +81,31 @@ cvOneD::options test_input_options(){
     opts.convergenceTolerance = 1.0e-6;
     opts.useIV = 1;
     opts.useStab = 0;
+    opts.nonlinearSolver = "JFNK";
+    opts.krylovRestart = 20;
+    opts.krylovTolerance = 1.0e-05;
+    opts.preconditionerRefresh = 5;
+    opts.solutionPredictor = "QUADRATIC";
+    opts.andersonDepth = 3;
+    opts.lineSearch = 4;
+    opts.timeIntegrator = "BDF2";
+    opts.linearSolves = 2;
+    opts.solverEngine = "EXPLICIT_FV";
+    opts.courantNumber = 0.5;
+    opts.steadyState = "INITIAL_CONDITION";
+    opts.warmStart = "previous/results_";
+    opts.adaptiveTimeStep = 1;
+    opts.timeStepTolerance = 0.002;
+    opts.minTimeStep = 1.0e-06;
+    opts.maxTimeStep = 0.01;
+    opts.periodicTolerance = 1.0e-04;
+    opts.periodicShooting = 1;
+    opts.parareal = 5;
+    opts.pararealCoarseFactor = 10;
+    opts.pararealWorkers = 4;
+    opts.waveformRelaxation = "GAUSS_SEIDEL";
+    opts.waveformCuts = cvStringVec{"J1", "J2"};
+    opts.waveformWindow = 50;
     opts.outputType = "SOME OUTPUT TYPE";
     opts.vtkOutputType = 23;
 
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#ifdef USE_KLU
+
+#include <cmath>
+#include <vector>
+
+#include "sparse/klu/cvOneDKLU.h"
+
+namespace {
+
+// Small network-like system: two chains coupled by a row with a zero
+// diagonal (like a joint Lagrange multiplier), so the maximum transversal
+// has to move entries onto the diagonal. The second chain does not see
+// the multiplier, which gives more than one diagonal block.
+cs* buildMatrix(double scale){
+    const int n = 7;
+    cs* T = cs_spalloc(n, n, 40, 1, 1);
+    for(int i = 0; i < 6; i++){
+        cs_entry(T, i, i, 4.0 * scale + i);
+        if(i != 2 && i < 5){
+            cs_entry(T, i, i + 1, -1.0);
+            cs_entry(T, i + 1, i, -1.0 * scale);
+        }
+    }
+    cs_entry(T, 6, 2, 1.0);
+    cs_entry(T, 6, 3, -1.0);
+    cs_entry(T, 2, 6, 1.0);
+    cs* A = cs_triplet(T);
+    cs_spfree(T);
+    return A;
+}
+
+double residual(const cs* A, const std::vector<double>& sol, const std::vector<double>& rhs){
+    std::vector<double> r(rhs);
+    for(int j = 0; j < A->n; j++){
+        for(int p = A->p[j]; p < A->p[j+1]; p++){
+            r[A->i[p]] -= A->x[p] * sol[j];
+        }
+    }
+    double norm = 0.0;
+    for(double v : r) norm = std::max(norm, std::fabs(v));
+    return norm;
+}
+
+} // namespace
+
+TEST(KLU, FactorAndRefactorSolve) {
+    cvOneDKLU klu;
+    std::vector<double> rhs = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 0.5};
+
+    cs* A = buildMatrix(1.0);
+    ASSERT_TRUE(klu.Analyze(A));
+    ASSERT_TRUE(klu.Factor());
+    EXPECT_GT(klu.GetNumberOfBlocks(), 1);
+    std::vector<double> sol(rhs);
+    ASSERT_TRUE(klu.Solve(sol.data()));
+    EXPECT_LT(residual(A, sol, rhs), 1.0e-12);
+    cs_spfree(A);
+
+    // Same pattern, new values: the pivot sequence is reused
+    A = buildMatrix(2.0);
+    ASSERT_TRUE(klu.Load(A));
+    ASSERT_TRUE(klu.Refactor());
+    EXPECT_EQ(klu.GetNumberOfRefactorizations(), 1);
+    sol = rhs;
+    ASSERT_TRUE(klu.Solve(sol.data()));
+    EXPECT_LT(residual(A, sol, rhs), 1.0e-12);
+    cs_spfree(A);
+}
+
+TEST(KLU, NewEntriesRequireAnalysis) {
+    cvOneDKLU klu;
+    cs* A = buildMatrix(1.0);
+    ASSERT_TRUE(klu.Analyze(A));
+    cs_spfree(A);
+
+    cs* T = cs_spalloc(7, 7, 1, 1, 1);
+    cs_entry(T, 0, 5, 1.0);
+    cs_entry(T, 6, 6, 1.0);
+    cs* B = cs_triplet(T);
+    cs_spfree(T);
+    EXPECT_FALSE(klu.Load(B));
+    cs_spfree(B);
+}
+
+#endif // USE_KLU
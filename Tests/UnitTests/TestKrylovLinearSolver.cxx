@@ -0,0 +1,198 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "cvOneDKrylovLinearSolver.h"
+#include "cvOneDSkylineLinearSolver.h"
+#include "cvOneDSkylineMatrix.h"
+#include "cvOneDFEAVector.h"
+
+namespace {
+
+// Two segments of two nodes (equations 0-3 and 4-7) joined by one
+// multiplier (equation 8) coupling the flow of equations 3 and 5.
+const long dim = 9;
+const long firstLag = 8;
+double K[dim][dim];
+double b0[dim];
+
+bool inSegment(long i, long j){
+    return (i < 4 && j < 4) || (i >= 4 && i < 8 && j >= 4 && j < 8);
+}
+
+void buildSystem(bool withJoint){
+    for(long i = 0; i < dim; i++){
+        b0[i] = 1.0 + 0.1 * i;
+        for(long j = 0; j < dim; j++){
+            K[i][j] = 0.0;
+            if(inSegment(i, j)){
+                K[i][j] = (i == j) ? 4.0 + i : 0.3 * (i + 1) - 0.2 * j;
+            }
+        }
+    }
+    if(withJoint){
+        K[3][8] = 1.0;  K[8][3] = 1.0;
+        K[5][8] = -1.0; K[8][5] = -1.0;
+    }else{
+        K[8][8] = 1.0;
+    }
+}
+
+// minus the residual of the linear problem K*u = b0
+void linearResidual(const cvOneDFEAVector& shift, cvOneDFEAVector& residual){
+    for(long i = 0; i < dim; i++){
+        double sum = b0[i];
+        for(long j = 0; j < dim; j++){
+            sum -= K[i][j] * shift.Get(j);
+        }
+        residual[i] = sum;
+    }
+}
+
+void fillPositions(long* pos, bool blocksOnly){
+    long heights[dim] = {0, 1, 2, 3, 0, 1, 2, 3, 0};
+    if(!blocksOnly){
+        heights[8] = 5;
+    }
+    pos[0] = 0;
+    for(long i = 0; i < dim; i++){
+        pos[i+1] = pos[i] + heights[i];
+    }
+}
+
+void fillMatrix(cvOneDSkylineMatrix& mat, bool blocksOnly){
+    mat.Clear();
+    for(long i = 0; i < dim; i++){
+        for(long j = 0; j < dim; j++){
+            if(K[i][j] != 0.0 && (!blocksOnly || inSegment(i, j))){
+                mat.SetValue(i, j, K[i][j]);
+            }
+        }
+    }
+}
+
+} // namespace
+
+// The matrix-free corrections, with the boundary manipulations replayed
+// on the directional differences, match the direct skyline solution even
+// when the preconditioner only has the segment blocks.
+TEST(KrylovLinearSolver, MatchesDirectSolveWithBoundaryConditions) {
+    buildSystem(true);
+
+    long fullPos[dim + 1];
+    fillPositions(fullPos, false);
+    cvOneDSkylineMatrix full(dim, fullPos);
+    cvOneDFEAVector directRhs(dim);
+    cvOneDFEAVector directSol(dim);
+    fillMatrix(full, false);
+    for(long i = 0; i < dim; i++) directRhs[i] = b0[i];
+
+    cvOneDSkylineLinearSolver direct;
+    direct.SetLHS(&full);
+    direct.SetRHS(&directRhs);
+    direct.SetSolution(1, 0.0);
+    direct.Minus1dof(7, 0.5);
+    direct.Solve(directSol);
+
+    long blockPos[dim + 1];
+    fillPositions(blockPos, true);
+    cvOneDSkylineMatrix blocks(dim, blockPos);
+    cvOneDFEAVector rhs(dim);
+    cvOneDFEAVector sol(dim);
+
+    cvOneDKrylovLinearSolver krylov(dim, firstLag, linearResidual);
+    krylov.SetTolerance(1.0e-12);
+    krylov.SetLHS(&blocks);
+    krylov.SetRHS(&rhs);
+    EXPECT_TRUE(krylov.NeedsRefresh());
+
+    krylov.BeginAssembly(true);
+    fillMatrix(blocks, true);
+    for(long i = 0; i < dim; i++) rhs[i] = b0[i];
+    krylov.SetSolution(1, 0.0);
+    krylov.Minus1dof(7, 0.5);
+    krylov.Solve(sol);
+    EXPECT_FALSE(krylov.NeedsRefresh());
+    EXPECT_GT(krylov.GetNumberOfIterations(), 1);
+
+    for(long i = 0; i < dim; i++){
+        EXPECT_NEAR(sol[i], directSol[i], 1.0e-8 * (1.0 + std::fabs(directSol[i]))) << i;
+    }
+
+    // Same system without refreshing: the factored blocks are reused
+    krylov.BeginAssembly(false);
+    for(long i = 0; i < dim; i++) rhs[i] = b0[i];
+    krylov.SetSolution(1, 0.0);
+    krylov.Minus1dof(7, 0.5);
+    krylov.Solve(sol);
+    for(long i = 0; i < dim; i++){
+        EXPECT_NEAR(sol[i], directSol[i], 1.0e-8 * (1.0 + std::fabs(directSol[i]))) << i;
+    }
+}
+
+// With the joint entries registered, the blocks and the Schur complement
+// of the multiplier invert the tangent exactly.
+TEST(KrylovLinearSolver, JointCouplingMakesPreconditionerExact) {
+    buildSystem(true);
+
+    long fullPos[dim + 1];
+    fillPositions(fullPos, false);
+    cvOneDSkylineMatrix full(dim, fullPos);
+    cvOneDFEAVector directRhs(dim);
+    cvOneDFEAVector directSol(dim);
+    fillMatrix(full, false);
+    for(long i = 0; i < dim; i++) directRhs[i] = b0[i];
+
+    cvOneDSkylineLinearSolver direct;
+    direct.SetLHS(&full);
+    direct.SetRHS(&directRhs);
+    direct.Solve(directSol);
+
+    long blockPos[dim + 1];
+    fillPositions(blockPos, true);
+    cvOneDSkylineMatrix blocks(dim, blockPos);
+    cvOneDFEAVector rhs(dim);
+    cvOneDFEAVector sol(dim);
+
+    cvOneDKrylovLinearSolver krylov(dim, firstLag, linearResidual);
+    krylov.SetLHS(&blocks);
+    krylov.SetRHS(&rhs);
+    krylov.BeginAssembly(true);
+    fillMatrix(blocks, true);
+    for(long i = 0; i < dim; i++){
+        rhs[i] = b0[i];
+        for(long j = 0; j < dim; j++){
+            if(K[i][j] != 0.0 && !inSegment(i, j)){
+                krylov.GetCouplingMatrix()->AddValue(i, j, K[i][j]);
+            }
+        }
+    }
+    krylov.Solve(sol);
+
+    EXPECT_EQ(krylov.GetNumberOfIterations(), 1);
+    for(long i = 0; i < dim; i++){
+        EXPECT_NEAR(sol[i], directSol[i], 1.0e-8 * (1.0 + std::fabs(directSol[i]))) << i;
+    }
+}
+
+// Without joints the segment blocks are the whole tangent, so the
+// preconditioned system is the identity.
+TEST(KrylovLinearSolver, ExactBlocksConvergeInOneIteration) {
+    buildSystem(false);
+
+    long blockPos[dim + 1];
+    fillPositions(blockPos, true);
+    cvOneDSkylineMatrix blocks(dim, blockPos);
+    cvOneDFEAVector rhs(dim);
+    cvOneDFEAVector sol(dim);
+
+    cvOneDKrylovLinearSolver krylov(dim, firstLag, linearResidual);
+    krylov.SetLHS(&blocks);
+    krylov.SetRHS(&rhs);
+    krylov.BeginAssembly(true);
+    fillMatrix(blocks, true);
+    for(long i = 0; i < dim; i++) rhs[i] = b0[i];
+    krylov.Solve(sol);
+
+    EXPECT_EQ(krylov.GetNumberOfIterations(), 1);
+}
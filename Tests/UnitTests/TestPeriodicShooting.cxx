@@ -0,0 +1,49 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <vector>
+
+#include "cvOneDPeriodicShooting.h"
+
+namespace {
+
+// Linear cycle map with one fast and one slowly decaying mode, like a
+// segment coupled to an RCR outlet: marching needs hundreds of cycles
+// to reach the fixed point (2, -1) within the tolerance.
+void affineMap(const std::vector<double>& x, std::vector<double>& y){
+    y.resize(2);
+    y[0] = 0.1 * (x[0] - 2.0) + 0.2 * (x[1] + 1.0) + 2.0;
+    y[1] = 0.99 * (x[1] + 1.0) - 1.0;
+}
+
+// Mildly nonlinear contraction with fixed point (1, 1)
+void nonlinearMap(const std::vector<double>& x, std::vector<double>& y){
+    y.resize(2);
+    y[0] = 1.0 + 0.5 * (x[0] - 1.0) * x[1];
+    y[1] = 1.0 + 0.9 * (x[1] - 1.0) + 0.05 * (x[0] - 1.0) * (x[0] - 1.0);
+}
+
+} // namespace
+
+TEST(PeriodicShooting, LinearMapConvergesInOneNewtonStep) {
+    cvOneDPeriodicShooting shooting(affineMap);
+    shooting.SetTolerance(1.0e-8);
+    std::vector<double> state = {0.0, 0.0};
+    ASSERT_TRUE(shooting.Solve(state));
+    EXPECT_NEAR(state[0], 2.0, 1.0e-6);
+    EXPECT_NEAR(state[1], -1.0, 1.0e-6);
+    // the residual, two directional differences and the new residual,
+    // a finite difference error may cost one more Newton step
+    EXPECT_LE(shooting.GetNumberOfCycles(), 8);
+}
+
+TEST(PeriodicShooting, NonlinearMapWithScaling) {
+    cvOneDPeriodicShooting shooting(nonlinearMap);
+    shooting.SetTolerance(1.0e-8);
+    shooting.SetScale({1.0, 10.0});
+    std::vector<double> state = {1.5, 0.5};
+    ASSERT_TRUE(shooting.Solve(state));
+    EXPECT_NEAR(state[0], 1.0, 1.0e-6);
+    EXPECT_NEAR(state[1], 1.0, 1.0e-6);
+    EXPECT_LT(shooting.GetResidual(), 1.0e-8);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstring>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "cvOneDContext.h"
+#include "cvOneDModelManager.h"
+#include "cvOneDOptionsJsonSerializer.h"
+#include "cvOneDOptionsLegacySerializer.h"
+#include "cvOneDServer.h"
+#include "cvOneDSimulation.h"
+
+namespace {
+
+// Straight tube named after the model of the job, the solver only keeps
+// the results in memory.
+void solveTube(const cvOneD::options& opts){
+    cvOneDModelManager oned((char*)opts.modelName.c_str());
+    oned.CreateNode((char*)"IN", 0.0, 0.0, 0.0);
+    oned.CreateNode((char*)"OUT", 0.0, 0.0, 10.0);
+    double params[3] = {1.0e15, -20.0, 1.0e9};
+    int matID = 0;
+    oned.CreateMaterial((char*)"MAT", (char*)"MATERIAL_OLUFSEN", 1.06, 0.04, 2.0, 0.0, 3, params, &matID);
+    double resistance = 100.0;
+    double outletTime = 0.0;
+    oned.CreateSegment((char*)"tube", 0, 10.0, 20, 0, 1, 1.0, 1.0, 0.0, matID, (char*)"NONE",
+                       0.0, 0, 0, (char*)"RESISTANCE", &resistance, &outletTime, 1);
+    cvOneDContext::Current()->solver->SetOutputType(OutputTypeScope::OUTPUT_NONE);
+    double times[2] = {0.0, 1.0};
+    double flows[2] = {50.0, 50.0};
+    oned.SolveModel(1.0e-3, 10, 100, 2, 2, (char*)"FLOW", flows, times, 1.0e-8, 1, 1);
+}
+
+std::string readFile(const std::string& fileName){
+    std::ifstream file(fileName.c_str());
+    std::stringstream text;
+    text << file.rdbuf();
+    return text.str();
+}
+
+// until a connection to the socket is accepted
+void waitForServer(const std::string& socketPath){
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath.c_str());
+    for(int i = 0; i < 1000; i++){
+        int probe = socket(AF_UNIX, SOCK_STREAM, 0);
+        bool listening = (connect(probe, (sockaddr*)&address, sizeof(address)) == 0);
+        close(probe);
+        if(listening){
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+}
+
+} // namespace
+
+// A resubmitted input uses the cached options and gets the same results,
+// the server stops when a client asks.
+TEST(Server, SolvesAndCachesJobs) {
+    cvOneD::options opts{};
+    cvOneD::readOptionsLegacyFormat("TestFiles/SimpleArtery.in", &opts);
+    std::string jsonInput = "serverTestInput.json";
+    cvOneD::writeJsonOptions(opts, jsonInput);
+
+    std::string socketPath = "/tmp/oneDServerTest_" + std::to_string(getpid()) + ".sock";
+    cvOneDServer server(socketPath);
+    server.SetWorkers(2);
+    std::thread serving([&](){server.Serve(solveTube);});
+    waitForServer(socketPath);
+
+    std::string flowFile = opts.modelName + "tube_flow.dat";
+    EXPECT_FALSE(cvOneDServer::SubmitJob(socketPath, jsonInput));
+    std::string first = readFile(flowFile);
+    EXPECT_FALSE(first.empty());
+    std::remove(flowFile.c_str());
+    EXPECT_TRUE(cvOneDServer::SubmitJob(socketPath, jsonInput));
+    EXPECT_EQ(readFile(flowFile), first);
+
+    cvOneDServer::StopServer(socketPath);
+    serving.join();
+    EXPECT_NE(access(socketPath.c_str(), F_OK), 0);
+
+    std::remove(jsonInput.c_str());
+    const char* fields[5] = {"flow", "area", "pressure", "wss", "Re"};
+    for(int i = 0; i < 5; i++){
+        std::remove((opts.modelName + "tube_" + fields[i] + ".dat").c_str());
+    }
+}
+
+// The socket of a server that is gone is replaced, a file that is not a
+// socket or the socket of a running server is left alone.
+TEST(Server, ReplacesOnlyStaleSockets) {
+    std::string socketPath = "/tmp/oneDServerStale_" + std::to_string(getpid()) + ".sock";
+    {
+        std::ofstream file(socketPath.c_str());
+        file << "not a socket" << std::endl;
+    }
+    cvOneDServer onFile(socketPath);
+    EXPECT_THROW(onFile.Serve(solveTube), cvException);
+    EXPECT_EQ(readFile(socketPath), "not a socket\n");
+    std::remove(socketPath.c_str());
+
+    // a bound socket nobody listens on any more
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strcpy(address.sun_path, socketPath.c_str());
+    int stale = socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(bind(stale, (sockaddr*)&address, sizeof(address)), 0);
+    close(stale);
+    ASSERT_EQ(access(socketPath.c_str(), F_OK), 0);
+
+    cvOneDServer server(socketPath);
+    server.SetWorkers(1);
+    std::thread serving([&](){server.Serve(solveTube);});
+    waitForServer(socketPath);
+
+    cvOneDServer second(socketPath);
+    EXPECT_THROW(second.Serve(solveTube), cvException);
+
+    cvOneDServer::StopServer(socketPath);
+    serving.join();
+    EXPECT_NE(access(socketPath.c_str(), F_OK), 0);
+}
+
+// Parareal jobs run their fine propagators on threads of the worker.
+TEST(Server, SolvesPararealJobs) {
+    cvOneD::options opts{};
+    cvOneD::readOptionsLegacyFormat("TestFiles/SimpleArtery.in", &opts);
+    opts.parareal = 2;
+    opts.pararealWorkers = 2;
+    std::string jsonInput = "serverPararealInput.json";
+    cvOneD::writeJsonOptions(opts, jsonInput);
+
+    std::string socketPath = "/tmp/oneDServerParareal_" + std::to_string(getpid()) + ".sock";
+    cvOneDServer server(socketPath);
+    server.SetWorkers(1);
+    std::thread serving([&](){server.Serve(cvOneD::solveInCurrentContext);});
+    waitForServer(socketPath);
+    EXPECT_NO_THROW(cvOneDServer::SubmitJob(socketPath, jsonInput));
+    cvOneDServer::StopServer(socketPath);
+    serving.join();
+
+    std::string name = opts.modelName + "ARTERY_";
+    EXPECT_FALSE(readFile(name + "flow.dat").empty());
+    std::remove(jsonInput.c_str());
+    const char* fields[5] = {"flow", "area", "pressure", "wss", "Re"};
+    for(int i = 0; i < 5; i++){
+        std::remove((name + fields[i] + ".dat").c_str());
+    }
+}
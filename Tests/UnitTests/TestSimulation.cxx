@@ -0,0 +1,242 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "cvOneDEnsemble.h"
+#include "cvOneDOptionsLegacySerializer.h"
+#include "cvOneDResultFile.h"
+#include "cvOneDSimulation.h"
+
+namespace {
+
+cvOneD::options arteryOptions(const std::string& outputType){
+    cvOneD::options opts{};
+    cvOneD::readOptionsLegacyFormat("TestFiles/SimpleArtery.in", &opts);
+    opts.outputType = outputType;
+    return opts;
+}
+
+} // namespace
+
+// The arrays of a simulation kept in memory hold the values of the text
+// result files of the same simulation.
+TEST(Simulation, ResultsMatchTextFiles) {
+    cvOneDSimulation memory(arteryOptions("NONE"));
+    EXPECT_THROW(memory.GetNumberOfSegments(), cvException);
+    memory.Run();
+    EXPECT_THROW(memory.Run(), cvException);
+    ASSERT_EQ(memory.GetNumberOfSegments(), 1);
+    EXPECT_EQ(memory.GetSegmentIndex("artery"), 0);
+    EXPECT_THROW(memory.GetSegmentIndex("vein"), cvException);
+    long nodes = memory.GetNumberOfNodes(0);
+    long steps = memory.GetNumberOfSavedSteps();
+    EXPECT_EQ(nodes, 51);
+
+    cvDoubleVec flow, area, pressure;
+    memory.GetSegmentResults(0, flow, area, pressure);
+    ASSERT_EQ((long)flow.size(), nodes*steps);
+    ASSERT_EQ((long)pressure.size(), nodes*steps);
+
+    cvOneD::options textOpts = arteryOptions("TEXT");
+    cvOneDSimulation text(textOpts);
+    text.Run();
+    std::string name = textOpts.modelName + "ARTERY_";
+    std::vector<double> saved;
+    std::ifstream file((name + "flow.dat").c_str());
+    double value;
+    while(file >> value){
+        saved.push_back(value);
+    }
+    ASSERT_EQ(saved.size(), flow.size());
+    for(size_t i = 0; i < saved.size(); i++){
+        EXPECT_NEAR(saved[i], flow[i], 1.0e-6*std::abs(flow[i]) + 1.0e-12);
+    }
+    // the inflow of the last step is out of the artery
+    EXPECT_NEAR(flow[nodes*steps - 1], 200.0, 1.0e-3);
+
+    const char* fields[5] = {"flow", "area", "pressure", "wss", "Re"};
+    for(int i = 0; i < 5; i++){
+        std::remove((name + fields[i] + ".dat").c_str());
+    }
+}
+
+// The arrays kept for views stay in place and hold the Reynolds numbers and
+// wall shear stresses of the text result files.
+TEST(Simulation, ResultDataMatchesTextFiles) {
+    cvOneD::options opts = arteryOptions("TEXT");
+    cvOneDSimulation simulation(opts);
+    EXPECT_THROW(simulation.GetSegmentResultData(0, "flow"), cvException);
+    simulation.Run();
+    long values = simulation.GetNumberOfNodes(0)*simulation.GetNumberOfSavedSteps();
+
+    cvDoubleVec flow, area, pressure;
+    simulation.GetSegmentResults(0, flow, area, pressure);
+    const double* data = simulation.GetSegmentResultData(0, "pressure");
+    EXPECT_EQ(cvDoubleVec(data, data + values), pressure);
+    EXPECT_EQ(simulation.GetSegmentResultData(0, "pressure"), data);
+    EXPECT_THROW(simulation.GetSegmentResultData(0, "velocity"), cvException);
+    EXPECT_THROW(simulation.GetSegmentResultData(1, "flow"), cvException);
+
+    std::string name = opts.modelName + "ARTERY_";
+    const char* fields[2] = {"Re", "wss"};
+    for(int f = 0; f < 2; f++){
+        data = simulation.GetSegmentResultData(0, fields[f]);
+        std::ifstream file((name + fields[f] + ".dat").c_str());
+        long count = 0;
+        double value;
+        while(file >> value && count < values){
+            EXPECT_NEAR(value, data[count], 1.0e-6*std::abs(data[count]) + 1.0e-12);
+            count++;
+        }
+        EXPECT_EQ(count, values);
+    }
+
+    const char* files[5] = {"flow", "area", "pressure", "wss", "Re"};
+    for(int i = 0; i < 5; i++){
+        std::remove((name + files[i] + ".dat").c_str());
+    }
+}
+
+// The binary result file holds the values of the text result files, and
+// any range of steps is read from it.
+TEST(Simulation, BinaryResultFile) {
+    cvOneD::options opts = arteryOptions("BINARY");
+    cvOneDSimulation simulation(opts);
+    simulation.Run();
+    long nodes = simulation.GetNumberOfNodes(0);
+    long steps = simulation.GetNumberOfSavedSteps();
+
+    std::string fileName = opts.modelName + "results.bin";
+    cvOneDResultFileReader reader(fileName);
+    ASSERT_EQ(reader.GetNumberOfSegments(), 1);
+    EXPECT_EQ(reader.GetSegmentIndex(simulation.GetSegmentName(0)), 0);
+    EXPECT_EQ(reader.GetNumberOfNodes(0), nodes);
+    ASSERT_EQ(reader.GetNumberOfSteps(), steps);
+    EXPECT_NEAR(reader.GetTimes()[steps - 1] - reader.GetTimes()[steps - 2],
+                opts.timeStep*opts.stepSize, 1.0e-12);
+    EXPECT_THROW(reader.GetFieldIndex("velocity"), cvException);
+    cvDoubleVec values;
+    EXPECT_THROW(reader.Read(0, 0, steps - 1, 2, values), cvException);
+
+    const char* fields[5] = {"flow", "area", "pressure", "Re", "wss"};
+    for(int f = 0; f < 5; f++){
+        const double* data = simulation.GetSegmentResultData(0, fields[f]);
+        reader.Read(0, reader.GetFieldIndex(fields[f]), 3, steps - 5, values);
+        ASSERT_EQ((long)values.size(), (steps - 5)*nodes);
+        for(long i = 0; i < steps - 5; i++){
+            for(long n = 0; n < nodes; n++){
+                EXPECT_EQ(values[i*nodes + n], data[n*steps + i + 3]);
+            }
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+// A file of several chunks, written in reverse order and with a shorter
+// last chunk, reads back across the chunk boundaries.
+TEST(Simulation, BinaryResultFileChunks) {
+    const long steps = 8;
+    cvDoubleVec times;
+    for(long i = 0; i < steps; i++){
+        times.push_back(0.1*i);
+    }
+    cvStringVec names = {"long", "short"};
+    cvLongVec nodes = {20000, 7};
+    auto value = [](long segment, long field, long step, long node){
+        return segment + 10.0*field + 100.0*step + 1000.0*node;
+    };
+
+    std::string fileName = "chunks_results.bin";
+    cvOneDResultFileWriter writer(fileName, times, names, nodes);
+    long stepsPerChunk = writer.GetStepsPerChunk();
+    long chunks = writer.GetNumberOfChunks();
+    ASSERT_EQ(stepsPerChunk, 3);
+    ASSERT_EQ(chunks, 3);
+    for(long c = chunks - 1; c >= 0; c--){
+        for(long s = 0; s < 2; s++){
+            long first = c*stepsPerChunk;
+            long count = std::min(stepsPerChunk, steps - first);
+            cvDoubleVec values;
+            for(long f = 0; f < 5; f++){
+                for(long i = 0; i < count; i++){
+                    for(long n = 0; n < nodes[s]; n++){
+                        values.push_back(value(s, f, first + i, n));
+                    }
+                }
+            }
+            writer.WriteChunk(s, c, values.data());
+        }
+    }
+    writer.Close();
+
+    cvOneDResultFileReader reader(fileName);
+    ASSERT_EQ(reader.GetNumberOfSteps(), steps);
+    ASSERT_EQ(reader.GetNumberOfNodes(0), nodes[0]);
+    // steps 2 to 6 span all three chunks, step 7 is the last of the short one
+    const long ranges[3][2] = {{2, 5}, {7, 1}, {0, steps}};
+    cvDoubleVec values;
+    for(long s = 0; s < 2; s++){
+        for(long f = 0; f < 5; f++){
+            for(const auto& range : ranges){
+                reader.Read(s, f, range[0], range[1], values);
+                ASSERT_EQ((long)values.size(), range[1]*nodes[s]);
+                for(long i = 0; i < range[1]; i++){
+                    for(long n = 0; n < nodes[s]; n++){
+                        ASSERT_EQ(values[i*nodes[s] + n], value(s, f, range[0] + i, n));
+                    }
+                }
+            }
+        }
+    }
+    std::remove(fileName.c_str());
+}
+
+// The fine propagators of Parareal on worker threads give the results of
+// those run one after the other, also for the members of an ensemble.
+TEST(Simulation, PararealWorkersMatchSerialRun) {
+    // two cycles of five time units
+    cvOneD::options opts = arteryOptions("NONE");
+    for(size_t i = 0; i < opts.dataTableName.size(); i++){
+        if(opts.dataTableName[i] == "INLETDATA"){
+            opts.dataTableVals[i] = {0.0, 200.0, 5.0, 200.0};
+        }
+    }
+    opts.parareal = 2;
+    opts.pararealCoarseFactor = 10;
+    opts.pararealWorkers = 1;
+    cvOneDSimulation serial(opts);
+    serial.Run();
+    opts.pararealWorkers = 2;
+    cvOneDSimulation threaded(opts);
+    threaded.Run();
+
+    cvDoubleVec serialFlow, serialArea, serialPressure;
+    cvDoubleVec flow, area, pressure;
+    serial.GetSegmentResults(0, serialFlow, serialArea, serialPressure);
+    threaded.GetSegmentResults(0, flow, area, pressure);
+    EXPECT_EQ(flow, serialFlow);
+    EXPECT_EQ(pressure, serialPressure);
+
+    cvOneDEnsemble ensemble(opts);
+    cvOneDEnsembleParameter inflow;
+    inflow.type = "DATATABLE";
+    inflow.name = "INLETDATA";
+    inflow.index = 1;
+    inflow.values = {200.0};
+    ensemble.AddParameter(inflow);
+    std::string fileName = opts.modelName + "ensemble.dat";
+    ensemble.Run(cvOneD::solveInCurrentContext, fileName);
+    const cvOneDEnsembleResult& member = ensemble.GetResult(0);
+    ASSERT_TRUE(member.solved) << member.message;
+    long nodes = threaded.GetNumberOfNodes(0);
+    long steps = threaded.GetNumberOfSavedSteps();
+    ASSERT_EQ((long)member.outletFlow[0].size(), steps);
+    for(long i = 0; i < steps; i++){
+        EXPECT_EQ(member.outletFlow[0][i], flow[(nodes - 1)*steps + i]);
+    }
+    std::remove(fileName.c_str());
+}
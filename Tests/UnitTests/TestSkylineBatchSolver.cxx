@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+#include <vector>
+
+#include "cvOneDSkylineBatchSolver.h"
+#include "cvOneDSkylineMatrix.h"
+#include "cvOneDSkylineLinearSolver.h"
+#include "cvOneDFEAVector.h"
+
+namespace {
+
+// Banded matrix with one long column, as the joint Lagrange multipliers
+// produce, its entries scaled differently for each lane.
+const long dim = 7;
+long heights[dim] = {0, 1, 2, 2, 3, 1, 6};
+
+void fillPositions(long* pos){
+    pos[0] = 0;
+    for(long i = 0; i < dim; i++){
+        pos[i+1] = pos[i] + heights[i];
+    }
+}
+
+void fillSystem(cvOneDSkylineMatrix& mat, cvOneDFEAVector& rhs, double scale){
+    mat.Clear();
+    for(long i = 0; i < dim; i++){
+        for(long j = 0; j < dim; j++){
+            long col = std::max(i, j);
+            long row = std::min(i, j);
+            if(col - row <= heights[col]){
+                mat.SetValue(i, j, (i == j ? 50.0 * scale : 0.0) + 1.0 + i * scale + j);
+            }
+        }
+        rhs[i] = 100.0 + i * scale;
+    }
+}
+
+std::vector<double> scalarSolution(double scale){
+    long pos[dim + 1];
+    fillPositions(pos);
+    cvOneDSkylineMatrix mat(dim, pos);
+    cvOneDFEAVector rhs(dim);
+    cvOneDFEAVector sol(dim);
+    fillSystem(mat, rhs, scale);
+    cvOneDSkylineLinearSolver solver;
+    solver.SetLHS(&mat);
+    solver.SetRHS(&rhs);
+    solver.Solve(sol);
+    return std::vector<double>(sol.GetEntries(), sol.GetEntries() + dim);
+}
+
+} // namespace
+
+// Each lane of the interleaved decomposition gives the solution of the
+// skyline solver, to the last bit.
+TEST(SkylineBatchSolver, LanesMatchScalarSolve) {
+    const int width = 3;
+    long pos[dim + 1];
+    fillPositions(pos);
+    long nnz = pos[dim];
+    std::vector<double> KU(nnz * width), KL(nnz * width), KD(dim * width), F(dim * width), u(dim * width);
+    for(int l = 0; l < width; l++){
+        cvOneDSkylineMatrix mat(dim, pos);
+        cvOneDFEAVector rhs(dim);
+        fillSystem(mat, rhs, 1.0 + l);
+        for(long k = 0; k < nnz; k++){
+            KU[k * width + l] = mat.GetUpperDiagonalEntries()[k];
+            KL[k * width + l] = mat.GetLowerDiagonalEntries()[k];
+        }
+        for(long k = 0; k < dim; k++){
+            KD[k * width + l] = mat.GetDiagonalEntries()[k];
+            F[k * width + l] = rhs[k];
+        }
+    }
+    cvOneDSkylineBatchSolver::FactorLanes(&KU[0], &KL[0], &KD[0], pos, dim, width);
+    cvOneDSkylineBatchSolver::SolveLanes(&KU[0], &KL[0], &KD[0], &F[0], &u[0], pos, dim, width);
+    for(int l = 0; l < width; l++){
+        std::vector<double> expected = scalarSolution(1.0 + l);
+        for(long k = 0; k < dim; k++){
+            EXPECT_EQ(u[k * width + l], expected[k]) << "lane " << l << " entry " << k;
+        }
+    }
+}
+
+// A lane that leaves does not hold back the rounds of the others.
+TEST(SkylineBatchSolver, LanesSolveInRounds) {
+    cvOneDSkylineBatchSolver batch(2);
+    std::vector<double> first, second, third;
+    auto solveOnLane = [&](int lane, double scale, std::vector<double>& result){
+        long pos[dim + 1];
+        fillPositions(pos);
+        cvOneDSkylineMatrix mat(dim, pos);
+        cvOneDFEAVector rhs(dim);
+        cvOneDFEAVector sol(dim);
+        fillSystem(mat, rhs, scale);
+        cvOneDSkylineLaneSolver solver(&batch, lane);
+        solver.SetLHS(&mat);
+        solver.SetRHS(&rhs);
+        solver.Solve(sol);
+        result.assign(sol.GetEntries(), sol.GetEntries() + dim);
+    };
+    std::thread laneZero([&](){
+        solveOnLane(0, 1.0, first);
+        solveOnLane(0, 3.0, third);
+        batch.Leave(0);
+    });
+    std::thread laneOne([&](){
+        solveOnLane(1, 2.0, second);
+        batch.Leave(1);
+    });
+    laneZero.join();
+    laneOne.join();
+    EXPECT_EQ(first, scalarSolution(1.0));
+    EXPECT_EQ(second, scalarSolution(2.0));
+    EXPECT_EQ(third, scalarSolution(3.0));
+}
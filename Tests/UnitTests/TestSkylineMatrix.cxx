@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include "cvOneDSkylineMatrix.h"
+#include "cvOneDSkylineLinearSolver.h"
+#include "cvOneDFEAVector.h"
+
+namespace {
+
+// Column heights of a small banded matrix with one long column,
+// similar to what the joint Lagrange multipliers produce.
+const long dim = 7;
+long heights[dim] = {0, 1, 2, 2, 3, 1, 6};
+
+void fillPositions(long* pos){
+    pos[0] = 0;
+    for(long i = 0; i < dim; i++){
+        pos[i+1] = pos[i] + heights[i];
+    }
+}
+
+void fillMatrix(cvOneDSkylineMatrix& mat, cvOneDFEAVector& rhs){
+    mat.Clear();
+    for(long i = 0; i < dim; i++){
+        for(long j = 0; j < dim; j++){
+            long col = std::max(i, j);
+            long row = std::min(i, j);
+            if(col - row <= heights[col]){
+                mat.SetValue(i, j, 1.0 + i * 10.0 + j);
+            }
+        }
+        rhs[i] = 100.0 + i;
+    }
+}
+
+} // namespace
+
+// Applying a Dirichlet condition through the precomputed boundary
+// structure must give the same system as the generic skyline traversal.
+TEST(SkylineMatrix, BoundaryEquationsMatchGenericPath) {
+    long pos[dim + 1];
+    fillPositions(pos);
+
+    cvOneDSkylineMatrix generic(dim, pos);
+    cvOneDSkylineMatrix cached(dim, pos);
+    cvOneDFEAVector genericRhs(dim);
+    cvOneDFEAVector cachedRhs(dim);
+
+    long bcEqs[3] = {0, 3, 6};
+    cached.SetBoundaryEquations(3, bcEqs);
+
+    fillMatrix(generic, genericRhs);
+    fillMatrix(cached, cachedRhs);
+
+    cvOneDSkylineLinearSolver solver;
+    for(long k = 0; k < 3; k++){
+        solver.SetLHS(&generic);
+        solver.SetRHS(&genericRhs);
+        solver.SetSolution(bcEqs[k], 2.0 + k);
+        solver.SetLHS(&cached);
+        solver.SetRHS(&cachedRhs);
+        solver.SetSolution(bcEqs[k], 2.0 + k);
+    }
+
+    for(long i = 0; i < dim; i++){
+        EXPECT_DOUBLE_EQ(genericRhs[i], cachedRhs[i]) << "rhs " << i;
+        for(long j = 0; j < dim; j++){
+            long col = std::max(i, j);
+            long row = std::min(i, j);
+            if(col - row <= heights[col]){
+                EXPECT_DOUBLE_EQ(generic.GetValue(i, j), cached.GetValue(i, j)) << i << "," << j;
+            }
+        }
+    }
+}
+
+TEST(SkylineMatrix, BoundaryEntriesCoverRowAndColumn) {
+    long pos[dim + 1];
+    fillPositions(pos);
+    cvOneDSkylineMatrix mat(dim, pos);
+
+    long bcEqs[1] = {4};
+    mat.SetBoundaryEquations(1, bcEqs);
+
+    const long* indices;
+    const long* positions;
+    long nent = mat.GetBoundaryEntries(4, &indices, &positions);
+    ASSERT_EQ(nent, mat.GetNumberOfEntriesIn(4));
+
+    long expected[dim];
+    mat.GetColumnEntries(4, expected);
+    for(long i = 0; i < nent; i++){
+        EXPECT_EQ(indices[i], expected[i]);
+        EXPECT_EQ(positions[i], mat.GetPosition(4, indices[i]));
+        EXPECT_EQ(positions[i], mat.GetPosition(indices[i], 4));
+    }
+
+    EXPECT_EQ(mat.GetBoundaryEntries(2, &indices, &positions), -1);
+}
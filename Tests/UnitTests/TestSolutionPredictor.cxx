@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+
+#include "cvOneDSolutionPredictor.h"
+
+namespace {
+
+// Two nodes with an area and a flow rate each
+void fill(cvOneDFEAVector& u, double t){
+    u.Set(0, 1.0 + t * t);
+    u.Set(1, 2.0 * t - 3.0 * t * t);
+    u.Set(2, 2.0 + t);
+    u.Set(3, std::sin(6.0 * t));
+}
+
+} // namespace
+
+TEST(SolutionPredictor, QuadraticIsExactForQuadratics) {
+    cvOneDSolutionPredictor predictor(PredictorTypeScope::QUADRATIC, 0);
+    cvOneDFEAVector u(4, "u");
+    // uneven steps, as with adaptive time stepping
+    double times[3] = {0.0, 0.1, 0.25};
+    for(double t : times){
+        fill(u, t);
+        predictor.Push(u, t);
+    }
+    ASSERT_TRUE(predictor.Predict(u, 0.3, 4));
+    EXPECT_NEAR(u.Get(0), 1.0 + 0.09, 1.0e-12);
+    EXPECT_NEAR(u.Get(1), 0.6 - 0.27, 1.0e-12);
+    EXPECT_NEAR(u.Get(2), 2.3, 1.0e-12);
+    EXPECT_EQ(predictor.GetNumberOfPredictions(), 1);
+}
+
+TEST(SolutionPredictor, CycleRepeatsPeriodicSolution) {
+    const long cycleSteps = 20;
+    const double dt = 2.0 * M_PI / 6.0 / cycleSteps;
+    cvOneDSolutionPredictor predictor(PredictorTypeScope::CYCLE, cycleSteps);
+    cvOneDFEAVector u(4, "u");
+    for(long k = 0; k <= cycleSteps + 3; k++){
+        u.Set(0, 1.5 + std::cos(6.0 * k * dt));
+        u.Set(1, std::sin(6.0 * k * dt));
+        u.Set(2, 3.0);
+        u.Set(3, 0.0);
+        predictor.Push(u, k * dt);
+    }
+    double t = (cycleSteps + 4) * dt;
+    ASSERT_TRUE(predictor.Predict(u, t, 4));
+    EXPECT_NEAR(u.Get(0), 1.5 + std::cos(6.0 * t), 1.0e-12);
+    EXPECT_NEAR(u.Get(1), std::sin(6.0 * t), 1.0e-12);
+}
+
+TEST(SolutionPredictor, KeepsGuessWithNegativeArea) {
+    cvOneDSolutionPredictor predictor(PredictorTypeScope::LINEAR, 0);
+    cvOneDFEAVector u(4, "u");
+    EXPECT_FALSE(predictor.Predict(u, 0.0, 4));
+    u.Set(0, 1.0);
+    predictor.Push(u, 0.0);
+    u.Set(0, 0.4);
+    predictor.Push(u, 1.0);
+    // the area would become -0.2
+    ASSERT_FALSE(predictor.Predict(u, 2.0, 4));
+    EXPECT_DOUBLE_EQ(u.Get(0), 0.4);
+    // flow rates may change sign
+    EXPECT_TRUE(predictor.Predict(u, 2.0, 0));
+}
+
+TEST(SolutionPredictor, StationarySolutionIsKept) {
+    cvOneDSolutionPredictor predictor(PredictorTypeScope::QUADRATIC, 0);
+    cvOneDFEAVector u(4, "u");
+    fill(u, 0.0);
+    predictor.Push(u, 0.0);
+    fill(u, 0.1);
+    predictor.Push(u, 0.1);
+    predictor.Push(u, 0.2);
+    EXPECT_FALSE(predictor.Predict(u, 0.3, 4));
+    EXPECT_EQ(predictor.GetNumberOfPredictions(), 0);
+}
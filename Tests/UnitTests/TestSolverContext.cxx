@@ -0,0 +1,81 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cvOneDContext.h"
+#include "cvOneDModelManager.h"
+
+namespace {
+
+// Straight tube with a constant inflow and a resistance outlet, solved in
+// the context of the calling thread. Returns the saved flow rates.
+std::vector<double> runTube(const std::string& name, double inflow){
+    cvOneDModelManager oned((char*)name.c_str());
+    oned.CreateNode((char*)"IN", 0.0, 0.0, 0.0);
+    oned.CreateNode((char*)"OUT", 0.0, 0.0, 10.0);
+    double params[3] = {1.0e15, -20.0, 1.0e9};
+    int matID = 0;
+    oned.CreateMaterial((char*)"MAT", (char*)"MATERIAL_OLUFSEN", 1.06, 0.04, 2.0, 0.0, 3, params, &matID);
+    double resistance = 100.0;
+    double outletTime = 0.0;
+    oned.CreateSegment((char*)"tube", 0, 10.0, 20, 0, 1, 1.0, 1.0, 0.0, matID, (char*)"NONE",
+                       0.0, 0, 0, (char*)"RESISTANCE", &resistance, &outletTime, 1);
+    double times[2] = {0.0, 1.0};
+    double flows[2] = {inflow, inflow};
+    oned.SolveModel(1.0e-3, 10, 100, 2, 2, (char*)"FLOW", flows, times, 1.0e-8, 1, 1);
+
+    std::vector<double> result;
+    std::ifstream file((name + "tube_flow.dat").c_str());
+    double value;
+    while(file >> value){
+        result.push_back(value);
+    }
+    const char* fields[5] = {"flow", "area", "pressure", "wss", "Re"};
+    for(int i = 0; i < 5; i++){
+        std::remove((name + "tube_" + fields[i] + ".dat").c_str());
+    }
+    return result;
+}
+
+std::vector<double> runInContext(const std::string& name, double inflow){
+    cvOneDContext context;
+    cvOneDContext::Scope scope(&context);
+    return runTube(name, inflow);
+}
+
+} // namespace
+
+// Each thread creates and solves its own model in its own context, the
+// results are those of the same models solved one after the other.
+TEST(SolverContext, ThreadsRunIndependentModels) {
+    std::vector<double> slow = runInContext("contextSerialA_", 50.0);
+    std::vector<double> fast = runInContext("contextSerialB_", 100.0);
+    ASSERT_FALSE(slow.empty());
+    ASSERT_EQ(slow.size(), fast.size());
+    EXPECT_NE(slow.back(), fast.back());
+
+    std::vector<double> threadSlow;
+    std::vector<double> threadFast;
+    std::thread first([&](){threadSlow = runInContext("contextThreadA_", 50.0);});
+    std::thread second([&](){threadFast = runInContext("contextThreadB_", 100.0);});
+    first.join();
+    second.join();
+
+    EXPECT_EQ(threadSlow, slow);
+    EXPECT_EQ(threadFast, fast);
+}
+
+// Without a bound context the process default one is used.
+TEST(SolverContext, ScopeBindsContext) {
+    cvOneDContext* processContext = cvOneDContext::Current();
+    {
+        cvOneDContext context;
+        cvOneDContext::Scope scope(&context);
+        EXPECT_EQ(cvOneDContext::Current(), &context);
+    }
+    EXPECT_EQ(cvOneDContext::Current(), processContext);
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include "cvOneDSubdomain.h"
+
+namespace {
+
+const double dt = 1.0e-3;
+
+void setupRCR(cvOneDSubdomain& sub){
+    double rcr[3] = {1000.0, 1.0e-4, 12000.0};
+    sub.SetBoundRCRValues(rcr, 3);
+}
+
+// Pressure convolution after one step of size step from time start,
+// as the outlet condition evaluates it in every Newton iteration
+double advance(cvOneDSubdomain& sub, double start, double step, double prevP){
+    double currP = prevP + 50.0;
+    sub.MemIntRCR(currP, prevP, step, start + step);
+    return sub.MemIntRCR(currP, prevP, step, start + step);
+}
+
+} // namespace
+
+// Rejecting a step and retrying it with half the size must give the same
+// outlet memory as taking the smaller step in the first place.
+TEST(SubdomainBoundaryMemory, RestoreUndoesRejectedStep) {
+    cvOneDSubdomain retried;
+    cvOneDSubdomain direct;
+    setupRCR(retried);
+    setupRCR(direct);
+
+    advance(retried, 0.0, dt, 1.0e5);
+    advance(retried, dt, dt, 1.1e5);
+    advance(direct, 0.0, dt, 1.0e5);
+    advance(direct, dt, dt, 1.1e5);
+
+    retried.SaveBoundaryMemory();
+    double rejected = advance(retried, 2.0 * dt, dt, 1.2e5);
+    retried.RestoreBoundaryMemory();
+    double accepted = advance(retried, 2.0 * dt, 0.5 * dt, 1.2e5);
+
+    double expected = advance(direct, 2.0 * dt, 0.5 * dt, 1.2e5);
+    EXPECT_DOUBLE_EQ(accepted, expected);
+    EXPECT_NE(rejected, accepted);
+
+    // The next step advances the memory over the half step
+    EXPECT_DOUBLE_EQ(advance(retried, 2.5 * dt, dt, 1.3e5), advance(direct, 2.5 * dt, dt, 1.3e5));
+}
+
+// A memory completed at the end of a step continues in another subdomain,
+// with another step size, like the one that took the step.
+TEST(SubdomainBoundaryMemory, CompletedMemoryResumes) {
+    cvOneDSubdomain direct;
+    cvOneDSubdomain resumed;
+    setupRCR(direct);
+    setupRCR(resumed);
+
+    advance(direct, 0.0, dt, 1.0e5);
+    advance(direct, dt, dt, 1.1e5);
+
+    cvOneDSubdomain completed;
+    setupRCR(completed);
+    completed.SetBoundCondition(BoundCondTypeScope::RCR);
+    advance(completed, 0.0, dt, 1.0e5);
+    advance(completed, dt, dt, 1.1e5);
+    completed.CompleteBoundaryMemory(1.1e5, 2.0 * dt, false);
+    double memory[cvOneDSubdomain::BOUNDARY_MEMORY_SIZE];
+    completed.GetBoundaryMemory(memory);
+    resumed.SetBoundaryMemory(memory);
+    resumed.ResumeBoundaryMemory(2.0 * dt, 5.0 * dt);
+
+    EXPECT_DOUBLE_EQ(advance(resumed, 2.0 * dt, 5.0 * dt, 1.1e5), advance(direct, 2.0 * dt, 5.0 * dt, 1.1e5));
+    EXPECT_DOUBLE_EQ(advance(resumed, 7.0 * dt, 5.0 * dt, 1.2e5), advance(direct, 7.0 * dt, 5.0 * dt, 1.2e5));
+}
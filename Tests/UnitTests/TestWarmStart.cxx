@@ -0,0 +1,40 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "cvOneDException.h"
+#include "cvOneDWarmStart.h"
+
+namespace {
+
+// Three nodes and two saved steps, the second one is the final state
+void writeResults(const std::string& prefix){
+    std::ofstream area((prefix + "seg0_area.dat").c_str());
+    area << "1.0 2.0 \n1.0 3.0 \n1.0 5.0 \n";
+    std::ofstream flow((prefix + "seg0_flow.dat").c_str());
+    flow << "0.0 4.0 \n0.0 6.0 \n0.0 10.0 \n";
+}
+
+} // namespace
+
+// The final column is interpolated linearly at the relative position.
+TEST(WarmStart, InterpolatesFinalState) {
+    std::string prefix = "warmStartTest_";
+    writeResults(prefix);
+
+    cvOneDWarmStart results(prefix);
+    results.Load("seg0");
+
+    EXPECT_DOUBLE_EQ(results.GetArea(0.0), 2.0);
+    EXPECT_DOUBLE_EQ(results.GetArea(0.25), 2.5);
+    EXPECT_DOUBLE_EQ(results.GetArea(0.75), 4.0);
+    EXPECT_DOUBLE_EQ(results.GetArea(1.0), 5.0);
+    EXPECT_DOUBLE_EQ(results.GetFlow(0.5), 6.0);
+    EXPECT_DOUBLE_EQ(results.GetFlow(1.0), 10.0);
+
+    EXPECT_THROW(results.Load("seg1"), cvException);
+
+    std::remove((prefix + "seg0_area.dat").c_str());
+    std::remove((prefix + "seg0_flow.dat").c_str());
+}
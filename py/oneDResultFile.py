@@ -0,0 +1,61 @@
+import struct
+import numpy as np
+
+# ===============================================
+# READER OF THE INDEXED BINARY RESULT FILE
+# (outputType BINARY, layout in cvOneDResultFile.h)
+# ===============================================
+class resultFile():
+
+  FIELDS = ['flow', 'area', 'pressure', 'Re', 'wss']
+
+  def __init__(self, fileName):
+    self.file = open(fileName, 'rb')
+    magic = self.file.read(8)
+    version, numSegments, numSteps, numFields, self.stepsPerChunk, indexOffset = \
+      struct.unpack('=6q', self.file.read(48))
+    if magic != b'ONEDRES1' or version != 1 or numFields != len(self.FIELDS):
+      raise ValueError(fileName + ' is not a result file of this version')
+    self.numChunks = (numSteps + self.stepsPerChunk - 1) // self.stepsPerChunk
+    self.times = np.fromfile(self.file, dtype=np.float64, count=numSteps)
+    self.file.seek(16 * numFields, 1)
+    self.segments = []
+    self.nodes = []
+    for loopA in range(numSegments):
+      nodes, nameLength = struct.unpack('=2q', self.file.read(16))
+      self.segments.append(self.file.read(nameLength).decode())
+      self.nodes.append(nodes)
+    self.file.seek(indexOffset)
+    self.index = np.fromfile(self.file, dtype=np.int64,
+                             count=numSegments * self.numChunks * numFields)
+    self.index = self.index.reshape(numSegments, self.numChunks, numFields)
+
+  def close(self):
+    self.file.close()
+
+  # Values of a field of a segment, by index or name, one row per step
+  # from firstStep, all steps from there without numSteps
+  def read(self, segment, field, firstStep=0, numSteps=None):
+    if isinstance(segment, str):
+      segment = self.segments.index(segment)
+    field = self.FIELDS.index(field)
+    if numSteps is None:
+      numSteps = len(self.times) - firstStep
+    if firstStep < 0 or numSteps < 0 or firstStep + numSteps > len(self.times):
+      raise ValueError('Invalid steps of the result file')
+    nodes = self.nodes[segment]
+    values = np.empty((numSteps, nodes))
+    step = firstStep
+    done = 0
+    while done < numSteps:
+      # the steps of the range held by this chunk are contiguous in it
+      chunk = step // self.stepsPerChunk
+      inChunk = step - chunk * self.stepsPerChunk
+      chunkSteps = min(self.stepsPerChunk, len(self.times) - chunk * self.stepsPerChunk)
+      count = min(numSteps - done, chunkSteps - inChunk)
+      self.file.seek(int(self.index[segment, chunk, field]) + inChunk * nodes * 8)
+      values[done:done + count] = np.fromfile(self.file, dtype=np.float64,
+                                              count=count * nodes).reshape(count, nodes)
+      step += count
+      done += count
+    return values